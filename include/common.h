@@ -156,6 +156,18 @@ typedef struct {
   uint32_t target_video_duration; /* Target video length in seconds (default: 300 = 5 min) */
   int auto_scale;              /* Auto-scale FPS and decay based on data span (default: 1) */
   int show_timestamp;          /* Show timestamp overlay on frames (default: 0) */
+  int ingest_jobs;             /* Parser threads for merged multi-file ingest (default: 1 = serial) */
+  int bin_jobs;                /* Render threads for finished bins (default: 1 = inline) */
+  int gz_readahead;            /* Inflate serial input on a separate thread (default: 1) */
+  uint32_t decay_cache_mb;     /* Decay cache memory budget in MB (default: 64, 0 = unlimited) */
+  int hilbert_order;           /* Hilbert curve order, heatmap is 2^order square (default: 12) */
+  uint32_t mem_limit_mb;       /* Budget for dense heatmap-sized buffers in MB (default: 0 = half of RAM) */
+  int exp_decay;               /* Fade coordinates exponentially instead of linearly (default: 0) */
+  const char *stats_file;      /* Per-frame statistics CSV (default: NULL = none) */
+  const char *load_state_file; /* Checkpoint to resume residue/decay from (default: NULL = cold start) */
+  const char *save_state_file; /* Checkpoint to write after processing (default: NULL = none) */
+  uint32_t reorder_seconds;    /* Hold events back this long to bin late ones in order (default: 0 = off) */
+  const char *prefix_table_file; /* Cache file for the /24 coordinate table (default: NULL = off) */
 
   /* Coordinate mapping strategy (v0.2.0+) */
   MappingStrategy_t mapping_strategy; /* Visualization mapping mode (default: MAPPING_HILBERT_IP) */
@@ -0,0 +1,549 @@
+/*****
+ *
+ * Description: Parallel Frame Rendering
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#include "binjobs.h"
+#include "mem.h"
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+/****
+ *
+ * typedefs
+ *
+ ****/
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * A finished bin waiting for (or being turned into) its frame
+ */
+typedef struct {
+    TimeBin_t *bin;
+    char output_path[PATH_MAX];
+    uint64_t residue_steps;       // Residue log length when the bin was handed over
+    uint32_t residue_max_volume;
+    int done;                     // Frame finished, bin may go back to the manager
+    int written;                  // Frame written successfully
+} BinJob_t;
+
+/**
+ * Render thread and the state it carries from one frame to the next
+ *
+ * Everything but residue_done is private to the thread. Buffers are
+ * allocated before the thread starts, so rendering never allocates.
+ */
+typedef struct {
+    struct BinJobs_s *jobs;
+    pthread_t thread;
+    uint32_t *grid;               // Render grid for sparse bins, all zero between frames (NULL = read in place)
+    GridMap_t *residue;           // Residue volumes as of the last replayed log step (dense)
+    uint8_t *image;               // Frame buffer (getPPMBufferSize())
+    ResidueLogBlock_t *block;     // Log block holding residue_pos, or ending at it
+    uint64_t block_base;          // Position of block's first step
+    uint64_t residue_pos;         // Log steps replayed
+    uint64_t residue_done;        // residue_pos after the last finished frame (under lock)
+} BinWorker_t;
+
+/**
+ * Shared bin job state
+ *
+ * Jobs are a ring of ring_size slots indexed by free-running counters:
+ * submitted >= taken >= reclaimed. Only the binning thread submits and
+ * reclaims, so the manager (bin pool, residue log) is never touched by
+ * a worker.
+ */
+struct BinJobs_s {
+    TimeBinManager_t *manager;
+    uint32_t width;
+    uint32_t height;
+    BinJob_t *ring;
+    uint32_t ring_size;
+    uint64_t submitted;           // Jobs handed over
+    uint64_t taken;               // Jobs picked up by a worker
+    uint64_t reclaimed;           // Jobs whose bin went back to the manager
+    uint32_t failed;              // Frames that could not be written
+    int shutdown;
+    BinWorker_t *workers;
+    int worker_count;             // Threads running
+    int worker_total;             // Workers with buffers allocated
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;     // Job queued or shutdown - workers may have work
+    pthread_cond_t done_cond;     // Job finished - binning thread may reclaim
+};
+#endif
+
+/****
+ *
+ * external variables
+ *
+ ****/
+
+extern Config_t *config;
+
+/****
+ *
+ * functions
+ *
+ ****/
+
+/****
+ *
+ * Resolve requested bin job count
+ *
+ * DESCRIPTION:
+ *   Maps the -B argument to a usable render thread count. 0 means one per
+ *   online CPU. Builds without pthreads always get 1.
+ *
+ * PARAMETERS:
+ *   requested - Value given on the command line (0 = auto)
+ *
+ * RETURNS:
+ *   Thread count between 1 and BIN_JOBS_MAX
+ *
+ ****/
+int getBinJobs(int requested)
+{
+#ifdef HAVE_PTHREAD_H
+    long cpus;
+
+    if (requested <= 0) {
+        cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        requested = (cpus > 0) ? (int)cpus : 1;
+    }
+    if (requested > BIN_JOBS_MAX) {
+        requested = BIN_JOBS_MAX;
+    }
+
+    return requested;
+#else
+    (void)requested;
+    return 1;
+#endif
+}
+
+#ifdef HAVE_PTHREAD_H
+/****
+ *
+ * Bring a worker's residue copy up to a bin's log position
+ *
+ * DESCRIPTION:
+ *   Workers take jobs in submission order, so target never goes back.
+ *   The next block is only followed once a step past the current one is
+ *   wanted, which the binning thread published after linking it.
+ *
+ ****/
+PRIVATE void replayResidueLog(BinWorker_t *worker, uint64_t target)
+{
+    ResidueStep_t *step;
+
+    while (worker->residue_pos < target) {
+        if (worker->residue_pos == worker->block_base + RESIDUE_LOG_BLOCK_STEPS) {
+            worker->block = worker->block->next;
+            worker->block_base += RESIDUE_LOG_BLOCK_STEPS;
+        }
+        step = &worker->block->steps[worker->residue_pos - worker->block_base];
+        setGridMapCell(worker->residue, step->idx, step->volume);
+        worker->residue_pos++;
+    }
+}
+
+/****
+ *
+ * Render thread main loop
+ *
+ * DESCRIPTION:
+ *   Takes the oldest queued bin, replays the residue log to the bin's
+ *   position, then expands, writes and collapses it with the worker's own
+ *   grid, residue copy and frame buffer. The frame is byte-for-byte what
+ *   the binning thread would have written at the same point.
+ *
+ ****/
+PRIVATE void *binJobsWorker(void *arg)
+{
+    BinWorker_t *worker = (BinWorker_t *)arg;
+    BinJobs_t *jobs = worker->jobs;
+    BinJob_t *job;
+    int written;
+
+    pthread_mutex_lock(&jobs->lock);
+    for (;;) {
+        while (!jobs->shutdown && jobs->taken == jobs->submitted) {
+            pthread_cond_wait(&jobs->work_cond, &jobs->lock);
+        }
+        if (jobs->taken == jobs->submitted) {
+            /* Shut down and nothing left */
+            break;
+        }
+
+        job = &jobs->ring[jobs->taken % jobs->ring_size];
+        jobs->taken++;
+        pthread_mutex_unlock(&jobs->lock);
+
+        replayResidueLog(worker, job->residue_steps);
+
+        written = expandTimeBinInto(job->bin, worker->grid) &&
+                  writePPMBuffer(job->output_path, job->bin, jobs->width, jobs->height,
+                                 worker->residue, job->residue_max_volume, worker->image);
+        collapseTimeBin(jobs->manager, job->bin);
+
+        if (!written) {
+            fprintf(stderr, "ERR - Failed to write frame: %s\n", job->output_path);
+        }
+
+        pthread_mutex_lock(&jobs->lock);
+        job->written = written;
+        job->done = TRUE;
+        worker->residue_done = worker->residue_pos;
+        pthread_cond_broadcast(&jobs->done_cond);
+    }
+    pthread_mutex_unlock(&jobs->lock);
+
+    return NULL;
+}
+
+/****
+ *
+ * Return finished bins to the manager (caller holds the lock)
+ *
+ * DESCRIPTION:
+ *   Releases bins in submission order up to the first unfinished one and
+ *   frees residue log blocks every worker has replayed.
+ *
+ ****/
+PRIVATE void reclaimBinJobs(BinJobs_t *jobs)
+{
+    BinJob_t *job;
+    uint64_t consumed = UINT64_MAX;
+    int i;
+
+    while (jobs->reclaimed < jobs->submitted) {
+        job = &jobs->ring[jobs->reclaimed % jobs->ring_size];
+        if (!job->done) {
+            break;
+        }
+        if (!job->written) {
+            jobs->failed++;
+        }
+        releaseTimeBin(jobs->manager, job->bin);
+        job->bin = NULL;
+        jobs->reclaimed++;
+    }
+
+    for (i = 0; i < jobs->worker_count; i++) {
+        if (jobs->workers[i].residue_done < consumed) {
+            consumed = jobs->workers[i].residue_done;
+        }
+    }
+    trimResidueLog(jobs->manager, consumed);
+}
+
+/****
+ *
+ * Free worker buffers and shared state (threads already joined)
+ *
+ ****/
+PRIVATE void freeBinJobs(BinJobs_t *jobs)
+{
+    int i;
+
+    for (i = 0; i < jobs->worker_total; i++) {
+        if (jobs->workers[i].grid) {
+            XFREE(jobs->workers[i].grid);
+        }
+        destroyGridMap(jobs->workers[i].residue);
+        XFREE(jobs->workers[i].image);
+    }
+    XFREE(jobs->workers);
+    XFREE(jobs->ring);
+
+    pthread_cond_destroy(&jobs->done_cond);
+    pthread_cond_destroy(&jobs->work_cond);
+    pthread_mutex_destroy(&jobs->lock);
+
+    XFREE(jobs);
+}
+#endif
+
+/****
+ *
+ * Start render threads for finished bins
+ *
+ * DESCRIPTION:
+ *   Binning stays on the calling thread: every event updates the decay
+ *   cache and the residue map, which depend on event order, and costs
+ *   far less than turning a bin into a frame. Each finished bin (decay
+ *   already applied, totals accumulated) becomes an independent job that
+ *   a worker expands and writes while binning moves on.
+ *
+ *   The residue map is handed over as mergeable state: each worker starts
+ *   from a copy of it and replays the manager's residue log (class
+ *   changes only) up to the position recorded with each bin, so it sees
+ *   exactly the residue the serial path would have drawn for that frame.
+ *
+ * PARAMETERS:
+ *   manager - Bin manager whose finished bins will be submitted
+ *   viz_config - Frame size
+ *   jobs - Render threads wanted (from getBinJobs())
+ *
+ * RETURNS:
+ *   BinJobs_t to submit bins to, NULL when frames should be rendered
+ *   inline (jobs <= 1, no pthreads, a sparse residue map, or no thread
+ *   could be started)
+ *
+ * SIDE EFFECTS:
+ *   Enables the manager's residue log, builds the non-routable mask and
+ *   raises the bin pool to cover queued bins
+ *
+ * MEMORY:
+ *   Per worker: a dimension² residue copy and, when the manager renders
+ *   through a dense grid, a render grid (64MB each at the default order)
+ *   plus one frame buffer
+ *
+ ****/
+BinJobs_t *createBinJobs(TimeBinManager_t *manager, const VisualizationConfig_t *viz_config, int jobs_wanted)
+{
+#ifdef HAVE_PTHREAD_H
+    BinJobs_t *jobs;
+    BinWorker_t *worker;
+    size_t grid_size;
+    int i;
+
+    if (!manager || !viz_config || jobs_wanted <= 1) {
+        return NULL;
+    }
+
+    /* Workers replay residue changes into copies that must never allocate */
+    if (manager->residue_map->layout != GRIDMAP_DENSE) {
+        fprintf(stderr, "WARN - Residue map is sparse at this order and memory limit, rendering frames inline\n");
+        return NULL;
+    }
+
+    if (!enableResidueLog(manager)) {
+        return NULL;
+    }
+
+    /* Shared by every worker, build it while there is one thread */
+    prepareNonRoutableMask(manager->config.dimension);
+
+    /* Allocation happens here, before any render thread starts */
+    jobs = (BinJobs_t *)XMALLOC(sizeof(BinJobs_t));
+    XMEMSET(jobs, 0, sizeof(BinJobs_t));
+    jobs->manager = manager;
+    jobs->width = viz_config->width;
+    jobs->height = viz_config->height;
+    jobs->ring_size = (uint32_t)jobs_wanted * BIN_JOBS_QUEUED;
+    jobs->ring = (BinJob_t *)XMALLOC((int)(sizeof(BinJob_t) * jobs->ring_size));
+    XMEMSET(jobs->ring, 0, (int)(sizeof(BinJob_t) * jobs->ring_size));
+    reserveTimeBins(manager, TIMEBIN_POOL_SIZE + jobs->ring_size);
+
+    pthread_mutex_init(&jobs->lock, NULL);
+    pthread_cond_init(&jobs->work_cond, NULL);
+    pthread_cond_init(&jobs->done_cond, NULL);
+
+    grid_size = (size_t)manager->config.dimension * manager->config.dimension * sizeof(uint32_t);
+    jobs->workers = (BinWorker_t *)XMALLOC((int)(sizeof(BinWorker_t) * (size_t)jobs_wanted));
+    XMEMSET(jobs->workers, 0, (int)(sizeof(BinWorker_t) * (size_t)jobs_wanted));
+    for (i = 0; i < jobs_wanted; i++) {
+        worker = &jobs->workers[i];
+        worker->jobs = jobs;
+        if (manager->config.dense_render) {
+            worker->grid = (uint32_t *)XMALLOC((int)grid_size);
+            XMEMSET(worker->grid, 0, (int)grid_size);
+        }
+        worker->residue = copyGridMap(manager->residue_map);
+        worker->image = (uint8_t *)XMALLOC((int)getPPMBufferSize(jobs->width, jobs->height));
+        worker->block = manager->residue_log_tail;
+        worker->block_base = manager->residue_log_tail_base;
+        worker->residue_pos = manager->residue_log_total;
+        worker->residue_done = manager->residue_log_total;
+        jobs->worker_total++;
+    }
+
+    for (i = 0; i < jobs_wanted; i++) {
+        if (pthread_create(&jobs->workers[i].thread, NULL, binJobsWorker, &jobs->workers[i]) != 0) {
+            fprintf(stderr, "WARN - Failed to start render thread %d, continuing with %d\n",
+                    i + 1, jobs->worker_count);
+            break;
+        }
+        jobs->worker_count++;
+    }
+
+    if (jobs->worker_count == 0) {
+        freeBinJobs(jobs);
+        return NULL;
+    }
+
+#ifdef DEBUG
+    if (config->debug >= 1) {
+        fprintf(stderr, "DEBUG - Rendering frames on %d threads (%u bins queued at most)\n",
+                jobs->worker_count, jobs->ring_size);
+    }
+#endif
+
+    return jobs;
+#else
+    (void)manager;
+    (void)viz_config;
+    (void)jobs_wanted;
+    return NULL;
+#endif
+}
+
+/****
+ *
+ * Hand a finished bin to the render threads
+ *
+ * DESCRIPTION:
+ *   Queues the bin with the current residue log position. Blocks while
+ *   ring_size bins are already queued or rendering. The bin belongs to
+ *   the jobs until it is released back to the manager's pool once its
+ *   frame is done.
+ *
+ * PARAMETERS:
+ *   jobs - Render threads (createBinJobs())
+ *   bin - Finished bin, detached from the manager (retireTimeBin())
+ *   output_path - Frame file to write
+ *
+ * RETURNS:
+ *   TRUE if queued, FALSE on bad arguments
+ *
+ ****/
+int submitBinJob(BinJobs_t *jobs, TimeBin_t *bin, const char *output_path)
+{
+#ifdef HAVE_PTHREAD_H
+    BinJob_t *job;
+
+    if (!jobs || !bin || !output_path) {
+        return FALSE;
+    }
+
+    pthread_mutex_lock(&jobs->lock);
+    reclaimBinJobs(jobs);
+    while (jobs->submitted - jobs->reclaimed == jobs->ring_size) {
+        pthread_cond_wait(&jobs->done_cond, &jobs->lock);
+        reclaimBinJobs(jobs);
+    }
+
+    job = &jobs->ring[jobs->submitted % jobs->ring_size];
+    job->bin = bin;
+    snprintf(job->output_path, sizeof(job->output_path), "%s", output_path);
+    job->residue_steps = jobs->manager->residue_log_total;
+    job->residue_max_volume = jobs->manager->residue_max_volume;
+    job->done = FALSE;
+    job->written = FALSE;
+    jobs->submitted++;
+
+    pthread_cond_signal(&jobs->work_cond);
+    pthread_mutex_unlock(&jobs->lock);
+
+    return TRUE;
+#else
+    (void)jobs;
+    (void)bin;
+    (void)output_path;
+    return FALSE;
+#endif
+}
+
+/****
+ *
+ * Wait for every submitted frame
+ *
+ * DESCRIPTION:
+ *   Returns once all queued bins are rendered and back in the manager's
+ *   pool. The render threads keep running for further bins.
+ *
+ * PARAMETERS:
+ *   jobs - Render threads (may be NULL)
+ *
+ * RETURNS:
+ *   TRUE if every frame so far was written, FALSE otherwise
+ *
+ ****/
+int finishBinJobs(BinJobs_t *jobs)
+{
+#ifdef HAVE_PTHREAD_H
+    int result;
+
+    if (!jobs) {
+        return TRUE;
+    }
+
+    pthread_mutex_lock(&jobs->lock);
+    reclaimBinJobs(jobs);
+    while (jobs->reclaimed < jobs->submitted) {
+        pthread_cond_wait(&jobs->done_cond, &jobs->lock);
+        reclaimBinJobs(jobs);
+    }
+    result = (jobs->failed == 0);
+    pthread_mutex_unlock(&jobs->lock);
+
+    return result;
+#else
+    (void)jobs;
+    return TRUE;
+#endif
+}
+
+/****
+ *
+ * Finish queued frames and stop the render threads
+ *
+ * PARAMETERS:
+ *   jobs - Render threads (may be NULL for no-op)
+ *
+ ****/
+void destroyBinJobs(BinJobs_t *jobs)
+{
+#ifdef HAVE_PTHREAD_H
+    int i;
+
+    if (!jobs) {
+        return;
+    }
+
+    finishBinJobs(jobs);
+
+    pthread_mutex_lock(&jobs->lock);
+    jobs->shutdown = TRUE;
+    pthread_cond_broadcast(&jobs->work_cond);
+    pthread_mutex_unlock(&jobs->lock);
+
+    for (i = 0; i < jobs->worker_count; i++) {
+        pthread_join(jobs->workers[i].thread, NULL);
+    }
+
+    freeBinJobs(jobs);
+#else
+    (void)jobs;
+#endif
+}
@@ -0,0 +1,75 @@
+/*****
+ *
+ * Description: Parallel Frame Rendering Headers
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#ifndef BINJOBS_DOT_H
+#define BINJOBS_DOT_H
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "../include/sysdep.h"
+
+#ifndef __SYSDEP_H__
+#error something is messed up
+#endif
+
+#include "../include/common.h"
+#include "timebin.h"
+#include "visualize.h"
+
+/****
+ *
+ * defines
+ *
+ ****/
+
+#define BIN_JOBS_MAX 64                   // Upper bound for -B
+#define BIN_JOBS_QUEUED 2                 // Finished bins waiting per worker
+
+/****
+ *
+ * typedefs & structs
+ *
+ ****/
+
+typedef struct BinJobs_s BinJobs_t;
+
+/****
+ *
+ * function prototypes
+ *
+ ****/
+
+int getBinJobs(int requested);
+BinJobs_t *createBinJobs(TimeBinManager_t *manager, const VisualizationConfig_t *viz_config, int jobs);
+int submitBinJob(BinJobs_t *jobs, TimeBin_t *bin, const char *output_path);
+int finishBinJobs(BinJobs_t *jobs);
+void destroyBinJobs(BinJobs_t *jobs);
+
+#endif /* BINJOBS_DOT_H */
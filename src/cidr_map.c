@@ -29,7 +29,10 @@
  * 2. Uses GeoIP to determine timezone for each block
  * 3. Counts /24 blocks per timezone
  * 4. Calculates proportional X-axis allocation based on density
- * 5. Generates mapping file: cidr_map.txt
+ * 5. Generates mapping file: cidr_map.txt (or binary, for a .bin name)
+ *
+ * "cidr_mapper --convert cidr_map.txt cidr_map.bin" turns an existing
+ * text map into the binary format (cidr_map.h) tplot maps at startup.
  *
  ****/
 
@@ -40,6 +43,7 @@
 #include <time.h>
 #include <maxminddb.h>
 #include <arpa/inet.h>
+#include "cidr_map.h"
 
 /****
  * Constants
@@ -424,6 +428,215 @@ void writeMappingFile(const char *filename, uint32_t hilbert_dimension)
     fprintf(stderr, "Mapping file written: %s (%u entries)\n", filename, cidr_mapping_count);
 }
 
+/****
+ *
+ * Order records the way tplot sorts a text map
+ *
+ * DESCRIPTION:
+ *   qsort() callback: prefix length descending, then network, timezone,
+ *   x_start and x_end ascending (see cidr_map.h).
+ *
+ ****/
+int compareMapRecords(const void *a, const void *b)
+{
+    const CIDRMapRecord_t *ra = (const CIDRMapRecord_t *)a;
+    const CIDRMapRecord_t *rb = (const CIDRMapRecord_t *)b;
+
+    if (ra->prefix_len != rb->prefix_len) {
+        return rb->prefix_len - ra->prefix_len;
+    }
+    if (ra->network != rb->network) {
+        return (ra->network < rb->network) ? -1 : 1;
+    }
+    if (ra->timezone_offset != rb->timezone_offset) {
+        return (ra->timezone_offset < rb->timezone_offset) ? -1 : 1;
+    }
+    if (ra->x_start != rb->x_start) {
+        return (ra->x_start < rb->x_start) ? -1 : 1;
+    }
+    if (ra->x_end != rb->x_end) {
+        return (ra->x_end < rb->x_end) ? -1 : 1;
+    }
+    return 0;
+}
+
+/****
+ *
+ * Write a binary mapping file
+ *
+ * DESCRIPTION:
+ *   Sorts the records and writes them behind a CIDRMapFileHeader_t, via a
+ *   temporary file and rename() so tplot never maps a partial file.
+ *
+ * PARAMETERS:
+ *   filename - Output file path
+ *   hilbert_dimension - Dimension the X ranges are laid out for
+ *   records - Records to write (sorted in place)
+ *   count - Number of records
+ *
+ * RETURNS:
+ *   void
+ *
+ * SIDE EFFECTS:
+ *   Creates mapping file on disk, exits on error
+ *
+ ****/
+void writeBinaryRecords(const char *filename, uint32_t hilbert_dimension, CIDRMapRecord_t *records, uint32_t count)
+{
+    CIDRMapFileHeader_t header;
+    char tmp_path[4096];
+    FILE *fp;
+    int ok;
+
+    qsort(records, count, sizeof(CIDRMapRecord_t), compareMapRecords);
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CIDR_MAP_MAGIC, sizeof(header.magic));
+    header.header_bytes = sizeof(CIDRMapFileHeader_t);
+    header.record_bytes = sizeof(CIDRMapRecord_t);
+    header.dimension = hilbert_dimension;
+    for (uint32_t order = 0; order < 32; order++) {
+        if ((1U << order) == hilbert_dimension) {
+            header.order = order;
+        }
+    }
+    header.record_count = count;
+    header.file_bytes = sizeof(CIDRMapFileHeader_t) + (uint64_t)count * sizeof(CIDRMapRecord_t);
+
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", filename) >= (int)sizeof(tmp_path) ||
+        (fp = fopen(tmp_path, "wb")) == NULL) {
+        fprintf(stderr, "ERR - Cannot create mapping file: %s\n", filename);
+        exit(1);
+    }
+    ok = (fwrite(&header, sizeof(header), 1, fp) == 1 &&
+          (count == 0 || fwrite(records, sizeof(CIDRMapRecord_t), count, fp) == count));
+    if (fclose(fp) != 0) {
+        ok = 0;
+    }
+    if (!ok || rename(tmp_path, filename) != 0) {
+        fprintf(stderr, "ERR - Cannot write mapping file: %s\n", filename);
+        remove(tmp_path);
+        exit(1);
+    }
+
+    fprintf(stderr, "Binary mapping file written: %s (%u entries, dimension %u)\n",
+            filename, count, hilbert_dimension);
+}
+
+/****
+ *
+ * Generate binary CIDR mapping output file
+ *
+ * DESCRIPTION:
+ *   Binary counterpart of writeMappingFile(), used when the output file
+ *   name ends in ".bin".
+ *
+ * PARAMETERS:
+ *   filename - Output file path
+ *   hilbert_dimension - Visualization dimension
+ *
+ * RETURNS:
+ *   void
+ *
+ * SIDE EFFECTS:
+ *   Creates mapping file on disk
+ *
+ ****/
+void writeBinaryMappingFile(const char *filename, uint32_t hilbert_dimension)
+{
+    CIDRMapRecord_t *records = calloc(cidr_mapping_count > 0 ? cidr_mapping_count : 1, sizeof(CIDRMapRecord_t));
+
+    if (records == NULL) {
+        fprintf(stderr, "ERR - Failed to allocate binary mapping records\n");
+        exit(1);
+    }
+
+    for (uint32_t i = 0; i < cidr_mapping_count; i++) {
+        int tz_index = cidr_mappings[i].timezone_offset - TIMEZONE_MIN;
+
+        records[i].network = cidr_mappings[i].network;
+        records[i].prefix_len = cidr_mappings[i].prefix_len;
+        records[i].timezone_offset = cidr_mappings[i].timezone_offset;
+        records[i].x_start = timezone_stats[tz_index].x_start;
+        records[i].x_end = timezone_stats[tz_index].x_end;
+    }
+
+    writeBinaryRecords(filename, hilbert_dimension, records, cidr_mapping_count);
+    free(records);
+}
+
+/****
+ *
+ * Convert a text mapping file to the binary format
+ *
+ * DESCRIPTION:
+ *   Parses a cidr_map.txt the way tplot does (comment lines, including
+ *   "# Hilbert dimension: N", and "NETWORK/PREFIX TZ X_START X_END"
+ *   entries) and writes it out with writeBinaryRecords().
+ *
+ * PARAMETERS:
+ *   text_file - Existing text mapping file
+ *   binary_file - Binary file to write
+ *
+ * RETURNS:
+ *   0 on success, 1 on error
+ *
+ ****/
+int convertMappingFile(const char *text_file, const char *binary_file)
+{
+    CIDRMapRecord_t *records = NULL;
+    uint32_t count = 0, capacity = 0, line_num = 0;
+    uint32_t hilbert_dimension = CIDR_MAP_DIMENSION_DEFAULT;
+    char line[256];
+    FILE *fp;
+
+    fp = fopen(text_file, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "ERR - Cannot open mapping file: %s\n", text_file);
+        return 1;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        uint32_t oct1, oct2, oct3, oct4, prefix, x_start, x_end;
+        int tz;
+
+        line_num++;
+        if (line[0] == '#') {
+            sscanf(line, "# Hilbert dimension: %u", &hilbert_dimension);
+            continue;
+        }
+        if (line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+        if (sscanf(line, "%u.%u.%u.%u/%u %d %u %u",
+                   &oct1, &oct2, &oct3, &oct4, &prefix, &tz, &x_start, &x_end) != 8 || prefix > 32) {
+            fprintf(stderr, "WARN - Invalid mapping line %u: %s", line_num, line);
+            continue;
+        }
+
+        if (count >= capacity) {
+            capacity = capacity == 0 ? 65536 : capacity * 2;
+            records = realloc(records, capacity * sizeof(CIDRMapRecord_t));
+            if (records == NULL) {
+                fprintf(stderr, "ERR - Failed to allocate binary mapping records\n");
+                exit(1);
+            }
+        }
+        memset(&records[count], 0, sizeof(CIDRMapRecord_t));
+        records[count].network = (oct1 << 24) | (oct2 << 16) | (oct3 << 8) | oct4;
+        records[count].prefix_len = (uint8_t)prefix;
+        records[count].timezone_offset = tz;
+        records[count].x_start = x_start;
+        records[count].x_end = x_end;
+        count++;
+    }
+    fclose(fp);
+
+    writeBinaryRecords(binary_file, hilbert_dimension, records, count);
+    free(records);
+    return 0;
+}
+
 /****
  * Main
  ****/
@@ -432,8 +645,18 @@ int main(int argc, char **argv)
     const char *geoip_db = argc > 1 ? argv[1] : "GeoLite2-City.mmdb";
     const char *output_file = argc > 2 ? argv[2] : "cidr_map.txt";
     uint32_t hilbert_dimension = argc > 3 ? atoi(argv[3]) : 4096;  /* Default: order 12 */
+    size_t output_len = strlen(output_file);
     int status;
 
+    /* Text map to binary, no GeoIP database needed */
+    if (argc > 1 && strcmp(argv[1], "--convert") == 0) {
+        if (argc != 4) {
+            fprintf(stderr, "usage: %s --convert cidr_map.txt cidr_map.bin\n", argv[0]);
+            return 1;
+        }
+        return convertMappingFile(argv[2], argv[3]);
+    }
+
     fprintf(stderr, "\n");
     fprintf(stderr, "CIDR Allocation Mapper\n");
     fprintf(stderr, "======================\n\n");
@@ -456,7 +679,11 @@ int main(int argc, char **argv)
     calculateProportionalAllocation(hilbert_dimension);
 
     /* Write mapping file */
-    writeMappingFile(output_file, hilbert_dimension);
+    if (output_len > 4 && strcmp(output_file + output_len - 4, ".bin") == 0) {
+        writeBinaryMappingFile(output_file, hilbert_dimension);
+    } else {
+        writeMappingFile(output_file, hilbert_dimension);
+    }
 
     /* Cleanup */
     MMDB_close(&mmdb);
@@ -0,0 +1,77 @@
+/*****
+ *
+ * Description: Binary CIDR Map File Format
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#ifndef CIDR_MAP_DOT_H
+#define CIDR_MAP_DOT_H
+
+/****
+ *
+ * Shared by tplot (loadCIDRMapping()) and the standalone cidr_mapper
+ * tool, so it only depends on the C library.
+ *
+ ****/
+
+#include <stdint.h>
+
+/****
+ *
+ * defines
+ *
+ ****/
+
+#define CIDR_MAP_MAGIC "TPCIDRM1"            /* 8 bytes, version in the last byte */
+#define CIDR_MAP_DIMENSION_DEFAULT 4096      /* Text maps without a "# Hilbert dimension:" line */
+
+/****
+ *
+ * typedefs & structs
+ *
+ ****/
+
+/**
+ * Binary CIDR map header, followed by record_count CIDRMapRecord_t
+ *
+ * Records are sorted the way loadCIDRMapping() sorts a text map:
+ * prefix length descending, then network, timezone, x_start and x_end
+ * ascending. The file is mapped read-only and used without parsing.
+ */
+typedef struct {
+    char magic[8];           /* CIDR_MAP_MAGIC */
+    uint32_t header_bytes;   /* sizeof(CIDRMapFileHeader_t) */
+    uint32_t record_bytes;   /* sizeof(CIDRMapRecord_t) */
+    uint32_t dimension;      /* Hilbert dimension the X ranges were laid out for */
+    uint32_t order;          /* log2(dimension), 0 if not a power of 2 */
+    uint32_t record_count;
+    uint32_t reserved;
+    uint64_t file_bytes;     /* Whole file, checked against its size */
+} CIDRMapFileHeader_t;
+
+typedef struct {
+    uint32_t network;        /* Network address, host byte order */
+    uint32_t x_start;        /* Starting X coordinate */
+    uint32_t x_end;          /* Ending X coordinate */
+    int32_t timezone_offset; /* UTC offset in hours */
+    uint8_t prefix_len;      /* 0-32 */
+    uint8_t reserved[3];
+} CIDRMapRecord_t;
+
+#endif /* CIDR_MAP_DOT_H */
@@ -0,0 +1,821 @@
+/*****
+ *
+ * Description: Decompression Backend Implementation
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+/****
+ *
+ * The gzip decoder is chosen at configure time with --with-inflate:
+ *
+ *   zlib        gzread() streaming in log_parser.c (default)
+ *   zlib-ng     the same code linked against zlib-ng's zlib-compatible
+ *               build, which has a faster inflate
+ *   libdeflate  whole-member decoding from a memory-mapped file (below)
+ *
+ * zstd and lz4 (frame format) input is recognised by its magic bytes and
+ * decoded with libzstd / liblz4 when configure finds them. Everything
+ * else goes to zlib, which also passes plain text through unchanged.
+ *
+ * Each backend hands text to the line reader through the GzipStream_t
+ * block source hook, so the parser does not change with the format.
+ *
+ ****/
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#include "decompress.h"
+#include "mem.h"
+#include "util.h"
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+#ifdef DECOMPRESS_HAVE_LIBDEFLATE
+#include <sys/mman.h>
+#include <libdeflate.h>
+#endif
+
+#ifdef DECOMPRESS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef DECOMPRESS_HAVE_LZ4
+#include <lz4frame.h>
+#endif
+
+/****
+ *
+ * defines
+ *
+ ****/
+
+#define FRAME_INPUT_SIZE (128 * 1024)   // Compressed read size for zstd/lz4
+#define MAGIC_ZSTD 0xFD2FB528U
+#define MAGIC_LZ4 0x184D2204U
+#define MAGIC_LZ4_LEGACY 0x184C2102U
+#define MAGIC_SKIPPABLE 0x184D2A50U     // Low 4 bits vary; shared by zstd and lz4
+#define MAGIC_SKIPPABLE_MASK 0xFFFFFFF0U
+
+/****
+ *
+ * typedefs
+ *
+ ****/
+
+#ifdef DECOMPRESS_HAVE_LIBDEFLATE
+/**
+ * libdeflate gzip source
+ *
+ * The compressed file is mapped whole; each gzip member is decoded into
+ * out in one call and then handed out block by block.
+ */
+typedef struct {
+    int fd;
+    const unsigned char *map;
+    size_t map_size;
+    size_t in_pos;                // Start of the next member
+    struct libdeflate_decompressor *decompressor;
+    char *out;
+    size_t out_cap;
+    size_t out_len;
+    size_t out_pos;
+    gzFile fallback;              // zlib for the rest of the file after an oversized member
+    char *file_path;
+    int done;
+} DeflateSource_t;
+#endif
+
+/**
+ * Compressed input formats recognised by magic bytes
+ */
+typedef enum {
+    FORMAT_OTHER = 0,             // Plain text or unknown
+    FORMAT_GZIP,
+    FORMAT_ZSTD,
+    FORMAT_LZ4,
+    FORMAT_LZ4_LEGACY
+} InputFormat_t;
+
+#if defined(DECOMPRESS_HAVE_ZSTD) || defined(DECOMPRESS_HAVE_LZ4)
+/**
+ * Streaming zstd / lz4 frame source
+ */
+typedef struct {
+    FILE *fp;
+    char *file_path;
+    InputFormat_t format;
+    unsigned char *input;
+    size_t in_len;
+    size_t in_pos;
+    int mid_frame;                // Decoder has an unfinished frame
+#ifdef DECOMPRESS_HAVE_ZSTD
+    ZSTD_DStream *zstd;
+#endif
+#ifdef DECOMPRESS_HAVE_LZ4
+    LZ4F_dctx *lz4;
+#endif
+} FrameSource_t;
+#endif
+
+/****
+ *
+ * external variables
+ *
+ ****/
+
+extern Config_t *config;
+
+/****
+ *
+ * functions
+ *
+ ****/
+
+#ifdef DECOMPRESS_HAVE_LIBDEFLATE
+/****
+ *
+ * Continue a file with zlib from the current member
+ *
+ * DESCRIPTION:
+ *   Used when a member would need more than DECOMPRESS_MEMBER_MAX bytes
+ *   of output, or does not decode as a whole (a file still being written,
+ *   or damaged). zlib reads from a duplicate descriptor positioned at the
+ *   member and streams it and any members after it, returning the same
+ *   partial data and errors gzread() would.
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on error
+ *
+ ****/
+PRIVATE int startDeflateFallback(DeflateSource_t *src)
+{
+    int fd;
+
+    fd = dup(src->fd);
+    if (fd < 0) {
+        return FALSE;
+    }
+    if (lseek(fd, (off_t)src->in_pos, SEEK_SET) < 0) {
+        close(fd);
+        return FALSE;
+    }
+    src->fallback = gzdopen(fd, "rb");
+    if (!src->fallback) {
+        close(fd);
+        return FALSE;
+    }
+    gzbuffer(src->fallback, 128 * 1024);
+
+#ifdef DEBUG
+    if (config->debug >= 1) {
+        fprintf(stderr, "DEBUG - %s: member at %lu not decoded whole, streaming with zlib\n",
+                src->file_path, (unsigned long)src->in_pos);
+    }
+#endif
+
+    return TRUE;
+}
+
+/****
+ *
+ * Decode the next gzip member
+ *
+ * DESCRIPTION:
+ *   libdeflate only decodes whole members, so the output buffer must be
+ *   sized before decoding. The ISIZE in the file's last trailer is exact
+ *   for the usual single-member file. When it is too small to be this
+ *   member's (ISIZE wrapped past 4GB, or more members follow) the guess
+ *   is four times the remaining input, and input over a quarter of
+ *   DECOMPRESS_MEMBER_MAX is taken to be a wrapped ISIZE. A member that
+ *   needs more than DECOMPRESS_MEMBER_MAX bytes goes to zlib streaming
+ *   before any decoding, and one that overflows the buffer goes to zlib
+ *   after a single pass rather than being decoded again into larger
+ *   buffers.
+ *   Anything after the last member that is not a gzip header is
+ *   ignored, as gzread() does.
+ *
+ * RETURNS:
+ *   1 if a member was decoded (or handed to zlib), 0 at end of data,
+ *   -1 on error
+ *
+ ****/
+PRIVATE int decodeDeflateMember(DeflateSource_t *src)
+{
+    const unsigned char *in = src->map + src->in_pos;
+    size_t avail = src->map_size - src->in_pos;
+    size_t want, overhead, floor_out, used_in = 0, used_out = 0;
+    enum libdeflate_result ret;
+    uint32_t isize;
+
+    if (avail < 18 || in[0] != 0x1f || in[1] != 0x8b) {
+        return 0;
+    }
+
+    /* ISIZE of the last member: uncompressed size mod 2^32 */
+    isize = (uint32_t)src->map[src->map_size - 4] |
+            ((uint32_t)src->map[src->map_size - 3] << 8) |
+            ((uint32_t)src->map[src->map_size - 2] << 16) |
+            ((uint32_t)src->map[src->map_size - 1] << 24);
+
+    /* Least output a member running to the end of the file can hold:
+     * stored blocks add 5 bytes per 65535, plus header and trailer */
+    overhead = 18 + 5 * (avail / 65535 + 1);
+    floor_out = (avail > overhead) ? avail - overhead : 0;
+
+    if ((size_t)isize >= floor_out) {
+        want = (size_t)isize + 1;
+    } else {
+        want = (avail <= DECOMPRESS_MEMBER_MAX / 4) ? avail * 4 : DECOMPRESS_MEMBER_MAX + 1;
+    }
+    if (want > DECOMPRESS_MEMBER_MAX) {
+        /* Too big to decode whole: stream this member and the rest of the file */
+        return startDeflateFallback(src) ? 1 : -1;
+    }
+
+    /* XMALLOC() takes an int */
+    if (want > (size_t)INT_MAX) {
+        return startDeflateFallback(src) ? 1 : -1;
+    }
+    if (want > src->out_cap) {
+        if (src->out) {
+            XFREE(src->out);
+        }
+        src->out = (char *)XMALLOC((int)want);
+        src->out_cap = want;
+    }
+
+    ret = libdeflate_gzip_decompress_ex(src->decompressor, in, avail, src->out, src->out_cap,
+                                        &used_in, &used_out);
+    if (ret != LIBDEFLATE_SUCCESS) {
+        /* Oversized, truncated or corrupt: let zlib stream what it can */
+        return startDeflateFallback(src) ? 1 : -1;
+    }
+
+    src->in_pos += used_in;
+    src->out_len = used_out;
+    src->out_pos = 0;
+
+    return 1;
+}
+
+/****
+ *
+ * Block reader for the libdeflate backend
+ *
+ ****/
+PRIVATE int readDeflateBlock(void *source, char *dst, size_t room)
+{
+    DeflateSource_t *src = (DeflateSource_t *)source;
+    size_t n;
+    int ret, errnum;
+
+    while (src->out_pos == src->out_len) {
+        if (src->fallback) {
+            ret = gzread(src->fallback, dst, (unsigned int)room);
+            if (ret < 0) {
+                fprintf(stderr, "ERR - Failed to read %s: %s\n", src->file_path,
+                        gzerror(src->fallback, &errnum));
+            }
+            return ret;
+        }
+        if (src->done) {
+            return 0;
+        }
+        ret = decodeDeflateMember(src);
+        if (ret <= 0) {
+            src->done = TRUE;
+            return ret;
+        }
+    }
+
+    n = src->out_len - src->out_pos;
+    if (n > room) {
+        n = room;
+    }
+    memcpy(dst, src->out + src->out_pos, n);
+    src->out_pos += n;
+
+    return (int)n;
+}
+
+/****
+ *
+ * Release a libdeflate source
+ *
+ ****/
+PRIVATE void closeDeflateSource(void *source)
+{
+    DeflateSource_t *src = (DeflateSource_t *)source;
+
+    if (src->fallback) {
+        gzclose(src->fallback);
+    }
+    if (src->decompressor) {
+        libdeflate_free_decompressor(src->decompressor);
+    }
+    if (src->map) {
+        munmap((void *)(uintptr_t)src->map, src->map_size);
+    }
+    if (src->fd >= 0) {
+        close(src->fd);
+    }
+    if (src->out) {
+        XFREE(src->out);
+    }
+    free(src->file_path);
+    XFREE(src);
+}
+
+/****
+ *
+ * Open a gzip file with the libdeflate backend
+ *
+ * RETURNS:
+ *   TRUE if the file is gzip and was opened, FALSE otherwise
+ *
+ ****/
+PRIVATE int openDeflateSource(const char *file_path, DecompressSource_t *out)
+{
+    DeflateSource_t *src;
+    struct stat st;
+    void *map;
+    int fd;
+
+    fd = open(file_path, O_RDONLY);
+    if (fd < 0) {
+        return FALSE;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < 18) {
+        close(fd);
+        return FALSE;
+    }
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return FALSE;
+    }
+    if (((const unsigned char *)map)[0] != 0x1f || ((const unsigned char *)map)[1] != 0x8b) {
+        /* Not gzip - zlib's transparent mode reads it as plain text */
+        munmap(map, (size_t)st.st_size);
+        close(fd);
+        return FALSE;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    src = (DeflateSource_t *)XMALLOC(sizeof(DeflateSource_t));
+    XMEMSET(src, 0, sizeof(DeflateSource_t));
+    src->fd = fd;
+    src->map = (const unsigned char *)map;
+    src->map_size = (size_t)st.st_size;
+    src->file_path = strdup(file_path);
+    src->decompressor = libdeflate_alloc_decompressor();
+    if (!src->decompressor) {
+        closeDeflateSource(src);
+        return FALSE;
+    }
+
+    out->read_block = readDeflateBlock;
+    out->close_source = closeDeflateSource;
+    out->source = src;
+
+    return TRUE;
+}
+#endif
+
+/****
+ *
+ * Identify the compressed format of a file
+ *
+ * DESCRIPTION:
+ *   Reads the leading magic number, stepping over skippable frames (which
+ *   zstd and lz4 share, and which pzstd writes first).
+ *
+ * RETURNS:
+ *   Detected format, FORMAT_OTHER for text (or anything unrecognised)
+ *
+ ****/
+PRIVATE InputFormat_t detectInputFormat(FILE *fp)
+{
+    unsigned char hdr[8];
+    uint32_t magic, skip;
+    int frames;
+
+    for (frames = 0; frames < 16; frames++) {
+        if (fread(hdr, 1, 4, fp) != 4) {
+            return FORMAT_OTHER;
+        }
+        magic = (uint32_t)hdr[0] | ((uint32_t)hdr[1] << 8) |
+                ((uint32_t)hdr[2] << 16) | ((uint32_t)hdr[3] << 24);
+
+        if (hdr[0] == 0x1f && hdr[1] == 0x8b) {
+            return FORMAT_GZIP;
+        }
+        if (magic == MAGIC_ZSTD) {
+            return FORMAT_ZSTD;
+        }
+        if (magic == MAGIC_LZ4) {
+            return FORMAT_LZ4;
+        }
+        if (magic == MAGIC_LZ4_LEGACY) {
+            return FORMAT_LZ4_LEGACY;
+        }
+        if ((magic & MAGIC_SKIPPABLE_MASK) != MAGIC_SKIPPABLE ||
+            fread(hdr + 4, 1, 4, fp) != 4) {
+            return FORMAT_OTHER;
+        }
+        skip = (uint32_t)hdr[4] | ((uint32_t)hdr[5] << 8) |
+               ((uint32_t)hdr[6] << 16) | ((uint32_t)hdr[7] << 24);
+        if (fseeko(fp, (off_t)skip, SEEK_CUR) != 0) {
+            return FORMAT_OTHER;
+        }
+    }
+
+    return FORMAT_OTHER;
+}
+
+#if defined(DECOMPRESS_HAVE_ZSTD) || defined(DECOMPRESS_HAVE_LZ4)
+/****
+ *
+ * Read more compressed input for a frame source
+ *
+ * RETURNS:
+ *   TRUE if input is available, FALSE at end of file or on error
+ *
+ ****/
+PRIVATE int refillFrameInput(FrameSource_t *src)
+{
+    size_t got;
+
+    got = fread(src->input, 1, FRAME_INPUT_SIZE, src->fp);
+    if (got == 0) {
+        if (ferror(src->fp)) {
+            fprintf(stderr, "ERR - Read error on %s\n", src->file_path);
+        }
+        return FALSE;
+    }
+    src->in_len = got;
+    src->in_pos = 0;
+
+    return TRUE;
+}
+
+/****
+ *
+ * Run one decoder step
+ *
+ * DESCRIPTION:
+ *   Feeds the unread input to the frame decoder and appends its output
+ *   to dst at *produced.
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on a decoder error
+ *
+ ****/
+PRIVATE int stepFrameDecoder(FrameSource_t *src, char *dst, size_t room, size_t *produced)
+{
+#ifdef DECOMPRESS_HAVE_ZSTD
+    if (src->format == FORMAT_ZSTD) {
+        ZSTD_inBuffer in;
+        ZSTD_outBuffer out;
+        size_t ret;
+
+        in.src = src->input;
+        in.size = src->in_len;
+        in.pos = src->in_pos;
+        out.dst = dst;
+        out.size = room;
+        out.pos = *produced;
+
+        ret = ZSTD_decompressStream(src->zstd, &out, &in);
+        src->in_pos = in.pos;
+        *produced = out.pos;
+        if (ZSTD_isError(ret)) {
+            fprintf(stderr, "ERR - Corrupt zstd data in %s: %s\n", src->file_path,
+                    ZSTD_getErrorName(ret));
+            return FALSE;
+        }
+        src->mid_frame = (ret != 0);
+
+        return TRUE;
+    }
+#endif
+#ifdef DECOMPRESS_HAVE_LZ4
+    if (src->format == FORMAT_LZ4) {
+        size_t dst_size = room - *produced;
+        size_t src_size = src->in_len - src->in_pos;
+        size_t ret;
+
+        ret = LZ4F_decompress(src->lz4, dst + *produced, &dst_size,
+                              src->input + src->in_pos, &src_size, NULL);
+        src->in_pos += src_size;
+        *produced += dst_size;
+        if (LZ4F_isError(ret)) {
+            fprintf(stderr, "ERR - Corrupt lz4 data in %s: %s\n", src->file_path,
+                    LZ4F_getErrorName(ret));
+            return FALSE;
+        }
+        src->mid_frame = (ret != 0);
+
+        return TRUE;
+    }
+#endif
+
+    return FALSE;
+}
+
+/****
+ *
+ * Block reader for zstd and lz4 input
+ *
+ * DESCRIPTION:
+ *   Decodes until dst is full or the file ends. Concatenated frames are
+ *   followed. A file that ends inside a frame (still being written, or
+ *   cut short) yields what could be decoded and a warning.
+ *
+ * PARAMETERS:
+ *   source - FrameSource_t
+ *   dst - Output buffer
+ *   room - Space in dst
+ *
+ * RETURNS:
+ *   Bytes written, 0 at end of data, -1 on error
+ *
+ ****/
+PRIVATE int readFrameBlock(void *source, char *dst, size_t room)
+{
+    FrameSource_t *src = (FrameSource_t *)source;
+    size_t produced = 0, before;
+
+    if (room > INT_MAX) {
+        room = INT_MAX;
+    }
+
+    while (produced < room) {
+        if (src->in_pos == src->in_len && !refillFrameInput(src)) {
+            src->in_len = src->in_pos = 0;
+            if (!src->mid_frame) {
+                break;
+            }
+            /* Flush output the decoder is still holding */
+            before = produced;
+            if (!stepFrameDecoder(src, dst, room, &produced)) {
+                return -1;
+            }
+            if (produced == before) {
+                fprintf(stderr, "WARN - %s ends in the middle of a compressed frame (truncated?)\n",
+                        src->file_path);
+                src->mid_frame = FALSE;
+                break;
+            }
+            continue;
+        }
+        if (!stepFrameDecoder(src, dst, room, &produced)) {
+            return -1;
+        }
+    }
+
+    return (int)produced;
+}
+
+/****
+ *
+ * Release a zstd / lz4 source
+ *
+ ****/
+PRIVATE void closeFrameSource(void *source)
+{
+    FrameSource_t *src = (FrameSource_t *)source;
+
+#ifdef DECOMPRESS_HAVE_ZSTD
+    if (src->zstd) {
+        ZSTD_freeDStream(src->zstd);
+    }
+#endif
+#ifdef DECOMPRESS_HAVE_LZ4
+    if (src->lz4) {
+        LZ4F_freeDecompressionContext(src->lz4);
+    }
+#endif
+    if (src->fp) {
+        fclose(src->fp);
+    }
+    if (src->input) {
+        XFREE(src->input);
+    }
+    free(src->file_path);
+    XFREE(src);
+}
+
+/****
+ *
+ * Open a zstd or lz4 file
+ *
+ * PARAMETERS:
+ *   fp - File, positioned at the start (ownership passes to the source)
+ *   file_path - Path for messages
+ *   format - FORMAT_ZSTD or FORMAT_LZ4
+ *   out - Receives the block source
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if the decoder could not be created
+ *
+ ****/
+PRIVATE int openFrameSource(FILE *fp, const char *file_path, InputFormat_t format,
+                            DecompressSource_t *out)
+{
+    FrameSource_t *src;
+    int ok = FALSE;
+
+    src = (FrameSource_t *)XMALLOC(sizeof(FrameSource_t));
+    XMEMSET(src, 0, sizeof(FrameSource_t));
+    src->fp = fp;
+    src->file_path = strdup(file_path);
+    src->format = format;
+    src->input = (unsigned char *)XMALLOC(FRAME_INPUT_SIZE);
+
+#ifdef DECOMPRESS_HAVE_ZSTD
+    if (format == FORMAT_ZSTD) {
+        src->zstd = ZSTD_createDStream();
+        ok = (src->zstd != NULL && !ZSTD_isError(ZSTD_initDStream(src->zstd)));
+        out->name = "zstd";
+    }
+#endif
+#ifdef DECOMPRESS_HAVE_LZ4
+    if (format == FORMAT_LZ4) {
+        ok = !LZ4F_isError(LZ4F_createDecompressionContext(&src->lz4, LZ4F_VERSION));
+        out->name = "lz4";
+    }
+#endif
+
+    if (!ok) {
+        fprintf(stderr, "ERR - Unable to initialize decoder for %s\n", file_path);
+        closeFrameSource(src);
+        return FALSE;
+    }
+
+    out->read_block = readFrameBlock;
+    out->close_source = closeFrameSource;
+    out->source = src;
+
+    return TRUE;
+}
+#endif
+
+/****
+ *
+ * Open a file with the matching decompression backend
+ *
+ * DESCRIPTION:
+ *   Detects zstd and lz4 input by magic bytes and opens it with the
+ *   matching decoder. gzip input is offered to the backend chosen at
+ *   configure time. When no backend takes the file (gzip with the zlib
+ *   or zlib-ng backend, plain text), the caller reads it itself, and
+ *   src->plain_text tells it the file is uncompressed. Only regular files
+ *   are sniffed; pipes and devices are left to the caller untouched so
+ *   no input is consumed.
+ *
+ * PARAMETERS:
+ *   file_path - Path to input file
+ *   src - Receives the block source when the file is taken
+ *
+ * RETURNS:
+ *   1 if src was filled in, 0 to fall back to gzread(), -1 on error
+ *   (format recognised but not supported by this build)
+ *
+ ****/
+int openDecompressSource(const char *file_path, DecompressSource_t *src)
+{
+    InputFormat_t format;
+    struct stat st;
+    FILE *fp;
+
+    if (!file_path || !src) {
+        return 0;
+    }
+    XMEMSET(src, 0, sizeof(DecompressSource_t));
+
+    if (stat(file_path, &st) != 0 || !S_ISREG(st.st_mode)) {
+        /* Missing files are reported by gzopen() */
+        return 0;
+    }
+
+    fp = fopen(file_path, "rb");
+    if (!fp) {
+        return 0;
+    }
+    format = detectInputFormat(fp);
+
+    switch (format) {
+    case FORMAT_ZSTD:
+#ifdef DECOMPRESS_HAVE_ZSTD
+        rewind(fp);
+        return openFrameSource(fp, file_path, format, src) ? 1 : -1;
+#else
+        fprintf(stderr, "ERR - %s is zstd compressed but tplot was built without zstd support\n",
+                file_path);
+        fclose(fp);
+        return -1;
+#endif
+    case FORMAT_LZ4:
+#ifdef DECOMPRESS_HAVE_LZ4
+        rewind(fp);
+        return openFrameSource(fp, file_path, format, src) ? 1 : -1;
+#else
+        fprintf(stderr, "ERR - %s is lz4 compressed but tplot was built without lz4 support\n",
+                file_path);
+        fclose(fp);
+        return -1;
+#endif
+    case FORMAT_LZ4_LEGACY:
+        fprintf(stderr, "ERR - %s uses the legacy lz4 format, recompress it with lz4 (frame format)\n",
+                file_path);
+        fclose(fp);
+        return -1;
+    case FORMAT_GZIP:
+        fclose(fp);
+        break;
+    case FORMAT_OTHER:
+    default:
+        fclose(fp);
+        src->plain_text = TRUE;
+        return 0;
+    }
+
+#ifdef DECOMPRESS_HAVE_LIBDEFLATE
+    if (openDeflateSource(file_path, src)) {
+        src->name = "libdeflate";
+        return 1;
+    }
+#endif
+
+    return 0;
+}
+
+/****
+ *
+ * Describe the gzip decoder this binary was built with
+ *
+ * RETURNS:
+ *   Static string such as "zlib 1.3"
+ *
+ ****/
+const char *getDecompressBackend(void)
+{
+#if defined(DECOMPRESS_HAVE_LIBDEFLATE) && defined(LIBDEFLATE_VERSION_STRING)
+    return "libdeflate " LIBDEFLATE_VERSION_STRING;
+#elif defined(DECOMPRESS_HAVE_LIBDEFLATE)
+    return "libdeflate";
+#elif defined(ZLIBNG_VERSION)
+    return "zlib-ng " ZLIBNG_VERSION;
+#else
+    return "zlib " ZLIB_VERSION;
+#endif
+}
+
+/****
+ *
+ * List the compressed input formats this binary can read
+ *
+ * RETURNS:
+ *   Static string such as "gzip zstd lz4"
+ *
+ ****/
+const char *getDecompressFormats(void)
+{
+#if defined(DECOMPRESS_HAVE_ZSTD) && defined(DECOMPRESS_HAVE_LZ4)
+    return "gzip zstd lz4";
+#elif defined(DECOMPRESS_HAVE_ZSTD)
+    return "gzip zstd";
+#elif defined(DECOMPRESS_HAVE_LZ4)
+    return "gzip lz4";
+#else
+    return "gzip";
+#endif
+}
@@ -0,0 +1,97 @@
+/*****
+ *
+ * Description: Decompression Backend Headers
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#ifndef DECOMPRESS_DOT_H
+#define DECOMPRESS_DOT_H
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "../include/sysdep.h"
+
+#ifndef __SYSDEP_H__
+#error something is messed up
+#endif
+
+#include "../include/common.h"
+
+/****
+ *
+ * defines
+ *
+ ****/
+
+#if defined(HAVE_LIBDEFLATE_H) && defined(HAVE_LIBDEFLATE)
+#define DECOMPRESS_HAVE_LIBDEFLATE 1
+#endif
+
+#if defined(HAVE_ZSTD_H) && defined(HAVE_LIBZSTD)
+#define DECOMPRESS_HAVE_ZSTD 1
+#endif
+
+#if defined(HAVE_LZ4FRAME_H) && defined(HAVE_LIBLZ4)
+#define DECOMPRESS_HAVE_LZ4 1
+#endif
+
+/* Largest gzip member decoded in one piece; bigger members stream through zlib */
+#ifndef DECOMPRESS_MEMBER_MAX
+#define DECOMPRESS_MEMBER_MAX ((size_t)512 * 1024 * 1024)
+#endif
+
+/****
+ *
+ * typedefs & structs
+ *
+ ****/
+
+/**
+ * Block source produced by a decompression backend
+ *
+ * Plugged into GzipStream_t (see openBlockStream()): read_block returns
+ * bytes written to dst, 0 at end of data or -1 on error.
+ */
+typedef struct {
+    int (*read_block)(void *source, char *dst, size_t room);
+    void (*close_source)(void *source);
+    void *source;
+    const char *name;           // Decoder name for messages
+    int plain_text;             // Not taken: file is a regular uncompressed file
+} DecompressSource_t;
+
+/****
+ *
+ * function prototypes
+ *
+ ****/
+
+int openDecompressSource(const char *file_path, DecompressSource_t *src);
+const char *getDecompressBackend(void);
+const char *getDecompressFormats(void);
+
+#endif /* DECOMPRESS_DOT_H */
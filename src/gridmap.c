@@ -0,0 +1,732 @@
+/*****
+ *
+ * Description: Dense, Tiled or Hashed Heatmap-Sized Grid Functions
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+/****
+ *
+ * The residue map and the non-routable mask hold one value for every
+ * heatmap cell. At order 12 that is 16M cells and a flat array is the
+ * fastest thing there is; at order 16 it is 4G cells and a flat array
+ * would not fit most machines (nor a single XMALLOC()). Reserved address
+ * space comes in large ranges, and a square of 2^k x 2^k cells aligned
+ * on the Hilbert curve is one contiguous range, so the mask is kept as
+ * tiles that exist only where something was written, with all-marked
+ * tiles sharing one copy. Attack sources are scattered one or a few
+ * addresses at a time, so the residue map keeps just its non-zero cells
+ * in a hash table, as sparse time bins do.
+ *
+ ****/
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#include "gridmap.h"
+#include "mem.h"
+#include <string.h>
+
+/****
+ *
+ * functions
+ *
+ ****/
+
+/****
+ *
+ * Bytes one tile of a map takes
+ *
+ ****/
+PRIVATE size_t gridMapTileBytes(const GridMap_t *map)
+{
+    return ((size_t)1 << (2 * map->tile_order)) * map->cell_size;
+}
+
+/****
+ *
+ * Find the tile and offset of a cell
+ *
+ * PARAMETERS:
+ *   map - Tiled map
+ *   idx - Heatmap index (y * dimension + x)
+ *   cell - Set to the cell's position within its tile
+ *
+ * RETURNS:
+ *   Index of the tile in the directory
+ *
+ ****/
+PRIVATE uint32_t gridMapTile(const GridMap_t *map, uint32_t idx, uint32_t *cell)
+{
+    uint32_t x = idx & (map->dimension - 1);
+    uint32_t y = idx >> map->order;
+    uint32_t tile_mask = (1U << map->tile_order) - 1;
+
+    *cell = ((y & tile_mask) << map->tile_order) | (x & tile_mask);
+
+    return (y >> map->tile_order) * map->tiles_per_row + (x >> map->tile_order);
+}
+
+/****
+ *
+ * Hash a heatmap index to a table slot
+ *
+ ****/
+PRIVATE uint32_t gridMapSlot(uint32_t idx, uint32_t mask)
+{
+    uint32_t h = idx * 0x9E3779B1U;
+
+    return (h ^ (h >> 16)) & mask;
+}
+
+/****
+ *
+ * Allocate an empty hash table
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if the table would be too large for one allocation
+ *
+ ****/
+PRIVATE int allocGridMapCells(GridMap_t *map, uint32_t capacity)
+{
+    uint64_t bytes = (uint64_t)sizeof(GridMapCell_t) * capacity;
+
+    if (capacity == 0 || bytes > GRIDMAP_DENSE_MAX) {
+        return FALSE;
+    }
+
+    map->cells = (GridMapCell_t *)XMALLOC((int)bytes);
+    if (!map->cells) {
+        return FALSE;
+    }
+    memset(map->cells, 0, (size_t)bytes);
+    map->cell_capacity = capacity;
+    map->cell_count = 0;
+
+    return TRUE;
+}
+
+/****
+ *
+ * Double a hash table, rehashing every cell
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if it cannot grow (map unchanged)
+ *
+ ****/
+PRIVATE int growGridMapCells(GridMap_t *map)
+{
+    GridMapCell_t *old_cells = map->cells;
+    uint32_t old_capacity = map->cell_capacity;
+    uint32_t old_count = map->cell_count;
+    uint32_t i, slot, mask;
+
+    if (!allocGridMapCells(map, old_capacity * 2)) {
+        map->cells = old_cells;
+        map->cell_capacity = old_capacity;
+        return FALSE;
+    }
+
+    mask = map->cell_capacity - 1;
+    for (i = 0; i < old_capacity; i++) {
+        if (old_cells[i].value) {
+            slot = gridMapSlot(old_cells[i].idx, mask);
+            while (map->cells[slot].value) {
+                slot = (slot + 1) & mask;
+            }
+            map->cells[slot] = old_cells[i];
+        }
+    }
+    map->cell_count = old_count;
+
+    XFREE(old_cells);
+
+    return TRUE;
+}
+
+/****
+ *
+ * Find a cell's hash slot, claiming an empty one for it if asked
+ *
+ * RETURNS:
+ *   The cell's slot, NULL if it is absent and was not (or could not be) added
+ *
+ ****/
+PRIVATE GridMapCell_t *gridMapFindCell(GridMap_t *map, uint32_t idx, int add)
+{
+    uint32_t mask = map->cell_capacity - 1;
+    uint32_t slot = gridMapSlot(idx, mask);
+
+    while (map->cells[slot].value) {
+        if (map->cells[slot].idx == idx) {
+            return &map->cells[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    if (!add) {
+        return NULL;
+    }
+
+    if ((map->cell_count + 1) * 4 > map->cell_capacity * 3) {
+        if (!growGridMapCells(map)) {
+            fprintf(stderr, "ERR - Sparse grid is full (%u cells)\n", map->cell_count);
+            return NULL;
+        }
+        return gridMapFindCell(map, idx, add);
+    }
+
+    map->cells[slot].idx = idx;
+    map->cell_count++;
+
+    return &map->cells[slot];
+}
+
+/****
+ *
+ * Address of a dense or tiled cell for writing
+ *
+ * DESCRIPTION:
+ *   Allocates the cell's tile the first time it is written, and gives a
+ *   tile pointing at the shared uniform tile a copy of its own.
+ *
+ * RETURNS:
+ *   Pointer to the cell (cell_size bytes)
+ *
+ ****/
+PRIVATE uint8_t *gridMapCellPtr(GridMap_t *map, uint32_t idx)
+{
+    uint32_t tile, cell;
+    size_t tile_bytes;
+    uint8_t *copy;
+
+    if (map->layout == GRIDMAP_DENSE) {
+        return map->dense + (size_t)idx * map->cell_size;
+    }
+
+    tile = gridMapTile(map, idx, &cell);
+    if (!map->tiles[tile] || map->tiles[tile] == map->shared_tile) {
+        tile_bytes = gridMapTileBytes(map);
+        copy = (uint8_t *)XMALLOC((int)tile_bytes);
+        if (map->tiles[tile]) {
+            memcpy(copy, map->tiles[tile], tile_bytes);
+        } else {
+            memset(copy, 0, tile_bytes);
+        }
+        map->tiles[tile] = copy;
+        map->tile_count++;
+    }
+
+    return map->tiles[tile] + (size_t)cell * map->cell_size;
+}
+
+/****
+ *
+ * Bytes a dense map of the given order would take
+ *
+ * DESCRIPTION:
+ *   What the memory budget is checked against when choosing a layout. A
+ *   dense map is only possible at or below GRIDMAP_DENSE_MAX.
+ *
+ * PARAMETERS:
+ *   order - Hilbert curve order
+ *   cell_size - Bytes per cell
+ *
+ * RETURNS:
+ *   dimension^2 * cell_size
+ *
+ ****/
+uint64_t getGridMapDenseBytes(uint8_t order, uint8_t cell_size)
+{
+    return ((uint64_t)1 << (2 * order)) * cell_size;
+}
+
+/****
+ *
+ * Name of a layout for messages
+ *
+ ****/
+const char *getGridMapLayoutName(GridMapLayout_t layout)
+{
+    switch (layout) {
+    case GRIDMAP_DENSE:
+        return "dense";
+    case GRIDMAP_TILED:
+        return "tiled";
+    case GRIDMAP_HASHED:
+        return "sparse";
+    }
+    return "unknown";
+}
+
+/****
+ *
+ * Create an all-zero map
+ *
+ * DESCRIPTION:
+ *   Allocates a dense map in one piece, an empty tile directory for a
+ *   tiled one or a small table for a hashed one. A dense request larger
+ *   than GRIDMAP_DENSE_MAX is made tiled instead.
+ *
+ * PARAMETERS:
+ *   order - Hilbert curve order (dimension = 2^order)
+ *   cell_size - Bytes per cell, 1 or 4
+ *   layout - Storage to use
+ *
+ * RETURNS:
+ *   New map, NULL on bad arguments or allocation failure
+ *
+ * MEMORY:
+ *   Dense: dimension^2 * cell_size. Tiled: a pointer per 64x64 cells
+ *   (8MB at order 16) plus 4096 * cell_size per tile written. Hashed:
+ *   8 bytes per slot, at least 4/3 of a slot per non-zero cell.
+ *
+ ****/
+GridMap_t *createGridMap(uint8_t order, uint8_t cell_size, GridMapLayout_t layout)
+{
+    GridMap_t *map;
+    uint64_t dense_bytes;
+    size_t directory_bytes;
+
+    if (order > 16 || (cell_size != 1 && cell_size != 4)) {
+        return NULL;
+    }
+
+    map = (GridMap_t *)XMALLOC(sizeof(GridMap_t));
+    if (!map) {
+        return NULL;
+    }
+    memset(map, 0, sizeof(GridMap_t));
+
+    map->order = order;
+    map->dimension = 1U << order;
+    map->cell_size = cell_size;
+    map->tile_order = (order < GRIDMAP_TILE_ORDER) ? order : GRIDMAP_TILE_ORDER;
+    map->tiles_per_row = map->dimension >> map->tile_order;
+
+    dense_bytes = getGridMapDenseBytes(order, cell_size);
+    if (layout == GRIDMAP_DENSE && dense_bytes > GRIDMAP_DENSE_MAX) {
+        layout = GRIDMAP_TILED;
+    }
+    map->layout = layout;
+
+    switch (layout) {
+    case GRIDMAP_DENSE:
+        map->dense = (uint8_t *)XMALLOC((int)dense_bytes);
+        if (!map->dense) {
+            XFREE(map);
+            return NULL;
+        }
+        memset(map->dense, 0, (size_t)dense_bytes);
+        break;
+
+    case GRIDMAP_TILED:
+        directory_bytes = sizeof(uint8_t *) * map->tiles_per_row * map->tiles_per_row;
+        map->tiles = (uint8_t **)XMALLOC((int)directory_bytes);
+        if (!map->tiles) {
+            XFREE(map);
+            return NULL;
+        }
+        memset(map->tiles, 0, directory_bytes);
+        break;
+
+    case GRIDMAP_HASHED:
+        if (!allocGridMapCells(map, GRIDMAP_HASH_INITIAL_CELLS)) {
+            XFREE(map);
+            return NULL;
+        }
+        break;
+    }
+
+    return map;
+}
+
+/****
+ *
+ * Free a map and everything it holds (NULL is a no-op)
+ *
+ ****/
+void destroyGridMap(GridMap_t *map)
+{
+    uint64_t tile, tiles;
+
+    if (!map) {
+        return;
+    }
+
+    if (map->dense) {
+        XFREE(map->dense);
+    }
+    if (map->tiles) {
+        tiles = (uint64_t)map->tiles_per_row * map->tiles_per_row;
+        for (tile = 0; tile < tiles; tile++) {
+            if (map->tiles[tile] && map->tiles[tile] != map->shared_tile) {
+                XFREE(map->tiles[tile]);
+            }
+        }
+        if (map->shared_tile) {
+            XFREE(map->shared_tile);
+        }
+        XFREE(map->tiles);
+    }
+    if (map->cells) {
+        XFREE(map->cells);
+    }
+    XFREE(map);
+}
+
+/****
+ *
+ * Duplicate a map in the same layout
+ *
+ * RETURNS:
+ *   New map with the same cells, NULL on allocation failure
+ *
+ ****/
+GridMap_t *copyGridMap(const GridMap_t *map)
+{
+    GridMap_t *copy;
+    uint64_t tile, tiles;
+    size_t tile_bytes;
+
+    if (!map) {
+        return NULL;
+    }
+
+    copy = createGridMap(map->order, map->cell_size, map->layout);
+    if (!copy) {
+        return NULL;
+    }
+
+    switch (map->layout) {
+    case GRIDMAP_DENSE:
+        memcpy(copy->dense, map->dense, (size_t)getGridMapDenseBytes(map->order, map->cell_size));
+        break;
+
+    case GRIDMAP_TILED:
+        tile_bytes = gridMapTileBytes(map);
+        if (map->shared_tile) {
+            copy->shared_tile = (uint8_t *)XMALLOC((int)tile_bytes);
+            memcpy(copy->shared_tile, map->shared_tile, tile_bytes);
+        }
+        tiles = (uint64_t)map->tiles_per_row * map->tiles_per_row;
+        for (tile = 0; tile < tiles; tile++) {
+            if (!map->tiles[tile]) {
+                continue;
+            }
+            if (map->tiles[tile] == map->shared_tile) {
+                copy->tiles[tile] = copy->shared_tile;
+                continue;
+            }
+            copy->tiles[tile] = (uint8_t *)XMALLOC((int)tile_bytes);
+            memcpy(copy->tiles[tile], map->tiles[tile], tile_bytes);
+            copy->tile_count++;
+        }
+        break;
+
+    case GRIDMAP_HASHED:
+        XFREE(copy->cells);
+        copy->cells = NULL;
+        if (!allocGridMapCells(copy, map->cell_capacity)) {
+            destroyGridMap(copy);
+            return NULL;
+        }
+        memcpy(copy->cells, map->cells, sizeof(GridMapCell_t) * map->cell_capacity);
+        copy->cell_count = map->cell_count;
+        break;
+    }
+
+    return copy;
+}
+
+/****
+ *
+ * Memory a map currently holds
+ *
+ * RETURNS:
+ *   Bytes of cells, tiles, tile directory or table (not the GridMap_t)
+ *
+ ****/
+uint64_t getGridMapBytes(const GridMap_t *map)
+{
+    uint64_t bytes = 0;
+
+    if (!map) {
+        return 0;
+    }
+
+    switch (map->layout) {
+    case GRIDMAP_DENSE:
+        bytes = getGridMapDenseBytes(map->order, map->cell_size);
+        break;
+    case GRIDMAP_TILED:
+        bytes = (uint64_t)sizeof(uint8_t *) * map->tiles_per_row * map->tiles_per_row +
+                ((uint64_t)map->tile_count + (map->shared_tile ? 1 : 0)) * gridMapTileBytes(map);
+        break;
+    case GRIDMAP_HASHED:
+        bytes = (uint64_t)sizeof(GridMapCell_t) * map->cell_capacity;
+        break;
+    }
+
+    return bytes;
+}
+
+/****
+ *
+ * Read a cell
+ *
+ * PARAMETERS:
+ *   map - Map
+ *   idx - Heatmap index (y * dimension + x), must be < dimension^2
+ *
+ * RETURNS:
+ *   Cell value, 0 for cells never written
+ *
+ * PERFORMANCE:
+ *   O(1): one load when dense, two when tiled, one probe sequence in a
+ *   table at most 3/4 full when hashed
+ *
+ ****/
+uint32_t getGridMapCell(const GridMap_t *map, uint32_t idx)
+{
+    const uint8_t *base;
+    uint32_t tile, cell, slot, mask;
+
+    switch (map->layout) {
+    case GRIDMAP_DENSE:
+        base = map->dense;
+        cell = idx;
+        break;
+
+    case GRIDMAP_TILED:
+        tile = gridMapTile(map, idx, &cell);
+        base = map->tiles[tile];
+        if (!base) {
+            return 0;
+        }
+        break;
+
+    default:
+        mask = map->cell_capacity - 1;
+        slot = gridMapSlot(idx, mask);
+        while (map->cells[slot].value) {
+            if (map->cells[slot].idx == idx) {
+                return map->cells[slot].value;
+            }
+            slot = (slot + 1) & mask;
+        }
+        return 0;
+    }
+
+    if (map->cell_size == 1) {
+        return base[cell];
+    }
+    return ((const uint32_t *)(const void *)base)[cell];
+}
+
+/****
+ *
+ * Write a cell
+ *
+ * DESCRIPTION:
+ *   Allocates the cell's tile, or its hash slot, the first time it is
+ *   written. Values are truncated to the cell size. Writing zero to a
+ *   hashed map is ignored (hashed cells stay non-zero).
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if a hashed map could not grow
+ *
+ ****/
+int setGridMapCell(GridMap_t *map, uint32_t idx, uint32_t value)
+{
+    GridMapCell_t *slot;
+    uint8_t *cell;
+
+    if (map->layout == GRIDMAP_HASHED) {
+        if (value == 0) {
+            return TRUE;
+        }
+        slot = gridMapFindCell(map, idx, TRUE);
+        if (!slot) {
+            return FALSE;
+        }
+        slot->value = value;
+        return TRUE;
+    }
+
+    cell = gridMapCellPtr(map, idx);
+    if (map->cell_size == 1) {
+        *cell = (uint8_t)value;
+    } else {
+        *(uint32_t *)(void *)cell = value;
+    }
+
+    return TRUE;
+}
+
+/****
+ *
+ * Add to a 4-byte cell
+ *
+ * RETURNS:
+ *   The cell's new value, 0 if a hashed map could not grow
+ *
+ ****/
+uint32_t addGridMapCell(GridMap_t *map, uint32_t idx, uint32_t amount)
+{
+    GridMapCell_t *slot;
+    uint32_t *cell;
+
+    if (map->layout == GRIDMAP_HASHED) {
+        if (amount == 0) {
+            return getGridMapCell(map, idx);
+        }
+        slot = gridMapFindCell(map, idx, TRUE);
+        if (!slot) {
+            return 0;
+        }
+        slot->value += amount;
+        return slot->value;
+    }
+
+    cell = (uint32_t *)(void *)gridMapCellPtr(map, idx);
+    *cell += amount;
+
+    return *cell;
+}
+
+/****
+ *
+ * Let uniform tiles share one copy
+ *
+ * DESCRIPTION:
+ *   Called once a tiled map has been filled. The first tile whose cells
+ *   all hold the same non-zero value becomes the shared tile, and every
+ *   later tile identical to it is freed and pointed at it. Reserved
+ *   address blocks cover whole tiles, so this leaves the mask about the
+ *   size of its tile directory plus the tiles along block edges. No-op
+ *   for other layouts.
+ *
+ ****/
+void shareUniformTiles(GridMap_t *map)
+{
+    uint64_t tile, tiles;
+    size_t tile_bytes;
+    uint8_t *t;
+
+    if (!map || map->layout != GRIDMAP_TILED) {
+        return;
+    }
+
+    tile_bytes = gridMapTileBytes(map);
+    tiles = (uint64_t)map->tiles_per_row * map->tiles_per_row;
+    for (tile = 0; tile < tiles; tile++) {
+        t = map->tiles[tile];
+        if (!t || t == map->shared_tile) {
+            continue;
+        }
+        if (!map->shared_tile) {
+            /* Uniform when every cell equals the one before it */
+            if (t[0] && memcmp(t, t + map->cell_size, tile_bytes - map->cell_size) == 0) {
+                map->shared_tile = t;
+                map->tile_count--;
+            }
+        } else if (memcmp(t, map->shared_tile, tile_bytes) == 0) {
+            XFREE(t);
+            map->tiles[tile] = map->shared_tile;
+            map->tile_count--;
+        }
+    }
+}
+
+/****
+ *
+ * Walk the non-zero cells of a map
+ *
+ * DESCRIPTION:
+ *   Returns the next non-zero cell at or after a cursor and moves the
+ *   cursor past it. Start with *pos = 0. Cells come in storage order:
+ *   index order when dense, tile by tile when tiled, table order when
+ *   hashed. The map must not be written during the walk.
+ *
+ * PARAMETERS:
+ *   map - Map
+ *   pos - Cursor, 0 for the first call
+ *   cell - Set to the cell's index and value
+ *
+ * RETURNS:
+ *   TRUE if a cell was found, FALSE once the walk is done
+ *
+ * PERFORMANCE:
+ *   O(dimension^2) over a whole walk when dense, O(cell_capacity) when
+ *   hashed; tiles never written are skipped whole
+ *
+ ****/
+int nextGridMapCell(const GridMap_t *map, uint64_t *pos, GridMapCell_t *cell)
+{
+    uint64_t end, tile_cells;
+    uint32_t tile, offset, tile_mask;
+    const uint8_t *base;
+
+    if (!map || !pos || !cell) {
+        return FALSE;
+    }
+
+    if (map->layout == GRIDMAP_HASHED) {
+        for (; *pos < map->cell_capacity; (*pos)++) {
+            if (map->cells[*pos].value) {
+                *cell = map->cells[(*pos)++];
+                return TRUE;
+            }
+        }
+        return FALSE;
+    }
+
+    end = (uint64_t)map->dimension * map->dimension;
+    tile_cells = (uint64_t)1 << (2 * map->tile_order);
+    tile_mask = (1U << map->tile_order) - 1;
+
+    while (*pos < end) {
+        if (map->layout == GRIDMAP_DENSE) {
+            base = map->dense;
+            offset = (uint32_t)*pos;
+            cell->idx = offset;
+        } else {
+            tile = (uint32_t)(*pos / tile_cells);
+            base = map->tiles[tile];
+            if (!base) {
+                *pos = (uint64_t)(tile + 1) * tile_cells;
+                continue;
+            }
+            offset = (uint32_t)(*pos % tile_cells);
+            cell->idx = (((tile / map->tiles_per_row) << map->tile_order | offset >> map->tile_order) << map->order) |
+                        (tile % map->tiles_per_row) << map->tile_order | (offset & tile_mask);
+        }
+        (*pos)++;
+
+        cell->value = (map->cell_size == 1) ? base[offset] : ((const uint32_t *)(const void *)base)[offset];
+        if (cell->value) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
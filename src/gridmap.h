@@ -0,0 +1,128 @@
+/*****
+ *
+ * Description: Dense, Tiled or Hashed Heatmap-Sized Grid Headers
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#ifndef GRIDMAP_DOT_H
+#define GRIDMAP_DOT_H
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "../include/sysdep.h"
+
+#ifndef __SYSDEP_H__
+#error something is messed up
+#endif
+
+#include "../include/common.h"
+#include <stdint.h>
+#include <limits.h>
+
+/****
+ *
+ * defines
+ *
+ ****/
+
+#define GRIDMAP_TILE_ORDER 6                /* Tiles of 64x64 cells */
+#define GRIDMAP_HASH_INITIAL_CELLS 4096     /* Initial hash slots (power of 2) */
+#define GRIDMAP_DENSE_MAX ((uint64_t)INT_MAX) /* Largest single allocation (XMALLOC() takes an int) */
+
+/****
+ *
+ * typedefs & structs
+ *
+ ****/
+
+/**
+ * How a map stores its cells
+ */
+typedef enum {
+    GRIDMAP_DENSE = 0,       /* One dimension^2 array */
+    GRIDMAP_TILED,           /* Square tiles allocated on first write, for values that come in ranges */
+    GRIDMAP_HASHED           /* Open-addressing table of non-zero cells, for scattered values */
+} GridMapLayout_t;
+
+/**
+ * Non-zero cell of a hashed map
+ */
+typedef struct {
+    uint32_t idx;            /* Heatmap index (y * dimension + x) */
+    uint32_t value;          /* 0 = empty slot */
+} GridMapCell_t;
+
+/**
+ * One value per heatmap cell, stored dense, tiled or hashed
+ *
+ * Cells are addressed by heatmap index (y * dimension + x) in every
+ * layout, and a cell never written reads as zero. A tiled map shares a
+ * single copy between tiles whose cells are all the same non-zero value
+ * (shareUniformTiles()) and unshares a tile when it is written. Hashed
+ * maps do not store zeros, so a cell once non-zero must stay non-zero.
+ */
+typedef struct {
+    GridMapLayout_t layout;
+    uint32_t dimension;      /* Width/height in cells (2^order) */
+    uint8_t order;
+    uint8_t cell_size;       /* Bytes per cell: 1 or 4 (hashed maps keep 4 either way) */
+    uint8_t tile_order;      /* Tile width is 2^tile_order cells */
+
+    /* GRIDMAP_DENSE */
+    uint8_t *dense;          /* dimension^2 cells */
+
+    /* GRIDMAP_TILED */
+    uint8_t **tiles;         /* Tile directory, row major, NULL entries are all zero */
+    uint8_t *shared_tile;    /* Uniform tile several directory entries may point at */
+    uint32_t tiles_per_row;
+    uint32_t tile_count;     /* Tiles allocated, not counting shared_tile */
+
+    /* GRIDMAP_HASHED */
+    GridMapCell_t *cells;
+    uint32_t cell_capacity;  /* Table slots (power of 2), kept at most 3/4 full */
+    uint32_t cell_count;     /* Non-zero cells */
+} GridMap_t;
+
+/****
+ *
+ * function prototypes
+ *
+ ****/
+
+GridMap_t *createGridMap(uint8_t order, uint8_t cell_size, GridMapLayout_t layout);
+void destroyGridMap(GridMap_t *map);
+GridMap_t *copyGridMap(const GridMap_t *map);
+uint64_t getGridMapDenseBytes(uint8_t order, uint8_t cell_size);
+uint64_t getGridMapBytes(const GridMap_t *map);
+uint32_t getGridMapCell(const GridMap_t *map, uint32_t idx);
+int setGridMapCell(GridMap_t *map, uint32_t idx, uint32_t value);
+uint32_t addGridMapCell(GridMap_t *map, uint32_t idx, uint32_t amount);
+void shareUniformTiles(GridMap_t *map);
+int nextGridMapCell(const GridMap_t *map, uint64_t *pos, GridMapCell_t *cell);
+const char *getGridMapLayoutName(GridMapLayout_t layout);
+
+#endif /* GRIDMAP_DOT_H */
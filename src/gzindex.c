@@ -0,0 +1,808 @@
+/*****
+ *
+ * Description: Random-Access Gzip Index Implementation
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+/****
+ *
+ * The index follows the approach of zlib's examples/zran.c: one full
+ * sequential inflate records "access points" at deflate block boundaries
+ * roughly every GZINDEX_SPAN bytes of output, each with the bit offset and
+ * the 32KB of history the next block may refer back to. Inflation can then
+ * restart at any point with inflatePrime() + inflateSetDictionary(), which
+ * lets separate threads each decompress their own slice of one file.
+ *
+ ****/
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#include "gzindex.h"
+#include "mem.h"
+#include "util.h"
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <zlib.h>
+
+/****
+ *
+ * defines
+ *
+ ****/
+
+#define GZINDEX_CHUNK (128 * 1024)       // Compressed read size
+#define GZINDEX_END UINT64_MAX           // Slice runs to end of file
+
+/****
+ *
+ * typedefs
+ *
+ ****/
+
+/**
+ * Block source state for one slice stream
+ */
+typedef struct {
+    FILE *fp;
+    const char *file_path;        // File fp is open on (owned by caller)
+    z_stream strm;
+    int strm_ready;
+    int raw;                      // Inflating raw deflate (resumed mid-member)
+    int member_start;             // Just reset for a new member, nothing inflated yet
+    uint32_t trailer_skip;        // Gzip trailer bytes still to skip after a raw member
+    unsigned char *input;
+    unsigned char *window;        // Scratch for the decompressed dictionary
+    uint64_t out_pos;             // Uncompressed offset of the next byte produced
+    uint64_t end;                 // Slice end (exclusive) or GZINDEX_END
+    int skip_head;                // Still dropping the partial first line
+    int done;
+} GzSliceSource_t;
+
+/****
+ *
+ * external variables
+ *
+ ****/
+
+extern Config_t *config;
+
+/****
+ *
+ * functions
+ *
+ ****/
+
+/****
+ *
+ * Record an access point
+ *
+ * DESCRIPTION:
+ *   Appends a point to the index, unrolling the circular output window so
+ *   the history is in order and compressing it for storage.
+ *
+ * PARAMETERS:
+ *   index - Index to append to
+ *   bits - Unused bits in the byte before in
+ *   in - Compressed offset
+ *   out - Uncompressed offset
+ *   left - Free bytes at the end of the circular window (strm.avail_out)
+ *   window - Circular GZINDEX_WINDOW byte output window
+ *   scratch - GZINDEX_WINDOW bytes of scratch space
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if the window could not be compressed
+ *
+ ****/
+PRIVATE int addGzIndexPoint(GzIndex_t *index, uint32_t bits, uint64_t in, uint64_t out,
+                            uInt left, const unsigned char *window, unsigned char *scratch)
+{
+    GzIndexPoint_t *point;
+    unsigned char packed[GZINDEX_WINDOW + 1024];
+    uLongf packed_len = sizeof(packed);
+
+    if (index->count == index->capacity) {
+        index->capacity = index->capacity ? index->capacity * 2 : 64;
+        index->points = (GzIndexPoint_t *)XREALLOC(index->points,
+                                                   (int)(sizeof(GzIndexPoint_t) * index->capacity));
+    }
+
+    /* Oldest history first */
+    if (left) {
+        memcpy(scratch, window + GZINDEX_WINDOW - left, left);
+    }
+    if (left < GZINDEX_WINDOW) {
+        memcpy(scratch + left, window, GZINDEX_WINDOW - left);
+    }
+
+    if (compress2(packed, &packed_len, scratch, GZINDEX_WINDOW, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        return FALSE;
+    }
+
+    point = &index->points[index->count++];
+    point->out = out;
+    point->in = in;
+    point->bits = bits;
+    point->window_len = (uint32_t)packed_len;
+    point->window = (unsigned char *)XMALLOC((int)packed_len);
+    memcpy(point->window, packed, packed_len);
+
+    return TRUE;
+}
+
+/****
+ *
+ * Build a checkpoint index for a gzip file
+ *
+ * DESCRIPTION:
+ *   Inflates the whole file once, recording an access point at the first
+ *   deflate block boundary after every `span` bytes of output. Concatenated
+ *   gzip members are followed; trailing garbage after a complete member is
+ *   ignored, as gzread() does.
+ *
+ * PARAMETERS:
+ *   file_path - Path to .gz file
+ *   span - Minimum uncompressed distance between access points
+ *
+ * RETURNS:
+ *   New index, or NULL on read or data error
+ *
+ ****/
+GzIndex_t *buildGzIndex(const char *file_path, uint64_t span)
+{
+    GzIndex_t *index;
+    FILE *fp;
+    z_stream strm;
+    struct stat st;
+    unsigned char *input, *window, *scratch;
+    uint64_t totin = 0, totout = 0, last = 0;
+    int ret = Z_OK;
+    int ok = FALSE;
+    size_t got;
+
+    fp = fopen(file_path, "rb");
+    if (!fp) {
+        fprintf(stderr, "ERR - Unable to open %s: %s\n", file_path, strerror(errno));
+        return NULL;
+    }
+    if (fstat(fileno(fp), &st) != 0) {
+        fclose(fp);
+        return NULL;
+    }
+
+    index = (GzIndex_t *)XMALLOC(sizeof(GzIndex_t));
+    XMEMSET(index, 0, sizeof(GzIndex_t));
+    index->file_size = (uint64_t)st.st_size;
+    index->file_mtime = (int64_t)st.st_mtime;
+
+    input = (unsigned char *)XMALLOC(GZINDEX_CHUNK);
+    window = (unsigned char *)XMALLOC(GZINDEX_WINDOW);
+    scratch = (unsigned char *)XMALLOC(GZINDEX_WINDOW);
+    XMEMSET(window, 0, GZINDEX_WINDOW);
+
+    memset(&strm, 0, sizeof(strm));
+    if (inflateInit2(&strm, 47) != Z_OK) {   /* 15 bit window, gzip or zlib header */
+        goto cleanup;
+    }
+
+    strm.avail_out = 0;
+    for (;;) {
+        got = fread(input, 1, GZINDEX_CHUNK, fp);
+        if (ferror(fp)) {
+            fprintf(stderr, "ERR - Read error on %s\n", file_path);
+            goto cleanup_inflate;
+        }
+        if (got == 0) {
+            /* EOF is only clean at a member boundary */
+            ok = (ret == Z_STREAM_END);
+            if (!ok) {
+                fprintf(stderr, "ERR - Unexpected end of compressed data in %s\n", file_path);
+            }
+            break;
+        }
+        strm.avail_in = (uInt)got;
+        strm.next_in = input;
+
+        do {
+            if (strm.avail_out == 0) {
+                strm.avail_out = GZINDEX_WINDOW;
+                strm.next_out = window;
+            }
+
+            if (ret == Z_STREAM_END) {
+                /* Another member follows */
+                inflateReset(&strm);
+            }
+
+            totin += strm.avail_in;
+            totout += strm.avail_out;
+            ret = inflate(&strm, Z_BLOCK);
+            totin -= strm.avail_in;
+            totout -= strm.avail_out;
+
+            if (ret == Z_NEED_DICT || ret == Z_DATA_ERROR || ret == Z_MEM_ERROR) {
+                if (ret == Z_DATA_ERROR && strm.total_out == 0 && totout > 0) {
+                    /* Garbage after the last member - stop like gzread() */
+                    ok = TRUE;
+                    ret = Z_STREAM_END;
+                    strm.avail_in = 0;
+                    goto finished;
+                }
+                fprintf(stderr, "ERR - Corrupt gzip data in %s: %s\n", file_path,
+                        strm.msg ? strm.msg : "inflate error");
+                goto cleanup_inflate;
+            }
+
+            /* At a block boundary (not the last block): maybe add a point */
+            if ((strm.data_type & 128) && !(strm.data_type & 64) &&
+                (totout == 0 || totout - last > span)) {
+                if (!addGzIndexPoint(index, (uint32_t)(strm.data_type & 7), totin, totout,
+                                     strm.avail_out, window, scratch)) {
+                    goto cleanup_inflate;
+                }
+                last = totout;
+            }
+        } while (strm.avail_in != 0);
+    }
+
+finished:
+    index->total_out = totout;
+
+cleanup_inflate:
+    inflateEnd(&strm);
+
+cleanup:
+    XFREE(scratch);
+    XFREE(window);
+    XFREE(input);
+    fclose(fp);
+
+    if (!ok || index->count == 0) {
+        freeGzIndex(index);
+        return NULL;
+    }
+
+#ifdef DEBUG
+    if (config->debug >= 1) {
+        fprintf(stderr, "DEBUG - Indexed %s: %u access points, %lu bytes uncompressed\n",
+                file_path, index->count, (unsigned long)index->total_out);
+    }
+#endif
+
+    return index;
+}
+
+/****
+ *
+ * Free a checkpoint index
+ *
+ ****/
+void freeGzIndex(GzIndex_t *index)
+{
+    uint32_t i;
+
+    if (!index) {
+        return;
+    }
+
+    for (i = 0; i < index->count; i++) {
+        XFREE(index->points[i].window);
+    }
+    if (index->points) {
+        XFREE(index->points);
+    }
+    XFREE(index);
+}
+
+/****
+ *
+ * Build the sidecar path for a gzip file
+ *
+ ****/
+PRIVATE int gzIndexPath(const char *file_path, char *buf, size_t buf_size)
+{
+    int len = snprintf(buf, buf_size, "%s%s", file_path, GZINDEX_SUFFIX);
+
+    return (len > 0 && (size_t)len < buf_size);
+}
+
+/****
+ *
+ * Write an index to its sidecar file
+ *
+ * DESCRIPTION:
+ *   Writes <file_path>.tpidx via a temporary file and rename(), so a
+ *   concurrent reader never sees a partial index. Layout (host byte order):
+ *   magic[8], file_size, file_mtime, total_out, count, then per point
+ *   out, in, bits, window_len and the compressed window.
+ *
+ * PARAMETERS:
+ *   index - Index to save
+ *   file_path - Path of the indexed .gz file
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on failure
+ *
+ ****/
+int saveGzIndex(const GzIndex_t *index, const char *file_path)
+{
+    char path[PATH_MAX], tmp_path[PATH_MAX];
+    FILE *fp;
+    uint32_t i;
+    int ok;
+
+    if (!index || !gzIndexPath(file_path, path, sizeof(path)) ||
+        snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+        return FALSE;
+    }
+
+    fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        return FALSE;
+    }
+
+    ok = (fwrite(GZINDEX_MAGIC, 1, 8, fp) == 8 &&
+          fwrite(&index->file_size, sizeof(index->file_size), 1, fp) == 1 &&
+          fwrite(&index->file_mtime, sizeof(index->file_mtime), 1, fp) == 1 &&
+          fwrite(&index->total_out, sizeof(index->total_out), 1, fp) == 1 &&
+          fwrite(&index->count, sizeof(index->count), 1, fp) == 1);
+
+    for (i = 0; ok && i < index->count; i++) {
+        const GzIndexPoint_t *point = &index->points[i];
+
+        ok = (fwrite(&point->out, sizeof(point->out), 1, fp) == 1 &&
+              fwrite(&point->in, sizeof(point->in), 1, fp) == 1 &&
+              fwrite(&point->bits, sizeof(point->bits), 1, fp) == 1 &&
+              fwrite(&point->window_len, sizeof(point->window_len), 1, fp) == 1 &&
+              fwrite(point->window, 1, point->window_len, fp) == point->window_len);
+    }
+
+    if (fclose(fp) != 0) {
+        ok = FALSE;
+    }
+    if (!ok || rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/****
+ *
+ * Load an index from its sidecar file
+ *
+ * DESCRIPTION:
+ *   Reads <file_path>.tpidx and checks it still matches the .gz file's size
+ *   and modification time.
+ *
+ * PARAMETERS:
+ *   file_path - Path of the indexed .gz file
+ *
+ * RETURNS:
+ *   Index, or NULL if missing, stale or malformed
+ *
+ ****/
+GzIndex_t *loadGzIndex(const char *file_path)
+{
+    char path[PATH_MAX];
+    char magic[8];
+    struct stat st;
+    GzIndex_t *index;
+    FILE *fp;
+    uint32_t i;
+    int ok;
+
+    if (!gzIndexPath(file_path, path, sizeof(path)) || stat(file_path, &st) != 0) {
+        return NULL;
+    }
+
+    fp = fopen(path, "rb");
+    if (!fp) {
+        return NULL;
+    }
+
+    index = (GzIndex_t *)XMALLOC(sizeof(GzIndex_t));
+    XMEMSET(index, 0, sizeof(GzIndex_t));
+
+    ok = (fread(magic, 1, 8, fp) == 8 && memcmp(magic, GZINDEX_MAGIC, 8) == 0 &&
+          fread(&index->file_size, sizeof(index->file_size), 1, fp) == 1 &&
+          fread(&index->file_mtime, sizeof(index->file_mtime), 1, fp) == 1 &&
+          fread(&index->total_out, sizeof(index->total_out), 1, fp) == 1 &&
+          fread(&index->capacity, sizeof(index->capacity), 1, fp) == 1);
+
+    if (ok && (index->file_size != (uint64_t)st.st_size ||
+               index->file_mtime != (int64_t)st.st_mtime ||
+               index->capacity == 0 || index->capacity > (1U << 24))) {
+        ok = FALSE;
+    }
+
+    if (ok) {
+        index->points = (GzIndexPoint_t *)XMALLOC((int)(sizeof(GzIndexPoint_t) * index->capacity));
+    }
+
+    for (i = 0; ok && i < index->capacity; i++) {
+        GzIndexPoint_t *point = &index->points[i];
+
+        ok = (fread(&point->out, sizeof(point->out), 1, fp) == 1 &&
+              fread(&point->in, sizeof(point->in), 1, fp) == 1 &&
+              fread(&point->bits, sizeof(point->bits), 1, fp) == 1 &&
+              fread(&point->window_len, sizeof(point->window_len), 1, fp) == 1 &&
+              point->bits < 8 && point->in <= index->file_size &&
+              point->window_len > 0 && point->window_len <= GZINDEX_WINDOW + 1024);
+        if (ok) {
+            point->window = (unsigned char *)XMALLOC((int)point->window_len);
+            index->count++;
+            ok = (fread(point->window, 1, point->window_len, fp) == point->window_len);
+        }
+    }
+
+    fclose(fp);
+
+    if (!ok) {
+        freeGzIndex(index);
+        return NULL;
+    }
+
+    return index;
+}
+
+/****
+ *
+ * Get the index for a gzip file, building it if needed
+ *
+ * DESCRIPTION:
+ *   Loads the sidecar index if present and current; otherwise, for gzip
+ *   input, builds one with a full sequential pass and tries to save it next
+ *   to the file. If the sidecar cannot be written the in-memory index is
+ *   still returned.
+ *
+ * PARAMETERS:
+ *   file_path - Path to .gz file
+ *
+ * RETURNS:
+ *   Index, or NULL if the file is not gzip or could not be indexed
+ *
+ ****/
+GzIndex_t *getGzIndex(const char *file_path)
+{
+    GzIndex_t *index;
+    unsigned char magic[2];
+    FILE *fp;
+    int is_gzip;
+
+    index = loadGzIndex(file_path);
+    if (index) {
+        return index;
+    }
+
+    /* Plain text input is streamed, not indexed */
+    fp = fopen(file_path, "rb");
+    if (!fp) {
+        return NULL;
+    }
+    is_gzip = (fread(magic, 1, 2, fp) == 2 && magic[0] == 0x1f && magic[1] == 0x8b);
+    fclose(fp);
+    if (!is_gzip) {
+        return NULL;
+    }
+
+    fprintf(stderr, "Building gzip index for %s (one-time pass)...\n", file_path);
+    index = buildGzIndex(file_path, GZINDEX_SPAN);
+    if (!index) {
+        return NULL;
+    }
+
+    if (!saveGzIndex(index, file_path)) {
+        fprintf(stderr, "WARN - Unable to write %s%s, index will be rebuilt next run\n",
+                file_path, GZINDEX_SUFFIX);
+    }
+
+    return index;
+}
+
+/****
+ *
+ * Inflate into dst, following member boundaries
+ *
+ * RETURNS:
+ *   Bytes produced, 0 at end of data, -1 on error
+ *
+ ****/
+PRIVATE int inflateSliceBlock(GzSliceSource_t *src, char *dst, size_t room)
+{
+    size_t got;
+    int ret;
+
+    src->strm.next_out = (Bytef *)dst;
+    src->strm.avail_out = (uInt)room;
+
+    while (src->strm.avail_out > 0) {
+        if (src->strm.avail_in == 0) {
+            got = fread(src->input, 1, GZINDEX_CHUNK, src->fp);
+            if (got == 0) {
+                if (ferror(src->fp)) {
+                    fprintf(stderr, "ERR - Read error on %s\n", src->file_path);
+                    return -1;
+                }
+                src->done = TRUE;
+                break;
+            }
+            src->strm.next_in = src->input;
+            src->strm.avail_in = (uInt)got;
+        }
+
+        if (src->trailer_skip > 0) {
+            uInt skip = (src->strm.avail_in < src->trailer_skip) ? src->strm.avail_in : src->trailer_skip;
+            src->strm.next_in += skip;
+            src->strm.avail_in -= skip;
+            src->trailer_skip -= skip;
+            continue;
+        }
+
+        ret = inflate(&src->strm, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+            /* Member finished; a raw stream leaves its 8 byte trailer behind */
+            if (src->raw) {
+                src->trailer_skip = 8;
+                src->raw = FALSE;
+                inflateReset2(&src->strm, 31);
+            } else {
+                inflateReset(&src->strm);
+            }
+            src->member_start = TRUE;
+            continue;
+        }
+        if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            if (ret == Z_DATA_ERROR && src->member_start) {
+                /* Garbage after the last member */
+                src->done = TRUE;
+                break;
+            }
+            fprintf(stderr, "ERR - Corrupt gzip data in %s: %s\n", src->file_path,
+                    src->strm.msg ? src->strm.msg : "inflate error");
+            return -1;
+        }
+        if (src->strm.avail_out < room) {
+            src->member_start = FALSE;
+        }
+    }
+
+    return (int)(room - src->strm.avail_out);
+}
+
+/****
+ *
+ * Block reader for slice streams
+ *
+ * DESCRIPTION:
+ *   Produces the text of one slice. A slice owns every line that starts
+ *   inside [point.out, end): the partial line at the start belongs to the
+ *   previous slice and is dropped, and the last line is completed past end.
+ *   Concatenating all slices therefore gives back every line exactly once.
+ *
+ * PARAMETERS:
+ *   source - GzSliceSource_t
+ *   dst - Output buffer
+ *   room - Space in dst
+ *
+ * RETURNS:
+ *   Bytes written, 0 at end of slice, -1 on error
+ *
+ ****/
+PRIVATE int readGzSliceBlock(void *source, char *dst, size_t room)
+{
+    GzSliceSource_t *src = (GzSliceSource_t *)source;
+    uint64_t base, last;
+    size_t n, start;
+    char *nl;
+    int got;
+
+    while (!src->done) {
+        got = inflateSliceBlock(src, dst, room);
+        if (got <= 0) {
+            return got;
+        }
+        n = (size_t)got;
+        base = src->out_pos;
+        src->out_pos += n;
+
+        /* Last owned line ends at the first newline at or after end - 1 */
+        last = (src->end == GZINDEX_END) ? GZINDEX_END : src->end - 1;
+
+        if (src->skip_head) {
+            nl = (char *)memchr(dst, '\n', n);
+            if (!nl) {
+                if (last != GZINDEX_END && base + n > last) {
+                    /* The previous slice's line runs through this whole slice */
+                    src->done = TRUE;
+                    return 0;
+                }
+                continue;
+            }
+            if (last != GZINDEX_END && base + (uint64_t)(nl - dst) >= last) {
+                src->done = TRUE;
+                return 0;
+            }
+            start = (size_t)(nl - dst) + 1;
+            memmove(dst, dst + start, n - start);
+            n -= start;
+            base += start;
+            src->skip_head = FALSE;
+        }
+
+        if (last != GZINDEX_END && base + n > last) {
+            start = (last > base) ? (size_t)(last - base) : 0;
+            nl = (char *)memchr(dst + start, '\n', n - start);
+            if (nl) {
+                n = (size_t)(nl - dst) + 1;
+                src->done = TRUE;
+            }
+        }
+
+        if (n > 0) {
+            return (int)n;
+        }
+    }
+
+    return 0;
+}
+
+/****
+ *
+ * Release slice reader state
+ *
+ ****/
+PRIVATE void closeGzSliceSource(void *source)
+{
+    GzSliceSource_t *src = (GzSliceSource_t *)source;
+
+    if (!src) {
+        return;
+    }
+    if (src->strm_ready) {
+        inflateEnd(&src->strm);
+    }
+    if (src->fp) {
+        fclose(src->fp);
+    }
+    XFREE(src->window);
+    XFREE(src->input);
+    XFREE(src);
+}
+
+/****
+ *
+ * Create an unpositioned slice stream
+ *
+ * DESCRIPTION:
+ *   Allocates a line stream with its own inflate state and buffers. It is
+ *   positioned (and repositioned) with seekGzipSliceStream(), which does
+ *   not allocate, so slice streams can be created up front and handed
+ *   between threads.
+ *
+ * RETURNS:
+ *   Pointer to GzipStream_t, or NULL on zlib init failure
+ *
+ ****/
+GzipStream_t *openGzipSliceStream(void)
+{
+    GzSliceSource_t *src;
+
+    src = (GzSliceSource_t *)XMALLOC(sizeof(GzSliceSource_t));
+    XMEMSET(src, 0, sizeof(GzSliceSource_t));
+    src->input = (unsigned char *)XMALLOC(GZINDEX_CHUNK);
+    src->window = (unsigned char *)XMALLOC(GZINDEX_WINDOW);
+    src->done = TRUE;
+
+    if (inflateInit2(&src->strm, -15) != Z_OK) {
+        closeGzSliceSource(src);
+        return NULL;
+    }
+    src->strm_ready = TRUE;
+
+    return openBlockStream(NULL, readGzSliceBlock, closeGzSliceSource, src);
+}
+
+/****
+ *
+ * Position a slice stream on part of an indexed file
+ *
+ * DESCRIPTION:
+ *   Restarts inflation at access point `point` and limits the stream to
+ *   lines starting before `end`. Reopens the file only if it differs from
+ *   the one the stream last read.
+ *
+ * PARAMETERS:
+ *   stream - Stream from openGzipSliceStream()
+ *   file_path - Indexed file (must stay valid while the stream uses it)
+ *   index - Index for file_path
+ *   point - Access point to start at
+ *   end - Uncompressed end offset (exclusive), or UINT64_MAX for EOF
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on error
+ *
+ ****/
+int seekGzipSliceStream(GzipStream_t *stream, const char *file_path,
+                        const GzIndex_t *index, uint32_t point, uint64_t end)
+{
+    GzSliceSource_t *src = (GzSliceSource_t *)stream->source;
+    const GzIndexPoint_t *pt;
+    uLongf window_len = GZINDEX_WINDOW;
+    int ch;
+
+    if (!src || !index || point >= index->count) {
+        return FALSE;
+    }
+    pt = &index->points[point];
+
+    resetBlockStream(stream);
+    src->done = TRUE;
+
+    if (src->file_path != file_path) {
+        if (src->fp) {
+            fclose(src->fp);
+        }
+        src->fp = fopen(file_path, "rb");
+        src->file_path = file_path;
+        if (!src->fp) {
+            src->file_path = NULL;
+            fprintf(stderr, "ERR - Unable to open %s: %s\n", file_path, strerror(errno));
+            return FALSE;
+        }
+    }
+
+    if (uncompress(src->window, &window_len, pt->window, pt->window_len) != Z_OK ||
+        window_len != GZINDEX_WINDOW) {
+        fprintf(stderr, "ERR - Corrupt index window for %s\n", file_path);
+        return FALSE;
+    }
+
+    if (fseeko(src->fp, (off_t)(pt->in - (pt->bits ? 1 : 0)), SEEK_SET) != 0) {
+        return FALSE;
+    }
+
+    inflateReset2(&src->strm, -15);
+    src->strm.avail_in = 0;
+    if (pt->bits) {
+        ch = getc(src->fp);
+        if (ch == EOF) {
+            return FALSE;
+        }
+        inflatePrime(&src->strm, (int)pt->bits, ch >> (8 - pt->bits));
+    }
+    inflateSetDictionary(&src->strm, src->window, GZINDEX_WINDOW);
+
+    src->raw = TRUE;
+    src->member_start = FALSE;
+    src->trailer_skip = 0;
+    src->out_pos = pt->out;
+    src->end = end;
+    src->skip_head = (pt->out > 0 && src->window[GZINDEX_WINDOW - 1] != '\n');
+    src->done = FALSE;
+
+    return TRUE;
+}
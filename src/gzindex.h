@@ -0,0 +1,113 @@
+/*****
+ *
+ * Description: Random-Access Gzip Index Headers
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#ifndef GZINDEX_DOT_H
+#define GZINDEX_DOT_H
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "../include/sysdep.h"
+
+#ifndef __SYSDEP_H__
+#error something is messed up
+#endif
+
+#include "../include/common.h"
+#include "log_parser.h"
+#include <stdint.h>
+
+/****
+ *
+ * defines
+ *
+ ****/
+
+#define GZINDEX_SUFFIX ".tpidx"                   // Sidecar: <file>.gz.tpidx
+#define GZINDEX_MAGIC "TPGZIDX1"                  // 8 bytes, version in the last byte
+#define GZINDEX_WINDOW 32768                      // Deflate history needed to resume
+
+/* Uncompressed bytes between access points (one parallel slice each) */
+#ifndef GZINDEX_SPAN
+#define GZINDEX_SPAN (16 * 1024 * 1024)
+#endif
+
+/* Only index files at least this large (compressed) */
+#ifndef GZINDEX_MIN_FILE_SIZE
+#define GZINDEX_MIN_FILE_SIZE (64 * 1024 * 1024)
+#endif
+
+/****
+ *
+ * typedefs & structs
+ *
+ ****/
+
+/**
+ * Access point - a deflate block boundary where inflation can restart
+ */
+typedef struct {
+    uint64_t out;               // Uncompressed offset of the point
+    uint64_t in;                // Compressed offset of the first whole byte after it
+    uint32_t bits;              // Bits of the byte before `in` still to be used (0-7)
+    uint32_t window_len;        // Length of the compressed window
+    unsigned char *window;      // Preceding 32KB of output, zlib compressed
+} GzIndexPoint_t;
+
+/**
+ * Checkpoint index for one gzip file
+ */
+typedef struct {
+    uint64_t file_size;         // Compressed size when indexed (staleness check)
+    int64_t file_mtime;         // Modification time when indexed (staleness check)
+    uint64_t total_out;         // Uncompressed size
+    uint32_t count;             // Number of access points
+    uint32_t capacity;
+    GzIndexPoint_t *points;
+} GzIndex_t;
+
+/****
+ *
+ * function prototypes
+ *
+ ****/
+
+/* Index build / persistence */
+GzIndex_t *buildGzIndex(const char *file_path, uint64_t span);
+GzIndex_t *loadGzIndex(const char *file_path);
+int saveGzIndex(const GzIndex_t *index, const char *file_path);
+GzIndex_t *getGzIndex(const char *file_path);
+void freeGzIndex(GzIndex_t *index);
+
+/* Slice streams - line streams over [point.out, end) of an indexed file */
+GzipStream_t *openGzipSliceStream(void);
+int seekGzipSliceStream(GzipStream_t *stream, const char *file_path,
+                        const GzIndex_t *index, uint32_t point, uint64_t end);
+
+#endif /* GZINDEX_DOT_H */
@@ -0,0 +1,374 @@
+/*****
+ *
+ * Description: Read-Ahead Gzip Ring Implementation
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+/****
+ *
+ * An inflater thread decompresses the file (with whichever backend
+ * openGzipStream() picks) into a single-producer/single-consumer ring of
+ * fixed-size blocks; the parsing thread drains the ring
+ * through the GzipStream_t block source hook. The ring indices are only
+ * ever advanced by one side each, so the hand-off needs no lock. A side
+ * that finds the ring empty (consumer) or full (producer) yields a few
+ * times and then sleeps on a condition variable; the other side only
+ * takes the mutex when it sees that a sleeper is registered.
+ *
+ ****/
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#include "gzring.h"
+#include "mem.h"
+#include "util.h"
+#include <string.h>
+#include <stdlib.h>
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+/****
+ *
+ * typedefs
+ *
+ ****/
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * One inflated block
+ */
+typedef struct {
+    char *data;
+    int len;                      // Bytes in data, 0 = end of file, -1 = read error
+} GzRingSlot_t;
+
+/**
+ * Ring shared by the inflater and the parser
+ *
+ * head is written only by the inflater, tail only by the parser. Both are
+ * free-running counters; the slot is counter % GZRING_SLOTS.
+ */
+typedef struct {
+    GzipStream_t *input;          // Decompressing stream, used only by the inflater
+    GzRingSlot_t slots[GZRING_SLOTS];
+    size_t head;                  // Next slot the inflater fills
+    size_t tail;                  // Next slot the parser drains
+    size_t offset;                // Parser's position within slots[tail]
+    int stop;                     // Parser closed the stream early
+    int producer_waiting;
+    int consumer_waiting;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+} GzRing_t;
+#endif
+
+/****
+ *
+ * external variables
+ *
+ ****/
+
+extern Config_t *config;
+
+/****
+ *
+ * functions
+ *
+ ****/
+
+#ifdef HAVE_PTHREAD_H
+/****
+ *
+ * Wait until a ring condition holds
+ *
+ * DESCRIPTION:
+ *   Yields GZRING_SPIN times, then registers as a sleeper and blocks. The
+ *   waiting flag is set before the final re-check and the other side
+ *   publishes before it reads the flag (both sequentially consistent), so a
+ *   wakeup cannot be missed.
+ *
+ * PARAMETERS:
+ *   ring - Ring
+ *   waiting - This side's sleeper flag
+ *   ready - Condition to wait for
+ *
+ ****/
+PRIVATE void waitGzRing(GzRing_t *ring, int *waiting, int (*ready)(const GzRing_t *ring))
+{
+    int i;
+
+    for (i = 0; i < GZRING_SPIN; i++) {
+        if (ready(ring)) {
+            return;
+        }
+        sched_yield();
+    }
+
+    pthread_mutex_lock(&ring->lock);
+    __atomic_store_n(waiting, TRUE, __ATOMIC_SEQ_CST);
+    while (!ready(ring)) {
+        pthread_cond_wait(&ring->cond, &ring->lock);
+    }
+    __atomic_store_n(waiting, FALSE, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&ring->lock);
+}
+
+/****
+ *
+ * Wake the other side if it is asleep
+ *
+ ****/
+PRIVATE void wakeGzRing(GzRing_t *ring, const int *waiting)
+{
+    if (__atomic_load_n(waiting, __ATOMIC_SEQ_CST)) {
+        pthread_mutex_lock(&ring->lock);
+        pthread_cond_signal(&ring->cond);
+        pthread_mutex_unlock(&ring->lock);
+    }
+}
+
+/****
+ *
+ * Ring conditions
+ *
+ ****/
+PRIVATE int gzRingHasData(const GzRing_t *ring)
+{
+    return (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) != ring->tail);
+}
+
+PRIVATE int gzRingHasRoom(const GzRing_t *ring)
+{
+    return (ring->head - __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) < GZRING_SLOTS ||
+            __atomic_load_n(&ring->stop, __ATOMIC_SEQ_CST));
+}
+
+/****
+ *
+ * Inflater thread
+ *
+ * DESCRIPTION:
+ *   Fills free slots with readGzipBlock() until end of file, a read error or the
+ *   parser stops the stream. The end/error marker is published as a slot
+ *   of its own so the parser sees it in order.
+ *
+ * PARAMETERS:
+ *   arg - GzRing_t
+ *
+ * RETURNS:
+ *   NULL
+ *
+ ****/
+PRIVATE void *gzRingInflater(void *arg)
+{
+    GzRing_t *ring = (GzRing_t *)arg;
+    GzRingSlot_t *slot;
+    int got;
+
+    for (;;) {
+        if (!gzRingHasRoom(ring)) {
+            waitGzRing(ring, &ring->producer_waiting, gzRingHasRoom);
+        }
+        if (__atomic_load_n(&ring->stop, __ATOMIC_SEQ_CST)) {
+            break;
+        }
+
+        slot = &ring->slots[ring->head % GZRING_SLOTS];
+        got = readGzipBlock(ring->input, slot->data, GZRING_SLOT_SIZE);
+        slot->len = (got < 0) ? -1 : got;
+
+        __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_SEQ_CST);
+        wakeGzRing(ring, &ring->consumer_waiting);
+
+        if (got <= 0) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/****
+ *
+ * Block reader for ring streams
+ *
+ * DESCRIPTION:
+ *   Copies inflated text from the oldest full slot into dst, releasing the
+ *   slot to the inflater once it has been drained.
+ *
+ * PARAMETERS:
+ *   source - GzRing_t
+ *   dst - Output buffer
+ *   room - Space in dst
+ *
+ * RETURNS:
+ *   Bytes written, 0 at end of file, -1 on read error
+ *
+ ****/
+PRIVATE int readGzRingBlock(void *source, char *dst, size_t room)
+{
+    GzRing_t *ring = (GzRing_t *)source;
+    GzRingSlot_t *slot;
+    size_t n;
+
+    if (!gzRingHasData(ring)) {
+        waitGzRing(ring, &ring->consumer_waiting, gzRingHasData);
+    }
+
+    slot = &ring->slots[ring->tail % GZRING_SLOTS];
+    if (slot->len <= 0) {
+        /* Leave the marker in place so later calls see it again */
+        return slot->len;
+    }
+
+    n = (size_t)slot->len - ring->offset;
+    if (n > room) {
+        n = room;
+    }
+    memcpy(dst, slot->data + ring->offset, n);
+    ring->offset += n;
+
+    if (ring->offset == (size_t)slot->len) {
+        ring->offset = 0;
+        __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_SEQ_CST);
+        wakeGzRing(ring, &ring->producer_waiting);
+    }
+
+    return (int)n;
+}
+
+/****
+ *
+ * Stop the inflater and release the ring
+ *
+ ****/
+PRIVATE void closeGzRing(void *source)
+{
+    GzRing_t *ring = (GzRing_t *)source;
+    int i;
+
+    __atomic_store_n(&ring->stop, TRUE, __ATOMIC_SEQ_CST);
+    wakeGzRing(ring, &ring->producer_waiting);
+    pthread_join(ring->thread, NULL);
+
+    pthread_cond_destroy(&ring->cond);
+    pthread_mutex_destroy(&ring->lock);
+    closeGzipStream(ring->input);
+    for (i = 0; i < GZRING_SLOTS; i++) {
+        XFREE(ring->slots[i].data);
+    }
+    XFREE(ring);
+}
+#endif
+
+/****
+ *
+ * Open a gzip file with decompression on its own thread
+ *
+ * DESCRIPTION:
+ *   Starts an inflater thread that decompresses ahead of the caller into
+ *   a ring of GZRING_SLOTS blocks, so inflate overlaps with parsing,
+ *   binning and rendering on the calling thread. The returned stream is
+ *   read with readLineViewGzip() as usual and must be read by one thread
+ *   only. Falls back to a plain openGzipStream() without pthreads, on a
+ *   single-CPU system, for mapped plain text files, or if the thread
+ *   cannot be started.
+ *
+ * PARAMETERS:
+ *   file_path - Path to .gz file
+ *
+ * RETURNS:
+ *   Pointer to GzipStream_t, or NULL on error
+ *
+ * MEMORY:
+ *   GZRING_SLOTS * GZRING_SLOT_SIZE bytes per open stream
+ *
+ ****/
+GzipStream_t *openGzipRingStream(const char *file_path)
+{
+#ifdef HAVE_PTHREAD_H
+    GzRing_t *ring;
+    GzipStream_t *stream;
+    int i;
+
+    if (!file_path) {
+        return NULL;
+    }
+
+    /* With one CPU the two threads would only take turns */
+    if (sysconf(_SC_NPROCESSORS_ONLN) < 2) {
+        return openGzipStream(file_path);
+    }
+
+    ring = (GzRing_t *)XMALLOC(sizeof(GzRing_t));
+    XMEMSET(ring, 0, sizeof(GzRing_t));
+
+    ring->input = openGzipStream(file_path);
+    if (!ring->input) {
+        XFREE(ring);
+        return NULL;
+    }
+
+    /* A mapped plain text file has nothing to inflate, parse it in place */
+    if (ring->input->mapped) {
+        stream = ring->input;
+        XFREE(ring);
+        return stream;
+    }
+
+    for (i = 0; i < GZRING_SLOTS; i++) {
+        ring->slots[i].data = (char *)XMALLOC(GZRING_SLOT_SIZE);
+    }
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->cond, NULL);
+
+    if (pthread_create(&ring->thread, NULL, gzRingInflater, ring) != 0) {
+        fprintf(stderr, "WARN - Unable to start inflater thread, decompressing inline\n");
+        pthread_cond_destroy(&ring->cond);
+        pthread_mutex_destroy(&ring->lock);
+        for (i = 0; i < GZRING_SLOTS; i++) {
+            XFREE(ring->slots[i].data);
+        }
+        stream = ring->input;
+        XFREE(ring);
+        return stream;
+    }
+
+    stream = openBlockStream(file_path, readGzRingBlock, closeGzRing, ring);
+
+#ifdef DEBUG
+    if (config->debug >= 1) {
+        fprintf(stderr, "DEBUG - Opened gzip stream with read-ahead: %s\n", file_path);
+    }
+#endif
+
+    return stream;
+#else
+    return openGzipStream(file_path);
+#endif
+}
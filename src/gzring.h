@@ -0,0 +1,63 @@
+/*****
+ *
+ * Description: Read-Ahead Gzip Ring Headers
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#ifndef GZRING_DOT_H
+#define GZRING_DOT_H
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "../include/sysdep.h"
+
+#ifndef __SYSDEP_H__
+#error something is messed up
+#endif
+
+#include "../include/common.h"
+#include "log_parser.h"
+
+/****
+ *
+ * defines
+ *
+ ****/
+
+#define GZRING_SLOTS 8                    // Inflated blocks in flight (power of 2)
+#define GZRING_SLOT_SIZE (256 * 1024)     // Bytes per inflated block
+#define GZRING_SPIN 64                    // Yields before sleeping on an empty/full ring
+
+/****
+ *
+ * function prototypes
+ *
+ ****/
+
+GzipStream_t *openGzipRingStream(const char *file_path);
+
+#endif /* GZRING_DOT_H */
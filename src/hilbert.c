@@ -31,9 +31,20 @@
  ****/
 
 #include "hilbert.h"
+#include "cidr_map.h"
 #include "mem.h"
 #include "util.h"
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/stat.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#if defined(__BMI2__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 /****
  *
@@ -152,6 +163,100 @@ uint64_t getTotalPoints(uint8_t order)
     return dim * dim;
 }
 
+/****
+ *
+ * Hilbert state machine tables
+ *
+ * Each curve level maps one (x,y) bit pair to one base-4 digit of the
+ * index and leaves the finer levels rotated/flipped. The four possible
+ * orientations are a 2-bit state (bit 0 = x/y swapped, bit 1 = both
+ * complemented), so a run of levels can be looked up in one step.
+ * Tables are indexed by [state][8-bit chunk] covering 4 levels; the
+ * chunk is Morton interleaved (x bit above y bit) for xy2d and base-4
+ * digits for d2xy. Each entry holds the converted chunk << 2 plus the
+ * state for the next chunk.
+ *
+ ****/
+
+PRIVATE uint16_t hilbert_xy2d_lut[4][256];
+PRIVATE uint16_t hilbert_d2xy_lut[4][256];
+PRIVATE int hilbert_lut_ready = FALSE;
+
+/****
+ *
+ * Build the Hilbert state machine tables
+ *
+ * DESCRIPTION:
+ *   Fills hilbert_xy2d_lut[] and hilbert_d2xy_lut[] by running the
+ *   classic one-level-at-a-time quadrant rotation over every state and
+ *   chunk value. Called from initHilbert() and lazily by the converters.
+ *
+ * PARAMETERS:
+ *   None
+ *
+ * RETURNS:
+ *   void
+ *
+ * SIDE EFFECTS:
+ *   Populates both tables and sets hilbert_lut_ready
+ *
+ * PERFORMANCE:
+ *   O(1) - 2 x 1024 entries of 4 levels each, 4KB of tables
+ *
+ ****/
+PRIVATE void buildHilbertTables(void)
+{
+    uint32_t state, chunk, level, s, tx, ty, bx, by, t, out;
+
+    for (state = 0; state < 4; state++) {
+        for (chunk = 0; chunk < 256; chunk++) {
+            /* (x,y) bit pairs to index digits */
+            s = state;
+            out = 0;
+            for (level = 4; level-- > 0;) {
+                tx = (chunk >> (level * 2 + 1)) & 1;
+                ty = (chunk >> (level * 2)) & 1;
+                if (s & 2) {
+                    tx ^= 1;
+                    ty ^= 1;
+                }
+                if (s & 1) {
+                    t = tx;
+                    tx = ty;
+                    ty = t;
+                }
+                out = (out << 2) | ((3 * tx) ^ ty);
+                if (ty == 0) {
+                    s ^= 1 | (tx << 1);
+                }
+            }
+            hilbert_xy2d_lut[state][chunk] = (uint16_t)((out << 2) | s);
+
+            /* Index digits back to (x,y) bit pairs */
+            s = state;
+            out = 0;
+            for (level = 4; level-- > 0;) {
+                t = (chunk >> (level * 2)) & 3;
+                tx = t >> 1;
+                ty = (t ^ tx) & 1;
+                bx = (s & 1) ? ty : tx;
+                by = (s & 1) ? tx : ty;
+                if (s & 2) {
+                    bx ^= 1;
+                    by ^= 1;
+                }
+                out = (out << 2) | (bx << 1) | by;
+                if (ty == 0) {
+                    s ^= 1 | (tx << 1);
+                }
+            }
+            hilbert_d2xy_lut[state][chunk] = (uint16_t)((out << 2) | s);
+        }
+    }
+
+    hilbert_lut_ready = TRUE;
+}
+
 /****
  *
  * Initialize Hilbert curve engine
@@ -170,6 +275,7 @@ uint64_t getTotalPoints(uint8_t order)
  * SIDE EFFECTS:
  *   Sets global hilbert_initialized flag to TRUE
  *   Populates global hilbert_config structure
+ *   Builds the Hilbert state machine tables on first call
  *   Prints debug message to stderr if debug level >= 1
  *
  * ALGORITHM:
@@ -191,6 +297,10 @@ int initHilbert(uint8_t order)
     hilbert_config.dimension = getDimension(order);
     hilbert_config.total_points = getTotalPoints(order);
 
+    if (!hilbert_lut_ready) {
+        buildHilbertTables();
+    }
+
     hilbert_initialized = TRUE;
 
 #ifdef DEBUG
@@ -209,8 +319,7 @@ int initHilbert(uint8_t order)
  * Deinitialize Hilbert curve engine
  *
  * DESCRIPTION:
- *   Shuts down Hilbert curve engine, freeing all CIDR mapping resources
- *   and optionally reporting cache statistics in debug mode.
+ *   Shuts down Hilbert curve engine, freeing all CIDR mapping resources.
  *
  * PARAMETERS:
  *   None
@@ -221,11 +330,10 @@ int initHilbert(uint8_t order)
  * SIDE EFFECTS:
  *   Calls freeCIDRMapping() to release allocated memory
  *   Sets hilbert_initialized flag to FALSE
- *   Prints CIDR cache statistics to stderr if debug >= 1 and cache was used
  *   Prints deinitialization message to stderr if debug >= 1
  *
  * ALGORITHM:
- *   Sequential cleanup: report stats, free CIDR map, clear flags
+ *   Sequential cleanup: free CIDR map and prefix table, clear flags
  *
  * PERFORMANCE:
  *   O(1) - Constant time cleanup
@@ -233,18 +341,9 @@ int initHilbert(uint8_t order)
  ****/
 void deInitHilbert(void)
 {
-    /* Report CIDR cache statistics before cleanup */
-#ifdef DEBUG
-    if (config->debug >= 1 && cidr_cache_initialized && (cidr_cache_hits + cidr_cache_misses) > 0) {
-        uint32_t total = cidr_cache_hits + cidr_cache_misses;
-        float hit_rate = (float)cidr_cache_hits / total * 100.0f;
-        fprintf(stderr, "DEBUG - CIDR cache stats: hits=%u, misses=%u, hit_rate=%.2f%%\n",
-                cidr_cache_hits, cidr_cache_misses, hit_rate);
-    }
-#endif
-
     /* Free CIDR mapping if allocated */
     freeCIDRMapping();
+    freePrefixTable();
 
     hilbert_initialized = FALSE;
 
@@ -370,47 +469,135 @@ uint32_t murmurhash3_32(const void *key, int len, uint32_t seed)
 
 /****
  *
- * Rotate/flip a quadrant for Hilbert curve transformation
+ * Interleave x and y into a Morton code
+ *
+ * DESCRIPTION:
+ *   Spreads the bits of x into the odd positions and y into the even
+ *   positions of a 64-bit word. Uses BMI2 pdep when the compiler targets
+ *   it (-mbmi2 or -march=native), magic-number bit spreading otherwise.
+ *
+ * PARAMETERS:
+ *   x - X coordinate
+ *   y - Y coordinate
+ *
+ * RETURNS:
+ *   Morton code with x bit n at position 2n+1 and y bit n at 2n
+ *
+ * PERFORMANCE:
+ *   O(1) - 2 instructions with BMI2, about 20 without
+ *
+ ****/
+static inline uint64_t mortonEncode(uint32_t x, uint32_t y)
+{
+#if defined(__BMI2__) && defined(__x86_64__)
+    return _pdep_u64(x, 0xAAAAAAAAAAAAAAAAULL) | _pdep_u64(y, 0x5555555555555555ULL);
+#else
+    uint64_t vx = x, vy = y;
+
+    vx = (vx | (vx << 16)) & 0x0000FFFF0000FFFFULL;
+    vx = (vx | (vx << 8)) & 0x00FF00FF00FF00FFULL;
+    vx = (vx | (vx << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    vx = (vx | (vx << 2)) & 0x3333333333333333ULL;
+    vx = (vx | (vx << 1)) & 0x5555555555555555ULL;
+
+    vy = (vy | (vy << 16)) & 0x0000FFFF0000FFFFULL;
+    vy = (vy | (vy << 8)) & 0x00FF00FF00FF00FFULL;
+    vy = (vy | (vy << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    vy = (vy | (vy << 2)) & 0x3333333333333333ULL;
+    vy = (vy | (vy << 1)) & 0x5555555555555555ULL;
+
+    return (vx << 1) | vy;
+#endif
+}
+
+/****
+ *
+ * Split a Morton code back into x and y
  *
  * DESCRIPTION:
- *   Applies rotation and/or flip transformations to coordinates within
- *   a quadrant according to Hilbert curve construction rules. Helper
- *   function for hilbertXYToIndex() and hilbertIndexToXY().
+ *   Inverse of mortonEncode(), gathering the odd bits into x and the
+ *   even bits into y. Uses BMI2 pext when available.
  *
  * PARAMETERS:
- *   n - Size of current quadrant
- *   x - Pointer to X coordinate (modified in place)
- *   y - Pointer to Y coordinate (modified in place)
- *   rx - Rotation flag for X axis (0 or 1)
- *   ry - Rotation flag for Y axis (0 or 1)
+ *   morton - Morton code
+ *   x - Output pointer for X coordinate
+ *   y - Output pointer for Y coordinate
  *
  * RETURNS:
  *   void
  *
- * SIDE EFFECTS:
- *   Modifies x and y coordinates passed by reference
+ * PERFORMANCE:
+ *   O(1) - 2 instructions with BMI2, about 20 without
+ *
+ ****/
+static inline void mortonDecode(uint64_t morton, uint32_t *x, uint32_t *y)
+{
+#if defined(__BMI2__) && defined(__x86_64__)
+    *x = (uint32_t)_pext_u64(morton, 0xAAAAAAAAAAAAAAAAULL);
+    *y = (uint32_t)_pext_u64(morton, 0x5555555555555555ULL);
+#else
+    uint64_t vx = (morton >> 1) & 0x5555555555555555ULL;
+    uint64_t vy = morton & 0x5555555555555555ULL;
+
+    vx = (vx | (vx >> 1)) & 0x3333333333333333ULL;
+    vx = (vx | (vx >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+    vx = (vx | (vx >> 4)) & 0x00FF00FF00FF00FFULL;
+    vx = (vx | (vx >> 8)) & 0x0000FFFF0000FFFFULL;
+    vx = (vx | (vx >> 16)) & 0x00000000FFFFFFFFULL;
+
+    vy = (vy | (vy >> 1)) & 0x3333333333333333ULL;
+    vy = (vy | (vy >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+    vy = (vy | (vy >> 4)) & 0x00FF00FF00FF00FFULL;
+    vy = (vy | (vy >> 8)) & 0x0000FFFF0000FFFFULL;
+    vy = (vy | (vy >> 16)) & 0x00000000FFFFFFFFULL;
+
+    *x = (uint32_t)vx;
+    *y = (uint32_t)vy;
+#endif
+}
+
+/****
+ *
+ * Convert a Hilbert index to a Morton code
+ *
+ * DESCRIPTION:
+ *   Walks the index 4 levels (8 bits) at a time through the d2xy state
+ *   machine, coarsest level first. Shared by hilbertIndexToXY() and
+ *   hilbertIndexToXYBatch().
+ *
+ * PARAMETERS:
+ *   index - Hilbert curve index, bits above 2*order are ignored
+ *   order - Hilbert curve order
+ *
+ * RETURNS:
+ *   Morton code of the (x,y) coordinates
  *
  * ALGORITHM:
- *   Hilbert curve quadrant rotation - conditionally swaps and/or
- *   inverts coordinates based on rx/ry flags
+ *   The index is treated as if zero-padded up to a multiple of 4 levels.
+ *   Each padded zero level swaps x and y, so starting in the swapped
+ *   state when the pad is odd cancels them out.
  *
  * PERFORMANCE:
- *   O(1) - Maximum 5 arithmetic operations
+ *   O(order / 4) - 3 table lookups at order 12, 4 at order 16
  *
  ****/
-PRIVATE void rot(uint32_t n, uint32_t *x, uint32_t *y, uint32_t rx, uint32_t ry)
+static inline uint64_t hilbertIndexToMorton(uint64_t index, uint8_t order)
 {
-    if (ry == 0) {
-        if (rx == 1) {
-            *x = n - 1 - *x;
-            *y = n - 1 - *y;
-        }
-
-        /* Swap x and y */
-        uint32_t t = *x;
-        *x = *y;
-        *y = t;
+    uint32_t steps = ((uint32_t)order + 3) / 4;
+    uint32_t state = (steps * 4 - order) & 1;
+    uint32_t entry;
+    uint64_t morton = 0;
+    uint32_t step;
+
+    index &= ((uint64_t)1 << (order * 2)) - 1;
+
+    for (step = steps; step-- > 0;) {
+        entry = hilbert_d2xy_lut[state][(index >> (step * 8)) & 0xFF];
+        morton = (morton << 8) | (entry >> 2);
+        state = entry & 3;
     }
+
+    return morton;
 }
 
 /****
@@ -431,27 +618,37 @@ PRIVATE void rot(uint32_t n, uint32_t *x, uint32_t *y, uint32_t rx, uint32_t ry)
  *   Hilbert curve index (0 to dimension²-1)
  *
  * SIDE EFFECTS:
- *   None (pure function with local coordinate copies)
+ *   Builds the state machine tables on first use if initHilbert()
+ *   has not been called
  *
  * ALGORITHM:
- *   Iterative Hilbert curve transformation, processes quadrants
- *   from coarse to fine resolution using rot() helper
+ *   Interleaves x and y into a Morton code, then walks it 4 levels
+ *   at a time through the xy2d state machine, coarsest level first
+ *   (see hilbertIndexToMorton() for the padding rule)
  *
  * PERFORMANCE:
- *   O(order) = O(log dimension)
- *   Typically 12 iterations for order 12 (4096x4096)
+ *   O(order / 4) - 3 table lookups at order 12, 4 at order 16
  *
  ****/
 uint64_t hilbertXYToIndex(uint32_t x, uint32_t y, uint8_t order)
 {
-    uint64_t d = 0;
-    uint32_t n = getDimension(order);
+    uint32_t steps = ((uint32_t)order + 3) / 4;
+    uint32_t state = (steps * 4 - order) & 1;
+    uint32_t mask = (uint32_t)(((uint64_t)1 << order) - 1);
+    uint32_t entry;
+    uint64_t morton, d = 0;
+    uint32_t step;
+
+    if (!hilbert_lut_ready) {
+        buildHilbertTables();
+    }
 
-    for (uint32_t s = n / 2; s > 0; s /= 2) {
-        uint32_t rx = (x & s) > 0;
-        uint32_t ry = (y & s) > 0;
-        d += s * s * ((3 * rx) ^ ry);
-        rot(s, &x, &y, rx, ry);
+    morton = mortonEncode(x & mask, y & mask);
+
+    for (step = steps; step-- > 0;) {
+        entry = hilbert_xy2d_lut[state][(morton >> (step * 8)) & 0xFF];
+        d = (d << 8) | (entry >> 2);
+        state = entry & 3;
     }
 
     return d;
@@ -476,32 +673,100 @@ uint64_t hilbertXYToIndex(uint32_t x, uint32_t y, uint8_t order)
  *
  * SIDE EFFECTS:
  *   Sets x and y to calculated coordinates
+ *   Builds the state machine tables on first use if initHilbert()
+ *   has not been called
  *
  * ALGORITHM:
- *   Inverse Hilbert curve transformation, builds coordinates from
- *   index using quadrant decomposition and rot() helper
+ *   hilbertIndexToMorton() then mortonDecode()
  *
  * PERFORMANCE:
- *   O(order) = O(log dimension)
- *   Typically 12 iterations for order 12 (4096x4096)
+ *   O(order / 4) - 3 table lookups at order 12, 4 at order 16
  *
  ****/
 void hilbertIndexToXY(uint64_t index, uint8_t order, uint32_t *x, uint32_t *y)
 {
-    uint32_t n = getDimension(order);
-    uint64_t d = index;
-    *x = *y = 0;
-
-    for (uint32_t s = 1; s < n; s *= 2) {
-        uint32_t rx = 1 & (d / 2);
-        uint32_t ry = 1 & (d ^ rx);
-        rot(s, x, y, rx, ry);
-        *x += s * rx;
-        *y += s * ry;
-        d /= 4;
+    if (!hilbert_lut_ready) {
+        buildHilbertTables();
+    }
+
+    mortonDecode(hilbertIndexToMorton(index, order), x, y);
+}
+
+/****
+ *
+ * Convert an array of Hilbert curve indices to (x,y) coordinates
+ *
+ * DESCRIPTION:
+ *   Batch form of hilbertIndexToXY() for callers converting many
+ *   indices at once (event batches, mask sampling). Table state and
+ *   order are hoisted out of the loop and independent conversions
+ *   can overlap in the pipeline.
+ *
+ * PARAMETERS:
+ *   index - Array of count Hilbert curve indices
+ *   count - Number of indices to convert
+ *   order - Hilbert curve order
+ *   x - Output array of count X coordinates
+ *   y - Output array of count Y coordinates
+ *
+ * RETURNS:
+ *   void
+ *
+ * SIDE EFFECTS:
+ *   Fills x[0..count-1] and y[0..count-1]
+ *
+ * PERFORMANCE:
+ *   O(count * order / 4)
+ *
+ ****/
+void hilbertIndexToXYBatch(const uint64_t *index, size_t count, uint8_t order, uint32_t *x, uint32_t *y)
+{
+    size_t i;
+
+    if (!hilbert_lut_ready) {
+        buildHilbertTables();
+    }
+
+    for (i = 0; i < count; i++) {
+        mortonDecode(hilbertIndexToMorton(index[i], order), &x[i], &y[i]);
     }
 }
 
+/****
+ *
+ * Non-routable IPv4 space
+ *
+ * Reserved and special-use prefixes shown by the visualization overlay.
+ * Each is aligned, so on the direct mapping it covers whole Hilbert
+ * sub-squares (rasterizeNonRoutable()).
+ *
+ ****/
+
+typedef struct {
+    uint32_t network;        /* Network address, host byte order */
+    uint8_t prefix_len;      /* CIDR prefix length */
+} ReservedPrefix_t;
+
+PRIVATE const ReservedPrefix_t nonroutable_prefixes[] = {
+    { 0x00000000U, 8 },      /* 0.0.0.0/8 - Current network (RFC 1122) */
+    { 0x0A000000U, 8 },      /* 10.0.0.0/8 - RFC1918 Private */
+    { 0x64400000U, 10 },     /* 100.64.0.0/10 - Carrier-grade NAT (RFC 6598) */
+    { 0x7F000000U, 8 },      /* 127.0.0.0/8 - Loopback (RFC 1122) */
+    { 0xA9FE0000U, 16 },     /* 169.254.0.0/16 - Link-local (RFC 3927) */
+    { 0xAC100000U, 12 },     /* 172.16.0.0/12 - RFC1918 Private */
+    { 0xC0000000U, 24 },     /* 192.0.0.0/24 - IETF Protocol Assignments (RFC 6890) */
+    { 0xC0000200U, 24 },     /* 192.0.2.0/24 - TEST-NET-1 Documentation (RFC 5737) */
+    { 0xC0586300U, 24 },     /* 192.88.99.0/24 - IPv6 to IPv4 relay (RFC 7526) */
+    { 0xC0A80000U, 16 },     /* 192.168.0.0/16 - RFC1918 Private */
+    { 0xC6120000U, 15 },     /* 198.18.0.0/15 - Benchmarking (RFC 2544) */
+    { 0xC6336400U, 24 },     /* 198.51.100.0/24 - TEST-NET-2 Documentation (RFC 5737) */
+    { 0xCB007100U, 24 },     /* 203.0.113.0/24 - TEST-NET-3 Documentation (RFC 5737) */
+    { 0xE0000000U, 4 },      /* 224.0.0.0/4 - Multicast (RFC 5771) */
+    { 0xF0000000U, 4 }       /* 240.0.0.0/4 - Reserved (RFC 1112) */
+};
+
+#define NONROUTABLE_PREFIX_COUNT (sizeof(nonroutable_prefixes) / sizeof(nonroutable_prefixes[0]))
+
 /****
  *
  * Check if IPv4 address is non-routable
@@ -521,99 +786,20 @@ void hilbertIndexToXY(uint64_t index, uint8_t order, uint32_t *x, uint32_t *y)
  * SIDE EFFECTS:
  *   None (pure function)
  *
- * ALGORITHM:
- *   Sequential octet extraction and comparison against 13 RFC-defined ranges:
- *   - 0.0.0.0/8 (RFC 1122), 10.0.0.0/8 (RFC1918), 100.64.0.0/10 (RFC 6598)
- *   - 127.0.0.0/8 (RFC 1122), 169.254.0.0/16 (RFC 3927), 172.16.0.0/12 (RFC1918)
- *   - 192.0.0.0/24 (RFC 6890), 192.0.2.0/24 (RFC 5737), 192.88.99.0/24 (RFC 7526)
- *   - 192.168.0.0/16 (RFC1918), 198.18.0.0/15 (RFC 2544)
- *   - 198.51.100.0/24 (RFC 5737), 203.0.113.0/24 (RFC 5737)
- *   - 224.0.0.0/4 (RFC 5771), 240.0.0.0/4 (RFC 1112)
- *
  * PERFORMANCE:
- *   O(1) - Maximum 13 comparisons, average ~6 due to early returns
+ *   O(1) - One masked compare per entry of nonroutable_prefixes[]
  *
  ****/
 int isNonRoutableIP(uint32_t ipv4)
 {
-    /* Extract octets (network byte order: big-endian) */
-    uint8_t octet1 = (uint8_t)((ipv4 >> 24) & 0xFF);
-    uint8_t octet2 = (uint8_t)((ipv4 >> 16) & 0xFF);
-    uint8_t octet3 = (uint8_t)((ipv4 >> 8) & 0xFF);
-
-    /* 0.0.0.0/8 - Current network (RFC 1122) */
-    if (octet1 == 0) {
-        return TRUE;
-    }
-
-    /* 10.0.0.0/8 - RFC1918 Private */
-    if (octet1 == 10) {
-        return TRUE;
-    }
-
-    /* 100.64.0.0/10 - Carrier-grade NAT (RFC 6598) */
-    if (octet1 == 100 && (octet2 >= 64 && octet2 <= 127)) {
-        return TRUE;
-    }
-
-    /* 127.0.0.0/8 - Loopback (RFC 1122) */
-    if (octet1 == 127) {
-        return TRUE;
-    }
-
-    /* 169.254.0.0/16 - Link-local (RFC 3927) */
-    if (octet1 == 169 && octet2 == 254) {
-        return TRUE;
-    }
-
-    /* 172.16.0.0/12 - RFC1918 Private */
-    if (octet1 == 172 && (octet2 >= 16 && octet2 <= 31)) {
-        return TRUE;
-    }
-
-    /* 192.0.0.0/24 - IETF Protocol Assignments (RFC 6890) */
-    if (octet1 == 192 && octet2 == 0 && octet3 == 0) {
-        return TRUE;
-    }
-
-    /* 192.0.2.0/24 - TEST-NET-1 Documentation (RFC 5737) */
-    if (octet1 == 192 && octet2 == 0 && octet3 == 2) {
-        return TRUE;
-    }
-
-    /* 192.88.99.0/24 - IPv6 to IPv4 relay (RFC 7526) */
-    if (octet1 == 192 && octet2 == 88 && octet3 == 99) {
-        return TRUE;
-    }
-
-    /* 192.168.0.0/16 - RFC1918 Private */
-    if (octet1 == 192 && octet2 == 168) {
-        return TRUE;
-    }
-
-    /* 198.18.0.0/15 - Benchmarking (RFC 2544) */
-    if (octet1 == 198 && (octet2 == 18 || octet2 == 19)) {
-        return TRUE;
-    }
+    uint32_t i;
 
-    /* 198.51.100.0/24 - TEST-NET-2 Documentation (RFC 5737) */
-    if (octet1 == 198 && octet2 == 51 && octet3 == 100) {
-        return TRUE;
-    }
-
-    /* 203.0.113.0/24 - TEST-NET-3 Documentation (RFC 5737) */
-    if (octet1 == 203 && octet2 == 0 && octet3 == 113) {
-        return TRUE;
-    }
-
-    /* 224.0.0.0/4 - Multicast (RFC 5771) */
-    if (octet1 >= 224 && octet1 <= 239) {
-        return TRUE;
-    }
+    for (i = 0; i < NONROUTABLE_PREFIX_COUNT; i++) {
+        uint32_t mask = 0xFFFFFFFFU << (32 - nonroutable_prefixes[i].prefix_len);
 
-    /* 240.0.0.0/4 - Reserved (RFC 1112) */
-    if (octet1 >= 240) {
-        return TRUE;
+        if ((ipv4 & mask) == nonroutable_prefixes[i].network) {
+            return TRUE;
+        }
     }
 
     return FALSE;
@@ -637,6 +823,17 @@ typedef struct {
 PRIVATE CIDRMapEntry_t *cidr_map = NULL;
 PRIVATE uint32_t cidr_map_count = 0;
 PRIVATE uint32_t cidr_map_capacity = 0;
+PRIVATE uint32_t cidr_map_generation = 0;  /* Bumped whenever the map changes */
+
+/* Longest prefix match trie over cidr_map (buildCIDRLookup()) */
+#define CIDR_LPM_ROOT_SLOTS 65536        /* Top 16 bits */
+#define CIDR_LPM_CHUNK_SLOTS 256         /* Next 8 bits per chunk */
+#define CIDR_LPM_CHUNK 0x80000000U       /* Slot points at a chunk */
+
+PRIVATE uint32_t *cidr_lpm_root = NULL;
+PRIVATE uint32_t *cidr_lpm_chunks = NULL;
+PRIVATE uint32_t cidr_lpm_chunk_count = 0;
+PRIVATE uint32_t cidr_lpm_chunk_capacity = 0;
 
 /****
  *
@@ -658,7 +855,8 @@ PRIVATE uint32_t cidr_map_capacity = 0;
  *   None (pure comparator)
  *
  * ALGORITHM:
- *   Two-level comparison: primary by prefix_len DESC, secondary by network ASC
+ *   Primary by prefix_len DESC, secondary by network ASC, then timezone,
+ *   x_start and x_end ASC for duplicate prefixes
  *
  * PERFORMANCE:
  *   O(1) - Maximum two integer comparisons
@@ -675,97 +873,564 @@ PRIVATE int compareCIDREntries(const void *a, const void *b)
     }
 
     /* Within same prefix length, sort by network address */
-    if (entry_a->network < entry_b->network) {
-        return -1;
-    } else if (entry_a->network > entry_b->network) {
-        return 1;
+    if (entry_a->network != entry_b->network) {
+        return (entry_a->network < entry_b->network) ? -1 : 1;
+    }
+
+    /* Duplicate prefixes in a fixed order, so text and binary maps agree on the winner */
+    if (entry_a->timezone_offset != entry_b->timezone_offset) {
+        return (entry_a->timezone_offset < entry_b->timezone_offset) ? -1 : 1;
+    }
+    if (entry_a->x_start != entry_b->x_start) {
+        return (entry_a->x_start < entry_b->x_start) ? -1 : 1;
+    }
+    if (entry_a->x_end != entry_b->x_end) {
+        return (entry_a->x_end < entry_b->x_end) ? -1 : 1;
     }
     return 0;
 }
 
 /****
  *
- * Load CIDR mapping file
+ * Longest prefix match trie over cidr_map
  *
- * DESCRIPTION:
- *   Loads CIDR-to-coordinate mapping file for timezone-aware geographic
- *   visualization. Parses file containing CIDR blocks mapped to timezone
- *   and X-axis coordinate ranges. Allocates dynamic array with overflow
- *   protection, pre-calculates masks, and sorts entries for optimal lookup.
+ * Multibit trie with strides of 16, 8 and 8 bits: a 64K-slot root for
+ * the top 16 bits, then 256-slot chunks for /17-/24 and /25-/32 where
+ * the map has prefixes that long. Shorter prefixes are expanded into
+ * every slot they cover, so a lookup is at most three loads. A slot
+ * holds 0 (no match), cidr_map index + 1, or CIDR_LPM_CHUNK plus the
+ * number of the chunk below it.
  *
- * PARAMETERS:
- *   filename - Path to CIDR mapping file (format: "IP/PREFIX TZ X_START X_END")
+ ****/
+
+/****
+ *
+ * Decide which of two entries owns a trie slot
  *
  * RETURNS:
- *   TRUE on successful load, FALSE on file/parse/allocation error
+ *   TRUE if candidate (index + 1) beats current: the longer prefix,
+ *   or the earlier entry for duplicate prefixes, as the sorted linear
+ *   scan did
  *
- * SIDE EFFECTS:
- *   Allocates global cidr_map array (initial 4096 entries, grows 2x as needed)
- *   Sets cidr_map_count and cidr_map_capacity globals
- *   Sorts CIDR entries by prefix length descending for optimal lookup
- *   Prints warnings to stderr for invalid lines
- *   Prints debug message with entry count if debug >= 1
+ ****/
+PRIVATE int betterCIDRSlot(uint32_t candidate, uint32_t current)
+{
+    const CIDRMapEntry_t *a, *b;
+
+    if (current == 0) {
+        return TRUE;
+    }
+    a = &cidr_map[candidate - 1];
+    b = &cidr_map[current - 1];
+
+    return (a->prefix_len > b->prefix_len ||
+            (a->prefix_len == b->prefix_len && candidate < current));
+}
+
+/****
  *
- * ALGORITHM:
- *   1. Open file, allocate initial 4096-entry array
- *   2. Parse each line: NETWORK/PREFIX TIMEZONE X_START X_END
- *   3. Skip comment (#) and empty lines
- *   4. Grow array 2x when capacity reached (with overflow checks)
- *   5. Pre-calculate network masks: (prefix==0) ? 0 : ~((1U << (32-prefix)) - 1)
- *   6. Sort array by prefix_len DESC using qsort() for most-specific-first lookup
+ * Add a trie chunk
  *
- * PERFORMANCE:
- *   O(m log m) where m = number of entries
- *   File I/O: O(n) where n = file size
- *   Parsing: O(m), Sorting: O(m log m) - dominates
- *   Typical: ~3500 entries, ~11K comparisons
+ * PARAMETERS:
+ *   fill - Slot value the chunk inherits from the slot it replaces
+ *
+ * RETURNS:
+ *   Slot value pointing at the new chunk, 0 if out of memory
  *
  ****/
-int loadCIDRMapping(const char *filename)
+PRIVATE uint32_t newCIDRChunk(uint32_t fill)
 {
-    FILE *fp;
-    char line[256];
-    uint32_t line_num = 0;
-    uint32_t entries_loaded = 0;
+    uint32_t *chunk;
+    uint32_t i, new_capacity;
 
-    fp = fopen(filename, "r");
-    if (fp == NULL) {
-        fprintf(stderr, "ERR - Cannot open CIDR mapping file: %s\n", filename);
-        return FALSE;
+    if (cidr_lpm_chunk_count == cidr_lpm_chunk_capacity) {
+        new_capacity = cidr_lpm_chunk_capacity ? cidr_lpm_chunk_capacity * 2 : 64;
+        if ((uint64_t)new_capacity * CIDR_LPM_CHUNK_SLOTS * sizeof(uint32_t) > INT_MAX) {
+            return 0;
+        }
+        cidr_lpm_chunks = (uint32_t *)XREALLOC(cidr_lpm_chunks,
+                                               (int)(new_capacity * CIDR_LPM_CHUNK_SLOTS * sizeof(uint32_t)));
+        if (cidr_lpm_chunks == NULL) {
+            cidr_lpm_chunk_count = cidr_lpm_chunk_capacity = 0;
+            return 0;
+        }
+        cidr_lpm_chunk_capacity = new_capacity;
     }
 
-    /* Allocate initial capacity */
-    cidr_map_capacity = 4096;
-    cidr_map = (CIDRMapEntry_t *)XMALLOC((int)(sizeof(CIDRMapEntry_t) * cidr_map_capacity));
-    if (cidr_map == NULL) {
-        fprintf(stderr, "ERR - Cannot allocate CIDR mapping array\n");
-        fclose(fp);
-        return FALSE;
+    chunk = &cidr_lpm_chunks[cidr_lpm_chunk_count * CIDR_LPM_CHUNK_SLOTS];
+    for (i = 0; i < CIDR_LPM_CHUNK_SLOTS; i++) {
+        chunk[i] = fill;
     }
 
-    while (fgets(line, sizeof(line), fp) != NULL) {
-        line_num++;
+    return CIDR_LPM_CHUNK | cidr_lpm_chunk_count++;
+}
 
-        /* Skip comments and empty lines */
-        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
-            continue;
+/****
+ *
+ * Give a run of trie slots to an entry where it is the better match
+ *
+ * PARAMETERS:
+ *   slot - First slot
+ *   count - Number of slots
+ *   value - cidr_map index + 1
+ *
+ ****/
+PRIVATE void paintCIDRSlots(uint32_t *slot, uint32_t count, uint32_t value)
+{
+    uint32_t i;
+
+    for (i = 0; i < count; i++) {
+        if (slot[i] & CIDR_LPM_CHUNK) {
+            paintCIDRSlots(&cidr_lpm_chunks[(slot[i] & ~CIDR_LPM_CHUNK) * CIDR_LPM_CHUNK_SLOTS],
+                           CIDR_LPM_CHUNK_SLOTS, value);
+        } else if (betterCIDRSlot(value, slot[i])) {
+            slot[i] = value;
         }
+    }
+}
 
-        /* Parse: NETWORK/PREFIX TIMEZONE X_START X_END */
-        uint32_t oct1, oct2, oct3, oct4, prefix;
-        int tz;
-        uint32_t x_start, x_end;
+/****
+ *
+ * Add one cidr_map entry to the trie
+ *
+ * PARAMETERS:
+ *   idx - cidr_map index
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if out of memory
+ *
+ ****/
+PRIVATE int insertCIDRLookup(uint32_t idx)
+{
+    const CIDRMapEntry_t *entry = &cidr_map[idx];
+    uint32_t network = entry->network;
+    uint32_t len = entry->prefix_len;
+    uint32_t base, slot, chunk;
 
-        int parsed = sscanf(line, "%u.%u.%u.%u/%u %d %u %u",
-                           &oct1, &oct2, &oct3, &oct4, &prefix,
-                           &tz, &x_start, &x_end);
+    /* Host bits set never matched the linear scan either */
+    if (len > 32 || (network & entry->mask) != network) {
+        return TRUE;
+    }
 
-        if (parsed != 8) {
-            fprintf(stderr, "WARN - Invalid CIDR mapping line %u: %s", line_num, line);
-            continue;
+    if (len <= 16) {
+        paintCIDRSlots(&cidr_lpm_root[network >> 16], 1U << (16 - len), idx + 1);
+        return TRUE;
+    }
+
+    slot = network >> 16;
+    if (!(cidr_lpm_root[slot] & CIDR_LPM_CHUNK)) {
+        if ((chunk = newCIDRChunk(cidr_lpm_root[slot])) == 0) {
+            return FALSE;
         }
+        cidr_lpm_root[slot] = chunk;
+    }
+    base = (cidr_lpm_root[slot] & ~CIDR_LPM_CHUNK) * CIDR_LPM_CHUNK_SLOTS;
 
-        /* Grow array if needed */
+    slot = base + ((network >> 8) & 0xFF);
+    if (len <= 24) {
+        paintCIDRSlots(&cidr_lpm_chunks[slot], 1U << (24 - len), idx + 1);
+        return TRUE;
+    }
+
+    if (!(cidr_lpm_chunks[slot] & CIDR_LPM_CHUNK)) {
+        if ((chunk = newCIDRChunk(cidr_lpm_chunks[slot])) == 0) {
+            return FALSE;
+        }
+        cidr_lpm_chunks[slot] = chunk;
+    }
+    base = (cidr_lpm_chunks[slot] & ~CIDR_LPM_CHUNK) * CIDR_LPM_CHUNK_SLOTS;
+
+    paintCIDRSlots(&cidr_lpm_chunks[base + (network & 0xFF)], 1U << (32 - len), idx + 1);
+    return TRUE;
+}
+
+/****
+ *
+ * Free the CIDR lookup trie
+ *
+ ****/
+PRIVATE void freeCIDRLookup(void)
+{
+    if (cidr_lpm_root != NULL) {
+        XFREE(cidr_lpm_root);
+    }
+    if (cidr_lpm_chunks != NULL) {
+        XFREE(cidr_lpm_chunks);
+    }
+    cidr_lpm_chunk_count = 0;
+    cidr_lpm_chunk_capacity = 0;
+}
+
+/****
+ *
+ * Build the CIDR lookup trie
+ *
+ * DESCRIPTION:
+ *   Indexes every cidr_map entry for findCIDRMapping(). Entries may be
+ *   inserted in any order; the longest prefix (then the earliest entry)
+ *   owns each slot.
+ *
+ * PARAMETERS:
+ *   None
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if out of memory
+ *
+ * MEMORY:
+ *   256KB root plus 1KB per /16 and per /24 holding longer prefixes
+ *
+ * PERFORMANCE:
+ *   O(m + slots painted), a few milliseconds for typical maps
+ *
+ ****/
+PRIVATE int buildCIDRLookup(void)
+{
+    uint32_t i;
+
+    freeCIDRLookup();
+
+    if (cidr_map_count >= CIDR_LPM_CHUNK) {
+        return FALSE;
+    }
+
+    cidr_lpm_root = (uint32_t *)XMALLOC((int)(sizeof(uint32_t) * CIDR_LPM_ROOT_SLOTS));
+    if (cidr_lpm_root == NULL) {
+        return FALSE;
+    }
+    XMEMSET(cidr_lpm_root, 0, (int)(sizeof(uint32_t) * CIDR_LPM_ROOT_SLOTS));
+
+    for (i = 0; i < cidr_map_count; i++) {
+        if (!insertCIDRLookup(i)) {
+            freeCIDRLookup();
+            return FALSE;
+        }
+    }
+
+#ifdef DEBUG
+    if (config->debug >= 1) {
+        fprintf(stderr, "DEBUG - CIDR lookup trie: %u entries, %u chunks, %lu bytes\n",
+                cidr_map_count, cidr_lpm_chunk_count,
+                (unsigned long)(sizeof(uint32_t) * (CIDR_LPM_ROOT_SLOTS +
+                                                    (uint64_t)cidr_lpm_chunk_capacity * CIDR_LPM_CHUNK_SLOTS)));
+    }
+#endif
+
+    return TRUE;
+}
+
+/****
+ *
+ * Finish loading a CIDR map
+ *
+ * DESCRIPTION:
+ *   Stretches X ranges laid out for another curve order onto this one
+ *   and builds the lookup trie. Shared by the text and binary loaders,
+ *   which leave cidr_map sorted.
+ *
+ * PARAMETERS:
+ *   map_dimension - Hilbert dimension the map's X ranges are for
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE (with the map freed) if the trie cannot be built
+ *
+ ****/
+PRIVATE int finishCIDRMapping(uint32_t map_dimension)
+{
+    uint32_t i;
+
+    if (hilbert_initialized && map_dimension > 0 && map_dimension != hilbert_config.dimension) {
+        for (i = 0; i < cidr_map_count; i++) {
+            cidr_map[i].x_start = (uint32_t)((uint64_t)cidr_map[i].x_start * hilbert_config.dimension / map_dimension);
+            cidr_map[i].x_end = (uint32_t)((uint64_t)cidr_map[i].x_end * hilbert_config.dimension / map_dimension);
+        }
+#ifdef DEBUG
+        if (config->debug >= 1) {
+            fprintf(stderr, "DEBUG - CIDR mapping X ranges scaled from %u to %u\n",
+                    map_dimension, hilbert_config.dimension);
+        }
+#endif
+    }
+
+    if (!buildCIDRLookup()) {
+        fprintf(stderr, "ERR - Cannot build CIDR lookup table (%u entries)\n", cidr_map_count);
+        freeCIDRMapping();
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/****
+ *
+ * Map a binary CIDR map file read-only
+ *
+ * RETURNS:
+ *   File contents (mmap()ed, or read into memory where mmap is not
+ *   available), NULL if the file cannot be read
+ *
+ ****/
+PRIVATE const uint8_t *mapCIDRMapFile(const char *filename, size_t *size, int *mapped)
+{
+    struct stat st;
+    uint8_t *data = NULL;
+    size_t done;
+    ssize_t got;
+    int fd;
+
+    *mapped = FALSE;
+
+    fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0 || (uint64_t)st.st_size > (uint64_t)INT_MAX) {
+        close(fd);
+        return NULL;
+    }
+    *size = (size_t)st.st_size;
+
+#ifdef HAVE_SYS_MMAN_H
+    data = (uint8_t *)mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != (uint8_t *)MAP_FAILED) {
+        close(fd);
+        *mapped = TRUE;
+        return data;
+    }
+    data = NULL;
+#endif
+
+    data = (uint8_t *)XMALLOC((int)*size);
+    for (done = 0; done < *size; done += (size_t)got) {
+        got = read(fd, data + done, *size - done);
+        if (got <= 0) {
+            XFREE(data);
+            close(fd);
+            return NULL;
+        }
+    }
+    close(fd);
+
+    return data;
+}
+
+PRIVATE void unmapCIDRMapFile(const uint8_t *data, size_t size, int mapped)
+{
+    void *buf = (void *)(uintptr_t)data;
+
+#ifdef HAVE_SYS_MMAN_H
+    if (mapped) {
+        munmap(buf, size);
+        return;
+    }
+#else
+    (void)size;
+    (void)mapped;
+#endif
+    XFREE(buf);
+}
+
+/****
+ *
+ * Load a binary CIDR map
+ *
+ * DESCRIPTION:
+ *   Loads a map written by cidr_mapper (cidr_map.h). The records are
+ *   already sorted, so they are copied straight into cidr_map with no
+ *   parsing or qsort(); a file that is somehow out of order is sorted.
+ *
+ * PARAMETERS:
+ *   filename - Binary CIDR map
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if the file is invalid or memory runs out
+ *
+ * SIDE EFFECTS:
+ *   Allocates global cidr_map and builds the lookup trie
+ *   Prints a warning for each record with an invalid prefix length
+ *
+ * PERFORMANCE:
+ *   O(m) - One pass over the mapped records
+ *
+ ****/
+PRIVATE int loadCIDRMappingBinary(const char *filename)
+{
+    const CIDRMapFileHeader_t *header;
+    const CIDRMapRecord_t *record;
+    const uint8_t *data;
+    CIDRMapEntry_t *entry;
+    size_t size = 0;
+    uint32_t i, dimension;
+    int mapped, sorted = TRUE;
+
+    data = mapCIDRMapFile(filename, &size, &mapped);
+    if (data == NULL) {
+        fprintf(stderr, "ERR - Cannot read CIDR mapping file: %s\n", filename);
+        return FALSE;
+    }
+
+    header = (const CIDRMapFileHeader_t *)data;
+    if (size < sizeof(CIDRMapFileHeader_t) ||
+        memcmp(header->magic, CIDR_MAP_MAGIC, sizeof(header->magic)) != 0 ||
+        header->header_bytes != sizeof(CIDRMapFileHeader_t) ||
+        header->record_bytes != sizeof(CIDRMapRecord_t) ||
+        header->file_bytes != (uint64_t)size ||
+        header->file_bytes != sizeof(CIDRMapFileHeader_t) + (uint64_t)header->record_count * sizeof(CIDRMapRecord_t) ||
+        (uint64_t)header->record_count * sizeof(CIDRMapEntry_t) > INT_MAX) {
+        fprintf(stderr, "ERR - Invalid binary CIDR mapping file: %s\n", filename);
+        unmapCIDRMapFile(data, size, mapped);
+        return FALSE;
+    }
+    dimension = header->dimension;
+
+    cidr_map_capacity = (header->record_count > 0) ? header->record_count : 1;
+    cidr_map = (CIDRMapEntry_t *)XMALLOC((int)(sizeof(CIDRMapEntry_t) * cidr_map_capacity));
+    if (cidr_map == NULL) {
+        fprintf(stderr, "ERR - Cannot allocate CIDR mapping array\n");
+        unmapCIDRMapFile(data, size, mapped);
+        cidr_map_capacity = 0;
+        return FALSE;
+    }
+
+    record = (const CIDRMapRecord_t *)(data + sizeof(CIDRMapFileHeader_t));
+    for (i = 0; i < header->record_count; i++, record++) {
+        if (record->prefix_len > 32) {
+            fprintf(stderr, "WARN - Invalid prefix length in CIDR mapping record %u: /%u\n", i, record->prefix_len);
+            continue;
+        }
+        entry = &cidr_map[cidr_map_count];
+        entry->network = record->network;
+        entry->prefix_len = record->prefix_len;
+        entry->mask = (record->prefix_len == 0) ? 0 : ~((1U << (32 - record->prefix_len)) - 1);
+        entry->timezone_offset = record->timezone_offset;
+        entry->x_start = record->x_start;
+        entry->x_end = record->x_end;
+        if (cidr_map_count > 0 && compareCIDREntries(entry - 1, entry) > 0) {
+            sorted = FALSE;
+        }
+        cidr_map_count++;
+    }
+    unmapCIDRMapFile(data, size, mapped);
+
+    if (!sorted) {
+        qsort(cidr_map, cidr_map_count, sizeof(CIDRMapEntry_t), compareCIDREntries);
+    }
+
+#ifdef DEBUG
+    if (config->debug >= 1) {
+        fprintf(stderr, "DEBUG - Binary CIDR mapping loaded: %u entries from %s%s\n",
+                cidr_map_count, filename, sorted ? "" : " (re-sorted)");
+    }
+#endif
+
+    return finishCIDRMapping(dimension);
+}
+
+/****
+ *
+ * Load CIDR mapping file
+ *
+ * DESCRIPTION:
+ *   Loads CIDR-to-coordinate mapping file for timezone-aware geographic
+ *   visualization. Parses file containing CIDR blocks mapped to timezone
+ *   and X-axis coordinate ranges. Allocates dynamic array with overflow
+ *   protection, pre-calculates masks, sorts entries and builds the
+ *   longest prefix match trie findCIDRMapping() searches. Binary maps
+ *   written by cidr_mapper (recognised by their magic bytes, whatever the
+ *   file is named) skip the parsing and sorting.
+ *
+ * PARAMETERS:
+ *   filename - Path to CIDR mapping file (format: "IP/PREFIX TZ X_START X_END"),
+ *              or a binary map (cidr_map.h)
+ *
+ * RETURNS:
+ *   TRUE on successful load, FALSE on file/parse/allocation error
+ *
+ * SIDE EFFECTS:
+ *   Allocates global cidr_map array (initial 4096 entries, grows 2x as needed)
+ *   Sets cidr_map_count and cidr_map_capacity globals
+ *   Sorts CIDR entries by prefix length descending
+ *   Builds the CIDR lookup trie (buildCIDRLookup())
+ *   Prints warnings to stderr for invalid lines
+ *   Prints debug message with entry count if debug >= 1
+ *
+ * ALGORITHM:
+ *   1. Open file, allocate initial 4096-entry array
+ *   2. Parse each line: NETWORK/PREFIX TIMEZONE X_START X_END
+ *   3. Skip comment (#) and empty lines
+ *   4. Grow array 2x when capacity reached (with overflow checks)
+ *   5. Pre-calculate network masks: (prefix==0) ? 0 : ~((1U << (32-prefix)) - 1)
+ *   6. Sort array by prefix_len DESC using qsort()
+ *   7. Scale X ranges if the file's "# Hilbert dimension:" differs from the
+ *      initialized curve (4096 assumed when absent)
+ *   8. Index the entries in the lookup trie (finishCIDRMapping())
+ *
+ * PERFORMANCE:
+ *   O(m log m) where m = number of entries
+ *   File I/O: O(n) where n = file size
+ *   Parsing: O(m), Sorting: O(m log m) - dominates
+ *   Typical: ~3500 entries, ~11K comparisons
+ *
+ ****/
+int loadCIDRMapping(const char *filename)
+{
+    FILE *fp;
+    char line[256];
+    uint32_t line_num = 0;
+    uint32_t entries_loaded = 0;
+    uint32_t map_dimension = CIDR_MAP_DIMENSION_DEFAULT;  /* cidr_map default when the file does not say */
+    char magic[8];
+
+    cidr_map_generation++;
+
+    fp = fopen(filename, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "ERR - Cannot open CIDR mapping file: %s\n", filename);
+        return FALSE;
+    }
+
+    /* Binary maps written by cidr_mapper are used as they are */
+    if (fread(magic, 1, sizeof(magic), fp) == sizeof(magic) && memcmp(magic, CIDR_MAP_MAGIC, sizeof(magic)) == 0) {
+        fclose(fp);
+        return loadCIDRMappingBinary(filename);
+    }
+    rewind(fp);
+
+    /* Allocate initial capacity */
+    cidr_map_capacity = 4096;
+    cidr_map = (CIDRMapEntry_t *)XMALLOC((int)(sizeof(CIDRMapEntry_t) * cidr_map_capacity));
+    if (cidr_map == NULL) {
+        fprintf(stderr, "ERR - Cannot allocate CIDR mapping array\n");
+        fclose(fp);
+        return FALSE;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        line_num++;
+
+        /* Skip comments and empty lines, noting the dimension X ranges were laid out for */
+        if (line[0] == '#') {
+            sscanf(line, "# Hilbert dimension: %u", &map_dimension);
+            continue;
+        }
+        if (line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+
+        /* Parse: NETWORK/PREFIX TIMEZONE X_START X_END */
+        uint32_t oct1, oct2, oct3, oct4, prefix;
+        int tz;
+        uint32_t x_start, x_end;
+
+        int parsed = sscanf(line, "%u.%u.%u.%u/%u %d %u %u",
+                           &oct1, &oct2, &oct3, &oct4, &prefix,
+                           &tz, &x_start, &x_end);
+
+        if (parsed != 8) {
+            fprintf(stderr, "WARN - Invalid CIDR mapping line %u: %s", line_num, line);
+            continue;
+        }
+
+        /* Grow array if needed */
         if (cidr_map_count >= cidr_map_capacity) {
             uint32_t new_capacity;
             size_t new_size;
@@ -808,154 +1473,530 @@ int loadCIDRMapping(const char *filename)
         entries_loaded++;
     }
 
-    fclose(fp);
+    fclose(fp);
+
+    /* Sort CIDR array by prefix length (DESC) and network, most specific first */
+    if (cidr_map_count > 0) {
+        qsort(cidr_map, cidr_map_count, sizeof(CIDRMapEntry_t), compareCIDREntries);
+    }
+
+#ifdef DEBUG
+    if (config->debug >= 1) {
+        fprintf(stderr, "DEBUG - CIDR mapping loaded and sorted: %u entries from %s\n",
+                entries_loaded, filename);
+    }
+#endif
+
+    return finishCIDRMapping(map_dimension);
+}
+
+/****
+ *
+ * Free CIDR mapping
+ *
+ * DESCRIPTION:
+ *   Frees all memory allocated for CIDR mapping and resets global state.
+ *   Safe to call multiple times.
+ *
+ * PARAMETERS:
+ *   None
+ *
+ * RETURNS:
+ *   void
+ *
+ * SIDE EFFECTS:
+ *   Frees global cidr_map array
+ *   Resets cidr_map, cidr_map_count, cidr_map_capacity to zero/NULL
+ *
+ * ALGORITHM:
+ *   Conditional free with pointer nullification and counter reset
+ *
+ * PERFORMANCE:
+ *   O(1) - Single deallocation
+ *
+ ****/
+void freeCIDRMapping(void)
+{
+    if (cidr_map != NULL) {
+        XFREE(cidr_map);
+        cidr_map = NULL;
+    }
+    freeCIDRLookup();
+    cidr_map_count = 0;
+    cidr_map_capacity = 0;
+    cidr_map_generation++;
+}
+
+/****
+ *
+ * Find CIDR mapping for IP address
+ *
+ * DESCRIPTION:
+ *   Looks up the most specific CIDR map entry covering an address
+ *   (longest prefix match) in the trie built by loadCIDRMapping().
+ *
+ * PARAMETERS:
+ *   ipv4 - IPv4 address in host byte order
+ *
+ * RETURNS:
+ *   Pointer to matching CIDRMapEntry_t (most specific match), or NULL if no match
+ *
+ * SIDE EFFECTS:
+ *   None
+ *
+ * ALGORITHM:
+ *   Root slot for the top 16 bits, then up to two 256-slot chunks for
+ *   the third and fourth octets where longer prefixes exist
+ *
+ * PERFORMANCE:
+ *   O(1) - At most three dependent loads, whatever the map size
+ *
+ ****/
+PRIVATE CIDRMapEntry_t *findCIDRMapping(uint32_t ipv4)
+{
+    uint32_t slot;
+
+    if (cidr_lpm_root == NULL) {
+        return NULL;
+    }
+
+    slot = cidr_lpm_root[ipv4 >> 16];
+    if (slot & CIDR_LPM_CHUNK) {
+        slot = cidr_lpm_chunks[(slot & ~CIDR_LPM_CHUNK) * CIDR_LPM_CHUNK_SLOTS + ((ipv4 >> 8) & 0xFF)];
+        if (slot & CIDR_LPM_CHUNK) {
+            slot = cidr_lpm_chunks[(slot & ~CIDR_LPM_CHUNK) * CIDR_LPM_CHUNK_SLOTS + (ipv4 & 0xFF)];
+        }
+    }
+
+    return (slot != 0) ? &cidr_map[slot - 1] : NULL;
+}
+
+/****
+ *
+ * X position of an address within its CIDR timezone band
+ *
+ * DESCRIPTION:
+ *   Spreads /16 networks proportionally across the band of the matching
+ *   CIDR map entry. Shared by ipToHilbert() and the prefix table builder.
+ *
+ * PARAMETERS:
+ *   entry - Matching CIDR map entry
+ *   ipv4 - IPv4 address in host byte order (only the /16 is used)
+ *
+ * RETURNS:
+ *   X coordinate within [x_start, x_end)
+ *
+ ****/
+PRIVATE uint32_t cidrBandX(const CIDRMapEntry_t *entry, uint32_t ipv4)
+{
+    uint32_t tz_band_width = entry->x_end - entry->x_start;
+    uint32_t network_16 = ipv4 >> 16;  /* First 16 bits */
+    uint32_t x;
+
+    if (tz_band_width == 0) {
+        tz_band_width = 1;
+    }
+
+    /* Use /16 network for coarse positioning within timezone band */
+    x = entry->x_start + (network_16 * tz_band_width) / 65536;
+
+    /* Ensure within bounds */
+    if (x >= entry->x_end) {
+        x = entry->x_end > 0 ? entry->x_end - 1 : 0;
+    }
+
+    return x;
+}
+
+/****
+ *
+ * /24 prefix lookup table
+ *
+ * One packed uint32_t per /24 so ipToHilbert() is a single load for
+ * most addresses. Entries are one of:
+ *   HILBERT_PREFIX_SLOW - the /24 is split by a longer CIDR prefix,
+ *                         map each address the long way
+ *   HILBERT_PREFIX_BAND - CIDR band, X in bits 0-15, Y from the low
+ *                         16 address bits as usual
+ *   otherwise           - direct mapping, X in bits 0-11, Y in bits
+ *                         12-23; above order 12 these are the curve's
+ *                         top 12 levels and bits 24-25 the state the
+ *                         remaining order - 12 levels start in
+ *
+ ****/
+
+PRIVATE uint32_t *prefix_table = NULL;         /* HILBERT_PREFIX_ENTRIES entries */
+PRIVATE void *prefix_table_base = NULL;        /* Allocation or mapping holding the table */
+PRIVATE size_t prefix_table_mapped = 0;        /* Mapping size, 0 if allocated */
+PRIVATE uint8_t prefix_table_order = 0;
+PRIVATE uint32_t prefix_table_generation = 0;  /* cidr_map_generation it was built for */
+PRIVATE char *prefix_table_file = NULL;        /* Cache file, NULL keeps it in memory */
+PRIVATE int prefix_table_wanted = FALSE;
+
+/****
+ *
+ * Hash the loaded CIDR map
+ *
+ * DESCRIPTION:
+ *   Keys a cached prefix table or non-routable mask to the map it was
+ *   built from. Covers everything that moves a coordinate, in lookup
+ *   order.
+ *
+ * RETURNS:
+ *   32-bit hash of the CIDR map entries
+ *
+ ****/
+uint32_t getCIDRMapHash(void)
+{
+    uint32_t fields[5];
+    uint32_t hash = HILBERT_HASH_SEED;
+    uint32_t i;
+
+    for (i = 0; i < cidr_map_count; i++) {
+        fields[0] = cidr_map[i].network;
+        fields[1] = cidr_map[i].mask;
+        fields[2] = cidr_map[i].prefix_len;
+        fields[3] = cidr_map[i].x_start;
+        fields[4] = cidr_map[i].x_end;
+        hash = murmurhash3_32(fields, (int)sizeof(fields), hash);
+    }
+
+    return hash;
+}
+
+/****
+ *
+ * Fill a prefix table for the current CIDR map and order
+ *
+ * DESCRIPTION:
+ *   Packs the coordinate of each /24 from the CIDR trie entry that owns
+ *   it, or from the direct mapping when none does.
+ *
+ * PARAMETERS:
+ *   table - HILBERT_PREFIX_ENTRIES entries to fill
+ *   order - Hilbert curve order
+ *
+ * RETURNS:
+ *   void
+ *
+ * PERFORMANCE:
+ *   O(2^24), roughly 0.2s
+ *
+ ****/
+PRIVATE void buildPrefixTable(uint32_t *table, uint8_t order)
+{
+    uint64_t total_points = getTotalPoints(order);
+    uint32_t prefix, owner, state, step, lut, x, y;
+    uint64_t morton;
+
+    for (prefix = 0; prefix < HILBERT_PREFIX_ENTRIES; prefix++) {
+        /* Trie slot covering the whole /24, a chunk if it is split */
+        owner = (cidr_lpm_root != NULL) ? cidr_lpm_root[prefix >> 8] : 0;
+        if (owner & CIDR_LPM_CHUNK) {
+            owner = cidr_lpm_chunks[(owner & ~CIDR_LPM_CHUNK) * CIDR_LPM_CHUNK_SLOTS + (prefix & 0xFF)];
+        }
+        if (owner & CIDR_LPM_CHUNK) {
+            table[prefix] = HILBERT_PREFIX_SLOW;
+            continue;
+        }
+
+        if (owner != 0) {
+            x = cidrBandX(&cidr_map[owner - 1], prefix << 8);
+            table[prefix] = (x <= 0xFFFF) ? (HILBERT_PREFIX_BAND | x) : HILBERT_PREFIX_SLOW;
+        } else if (order <= 12) {
+            /* Index depends on at most the top 24 bits */
+            hilbertIndexToXY(((uint64_t)(prefix << 8) * total_points) >> 32, order, &x, &y);
+            table[prefix] = x | (y << 12);
+        } else {
+            /* Top 12 levels, and the state the rest start in */
+            state = 0;
+            morton = 0;
+            for (step = 3; step-- > 0;) {
+                lut = hilbert_d2xy_lut[state][(prefix >> (step * 8)) & 0xFF];
+                morton = (morton << 8) | (lut >> 2);
+                state = lut & 3;
+            }
+            mortonDecode(morton, &x, &y);
+            table[prefix] = x | (y << 12) | (state << 24);
+        }
+    }
+}
+
+/****
+ *
+ * Coordinates of an address from its prefix table entry
+ *
+ * DESCRIPTION:
+ *   Unpacks a non-HILBERT_PREFIX_SLOW entry. Above order 12 the last
+ *   order - 12 curve levels (at most 4) come from one d2xy table lookup.
+ *
+ * PARAMETERS:
+ *   packed - Prefix table entry for ipv4 >> 8
+ *   ipv4 - IPv4 address in host byte order
+ *   order - Hilbert curve order the table was built for
+ *
+ * RETURNS:
+ *   HilbertCoord_t, same as ipToHilbert() computes
+ *
+ ****/
+static inline HilbertCoord_t prefixTableCoord(uint32_t packed, uint32_t ipv4, uint8_t order)
+{
+    HilbertCoord_t coord;
+    uint32_t levels, digits, lut, x, y;
+
+    coord.order = order;
 
-    /* PERFORMANCE OPTIMIZATION: Sort CIDR array by prefix length (DESC) and network
-     * This allows faster lookups by checking most specific matches first
-     * Also enables future binary search optimization
-     */
-    if (cidr_map_count > 0) {
-        qsort(cidr_map, cidr_map_count, sizeof(CIDRMapEntry_t), compareCIDREntries);
+    if (packed & HILBERT_PREFIX_BAND) {
+        coord.x = packed & 0xFFFF;
+        coord.y = ((ipv4 & 0xFFFF) << order) >> 16;
+    } else if (order <= 12) {
+        coord.x = packed & 0xFFF;
+        coord.y = (packed >> 12) & 0xFFF;
+    } else {
+        /* Zero levels padding the rest to 4 each swap x and y */
+        levels = (uint32_t)order - 12;
+        digits = (ipv4 >> (32 - order * 2)) & ((1U << (levels * 2)) - 1);
+        lut = hilbert_d2xy_lut[((packed >> 24) & 3) ^ ((4 - levels) & 1)][digits];
+        mortonDecode((lut >> 2) & ((1U << (levels * 2)) - 1), &x, &y);
+        coord.x = ((packed & 0xFFF) << levels) | x;
+        coord.y = (((packed >> 12) & 0xFFF) << levels) | y;
     }
 
-#ifdef DEBUG
-    if (config->debug >= 1) {
-        fprintf(stderr, "DEBUG - CIDR mapping loaded and sorted: %u entries from %s\n",
-                entries_loaded, filename);
+    return coord;
+}
+
+/****
+ *
+ * Release the attached prefix table
+ *
+ ****/
+PRIVATE void dropPrefixTable(void)
+{
+#ifdef HAVE_SYS_MMAN_H
+    if (prefix_table_mapped > 0) {
+        munmap(prefix_table_base, prefix_table_mapped);
+        prefix_table_base = NULL;
     }
 #endif
-
-    return TRUE;
+    if (prefix_table_base != NULL) {
+        XFREE(prefix_table_base);
+    }
+    prefix_table = NULL;
+    prefix_table_mapped = 0;
 }
 
 /****
  *
- * Free CIDR mapping
+ * Map a cached prefix table file
  *
  * DESCRIPTION:
- *   Frees all memory allocated for CIDR mapping and resets global state.
- *   Safe to call multiple times.
+ *   Maps prefix_table_file read-only if its header matches the order
+ *   and CIDR map.
  *
  * PARAMETERS:
- *   None
+ *   expected - Header the file must carry
  *
  * RETURNS:
- *   void
- *
- * SIDE EFFECTS:
- *   Frees global cidr_map array
- *   Resets cidr_map, cidr_map_count, cidr_map_capacity to zero/NULL
- *
- * ALGORITHM:
- *   Conditional free with pointer nullification and counter reset
- *
- * PERFORMANCE:
- *   O(1) - Single deallocation
+ *   TRUE if the table is attached, FALSE if the file is missing, stale
+ *   or cannot be mapped
  *
  ****/
-void freeCIDRMapping(void)
+PRIVATE int mapPrefixTable(const HilbertPrefixHeader_t *expected)
 {
-    if (cidr_map != NULL) {
-        XFREE(cidr_map);
-        cidr_map = NULL;
+#ifdef HAVE_SYS_MMAN_H
+    HilbertPrefixHeader_t header;
+    struct stat st;
+    void *base;
+    int fd;
+
+    fd = open(prefix_table_file, O_RDONLY);
+    if (fd < 0) {
+        return FALSE;
     }
-    cidr_map_count = 0;
-    cidr_map_capacity = 0;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (uint64_t)st.st_size != expected->file_bytes ||
+        read(fd, &header, sizeof(header)) != (ssize_t)sizeof(header) ||
+        memcmp(&header, expected, sizeof(header)) != 0) {
+        close(fd);
+        return FALSE;
+    }
+
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return FALSE;
+    }
+
+    prefix_table_base = base;
+    prefix_table_mapped = (size_t)st.st_size;
+    prefix_table = (uint32_t *)((uint8_t *)base + sizeof(HilbertPrefixHeader_t));
+    return TRUE;
+#else
+    (void)expected;
+    return FALSE;
+#endif
 }
 
 /****
- * Simple LRU cache for IP->CIDR lookups
- * Attack traffic often comes in bursts from same IPs, so caching helps significantly
+ *
+ * Write the prefix table to its cache file
+ *
+ * DESCRIPTION:
+ *   Writes via a temporary file and rename() so concurrent runs never
+ *   map a partial table.
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on I/O error
+ *
  ****/
-#define CIDR_CACHE_SIZE 256  /* Power of 2 for fast modulo */
-typedef struct {
-    uint32_t ip;
-    CIDRMapEntry_t *entry;
-    uint32_t access_count;
-} CIDRCacheEntry_t;
+PRIVATE int savePrefixTable(const HilbertPrefixHeader_t *header)
+{
+    char tmp_path[PATH_MAX];
+    FILE *fp;
+    int ok;
+
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", prefix_table_file) >= (int)sizeof(tmp_path)) {
+        return FALSE;
+    }
+
+    fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        return FALSE;
+    }
+    ok = (fwrite(header, sizeof(*header), 1, fp) == 1 &&
+          fwrite(prefix_table, sizeof(uint32_t), HILBERT_PREFIX_ENTRIES, fp) == HILBERT_PREFIX_ENTRIES);
+    if (fclose(fp) != 0) {
+        ok = FALSE;
+    }
+    if (!ok || rename(tmp_path, prefix_table_file) != 0) {
+        unlink(tmp_path);
+        return FALSE;
+    }
 
-PRIVATE CIDRCacheEntry_t cidr_cache[CIDR_CACHE_SIZE];
-PRIVATE int cidr_cache_initialized = FALSE;
-PRIVATE uint32_t cidr_cache_hits = 0;
-PRIVATE uint32_t cidr_cache_misses = 0;
+    return TRUE;
+}
 
 /****
  *
- * Find CIDR mapping for IP address
+ * Attach a prefix table for the current CIDR map and order
  *
  * DESCRIPTION:
- *   Looks up CIDR map entry for IP address using 256-entry LRU cache
- *   and linear search through sorted CIDR array. Returns most specific
- *   matching CIDR block (longest prefix match).
+ *   Maps the cache file when it matches, otherwise builds the table in
+ *   memory and (re)writes the cache file. Called by ipToHilbert() the
+ *   first time it runs after usePrefixTable(), and again whenever the
+ *   order or CIDR map has changed since.
  *
  * PARAMETERS:
- *   ipv4 - IPv4 address in host byte order
+ *   order - Hilbert curve order
  *
  * RETURNS:
- *   Pointer to matching CIDRMapEntry_t (most specific match), or NULL if no match
+ *   void
  *
  * SIDE EFFECTS:
- *   Initializes cidr_cache on first call (memset to zero)
- *   Updates cache entry for this IP (hit or miss)
- *   Increments global cidr_cache_hits or cidr_cache_misses counters
- *
- * ALGORITHM:
- *   1. Check 256-entry direct-mapped cache using IP's lower 8 bits as index
- *   2. On cache hit: increment counters, return cached entry pointer
- *   3. On cache miss: linear search through sorted CIDR array
- *   4. Use pre-calculated masks for fast comparison: (ip & mask) == network
- *   5. Stop at first match (most specific due to prefix-length sorting)
- *   6. Update cache with result (even NULL to prevent repeated searches)
+ *   Turns the table off (with a warning) if it cannot be allocated
  *
- * PERFORMANCE:
- *   Cache hit: O(1) - Single array lookup
- *   Cache miss: O(m) where m = CIDR entry count (~3500 typical)
- *   Average case: O(1) - High hit rate due to bursty attack traffic patterns
- *   Cache strategy: Direct-mapped, simple LRU replacement per slot
+ * MEMORY:
+ *   64MB, shared page cache when mapped from the cache file
  *
  ****/
-PRIVATE CIDRMapEntry_t *findCIDRMapping(uint32_t ipv4)
+PRIVATE void attachPrefixTable(uint8_t order)
 {
-    uint32_t cache_idx;
-    CIDRMapEntry_t *result;
+    HilbertPrefixHeader_t header;
 
-    /* Initialize cache on first use */
-    if (!cidr_cache_initialized) {
-        memset(cidr_cache, 0, sizeof(cidr_cache));
-        cidr_cache_initialized = TRUE;
+    dropPrefixTable();
+
+    if (!hilbert_lut_ready) {
+        buildHilbertTables();
     }
 
-    /* Check cache first - use IP's lower bits for fast indexing */
-    cache_idx = ipv4 & (CIDR_CACHE_SIZE - 1);
+    XMEMSET(&header, 0, sizeof(header));
+    XMEMCPY(header.magic, HILBERT_PREFIX_MAGIC, 8);
+    header.header_bytes = sizeof(HilbertPrefixHeader_t);
+    header.order = order;
+    header.map_count = cidr_map_count;
+    header.map_hash = getCIDRMapHash();
+    header.file_bytes = sizeof(HilbertPrefixHeader_t) + (uint64_t)HILBERT_PREFIX_ENTRIES * sizeof(uint32_t);
+
+    prefix_table_order = order;
+    prefix_table_generation = cidr_map_generation;
 
-    if (cidr_cache[cache_idx].ip == ipv4 && cidr_cache[cache_idx].entry != NULL) {
-        cidr_cache[cache_idx].access_count++;
-        cidr_cache_hits++;
-        return cidr_cache[cache_idx].entry;
+    if (prefix_table_file && mapPrefixTable(&header)) {
+#ifdef DEBUG
+        if (config->debug >= 1) {
+            fprintf(stderr, "DEBUG - Prefix table mapped from %s (order=%u)\n", prefix_table_file, order);
+        }
+#endif
+        return;
+    }
+
+    prefix_table_base = XMALLOC((int)(sizeof(uint32_t) * HILBERT_PREFIX_ENTRIES));
+    if (prefix_table_base == NULL) {
+        fprintf(stderr, "WARN - Cannot allocate prefix table, mapping each address\n");
+        prefix_table_wanted = FALSE;
+        return;
     }
+    prefix_table = (uint32_t *)prefix_table_base;
+    buildPrefixTable(prefix_table, order);
 
-    cidr_cache_misses++;
+    if (prefix_table_file && !savePrefixTable(&header)) {
+        fprintf(stderr, "WARN - Cannot write prefix table %s, keeping it in memory\n", prefix_table_file);
+    }
 
-    /* Cache miss - search sorted array using pre-calculated masks
-     * Since array is sorted by prefix length (longest first), we find
-     * the most specific match first, which is correct for CIDR semantics
-     * PERFORMANCE: Using pre-calculated masks (boolean AND) is much faster
-     * than recalculating masks with bit shifts for every comparison
-     */
-    result = NULL;
-    for (uint32_t i = 0; i < cidr_map_count; i++) {
-        if ((ipv4 & cidr_map[i].mask) == cidr_map[i].network) {
-            result = &cidr_map[i];
-            break;  /* Found most specific match, stop searching */
+#ifdef DEBUG
+    if (config->debug >= 1) {
+        fprintf(stderr, "DEBUG - Prefix table built (order=%u, cidr entries=%u)\n", order, cidr_map_count);
+    }
+#endif
+}
+
+/****
+ *
+ * Map addresses through a precomputed /24 table
+ *
+ * DESCRIPTION:
+ *   Turns on the prefix table. It is built (or mapped from filename) the
+ *   first time ipToHilbert() runs, and rebuilt if the order or CIDR map
+ *   changes later. Coordinates are identical either way.
+ *
+ * PARAMETERS:
+ *   filename - Cache file for the table, NULL to keep it in memory only
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if filename cannot be stored
+ *
+ * MEMORY:
+ *   64MB once attached
+ *
+ ****/
+int usePrefixTable(const char *filename)
+{
+    freePrefixTable();
+
+    if (filename != NULL) {
+        prefix_table_file = XSTRDUP(filename);
+        if (prefix_table_file == NULL) {
+            return FALSE;
         }
     }
+    prefix_table_wanted = TRUE;
 
-    /* Update cache with new result (even if NULL to avoid repeated misses) */
-    cidr_cache[cache_idx].ip = ipv4;
-    cidr_cache[cache_idx].entry = result;
-    cidr_cache[cache_idx].access_count = 1;
+    return TRUE;
+}
 
-    return result;
+/****
+ *
+ * Turn off and release the prefix table
+ *
+ * DESCRIPTION:
+ *   Safe to call multiple times.
+ *
+ ****/
+void freePrefixTable(void)
+{
+    dropPrefixTable();
+    if (prefix_table_file != NULL) {
+        XFREE(prefix_table_file);
+    }
+    prefix_table_wanted = FALSE;
 }
 
 /****
@@ -974,14 +2015,13 @@ PRIVATE CIDRMapEntry_t *findCIDRMapping(uint32_t ipv4)
  *   Hilbert curve index (0 to dimension²-1)
  *
  * SIDE EFFECTS:
- *   May update CIDR cache (via ipToHilbert -> findCIDRMapping)
+ *   None
  *
  * ALGORITHM:
  *   Calls ipToHilbert() then hilbertXYToIndex() for coordinate conversion
  *
  * PERFORMANCE:
- *   O(order) for Hilbert conversion + O(1) cache hit or O(m) cache miss
- *   Typical (order 12, cached): ~12 iterations for XY conversion
+ *   O(order / 4) for Hilbert conversion + O(1) CIDR lookup
  *
  ****/
 uint64_t ipToHilbertIndex(uint32_t ipv4, uint8_t order)
@@ -1009,7 +2049,6 @@ uint64_t ipToHilbertIndex(uint32_t ipv4, uint8_t order)
  *   HilbertCoord_t structure containing {x, y, order}
  *
  * SIDE EFFECTS:
- *   May update CIDR cache if CIDR mapping is loaded
  *   Prints debug message if debug >= 5 (CIDR mode only)
  *
  * ALGORITHM:
@@ -1030,9 +2069,9 @@ uint64_t ipToHilbertIndex(uint32_t ipv4, uint8_t order)
  *     3. Result: Adjacent IPs map to nearby coordinates (locality-preserving)
  *
  * PERFORMANCE:
- *   With CIDR: O(1) cache hit or O(m) cache miss + O(1) coordinate calculation
- *   Without CIDR: O(order) for Hilbert index->XY conversion
- *   Typical (order 12, with cache): ~12 iterations
+ *   With CIDR: O(1) trie lookup + O(1) coordinate calculation
+ *   Without CIDR: O(order / 4) for Hilbert index->XY conversion
+ *   With a prefix table: one load for most addresses
  *
  * KEY PROPERTIES:
  *   - Deterministic: Same IP always maps to same coordinate
@@ -1046,35 +2085,32 @@ HilbertCoord_t ipToHilbert(uint32_t ipv4, uint8_t order)
     HilbertCoord_t coord;
     uint32_t dimension = getDimension(order);
 
+    /* Precomputed /24 table (usePrefixTable()) */
+    if (prefix_table_wanted) {
+        if (prefix_table == NULL || prefix_table_order != order ||
+            prefix_table_generation != cidr_map_generation) {
+            attachPrefixTable(order);
+        }
+        if (prefix_table != NULL) {
+            uint32_t packed = prefix_table[ipv4 >> 8];
+
+            if (!(packed & HILBERT_PREFIX_SLOW)) {
+                return prefixTableCoord(packed, ipv4, order);
+            }
+        }
+    }
+
     /* If CIDR mapping is loaded, use it */
     if (cidr_map != NULL && cidr_map_count > 0) {
         CIDRMapEntry_t *entry = findCIDRMapping(ipv4);
 
         if (entry != NULL) {
             /* Found mapping - use timezone band with CIDR clustering */
-            uint32_t tz_band_width = entry->x_end - entry->x_start;
-
-            if (tz_band_width == 0) {
-                tz_band_width = 1;
-            }
-
-            /* Extract IP octets for clustering */
-            uint8_t oct1 = (uint8_t)((ipv4 >> 24) & 0xFF);
-            uint8_t oct2 = (ipv4 >> 16) & 0xFF;
             uint8_t oct3 = (ipv4 >> 8) & 0xFF;
             uint8_t oct4 = ipv4 & 0xFF;
 
-            /* Use /16 network for coarse positioning within timezone band */
-            uint32_t network_16 = (oct1 << 8) | oct2;  /* First 16 bits */
-
             /* X position within timezone band based on /16 network */
-            uint32_t x_offset = (network_16 * tz_band_width) / 65536;
-            coord.x = entry->x_start + x_offset;
-
-            /* Ensure within bounds */
-            if (coord.x >= entry->x_end) {
-                coord.x = entry->x_end > 0 ? entry->x_end - 1 : 0;
-            }
+            coord.x = cidrBandX(entry, ipv4);
 
             /* Y position based on full IP for vertical clustering */
             /* Spread across full Y dimension for vertical distribution */
@@ -1086,7 +2122,7 @@ HilbertCoord_t ipToHilbert(uint32_t ipv4, uint8_t order)
 #ifdef DEBUG
             if (config->debug >= 5) {
                 fprintf(stderr, "DEBUG - IP %u.%u.%u.%u -> TZ=%+d, X=%u (band:%u-%u), Y=%u\n",
-                        oct1, oct2, oct3, oct4, entry->timezone_offset,
+                        (ipv4 >> 24) & 0xFF, (ipv4 >> 16) & 0xFF, oct3, oct4, entry->timezone_offset,
                         coord.x, entry->x_start, entry->x_end, coord.y);
             }
 #endif
@@ -1127,3 +2163,262 @@ HilbertCoord_t ipToHilbert(uint32_t ipv4, uint8_t order)
 
     return coord;
 }
+
+/****
+ *
+ * Map an array of IPv4 addresses to Hilbert curve coordinates
+ *
+ * DESCRIPTION:
+ *   Batch form of ipToHilbert(). With a prefix table (usePrefixTable())
+ *   most addresses are one load, and only /24s marked slow go through
+ *   ipToHilbert(). Otherwise, without a CIDR map the addresses are
+ *   scaled to curve indices and converted with hilbertIndexToXYBatch();
+ *   with one loaded each address goes through ipToHilbert().
+ *
+ * PARAMETERS:
+ *   ipv4 - Array of count IPv4 addresses in host byte order
+ *   count - Number of addresses
+ *   order - Hilbert curve order
+ *   x - Output array of count X coordinates
+ *   y - Output array of count Y coordinates
+ *
+ * RETURNS:
+ *   void
+ *
+ * SIDE EFFECTS:
+ *   Fills x[0..count-1] and y[0..count-1]
+ *
+ * PERFORMANCE:
+ *   O(count) with a prefix table, O(count * order / 4) without a CIDR map
+ *
+ ****/
+void ipToHilbertBatch(const uint32_t *ipv4, size_t count, uint8_t order, uint32_t *x, uint32_t *y)
+{
+    uint64_t index[HILBERT_BATCH_CHUNK];
+    uint64_t total_points = getTotalPoints(order);
+    HilbertCoord_t coord;
+    uint32_t packed;
+    size_t i, j, n;
+
+    /* Precomputed /24 table, attached the same way as in ipToHilbert() */
+    if (prefix_table_wanted) {
+        if (prefix_table == NULL || prefix_table_order != order ||
+            prefix_table_generation != cidr_map_generation) {
+            attachPrefixTable(order);
+        }
+        if (prefix_table != NULL) {
+            for (i = 0; i < count; i++) {
+                packed = prefix_table[ipv4[i] >> 8];
+                if (packed & HILBERT_PREFIX_SLOW) {
+                    coord = ipToHilbert(ipv4[i], order);
+                } else {
+                    coord = prefixTableCoord(packed, ipv4[i], order);
+                }
+                x[i] = coord.x;
+                y[i] = coord.y;
+            }
+            return;
+        }
+    }
+
+    if (cidr_map != NULL && cidr_map_count > 0) {
+        for (i = 0; i < count; i++) {
+            coord = ipToHilbert(ipv4[i], order);
+            x[i] = coord.x;
+            y[i] = coord.y;
+        }
+        return;
+    }
+
+    /* Same scaling as ipToHilbert(), (0xFFFFFFFF * total_points) >> 32 < total_points */
+    for (i = 0; i < count; i += n) {
+        n = (count - i < HILBERT_BATCH_CHUNK) ? count - i : HILBERT_BATCH_CHUNK;
+        for (j = 0; j < n; j++) {
+            index[j] = ((uint64_t)ipv4[i + j] * total_points) >> 32;
+        }
+        hilbertIndexToXYBatch(index, n, order, &x[i], &y[i]);
+    }
+}
+
+/****
+ *
+ * Non-routable mask rasterization
+ *
+ * Paints nonroutable_prefixes[] into a bitset of dimension^2 bits, bit
+ * (y * dimension + x) of 64-bit words, without mapping addresses one by
+ * one. On the direct mapping an address range is a Hilbert index range,
+ * split into aligned runs of 4^k indices that each fill a 2^k square.
+ * Under a CIDR map, each span of a /16 owned by one map entry is part of
+ * one column of its timezone band.
+ *
+ ****/
+
+/****
+ *
+ * Set a run of bits
+ *
+ ****/
+PRIVATE void setBitRange(uint64_t *bits, uint64_t first, uint64_t count)
+{
+    uint64_t last = first + count - 1;
+    uint64_t pos = first >> 6, last_pos = last >> 6;
+    uint64_t head = ~(uint64_t)0 << (first & 63);
+    uint64_t tail = ~(uint64_t)0 >> (63 - (last & 63));
+
+    if (pos == last_pos) {
+        bits[pos] |= head & tail;
+        return;
+    }
+
+    bits[pos++] |= head;
+    while (pos < last_pos) {
+        bits[pos++] = ~(uint64_t)0;
+    }
+    bits[pos] |= tail;
+}
+
+/****
+ *
+ * Set the bits of a rectangle of cells
+ *
+ ****/
+PRIVATE void setBitRect(uint64_t *bits, uint32_t dimension, uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+    uint32_t row;
+
+    for (row = y; row < y + height; row++) {
+        setBitRange(bits, (uint64_t)row * dimension + x, width);
+    }
+}
+
+/****
+ *
+ * Mark a range of Hilbert indices
+ *
+ * DESCRIPTION:
+ *   Splits [first, last] into the largest aligned runs of 4^k indices,
+ *   each of which is a 2^k x 2^k square of the curve.
+ *
+ ****/
+PRIVATE void markIndexRange(uint64_t *bits, uint8_t order, uint64_t first, uint64_t last)
+{
+    uint32_t dimension = getDimension(order);
+    uint32_t x, y, side;
+    uint8_t level;
+
+    while (first <= last) {
+        level = 0;
+        while (level < order && (first & ((4ULL << (2 * level)) - 1)) == 0 &&
+               first + (4ULL << (2 * level)) - 1 <= last) {
+            level++;
+        }
+
+        side = 1U << level;
+        hilbertIndexToXY(first, order, &x, &y);
+        setBitRect(bits, dimension, x & ~(side - 1), y & ~(side - 1), side, side);
+        first += 1ULL << (2 * level);
+    }
+}
+
+/****
+ *
+ * Mark an address range that shares one CIDR trie slot
+ *
+ * DESCRIPTION:
+ *   Descends into trie chunks until [first, last] sits under a single
+ *   slot, then marks it as ipToHilbert() would map it: a column of the
+ *   owning entry's band, or the direct Hilbert range when no entry does.
+ *
+ * PARAMETERS:
+ *   bits - Bitset to mark
+ *   order - Hilbert curve order
+ *   slot - Trie slot covering the range
+ *   shift - Address bits below the slot (16, 8 or 0)
+ *   first, last - Inclusive address range under the slot
+ *
+ ****/
+PRIVATE void markTrieRange(uint64_t *bits, uint8_t order, uint32_t slot, uint8_t shift, uint32_t first, uint32_t last)
+{
+    uint32_t dimension = getDimension(order);
+    uint64_t total_points = getTotalPoints(order);
+
+    if (slot & CIDR_LPM_CHUNK) {
+        const uint32_t *chunk = &cidr_lpm_chunks[(slot & ~CIDR_LPM_CHUNK) * CIDR_LPM_CHUNK_SLOTS];
+        uint8_t sub_shift = (uint8_t)(shift - 8);
+        uint32_t sub, sub_first, sub_last;
+        uint32_t span = (1U << sub_shift) - 1;
+
+        for (sub = (first >> sub_shift) & 0xFF; sub <= ((last >> sub_shift) & 0xFF); sub++) {
+            sub_first = (first & ~((1U << shift) - 1)) | (sub << sub_shift);
+            sub_last = sub_first | span;
+            markTrieRange(bits, order, chunk[sub], sub_shift,
+                          (sub_first > first) ? sub_first : first,
+                          (sub_last < last) ? sub_last : last);
+        }
+        return;
+    }
+
+    if (slot != 0) {
+        uint32_t x = cidrBandX(&cidr_map[slot - 1], first);
+        uint32_t y_first = ((first & 0xFFFF) * dimension) / 65536;
+        uint32_t y_last = ((last & 0xFFFF) * dimension) / 65536;
+
+        if (x < dimension) {
+            setBitRect(bits, dimension, x, y_first, 1, y_last - y_first + 1);
+        }
+        return;
+    }
+
+    markIndexRange(bits, order, ((uint64_t)first * total_points) >> 32,
+                   ((uint64_t)last * total_points) >> 32);
+}
+
+/****
+ *
+ * Rasterize the non-routable address space
+ *
+ * DESCRIPTION:
+ *   Sets the bit of every cell that some non-routable address maps to
+ *   (isNonRoutableIP()) under the current mapping, direct or CIDR.
+ *   Works from the prefix list, so the cost follows the number of
+ *   squares and band columns painted rather than the size of the space.
+ *
+ * PARAMETERS:
+ *   bits - dimension^2 bits, cleared by the caller
+ *   order - Hilbert curve order
+ *
+ * RETURNS:
+ *   void
+ *
+ * PERFORMANCE:
+ *   A few milliseconds at order 12, direct or with a CIDR map
+ *
+ ****/
+void rasterizeNonRoutable(uint64_t *bits, uint8_t order)
+{
+    uint32_t i, net16;
+    uint32_t first, last, span_first, span_last;
+
+    if (!hilbert_lut_ready) {
+        buildHilbertTables();
+    }
+
+    for (i = 0; i < NONROUTABLE_PREFIX_COUNT; i++) {
+        first = nonroutable_prefixes[i].network;
+        last = first | (0xFFFFFFFFU >> nonroutable_prefixes[i].prefix_len);
+
+        if (cidr_lpm_root == NULL) {
+            markTrieRange(bits, order, 0, 32, first, last);
+            continue;
+        }
+
+        /* One root slot per /16 */
+        for (net16 = first >> 16; net16 <= (last >> 16); net16++) {
+            span_first = net16 << 16;
+            span_last = span_first | 0xFFFF;
+            markTrieRange(bits, order, cidr_lpm_root[net16], 16,
+                          (span_first > first) ? span_first : first,
+                          (span_last < last) ? span_last : last);
+        }
+    }
+}
@@ -53,9 +53,18 @@
 #define HILBERT_ORDER_MAX 16
 #define HILBERT_ORDER_DEFAULT 12  /* 4096x4096 = 16M points */
 
+/* Indices converted per hilbertIndexToXYBatch() call by ipToHilbertBatch() */
+#define HILBERT_BATCH_CHUNK 256
+
 /* Hash seed for IP distribution */
 #define HILBERT_HASH_SEED 0x9747b28c
 
+/* /24 prefix lookup table (usePrefixTable()) */
+#define HILBERT_PREFIX_MAGIC "TPPREFX1"       /* 8 bytes, version in the last byte */
+#define HILBERT_PREFIX_ENTRIES (1U << 24)     /* One per /24 */
+#define HILBERT_PREFIX_SLOW 0x80000000U       /* Split by a longer CIDR prefix */
+#define HILBERT_PREFIX_BAND 0x40000000U       /* CIDR band, X in the low 16 bits */
+
 /****
  *
  * typedefs & structs
@@ -80,6 +89,19 @@ typedef struct {
     uint64_t total_points;   /* Derived: dimension^2 */
 } HilbertConfig_t;
 
+/**
+ * Prefix table cache file header, followed by HILBERT_PREFIX_ENTRIES
+ * packed uint32_t coordinates
+ */
+typedef struct {
+    char magic[8];           /* HILBERT_PREFIX_MAGIC */
+    uint32_t header_bytes;   /* sizeof(HilbertPrefixHeader_t) */
+    uint32_t order;          /* Hilbert order the table was built for */
+    uint32_t map_count;      /* CIDR map entries (0 = direct mapping) */
+    uint32_t map_hash;       /* CIDR map contents */
+    uint64_t file_bytes;     /* Whole file, checked against its size */
+} HilbertPrefixHeader_t;
+
 /****
  *
  * function prototypes
@@ -94,10 +116,12 @@ HilbertConfig_t *getHilbertConfig(void);
 /* Core Hilbert curve functions */
 uint64_t hilbertXYToIndex(uint32_t x, uint32_t y, uint8_t order);
 void hilbertIndexToXY(uint64_t index, uint8_t order, uint32_t *x, uint32_t *y);
+void hilbertIndexToXYBatch(const uint64_t *index, size_t count, uint8_t order, uint32_t *x, uint32_t *y);
 
 /* IP address to Hilbert coordinate mapping */
 uint64_t ipToHilbertIndex(uint32_t ipv4, uint8_t order);
 HilbertCoord_t ipToHilbert(uint32_t ipv4, uint8_t order);
+void ipToHilbertBatch(const uint32_t *ipv4, size_t count, uint8_t order, uint32_t *x, uint32_t *y);
 
 /* Hash function for IP distribution */
 uint32_t murmurhash3_32(const void *key, int len, uint32_t seed);
@@ -109,9 +133,15 @@ uint64_t getTotalPoints(uint8_t order);
 
 /* IP classification */
 int isNonRoutableIP(uint32_t ipv4);
+void rasterizeNonRoutable(uint64_t *bits, uint8_t order);
 
 /* CIDR mapping functions */
 int loadCIDRMapping(const char *filename);
 void freeCIDRMapping(void);
+uint32_t getCIDRMapHash(void);
+
+/* /24 prefix lookup table */
+int usePrefixTable(const char *filename);
+void freePrefixTable(void);
 
 #endif /* HILBERT_DOT_H */
@@ -0,0 +1,82 @@
+/*****
+ *
+ * Description: HyperLogLog Cardinality Sketch Headers
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#ifndef HLL_DOT_H
+#define HLL_DOT_H
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "../include/sysdep.h"
+
+#ifndef __SYSDEP_H__
+#error something is messed up
+#endif
+
+#include "../include/common.h"
+#include <stdint.h>
+
+/****
+ *
+ * defines
+ *
+ ****/
+
+/* 2^12 one-byte registers: 4KB per sketch, ~1.6% standard error */
+#define HLL_PRECISION 12
+#define HLL_REGISTERS (1U << HLL_PRECISION)
+
+/****
+ *
+ * typedefs & structs
+ *
+ ****/
+
+/**
+ * HyperLogLog sketch - estimates distinct values in fixed memory
+ *
+ * Sketches of the same precision merge by taking the larger register, so
+ * the union of any set of bins can be estimated from their sketches.
+ */
+typedef struct {
+    uint8_t reg[HLL_REGISTERS];
+} HyperLogLog_t;
+
+/****
+ *
+ * function prototypes
+ *
+ ****/
+
+void hllClear(HyperLogLog_t *hll);
+void hllAdd(HyperLogLog_t *hll, uint32_t value);
+void hllMerge(HyperLogLog_t *dst, const HyperLogLog_t *src);
+uint32_t hllCount(const HyperLogLog_t *hll);
+
+#endif /* HLL_DOT_H */
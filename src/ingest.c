@@ -0,0 +1,994 @@
+/*****
+ *
+ * Description: Parallel Multi-File Ingest Implementation
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#include "ingest.h"
+#include "gzindex.h"
+#include "mem.h"
+#include "util.h"
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+/****
+ *
+ * typedefs
+ *
+ ****/
+
+/**
+ * Chunk of parsed events, recycled through the shared free list
+ */
+typedef struct IngestChunk_s {
+    HoneypotEvent_t *events;
+    size_t count;
+    struct IngestChunk_s *next;       // Free or ready list link
+    struct IngestChunk_s *all_next;   // Every allocated chunk (cleanup)
+} IngestChunk_t;
+
+/**
+ * Part of a file parsed by one thread at a time
+ *
+ * A plain file is a single slice read through its own stream. An indexed
+ * gzip file has one slice per access point; a slice borrows a reader from
+ * the shared pool while it is being parsed.
+ */
+typedef struct {
+    GzipStream_t *stream;
+    uint32_t seq;                 // Position within the file
+    IngestChunk_t *ready_head;    // Parsed chunks in slice order
+    IngestChunk_t *ready_tail;
+    uint32_t ready_count;
+    int busy;                     // A parser is filling a chunk for this slice
+    int started;                  // Stream positioned on the slice
+    int eof;                      // No more chunks will be queued
+} IngestSlice_t;
+
+/**
+ * One input file
+ *
+ * Slice fields and current_slice are shared between parser threads and the
+ * merging thread and are guarded by IngestContext_t.lock. current/pos are
+ * only touched by the merging thread.
+ */
+typedef struct {
+    const char *path;
+    int index;                    // Position in the input list (merge tie-break)
+    GzIndex_t *gz_index;          // Access points, NULL when streamed
+    IngestSlice_t *slices;
+    uint32_t slice_count;
+    uint32_t current_slice;       // Slice being merged
+    ParserStats_t stats;          // Totals of finished indexed slices
+
+    IngestChunk_t *current;       // Chunk being merged
+    size_t pos;                   // Next event in current
+} IngestFile_t;
+
+/**
+ * Shared ingest state
+ */
+typedef struct {
+    IngestFile_t *files;
+    int file_count;
+    uint32_t window;              // Indexed slices per file parsed ahead of the merger
+    IngestChunk_t *free_list;     // Empty chunks, topped up only by the merger
+    IngestChunk_t *all_chunks;
+    size_t chunk_total;
+    GzipStream_t **readers;       // Idle slice readers
+    int reader_count;
+    int reader_total;
+    IngestSlice_t *wanted;        // Slice the merger is blocked on
+    size_t slices_open;           // Slices not yet at their end
+    int failed;
+    int shutdown;
+#ifdef HAVE_PTHREAD_H
+    int threaded;
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;     // Chunk freed, slice finished or shutdown - parsers may have work
+    pthread_cond_t ready_cond;    // Chunk queued or slice finished - merger may proceed
+#endif
+} IngestContext_t;
+
+/****
+ *
+ * external variables
+ *
+ ****/
+
+extern Config_t *config;
+
+/****
+ *
+ * functions
+ *
+ ****/
+
+/****
+ *
+ * Resolve requested ingest thread count
+ *
+ * DESCRIPTION:
+ *   Maps the -j argument to a usable thread count. 0 means one per online
+ *   CPU. Builds without pthreads always get 1.
+ *
+ * PARAMETERS:
+ *   requested - Value given on the command line (0 = auto)
+ *
+ * RETURNS:
+ *   Thread count between 1 and INGEST_JOBS_MAX
+ *
+ ****/
+int getIngestJobs(int requested)
+{
+#ifdef HAVE_PTHREAD_H
+    long cpus;
+
+    if (requested <= 0) {
+        cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        requested = (cpus > 0) ? (int)cpus : 1;
+    }
+    if (requested > INGEST_JOBS_MAX) {
+        requested = INGEST_JOBS_MAX;
+    }
+
+    return requested;
+#else
+    (void)requested;
+    return 1;
+#endif
+}
+
+/****
+ *
+ * Add empty chunks to the free list
+ *
+ * DESCRIPTION:
+ *   Only called by the merging thread (or before parser threads start), so
+ *   parser threads never allocate.
+ *
+ ****/
+PRIVATE void addIngestChunks(IngestContext_t *ctx, size_t count)
+{
+    IngestChunk_t *chunk;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        chunk = (IngestChunk_t *)XMALLOC(sizeof(IngestChunk_t));
+        chunk->events = (HoneypotEvent_t *)XMALLOC((int)(sizeof(HoneypotEvent_t) * INGEST_CHUNK_EVENTS));
+        chunk->count = 0;
+        chunk->next = ctx->free_list;
+        ctx->free_list = chunk;
+        chunk->all_next = ctx->all_chunks;
+        ctx->all_chunks = chunk;
+        ctx->chunk_total++;
+    }
+}
+
+/****
+ *
+ * Parse events from a slice into one chunk
+ *
+ * DESCRIPTION:
+ *   Reads and parses lines until the chunk is full or the slice ends.
+ *   Runs on a parser thread without holding the context lock; only the
+ *   thread that marked the slice busy may call it.
+ *
+ * PARAMETERS:
+ *   file - File the slice belongs to
+ *   slice - Slice to read from
+ *   chunk - Empty chunk to fill
+ *
+ * RETURNS:
+ *   TRUE if the slice reached its end, FALSE if more data remains
+ *
+ ****/
+PRIVATE int fillIngestChunk(IngestFile_t *file, IngestSlice_t *slice, IngestChunk_t *chunk)
+{
+    GzipStream_t *stream = slice->stream;
+    LineView_t line;
+    struct timeval start_time, end_time;
+    int eof = TRUE;
+
+    gettimeofday(&start_time, NULL);
+
+    chunk->count = 0;
+    while (readLineViewGzip(stream, &line)) {
+        if (parseHoneypotLine(line.ptr, line.len, &chunk->events[chunk->count])) {
+            stream->stats.lines_parsed_ok++;
+            chunk->count++;
+        } else {
+            stream->stats.lines_parse_failed++;
+        }
+
+        /* Progress indicator every 1M lines (indexed files report per slice) */
+        if (!file->gz_index && stream->stats.lines_processed % 1000000 == 0) {
+            fprintf(stderr, "  %s: processed %luM lines...\n", file->path,
+                    stream->stats.lines_processed / 1000000);
+        }
+
+        if (chunk->count == INGEST_CHUNK_EVENTS) {
+            eof = FALSE;
+            break;
+        }
+    }
+
+    gettimeofday(&end_time, NULL);
+    stream->stats.parse_time_sec +=
+        (double)(end_time.tv_sec - start_time.tv_sec) +
+        (double)(end_time.tv_usec - start_time.tv_usec) / 1000000.0;
+
+    return eof;
+}
+
+/****
+ *
+ * Finish an indexed slice (caller holds the lock in threaded mode)
+ *
+ * DESCRIPTION:
+ *   Folds the slice reader's statistics into the file totals and returns
+ *   the reader to the pool.
+ *
+ ****/
+PRIVATE void finishIngestSlice(IngestContext_t *ctx, IngestFile_t *file, IngestSlice_t *slice)
+{
+    const ParserStats_t *s = &slice->stream->stats;
+    uint64_t before = file->stats.lines_processed;
+
+    file->stats.lines_processed += s->lines_processed;
+    file->stats.lines_parsed_ok += s->lines_parsed_ok;
+    file->stats.lines_parse_failed += s->lines_parse_failed;
+    file->stats.bytes_read += s->bytes_read;
+    file->stats.parse_time_sec += s->parse_time_sec;
+    file->stats.read_time_sec += s->read_time_sec;
+
+    if (before / 1000000 != file->stats.lines_processed / 1000000) {
+        fprintf(stderr, "  %s: processed %luM lines...\n", file->path,
+                file->stats.lines_processed / 1000000);
+    }
+
+    ctx->readers[ctx->reader_count++] = slice->stream;
+    slice->stream = NULL;
+}
+
+/****
+ *
+ * Queue a filled chunk (caller holds the lock in threaded mode)
+ *
+ ****/
+PRIVATE void queueIngestChunk(IngestContext_t *ctx, IngestFile_t *file, IngestSlice_t *slice,
+                              IngestChunk_t *chunk, int eof)
+{
+    if (chunk->count > 0) {
+        chunk->next = NULL;
+        if (slice->ready_tail) {
+            slice->ready_tail->next = chunk;
+        } else {
+            slice->ready_head = chunk;
+        }
+        slice->ready_tail = chunk;
+        slice->ready_count++;
+    } else {
+        chunk->next = ctx->free_list;
+        ctx->free_list = chunk;
+    }
+
+    if (eof) {
+        slice->eof = TRUE;
+        ctx->slices_open--;
+        if (file->gz_index && slice->stream) {
+            finishIngestSlice(ctx, file, slice);
+        }
+    }
+}
+
+/****
+ *
+ * Start an indexed slice (caller holds the lock in threaded mode)
+ *
+ * DESCRIPTION:
+ *   Takes a reader from the pool for the slice. The reader is positioned
+ *   by positionIngestSlice() once the lock has been dropped.
+ *
+ ****/
+PRIVATE void claimIngestReader(IngestContext_t *ctx, IngestSlice_t *slice)
+{
+    slice->stream = ctx->readers[--ctx->reader_count];
+    slice->started = TRUE;
+}
+
+/****
+ *
+ * Seek a claimed reader to its slice
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on error
+ *
+ ****/
+PRIVATE int positionIngestSlice(IngestFile_t *file, IngestSlice_t *slice)
+{
+    uint64_t end = (slice->seq + 1 < file->slice_count) ?
+        file->gz_index->points[slice->seq + 1].out : UINT64_MAX;
+
+    return seekGzipSliceStream(slice->stream, file->path, file->gz_index, slice->seq, end);
+}
+
+/****
+ *
+ * Check whether a slice can take a parser now (caller holds the lock)
+ *
+ ****/
+PRIVATE int ingestSliceRunnable(const IngestContext_t *ctx, const IngestFile_t *file,
+                                const IngestSlice_t *slice)
+{
+    if (slice->busy || slice->eof) {
+        return FALSE;
+    }
+
+    /* A plain stream parses ahead a few chunks, bounded per file */
+    if (!file->gz_index) {
+        return (slice->ready_count < INGEST_CHUNKS_PER_FILE);
+    }
+
+    /* Indexed slices run to completion, bounded by the window instead */
+    if (slice->seq >= file->current_slice + ctx->window) {
+        return FALSE;
+    }
+    return (slice->started || ctx->reader_count > 0);
+}
+
+#ifdef HAVE_PTHREAD_H
+/****
+ *
+ * Pick the slice a parser thread should work on next
+ *
+ * DESCRIPTION:
+ *   Serves the slice the merger is waiting on first, then the runnable
+ *   slice with the fewest parsed chunks queued (earliest first on ties).
+ *   Caller holds the lock.
+ *
+ * PARAMETERS:
+ *   ctx - Ingest context
+ *   file_out - Receives the file the slice belongs to
+ *
+ * RETURNS:
+ *   Slice to parse, or NULL if nothing currently needs a parser
+ *
+ ****/
+PRIVATE IngestSlice_t *pickIngestSlice(IngestContext_t *ctx, IngestFile_t **file_out)
+{
+    IngestSlice_t *best = NULL;
+    IngestFile_t *best_file = NULL;
+    uint32_t s, last;
+    int i;
+
+    if (!ctx->free_list) {
+        return NULL;
+    }
+
+    for (i = 0; i < ctx->file_count; i++) {
+        IngestFile_t *file = &ctx->files[i];
+
+        last = file->current_slice + ctx->window;
+        if (last > file->slice_count) {
+            last = file->slice_count;
+        }
+        for (s = file->current_slice; s < last; s++) {
+            IngestSlice_t *slice = &file->slices[s];
+
+            if (!ingestSliceRunnable(ctx, file, slice)) {
+                continue;
+            }
+            if (slice == ctx->wanted) {
+                *file_out = file;
+                return slice;
+            }
+            if (!best || slice->ready_count < best->ready_count) {
+                best = slice;
+                best_file = file;
+            }
+        }
+    }
+
+    *file_out = best_file;
+    return best;
+}
+
+/****
+ *
+ * Parser thread
+ *
+ * DESCRIPTION:
+ *   Repeatedly takes a free chunk for the neediest slice, fills it outside
+ *   the lock and queues it for the merger. Any thread may continue any
+ *   slice, so a bounded number of threads serves any number of inputs
+ *   without the merger ever waiting on a slice nobody is parsing.
+ *
+ * PARAMETERS:
+ *   arg - IngestContext_t
+ *
+ * RETURNS:
+ *   NULL
+ *
+ ****/
+PRIVATE void *ingestWorker(void *arg)
+{
+    IngestContext_t *ctx = (IngestContext_t *)arg;
+    IngestFile_t *file;
+    IngestSlice_t *slice;
+    IngestChunk_t *chunk;
+    int eof, position;
+
+    pthread_mutex_lock(&ctx->lock);
+    while (!ctx->shutdown) {
+        slice = pickIngestSlice(ctx, &file);
+        if (!slice) {
+            /* Nothing to do - exit once every slice is done */
+            if (ctx->slices_open == 0) {
+                break;
+            }
+            pthread_cond_wait(&ctx->work_cond, &ctx->lock);
+            continue;
+        }
+
+        position = FALSE;
+        if (!slice->started) {
+            claimIngestReader(ctx, slice);
+            position = TRUE;
+        }
+        slice->busy = TRUE;
+        chunk = ctx->free_list;
+        ctx->free_list = chunk->next;
+        pthread_mutex_unlock(&ctx->lock);
+
+        if (position && !positionIngestSlice(file, slice)) {
+            chunk->count = 0;
+            eof = TRUE;
+            pthread_mutex_lock(&ctx->lock);
+            ctx->failed = TRUE;
+        } else {
+            eof = fillIngestChunk(file, slice, chunk);
+            pthread_mutex_lock(&ctx->lock);
+            if (slice->stream->read_error) {
+                ctx->failed = TRUE;
+            }
+        }
+
+        slice->busy = FALSE;
+        queueIngestChunk(ctx, file, slice, chunk, eof);
+        pthread_cond_broadcast(&ctx->ready_cond);
+        if (eof) {
+            /* A reader went back to the pool */
+            pthread_cond_broadcast(&ctx->work_cond);
+        }
+    }
+    pthread_mutex_unlock(&ctx->lock);
+
+    return NULL;
+}
+#endif
+
+/****
+ *
+ * Take the next ready chunk of a file (caller holds the lock in threaded mode)
+ *
+ * DESCRIPTION:
+ *   Moves past finished slices in order. Slice contents are consumed in
+ *   file order, so an indexed file is merged exactly as if it had been read
+ *   sequentially.
+ *
+ * RETURNS:
+ *   TRUE if a chunk was taken or the file is finished, FALSE if the merger
+ *   must wait for the current slice
+ *
+ ****/
+PRIVATE int takeIngestChunk(IngestFile_t *file, IngestChunk_t **chunk_out)
+{
+    IngestSlice_t *slice;
+    IngestChunk_t *chunk;
+
+    for (;;) {
+        slice = &file->slices[file->current_slice];
+        chunk = slice->ready_head;
+        if (chunk) {
+            slice->ready_head = chunk->next;
+            if (!slice->ready_head) {
+                slice->ready_tail = NULL;
+            }
+            slice->ready_count--;
+            *chunk_out = chunk;
+            return TRUE;
+        }
+        if (!slice->eof) {
+            return FALSE;
+        }
+        if (file->current_slice + 1 == file->slice_count) {
+            *chunk_out = NULL;
+            return TRUE;
+        }
+        file->current_slice++;
+    }
+}
+
+/****
+ *
+ * Advance the merger to the next parsed chunk of a file
+ *
+ * DESCRIPTION:
+ *   Returns the current chunk (if any) to the free list and waits for the
+ *   next chunk in file order. While waiting, the merger adds chunks to the
+ *   pool if parsers have run out. Without threads the chunk is parsed
+ *   inline.
+ *
+ * PARAMETERS:
+ *   ctx - Ingest context
+ *   file - File to advance
+ *
+ * RETURNS:
+ *   TRUE if file->current holds new events, FALSE when the file is finished
+ *
+ ****/
+PRIVATE int nextIngestChunk(IngestContext_t *ctx, IngestFile_t *file)
+{
+    IngestChunk_t *chunk = NULL;
+    IngestSlice_t *slice;
+    uint32_t seq;
+    int eof;
+
+#ifdef HAVE_PTHREAD_H
+    if (ctx->threaded) {
+        pthread_mutex_lock(&ctx->lock);
+        if (file->current) {
+            file->current->next = ctx->free_list;
+            ctx->free_list = file->current;
+            file->current = NULL;
+            pthread_cond_signal(&ctx->work_cond);
+        }
+        seq = file->current_slice;
+        while (!takeIngestChunk(file, &chunk)) {
+            ctx->wanted = &file->slices[file->current_slice];
+            if (!ctx->free_list) {
+                addIngestChunks(ctx, (size_t)ctx->window);
+            }
+            pthread_cond_broadcast(&ctx->work_cond);
+            pthread_cond_wait(&ctx->ready_cond, &ctx->lock);
+        }
+        ctx->wanted = NULL;
+        if (file->current_slice != seq) {
+            /* The parse-ahead window moved */
+            pthread_cond_broadcast(&ctx->work_cond);
+        }
+        pthread_mutex_unlock(&ctx->lock);
+
+        file->current = chunk;
+        file->pos = 0;
+
+        return (chunk != NULL);
+    }
+#endif
+
+    /* Single-threaded: parse on demand */
+    if (file->current) {
+        file->current->next = ctx->free_list;
+        ctx->free_list = file->current;
+        file->current = NULL;
+    }
+    while (!takeIngestChunk(file, &chunk)) {
+        slice = &file->slices[file->current_slice];
+        if (!ctx->free_list) {
+            addIngestChunks(ctx, 1);
+        }
+        chunk = ctx->free_list;
+        ctx->free_list = chunk->next;
+        if (!slice->started) {
+            claimIngestReader(ctx, slice);
+            if (!positionIngestSlice(file, slice)) {
+                ctx->failed = TRUE;
+                chunk->count = 0;
+                queueIngestChunk(ctx, file, slice, chunk, TRUE);
+                continue;
+            }
+        }
+        eof = fillIngestChunk(file, slice, chunk);
+        if (slice->stream->read_error) {
+            ctx->failed = TRUE;
+        }
+        queueIngestChunk(ctx, file, slice, chunk, eof);
+    }
+
+    file->current = chunk;
+    file->pos = 0;
+
+    return (chunk != NULL);
+}
+
+/****
+ *
+ * Compare the head events of two files for the merge heap
+ *
+ * RETURNS:
+ *   TRUE if a should be emitted before b
+ *
+ ****/
+PRIVATE int ingestHeadBefore(const IngestFile_t *a, const IngestFile_t *b)
+{
+    const HoneypotEvent_t *ea = &a->current->events[a->pos];
+    const HoneypotEvent_t *eb = &b->current->events[b->pos];
+
+    if (ea->timestamp != eb->timestamp) {
+        return (ea->timestamp < eb->timestamp);
+    }
+    if (ea->timestamp_us != eb->timestamp_us) {
+        return (ea->timestamp_us < eb->timestamp_us);
+    }
+
+    /* Stable across files: earlier input first */
+    return (a->index < b->index);
+}
+
+/****
+ *
+ * Restore heap order below position i
+ *
+ ****/
+PRIVATE void ingestSiftDown(IngestFile_t **heap, size_t count, size_t i)
+{
+    IngestFile_t *tmp;
+    size_t child;
+
+    for (;;) {
+        child = (2 * i) + 1;
+        if (child >= count) {
+            break;
+        }
+        if (child + 1 < count && ingestHeadBefore(heap[child + 1], heap[child])) {
+            child++;
+        }
+        if (!ingestHeadBefore(heap[child], heap[i])) {
+            break;
+        }
+        tmp = heap[i];
+        heap[i] = heap[child];
+        heap[child] = tmp;
+        i = child;
+    }
+}
+
+/****
+ *
+ * Set up the slices of one input file
+ *
+ * DESCRIPTION:
+ *   Large gzip files are split at the access points of their index (built
+ *   on first use and kept in a sidecar file) when more than one parser
+ *   thread is available. Everything else is streamed as a single slice.
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if the file could not be opened
+ *
+ ****/
+PRIVATE int openIngestFile(IngestFile_t *file, int jobs)
+{
+    struct stat st;
+    uint32_t s;
+
+    if (jobs > 1 && stat(file->path, &st) == 0 &&
+        (uint64_t)st.st_size >= (uint64_t)GZINDEX_MIN_FILE_SIZE) {
+        file->gz_index = getGzIndex(file->path);
+        if (file->gz_index && file->gz_index->count < 2) {
+            /* Too small to split */
+            freeGzIndex(file->gz_index);
+            file->gz_index = NULL;
+        }
+    }
+
+    if (file->gz_index) {
+        file->slice_count = file->gz_index->count;
+        file->slices = (IngestSlice_t *)XMALLOC((int)(sizeof(IngestSlice_t) * file->slice_count));
+        XMEMSET(file->slices, 0, (int)(sizeof(IngestSlice_t) * file->slice_count));
+        for (s = 0; s < file->slice_count; s++) {
+            file->slices[s].seq = s;
+        }
+        resetParserStats(&file->stats);
+        return TRUE;
+    }
+
+    file->slice_count = 1;
+    file->slices = (IngestSlice_t *)XMALLOC(sizeof(IngestSlice_t));
+    XMEMSET(file->slices, 0, sizeof(IngestSlice_t));
+    file->slices[0].stream = openGzipStream(file->path);
+    file->slices[0].started = TRUE;
+
+    return (file->slices[0].stream != NULL);
+}
+
+/****
+ *
+ * Parse several log files in parallel and merge them by timestamp
+ *
+ * DESCRIPTION:
+ *   Opens every file, starts up to `jobs` parser threads and merges the
+ *   parsed event streams with a k-way min-heap keyed on (timestamp,
+ *   microseconds, input position). Merged events are handed to the batch
+ *   callback on the calling thread, LOG_PARSER_BATCH_SIZE at a time, so
+ *   the callback needs no locking. Files that overlap in time are
+ *   interleaved correctly; files that do not overlap come out in the same
+ *   order as processing them one after another. Each file is merged in its
+ *   own line order (the head of a file is not re-sorted within the file).
+ *
+ *   Gzip files of at least GZINDEX_MIN_FILE_SIZE bytes are split into
+ *   slices at indexed deflate block boundaries, so several threads can
+ *   decompress and parse one large file. Slices are reassembled in file
+ *   order before merging, so the result is identical to a sequential read.
+ *
+ * PARAMETERS:
+ *   file_paths - Input files (in preferred tie-break order)
+ *   file_count - Number of input files
+ *   jobs - Parser threads to use (1 = parse inline on the calling thread)
+ *   batch_callback - Function called for each merged batch (return FALSE to stop)
+ *   user_data - Opaque pointer passed to callback
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on open or read error or callback abort
+ *
+ * SIDE EFFECTS:
+ *   May create <file>.tpidx index files next to large inputs
+ *   Prints per-file parser statistics once all threads have finished
+ *
+ ****/
+int ingestFilesMerged(char **file_paths, int file_count, int jobs,
+                      int (*batch_callback)(const HoneypotEvent_t *events, size_t count, void *user_data),
+                      void *user_data)
+{
+    IngestContext_t ctx;
+    IngestFile_t **heap = NULL;
+    HoneypotEvent_t *batch = NULL;
+    IngestChunk_t *chunk;
+    size_t batch_count = 0;
+    size_t heap_count = 0;
+    size_t total_slices = 0;
+    size_t h;
+    int result = TRUE;
+    int opened = 0;
+    int indexed = 0;
+    int i;
+    uint32_t s;
+#ifdef HAVE_PTHREAD_H
+    pthread_t *threads = NULL;
+    int thread_count = 0;
+#endif
+
+    if (!file_paths || file_count <= 0 || !batch_callback) {
+        return FALSE;
+    }
+
+    /* Allocation happens here, before any parser thread starts */
+    XMEMSET(&ctx, 0, sizeof(ctx));
+    ctx.file_count = file_count;
+    ctx.files = (IngestFile_t *)XMALLOC((int)(sizeof(IngestFile_t) * (size_t)file_count));
+    XMEMSET(ctx.files, 0, sizeof(IngestFile_t) * (size_t)file_count);
+
+    for (i = 0; i < file_count; i++) {
+        IngestFile_t *file = &ctx.files[i];
+
+        file->path = file_paths[i];
+        file->index = i;
+        opened++;
+        if (!openIngestFile(file, jobs)) {
+            fprintf(stderr, "ERR - Failed to open file: %s\n", file_paths[i]);
+            result = FALSE;
+            break;
+        }
+        if (file->gz_index) {
+            indexed++;
+        }
+        total_slices += file->slice_count;
+    }
+
+    if (result) {
+        if ((size_t)jobs > total_slices) {
+            jobs = (int)total_slices;
+        }
+        ctx.window = (uint32_t)jobs + 1;
+        ctx.slices_open = total_slices;
+
+        /*
+         * Every indexed file's current slice may hold a reader while the
+         * rest of the window is parsed ahead, so the pool covers both.
+         */
+        ctx.reader_total = (indexed > 0) ? (int)ctx.window + indexed : 0;
+        if (ctx.reader_total > 0) {
+            ctx.readers = (GzipStream_t **)XMALLOC((int)(sizeof(GzipStream_t *) * (size_t)ctx.reader_total));
+            for (i = 0; i < ctx.reader_total; i++) {
+                ctx.readers[i] = openGzipSliceStream();
+                if (!ctx.readers[i]) {
+                    fprintf(stderr, "ERR - Unable to initialize gzip reader\n");
+                    result = FALSE;
+                    break;
+                }
+                ctx.reader_count++;
+            }
+        }
+
+        addIngestChunks(&ctx, (size_t)file_count * INGEST_CHUNKS_PER_FILE);
+        heap = (IngestFile_t **)XMALLOC((int)(sizeof(IngestFile_t *) * (size_t)file_count));
+        batch = (HoneypotEvent_t *)XMALLOC((int)(sizeof(HoneypotEvent_t) * LOG_PARSER_BATCH_SIZE));
+    }
+
+    if (result) {
+#ifdef HAVE_PTHREAD_H
+        if (jobs > 1) {
+            pthread_mutex_init(&ctx.lock, NULL);
+            pthread_cond_init(&ctx.work_cond, NULL);
+            pthread_cond_init(&ctx.ready_cond, NULL);
+            ctx.threaded = TRUE;
+
+            threads = (pthread_t *)XMALLOC((int)(sizeof(pthread_t) * (size_t)jobs));
+            for (i = 0; i < jobs; i++) {
+                if (pthread_create(&threads[i], NULL, ingestWorker, &ctx) != 0) {
+                    fprintf(stderr, "WARN - Failed to start parser thread %d, continuing with %d\n",
+                            i + 1, thread_count);
+                    break;
+                }
+                thread_count++;
+            }
+            if (thread_count == 0) {
+                ctx.threaded = FALSE;
+            }
+        }
+#endif
+
+#ifdef DEBUG
+        if (config->debug >= 1) {
+#ifdef HAVE_PTHREAD_H
+            fprintf(stderr, "DEBUG - Merging %d files (%lu slices) with %d parser threads\n",
+                    file_count, (unsigned long)total_slices, thread_count);
+#else
+            fprintf(stderr, "DEBUG - Merging %d files without threads\n", file_count);
+#endif
+        }
+#endif
+
+        /* Prime the heap with the first chunk of every file */
+        for (i = 0; i < file_count; i++) {
+            if (nextIngestChunk(&ctx, &ctx.files[i])) {
+                heap[heap_count++] = &ctx.files[i];
+            }
+        }
+        for (h = heap_count / 2; h > 0; h--) {
+            ingestSiftDown(heap, heap_count, h - 1);
+        }
+
+        /* K-way merge */
+        while (heap_count > 0) {
+            IngestFile_t *file = heap[0];
+
+            batch[batch_count++] = file->current->events[file->pos++];
+            if (batch_count == LOG_PARSER_BATCH_SIZE) {
+                if (!batch_callback(batch, batch_count, user_data)) {
+                    result = FALSE;
+                    batch_count = 0;
+                    break;
+                }
+                batch_count = 0;
+            }
+
+            if (file->pos == file->current->count && !nextIngestChunk(&ctx, file)) {
+                heap[0] = heap[--heap_count];
+            }
+            ingestSiftDown(heap, heap_count, 0);
+        }
+
+        /* Deliver the partial final batch */
+        if (result && batch_count > 0 && !batch_callback(batch, batch_count, user_data)) {
+            result = FALSE;
+        }
+    }
+
+#ifdef HAVE_PTHREAD_H
+    if (ctx.threaded) {
+        pthread_mutex_lock(&ctx.lock);
+        ctx.shutdown = TRUE;
+        pthread_cond_broadcast(&ctx.work_cond);
+        pthread_mutex_unlock(&ctx.lock);
+
+        for (i = 0; i < thread_count; i++) {
+            pthread_join(threads[i], NULL);
+        }
+
+        pthread_cond_destroy(&ctx.ready_cond);
+        pthread_cond_destroy(&ctx.work_cond);
+        pthread_mutex_destroy(&ctx.lock);
+    }
+    if (threads) {
+        XFREE(threads);
+    }
+#endif
+
+    if (ctx.failed) {
+        fprintf(stderr, "ERR - Failed to read part of the input, results are incomplete\n");
+        result = FALSE;
+    }
+
+    /* Statistics and cleanup, in input order */
+    for (i = 0; i < opened; i++) {
+        IngestFile_t *file = &ctx.files[i];
+
+        if (file->gz_index) {
+            if (result) {
+                fprintf(stderr, "\n%s (%u slices):", file->path, file->slice_count);
+                printParserStats(&file->stats);
+            }
+            for (s = 0; s < file->slice_count; s++) {
+                if (file->slices[s].stream) {
+                    /* Abandoned mid-slice */
+                    ctx.readers[ctx.reader_count++] = file->slices[s].stream;
+                }
+            }
+            freeGzIndex(file->gz_index);
+        } else if (file->slices) {
+            if (result) {
+                fprintf(stderr, "\n%s:", file->path);
+                printParserStats(&file->slices[0].stream->stats);
+            }
+            if (file->slices[0].stream) {
+                closeGzipStream(file->slices[0].stream);
+            }
+        }
+        if (file->slices) {
+            XFREE(file->slices);
+        }
+    }
+
+    for (i = 0; i < ctx.reader_count; i++) {
+        closeGzipStream(ctx.readers[i]);
+    }
+    if (ctx.readers) {
+        XFREE(ctx.readers);
+    }
+
+    while (ctx.all_chunks) {
+        chunk = ctx.all_chunks;
+        ctx.all_chunks = chunk->all_next;
+        XFREE(chunk->events);
+        XFREE(chunk);
+    }
+
+    if (batch) {
+        XFREE(batch);
+    }
+    if (heap) {
+        XFREE(heap);
+    }
+    XFREE(ctx.files);
+
+    return result;
+}
@@ -0,0 +1,66 @@
+/*****
+ *
+ * Description: Parallel Multi-File Ingest Headers
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#ifndef INGEST_DOT_H
+#define INGEST_DOT_H
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "../include/sysdep.h"
+
+#ifndef __SYSDEP_H__
+#error something is messed up
+#endif
+
+#include "../include/common.h"
+#include "log_parser.h"
+
+/****
+ *
+ * defines
+ *
+ ****/
+
+#define INGEST_JOBS_MAX 64                          // Upper bound for -j
+#define INGEST_CHUNK_EVENTS LOG_PARSER_BATCH_SIZE   // Events per parsed chunk
+#define INGEST_CHUNKS_PER_FILE 4                    // Parsed chunks buffered per file
+
+/****
+ *
+ * function prototypes
+ *
+ ****/
+
+int getIngestJobs(int requested);
+int ingestFilesMerged(char **file_paths, int file_count, int jobs,
+                      int (*batch_callback)(const HoneypotEvent_t *events, size_t count, void *user_data),
+                      void *user_data);
+
+#endif /* INGEST_DOT_H */
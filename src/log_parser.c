@@ -27,12 +27,39 @@
  ****/
 
 #include "log_parser.h"
+#include "gzring.h"
+#include "decompress.h"
 #include "mem.h"
 #include "util.h"
 #include <string.h>
 #include <stdlib.h>
 #include <arpa/inet.h>
 #include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
+/* Per-thread state for the parallel ingest path */
+#ifdef __GNUC__
+# define LOG_PARSER_TLS __thread
+#else
+# define LOG_PARSER_TLS
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# if defined(__SSE2__) && defined(HAVE_EMMINTRIN_H)
+#  include <emmintrin.h>
+#  define LOG_PARSER_HAVE_SSE2 1
+# endif
+# ifdef HAVE_IMMINTRIN_H
+#  include <immintrin.h>
+#  define LOG_PARSER_HAVE_AVX2 1
+# endif
+#endif
 
 /****
  *
@@ -42,6 +69,12 @@
 
 PRIVATE int parser_initialized = FALSE;
 
+/* Field anchor scanner, picked for the running CPU by initLogParser() */
+PRIVATE void selectAnchorScanner(void);
+PRIVATE int scanAnchorsScalar(const char *line, size_t len, LineAnchors_t *anchors);
+PRIVATE int (*scan_anchors)(const char *line, size_t len, LineAnchors_t *anchors) = scanAnchorsScalar;
+PRIVATE const char *scan_anchors_name = "scalar";
+
 /****
  *
  * external variables
@@ -61,7 +94,9 @@ extern Config_t *config;
  * Initialize log parser
  *
  * DESCRIPTION:
- *   Sets parser initialization flag. Idempotent (safe to call multiple times).
+ *   Sets parser initialization flag and picks the field anchor scanner.
+ *   Idempotent (safe to call multiple times). Must run before any thread
+ *   parses lines; until then lines are scanned with the scalar scanner.
  *
  * RETURNS:
  *   TRUE
@@ -74,10 +109,11 @@ int initLogParser(void)
     }
 
     parser_initialized = TRUE;
+    selectAnchorScanner();
 
 #ifdef DEBUG
     if (config->debug >= 1) {
-        fprintf(stderr, "DEBUG - Log parser initialized\n");
+        fprintf(stderr, "DEBUG - Log parser initialized (%s field scanner)\n", scan_anchors_name);
     }
 #endif
 
@@ -198,13 +234,14 @@ const char *findIPv4Protocol(const char *line)
 
 /****
  *
- * Parse timestamp from PacketTime field
+ * Parse timestamp with sscanf() and mktime()
  *
  * DESCRIPTION:
- *   Parses "PacketTime:YYYY-MM-DD HH:MM:SS.microseconds" format.
+ *   General (slow) path for timestamps the fixed-width parser does not
+ *   accept, and for days that contain a DST transition.
  *
  * PARAMETERS:
- *   time_str - Timestamp string (with or without "PacketTime:" prefix)
+ *   time_str - Timestamp string without "PacketTime:" prefix
  *   timestamp - Output Unix timestamp
  *   microseconds - Output microseconds
  *
@@ -212,20 +249,11 @@ const char *findIPv4Protocol(const char *line)
  *   TRUE on success, FALSE on parse failure
  *
  ****/
-int parseTimestamp(const char *time_str, time_t *timestamp, uint32_t *microseconds)
+PRIVATE int parseTimestampSlow(const char *time_str, time_t *timestamp, uint32_t *microseconds)
 {
     struct tm tm_info;
     int year, month, day, hour, min, sec, usec;
 
-    if (!time_str || !timestamp || !microseconds) {
-        return FALSE;
-    }
-
-    /* Skip "PacketTime:" prefix if present */
-    if (strncmp(time_str, "PacketTime:", 11) == 0) {
-        time_str += 11;
-    }
-
     /* Parse: YYYY-MM-DD HH:MM:SS.microseconds */
     int parsed = sscanf(time_str, "%d-%d-%d %d:%d:%d.%d",
                         &year, &month, &day, &hour, &min, &sec, &usec);
@@ -257,6 +285,212 @@ int parseTimestamp(const char *time_str, time_t *timestamp, uint32_t *microsecon
     return TRUE;
 }
 
+/****
+ *
+ * Look up local midnight for a calendar day
+ *
+ * DESCRIPTION:
+ *   Returns the epoch of local midnight for the given day, caching the
+ *   most recent day (per thread) so consecutive lines need no mktime() call. A day is
+ *   only cached as "uniform" when 23:59:59 is exactly 86399 seconds after
+ *   midnight, i.e. the UTC offset does not change during the day.
+ *
+ * PARAMETERS:
+ *   year, month, day - Calendar date (validated by caller)
+ *   midnight - Output epoch of local midnight
+ *
+ * RETURNS:
+ *   TRUE if the day is uniform and midnight can be used as a base,
+ *   FALSE if the caller must fall back to mktime() (DST day or error)
+ *
+ ****/
+PRIVATE int getDayEpoch(int year, int month, int day, time_t *midnight)
+{
+    static LOG_PARSER_TLS int cached_key = -1;
+    static LOG_PARSER_TLS time_t cached_midnight = 0;
+    static LOG_PARSER_TLS int cached_uniform = FALSE;
+    struct tm tm_info;
+    time_t start, end;
+    int key = (year * 10000) + (month * 100) + day;
+
+    if (key != cached_key) {
+        memset(&tm_info, 0, sizeof(struct tm));
+        tm_info.tm_year = year - 1900;
+        tm_info.tm_mon = month - 1;
+        tm_info.tm_mday = day;
+        tm_info.tm_isdst = -1;
+        start = mktime(&tm_info);
+
+        memset(&tm_info, 0, sizeof(struct tm));
+        tm_info.tm_year = year - 1900;
+        tm_info.tm_mon = month - 1;
+        tm_info.tm_mday = day;
+        tm_info.tm_hour = 23;
+        tm_info.tm_min = 59;
+        tm_info.tm_sec = 59;
+        tm_info.tm_isdst = -1;
+        end = mktime(&tm_info);
+
+        cached_key = key;
+        cached_midnight = start;
+        cached_uniform = (start != (time_t)-1 && end != (time_t)-1 &&
+                          end - start == 86399) ? TRUE : FALSE;
+    }
+
+    *midnight = cached_midnight;
+
+    return cached_uniform;
+}
+
+/****
+ *
+ * Parse timestamp from a length-bounded PacketTime field
+ *
+ * DESCRIPTION:
+ *   Parses "PacketTime:YYYY-MM-DD HH:MM:SS.microseconds" format without
+ *   reading past len bytes (the input need not be NUL-terminated).
+ *   The fixed-width layout written by the sensor is decoded digit by digit
+ *   and added to a cached local-midnight epoch, so most lines need no libc
+ *   time call. Anything else (other widths, out-of-range fields, days with
+ *   a DST transition) goes through the sscanf()/mktime() path.
+ *
+ * PARAMETERS:
+ *   time_str - Timestamp bytes (with or without "PacketTime:" prefix)
+ *   len - Number of bytes available at time_str
+ *   timestamp - Output Unix timestamp
+ *   microseconds - Output microseconds
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on parse failure
+ *
+ ****/
+int parseTimestampLen(const char *time_str, size_t len, time_t *timestamp, uint32_t *microseconds)
+{
+    static const int days_in_month[12] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    const char *p;
+    char slow_buf[64];
+    size_t i;
+    int year, month, day, hour, min, sec;
+    uint32_t usec = 0;
+    time_t midnight;
+
+    if (!time_str || !timestamp || !microseconds) {
+        return FALSE;
+    }
+
+    /* Skip "PacketTime:" prefix if present */
+    if (len >= 11 && memcmp(time_str, "PacketTime:", 11) == 0) {
+        time_str += 11;
+        len -= 11;
+    }
+
+    p = time_str;
+
+#define TS_DIGIT(c) ((unsigned int)((c) - '0') <= 9)
+#define TS_2(s) (((s)[0] - '0') * 10 + ((s)[1] - '0'))
+
+    /* Fixed layout: YYYY-MM-DD HH:MM:SS */
+    if (len < 19) {
+        goto slow_path;
+    }
+    for (i = 0; i < 19; i++) {
+        if (i == 4 || i == 7) {
+            if (p[i] != '-') break;
+        } else if (i == 10) {
+            if (p[i] != ' ') break;
+        } else if (i == 13 || i == 16) {
+            if (p[i] != ':') break;
+        } else if (!TS_DIGIT(p[i])) {
+            break;
+        }
+    }
+    if (i < 19) {
+        goto slow_path;
+    }
+
+    year = (TS_2(p) * 100) + TS_2(p + 2);
+    month = TS_2(p + 5);
+    day = TS_2(p + 8);
+    hour = TS_2(p + 11);
+    min = TS_2(p + 14);
+    sec = TS_2(p + 17);
+
+    /* Seconds wider than two digits are read whole by sscanf() */
+    if (len > 19 && TS_DIGIT(p[19])) {
+        goto slow_path;
+    }
+
+    /* Optional fraction - value of the digits, as sscanf("%d") reads it */
+    if (len > 19 && p[19] == '.') {
+        if (len == 20 || !TS_DIGIT(p[20])) {
+            goto slow_path;
+        }
+        for (i = 20; i < len && TS_DIGIT(p[i]); i++) {
+            if (i >= 29) {
+                /* Too many digits for a 32-bit value, let sscanf decide */
+                goto slow_path;
+            }
+            usec = (usec * 10) + (uint32_t)(p[i] - '0');
+        }
+    }
+
+#undef TS_2
+#undef TS_DIGIT
+
+    /* Out-of-range fields are normalized by mktime(), leave them to it */
+    if (month < 1 || month > 12 || day < 1 || day > days_in_month[month - 1] ||
+        (month == 2 && day == 29 &&
+         !((year % 4 == 0 && year % 100 != 0) || year % 400 == 0)) ||
+        hour > 23 || min > 59 || sec > 59) {
+        goto slow_path;
+    }
+
+    if (!getDayEpoch(year, month, day, &midnight)) {
+        goto slow_path;
+    }
+
+    *timestamp = midnight + (time_t)((hour * 3600) + (min * 60) + sec);
+    *microseconds = usec;
+
+    return TRUE;
+
+slow_path:
+    /* sscanf() needs a terminated string - copy the (short) field */
+    if (len > sizeof(slow_buf) - 1) {
+        len = sizeof(slow_buf) - 1;
+    }
+    memcpy(slow_buf, time_str, len);
+    slow_buf[len] = '\0';
+
+    return parseTimestampSlow(slow_buf, timestamp, microseconds);
+}
+
+/****
+ *
+ * Parse timestamp from PacketTime field
+ *
+ * DESCRIPTION:
+ *   Parses "PacketTime:YYYY-MM-DD HH:MM:SS.microseconds" format from a
+ *   NUL-terminated string. See parseTimestampLen().
+ *
+ * PARAMETERS:
+ *   time_str - Timestamp string (with or without "PacketTime:" prefix)
+ *   timestamp - Output Unix timestamp
+ *   microseconds - Output microseconds
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on parse failure
+ *
+ ****/
+int parseTimestamp(const char *time_str, time_t *timestamp, uint32_t *microseconds)
+{
+    if (!time_str) {
+        return FALSE;
+    }
+
+    return parseTimestampLen(time_str, strlen(time_str), timestamp, microseconds);
+}
+
 /****
  *
  * Extract IP:port from string
@@ -322,38 +556,300 @@ int extractIPPort(const char *str, char *ip_buf, int ip_buf_size, uint16_t *port
     return (ip_len > 0);
 }
 
+/****
+ *
+ * Check a candidate byte for a field anchor
+ *
+ * DESCRIPTION:
+ *   Called by the anchor scanners for every 'P', 'I' or '>' byte. Verifies
+ *   the full "PacketTime:", "IPv4/" or " -> " token at that position and
+ *   records the first occurrence of each. The arrow only counts once it
+ *   follows the protocol token, as the source address sits in between.
+ *
+ * PARAMETERS:
+ *   line - Line bytes
+ *   len - Line length
+ *   pos - Offset of the candidate byte
+ *   anchors - Anchor offsets found so far (updated)
+ *
+ * RETURNS:
+ *   TRUE once all three anchors are known, FALSE otherwise
+ *
+ ****/
+PRIVATE int checkAnchor(const char *line, size_t len, size_t pos, LineAnchors_t *anchors)
+{
+    switch (line[pos]) {
+    case 'P':
+        if (!anchors->packet_time && len - pos >= 11 &&
+            memcmp(line + pos, "PacketTime:", 11) == 0) {
+            anchors->packet_time = line + pos;
+        }
+        break;
+    case 'I':
+        if (!anchors->ipv4 && len - pos >= 5 &&
+            memcmp(line + pos, "IPv4/", 5) == 0) {
+            anchors->ipv4 = line + pos;
+        }
+        break;
+    case '>':
+        if (!anchors->arrow && anchors->ipv4 && pos >= 2 && pos + 1 < len &&
+            line[pos - 2] == ' ' && line[pos - 1] == '-' && line[pos + 1] == ' ' &&
+            line + pos - 2 >= anchors->ipv4 + 8) {
+            anchors->arrow = line + pos - 2;
+        }
+        break;
+    default:
+        break;
+    }
+
+    return (anchors->packet_time && anchors->ipv4 && anchors->arrow);
+}
+
+/****
+ *
+ * Scalar field anchor scanner
+ *
+ * DESCRIPTION:
+ *   Byte-at-a-time anchor scan from offset start to the end of the line.
+ *   Used on targets without SIMD and for the tail of the vector scanners.
+ *
+ * PARAMETERS:
+ *   line - Line bytes
+ *   len - Line length
+ *   start - Offset to start scanning at
+ *   anchors - Anchor offsets (updated)
+ *
+ * RETURNS:
+ *   TRUE if all anchors were found, FALSE otherwise
+ *
+ ****/
+PRIVATE int scanAnchorsFrom(const char *line, size_t len, size_t start, LineAnchors_t *anchors)
+{
+    size_t i;
+
+    for (i = start; i < len; i++) {
+        char c = line[i];
+        if ((c == 'P' || c == 'I' || c == '>') && checkAnchor(line, len, i, anchors)) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+PRIVATE int scanAnchorsScalar(const char *line, size_t len, LineAnchors_t *anchors)
+{
+    return scanAnchorsFrom(line, len, 0, anchors);
+}
+
+#ifdef LOG_PARSER_HAVE_SSE2
+/****
+ *
+ * SSE2 field anchor scanner
+ *
+ * DESCRIPTION:
+ *   Compares 16 bytes at a time against 'P', 'I' and '>' and only visits
+ *   the matching positions. Loads never cross len; the remainder of the
+ *   line is handled by the scalar scanner.
+ *
+ ****/
+PRIVATE int scanAnchorsSSE2(const char *line, size_t len, LineAnchors_t *anchors)
+{
+    const __m128i want_p = _mm_set1_epi8('P');
+    const __m128i want_i = _mm_set1_epi8('I');
+    const __m128i want_gt = _mm_set1_epi8('>');
+    size_t i;
+
+    for (i = 0; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(const void *)(line + i));
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, want_p),
+                                                 _mm_cmpeq_epi8(v, want_i)),
+                                    _mm_cmpeq_epi8(v, want_gt));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(hits);
+
+        while (mask) {
+            if (checkAnchor(line, len, i + (size_t)__builtin_ctz(mask), anchors)) {
+                return TRUE;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    return scanAnchorsFrom(line, len, i, anchors);
+}
+#endif
+
+#ifdef LOG_PARSER_HAVE_AVX2
+/****
+ *
+ * AVX2 field anchor scanner
+ *
+ * DESCRIPTION:
+ *   32-byte variant of scanAnchorsSSE2(). Compiled for AVX2 with a target
+ *   attribute and only selected when the CPU reports AVX2 support.
+ *
+ ****/
+__attribute__((target("avx2")))
+PRIVATE int scanAnchorsAVX2(const char *line, size_t len, LineAnchors_t *anchors)
+{
+    const __m256i want_p = _mm256_set1_epi8('P');
+    const __m256i want_i = _mm256_set1_epi8('I');
+    const __m256i want_gt = _mm256_set1_epi8('>');
+    size_t i;
+
+    for (i = 0; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(const void *)(line + i));
+        __m256i hits = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, want_p),
+                                                       _mm256_cmpeq_epi8(v, want_i)),
+                                       _mm256_cmpeq_epi8(v, want_gt));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(hits);
+
+        while (mask) {
+            if (checkAnchor(line, len, i + (size_t)__builtin_ctz(mask), anchors)) {
+                return TRUE;
+            }
+            mask &= mask - 1;
+        }
+    }
+
+    return scanAnchorsFrom(line, len, i, anchors);
+}
+#endif
+
+/****
+ *
+ * Pick the field anchor scanner for this CPU
+ *
+ * DESCRIPTION:
+ *   Selects AVX2 when the CPU supports it, else SSE2 where compiled in,
+ *   else the scalar scanner. Called once from initLogParser() while
+ *   the program is still single-threaded, so parsing threads only ever
+ *   read scan_anchors.
+ *
+ ****/
+PRIVATE void selectAnchorScanner(void)
+{
+    scan_anchors = scanAnchorsScalar;
+    scan_anchors_name = "scalar";
+
+#ifdef LOG_PARSER_HAVE_SSE2
+    scan_anchors = scanAnchorsSSE2;
+    scan_anchors_name = "sse2";
+#endif
+
+#ifdef LOG_PARSER_HAVE_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        scan_anchors = scanAnchorsAVX2;
+        scan_anchors_name = "avx2";
+    }
+#endif
+}
+
+/****
+ *
+ * Parse "a.b.c.d:port" straight from the line bytes
+ *
+ * DESCRIPTION:
+ *   Skips leading blanks, then reads four 1-3 digit decimal octets and a
+ *   1-5 digit decimal port without copying the text anywhere. Longer
+ *   ports are rejected like any other out of range value.
+ *
+ * PARAMETERS:
+ *   p - Start of the field
+ *   end - End of the line (exclusive)
+ *   ip - Output IP (network byte order)
+ *   port - Output port
+ *
+ * RETURNS:
+ *   Pointer just past the port, or NULL on parse failure
+ *
+ ****/
+PRIVATE const char *parseIPv4Port(const char *p, const char *end, uint32_t *ip, uint16_t *port)
+{
+    uint32_t addr = 0;
+    uint32_t value;
+    int octet, digits;
+
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    for (octet = 0; octet < 4; octet++) {
+        if (octet > 0) {
+            if (p >= end || *p != '.') {
+                return NULL;
+            }
+            p++;
+        }
+        value = 0;
+        for (digits = 0; digits < 3 && p < end && (unsigned int)(*p - '0') <= 9; digits++, p++) {
+            value = (value * 10) + (uint32_t)(*p - '0');
+        }
+        if (digits == 0 || value > 255) {
+            return NULL;
+        }
+        addr = (addr << 8) | value;
+    }
+
+    if (p >= end || *p != ':') {
+        return NULL;
+    }
+    p++;
+
+    value = 0;
+    for (digits = 0; digits < 5 && p < end && (unsigned int)(*p - '0') <= 9; digits++, p++) {
+        value = (value * 10) + (uint32_t)(*p - '0');
+    }
+    /* A sixth digit is out of range, not the end of the port */
+    if (digits == 0 || value > 65535 || (p < end && (unsigned int)(*p - '0') <= 9)) {
+        return NULL;
+    }
+
+    *ip = htonl(addr);
+    *port = (uint16_t)value;
+
+    return p;
+}
+
 /****
  *
  * Parse honeypot sensor log line
  *
  * DESCRIPTION:
  *   Parses syslog honeypot format. Extracts timestamp, IPs, ports, protocol.
+ *   One SIMD pass locates the "PacketTime:", "IPv4/" and " -> " anchors;
+ *   addresses and ports are then decoded in place. Never reads past len.
  *
  * PARAMETERS:
- *   line - Log line to parse
+ *   line - Log line to parse (need not be NUL-terminated)
+ *   len - Line length in bytes
  *   event - Output HoneypotEvent_t structure
  *
  * RETURNS:
  *   TRUE on success, FALSE if line doesn't match format
  *
  ****/
-int parseHoneypotLine(const char *line, HoneypotEvent_t *event)
+int parseHoneypotLine(const char *line, size_t len, HoneypotEvent_t *event)
 {
+    const char *end = line + len;
     const char *p;
-    char ip_buf[16];
-    uint16_t port;
+    LineAnchors_t anchors;
 
     if (!line || !event) {
         return FALSE;
     }
 
     /* Initialize event structure */
-    memset(event, 0, sizeof(HoneypotEvent_t));
+    event->tcp_flags = 0;
     event->log_type = LOG_TYPE_HONEYPOT_SENSOR;
 
-    /* Find and parse PacketTime */
-    p = findPacketTime(line);
-    if (!p) {
+    /* Locate all fields in a single sweep */
+    anchors.packet_time = NULL;
+    anchors.ipv4 = NULL;
+    anchors.arrow = NULL;
+    scan_anchors(line, len, &anchors);
+
+    if (!anchors.packet_time) {
 #ifdef DEBUG
         if (config->debug >= 3) {
             fprintf(stderr, "DEBUG - PacketTime not found in line\n");
@@ -363,7 +859,8 @@ int parseHoneypotLine(const char *line, HoneypotEvent_t *event)
     }
 
     /* Parse timestamp */
-    if (!parseTimestamp(p, &event->timestamp, &event->timestamp_us)) {
+    if (!parseTimestampLen(anchors.packet_time, (size_t)(end - anchors.packet_time),
+                           &event->timestamp, &event->timestamp_us)) {
 #ifdef DEBUG
         if (config->debug >= 3) {
             fprintf(stderr, "DEBUG - Failed to parse timestamp\n");
@@ -372,8 +869,8 @@ int parseHoneypotLine(const char *line, HoneypotEvent_t *event)
         return FALSE;
     }
 
-    /* Find protocol field (IPv4/TCP or IPv4/UDP) */
-    p = findIPv4Protocol(line);
+    /* Protocol field (IPv4/TCP or IPv4/UDP) */
+    p = anchors.ipv4;
     if (!p) {
 #ifdef DEBUG
         if (config->debug >= 3) {
@@ -384,23 +881,20 @@ int parseHoneypotLine(const char *line, HoneypotEvent_t *event)
     }
 
     /* Determine protocol */
-    if (strncmp(p, "IPv4/TCP", 8) == 0) {
+    if (end - p < 8) {
+        return FALSE;
+    } else if (memcmp(p, "IPv4/TCP", 8) == 0) {
         event->protocol = PROTO_TCP;
-        p += 8;  // Skip "IPv4/TCP"
-    } else if (strncmp(p, "IPv4/UDP", 8) == 0) {
+    } else if (memcmp(p, "IPv4/UDP", 8) == 0) {
         event->protocol = PROTO_UDP;
-        p += 8;  // Skip "IPv4/UDP"
     } else {
         return FALSE;  // Unknown protocol
     }
+    p += 8;
 
-    /* Skip whitespace */
-    while (*p && isspace(*p)) {
-        p++;
-    }
-
-    /* Extract source IP:port */
-    if (!extractIPPort(p, ip_buf, sizeof(ip_buf), &port)) {
+    /* Source IP:port */
+    p = parseIPv4Port(p, end, &event->src_ip, &event->src_port);
+    if (!p || event->src_ip == 0) {
 #ifdef DEBUG
         if (config->debug >= 3) {
             fprintf(stderr, "DEBUG - Failed to extract source IP:port\n");
@@ -409,24 +903,8 @@ int parseHoneypotLine(const char *line, HoneypotEvent_t *event)
         return FALSE;
     }
 
-    /* Convert source IP to integer */
-    event->src_ip = ipStringToInt(ip_buf);
-    if (event->src_ip == 0) {
-#ifdef DEBUG
-        if (config->debug >= 3) {
-            fprintf(stderr, "DEBUG - Invalid source IP: %s\n", ip_buf);
-        }
-#endif
-        return FALSE;
-    }
-
-    event->src_port = port;
-    strncpy(event->src_ip_str, ip_buf, sizeof(event->src_ip_str) - 1);
-    event->src_ip_str[sizeof(event->src_ip_str) - 1] = '\0';
-
-    /* Find " -> " separator */
-    p = strstr(p, " -> ");
-    if (!p) {
+    /* " -> " separator */
+    if (!anchors.arrow || anchors.arrow < p) {
 #ifdef DEBUG
         if (config->debug >= 3) {
             fprintf(stderr, "DEBUG - No ' -> ' separator found\n");
@@ -435,10 +913,9 @@ int parseHoneypotLine(const char *line, HoneypotEvent_t *event)
         return FALSE;
     }
 
-    p += 4;  // Skip " -> "
-
-    /* Extract destination IP:port */
-    if (!extractIPPort(p, ip_buf, sizeof(ip_buf), &port)) {
+    /* Destination IP:port */
+    p = parseIPv4Port(anchors.arrow + 4, end, &event->dst_ip, &event->dst_port);
+    if (!p || event->dst_ip == 0) {
 #ifdef DEBUG
         if (config->debug >= 3) {
             fprintf(stderr, "DEBUG - Failed to extract destination IP:port\n");
@@ -447,26 +924,14 @@ int parseHoneypotLine(const char *line, HoneypotEvent_t *event)
         return FALSE;
     }
 
-    /* Convert destination IP to integer */
-    event->dst_ip = ipStringToInt(ip_buf);
-    if (event->dst_ip == 0) {
-#ifdef DEBUG
-        if (config->debug >= 3) {
-            fprintf(stderr, "DEBUG - Invalid destination IP: %s\n", ip_buf);
-        }
-#endif
-        return FALSE;
-    }
-
-    event->dst_port = port;
-    strncpy(event->dst_ip_str, ip_buf, sizeof(event->dst_ip_str) - 1);
-    event->dst_ip_str[sizeof(event->dst_ip_str) - 1] = '\0';
-
 #ifdef DEBUG
     if (config->debug >= 5) {
+        char src_str[16], dst_str[16];
+        ipIntToString(event->src_ip, src_str, sizeof(src_str));
+        ipIntToString(event->dst_ip, dst_str, sizeof(dst_str));
         fprintf(stderr, "DEBUG - Parsed: %s:%u -> %s:%u proto=%u time=%ld.%06u\n",
-                event->src_ip_str, event->src_port,
-                event->dst_ip_str, event->dst_port,
+                src_str, event->src_port,
+                dst_str, event->dst_port,
                 event->protocol,
                 (long)event->timestamp, event->timestamp_us);
     }
@@ -475,15 +940,91 @@ int parseHoneypotLine(const char *line, HoneypotEvent_t *event)
     return TRUE;
 }
 
+#ifdef HAVE_SYS_MMAN_H
+/****
+ *
+ * Map an uncompressed log file for in-place parsing
+ *
+ * DESCRIPTION:
+ *   Maps the whole file read-only and hands it to the line reader as one
+ *   buffer that is already at EOF, so lines are split and parsed where the
+ *   page cache holds them: no read() per block and no copy into the stream
+ *   buffer. The kernel is told the access is sequential so it reads ahead
+ *   and drops pages behind.
+ *
+ * PARAMETERS:
+ *   file_path - Path to an uncompressed file
+ *
+ * RETURNS:
+ *   Pointer to GzipStream_t, or NULL if the file cannot be mapped (the
+ *   caller then reads it through zlib)
+ *
+ ****/
+PRIVATE GzipStream_t *openMappedStream(const char *file_path)
+{
+    GzipStream_t *stream;
+    struct stat st;
+    void *map;
+    size_t size;
+    int fd;
+
+    fd = open(file_path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 ||
+        (uint64_t)st.st_size > (uint64_t)SIZE_MAX) {
+        close(fd);
+        return NULL;
+    }
+    size = (size_t)st.st_size;
+
+    map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(map, size, MADV_SEQUENTIAL);
+#endif
+
+    stream = (GzipStream_t *)XMALLOC(sizeof(GzipStream_t));
+    memset(stream, 0, sizeof(GzipStream_t));
+
+    stream->buffer = (char *)map;
+    stream->buffer_size = LOG_PARSER_BUFFER_SIZE;
+    stream->buffer_used = size;
+    stream->eof_reached = TRUE;
+    stream->mapped = TRUE;
+    stream->file_path = strdup(file_path);
+
+    resetParserStats(&stream->stats);
+
+#ifdef DEBUG
+    if (config->debug >= 1) {
+        fprintf(stderr, "DEBUG - Mapped plain text file: %s (%zu bytes)\n", file_path, size);
+    }
+#endif
+
+    return stream;
+}
+#endif
+
 /****
  *
  * Open gzip compressed file for streaming
  *
  * DESCRIPTION:
  *   Opens .gz file for line-by-line reading. Allocates GzipStream_t structure.
+ *   zstd and lz4 files are detected by magic bytes and decoded with their
+ *   own libraries; gzip uses the backend chosen at configure time (see
+ *   decompress.c), falling back to zlib's gzread(). Uncompressed files
+ *   are mapped with openMappedStream() where possible. LOG_PARSER_STDIN
+ *   ("-") reads standard input, gzip or plain, through gzread() in
+ *   buffer-sized blocks.
  *
  * PARAMETERS:
- *   file_path - Path to .gz file
+ *   file_path - Path to .gz file, or "-" for standard input
  *
  * RETURNS:
  *   Pointer to GzipStream_t on success, NULL on failure
@@ -492,10 +1033,36 @@ int parseHoneypotLine(const char *line, HoneypotEvent_t *event)
 GzipStream_t *openGzipStream(const char *file_path)
 {
     GzipStream_t *stream;
+    DecompressSource_t src;
+    int from_stdin;
+    int taken;
 
     if (!file_path) {
         return NULL;
     }
+    from_stdin = (strcmp(file_path, LOG_PARSER_STDIN) == 0);
+
+    if (!from_stdin) {
+        /* zstd/lz4 input, or gzip with a faster backend selected at configure time */
+        taken = openDecompressSource(file_path, &src);
+        if (taken < 0) {
+            return NULL;
+        }
+        if (taken) {
+            stream = openBlockStream(file_path, src.read_block, src.close_source, src.source);
+#ifdef DEBUG
+            if (config->debug >= 1) {
+                fprintf(stderr, "DEBUG - Opened %s stream: %s\n", src.name, file_path);
+            }
+#endif
+            return stream;
+        }
+#ifdef HAVE_SYS_MMAN_H
+        if (src.plain_text && (stream = openMappedStream(file_path)) != NULL) {
+            return stream;
+        }
+#endif
+    }
 
     stream = (GzipStream_t *)XMALLOC(sizeof(GzipStream_t));
     if (!stream) {
@@ -504,17 +1071,22 @@ GzipStream_t *openGzipStream(const char *file_path)
 
     memset(stream, 0, sizeof(GzipStream_t));
 
-    /* Open gzip file */
-    stream->gz_file = gzopen(file_path, "rb");
+    /* Open gzip file (zlib passes uncompressed input through) */
+    if (from_stdin) {
+        /* Own descriptor so gzclose() leaves stdin itself open */
+        stream->gz_file = gzdopen(dup(STDIN_FILENO), "rb");
+    } else {
+        stream->gz_file = gzopen(file_path, "rb");
+    }
     if (!stream->gz_file) {
         fprintf(stderr, "ERR - Failed to open gzip file: %s\n", file_path);
         XFREE(stream);
         return NULL;
     }
 
-    /* Allocate read buffer */
+    /* Allocate block buffer (+1 so the last line can always be NUL-terminated) */
     stream->buffer_size = LOG_PARSER_BUFFER_SIZE;
-    stream->buffer = (char *)XMALLOC((int)stream->buffer_size);
+    stream->buffer = (char *)XMALLOC((int)stream->buffer_size + 1);
     if (!stream->buffer) {
         gzclose(stream->gz_file);
         XFREE(stream);
@@ -522,9 +1094,13 @@ GzipStream_t *openGzipStream(const char *file_path)
     }
 
     /* Store file path */
-    stream->file_path = strdup(file_path);
+    stream->file_path = strdup(from_stdin ? "stdin" : file_path);
 
-    /* Set compression level for better speed */
+    /*
+     * Large internal input buffer - we inflate in big blocks anyway. Reads
+     * of at least twice this size bypass it for uncompressed input, so
+     * plain text on stdin lands directly in the line buffer.
+     */
     gzbuffer(stream->gz_file, 128 * 1024);  // 128KB internal buffer
 
     resetParserStats(&stream->stats);
@@ -559,7 +1135,15 @@ void closeGzipStream(GzipStream_t *stream)
         gzclose(stream->gz_file);
     }
 
-    if (stream->buffer) {
+    if (stream->close_source) {
+        stream->close_source(stream->source);
+    }
+
+    if (stream->mapped) {
+#ifdef HAVE_SYS_MMAN_H
+        munmap(stream->buffer, stream->buffer_used);
+#endif
+    } else if (stream->buffer) {
         XFREE(stream->buffer);
     }
 
@@ -570,12 +1154,283 @@ void closeGzipStream(GzipStream_t *stream)
     XFREE(stream);
 }
 
+/****
+ *
+ * Open a line stream over a custom block source
+ *
+ * DESCRIPTION:
+ *   Wraps a block reader (anything that can fill a buffer with text) in a
+ *   GzipStream_t so readLineViewGzip() and the parser can consume it like
+ *   a gzip file. Used for indexed gzip slices.
+ *
+ * PARAMETERS:
+ *   name - Name used in messages
+ *   read_block - Block reader (returns bytes, 0 at end, -1 on error)
+ *   close_source - Called with source by closeGzipStream() (may be NULL)
+ *   source - Reader state passed to both callbacks
+ *
+ * RETURNS:
+ *   Pointer to GzipStream_t
+ *
+ ****/
+GzipStream_t *openBlockStream(const char *name, int (*read_block)(void *source, char *dst, size_t room),
+                              void (*close_source)(void *source), void *source)
+{
+    GzipStream_t *stream;
+
+    stream = (GzipStream_t *)XMALLOC(sizeof(GzipStream_t));
+    memset(stream, 0, sizeof(GzipStream_t));
+
+    stream->read_block = read_block;
+    stream->close_source = close_source;
+    stream->source = source;
+
+    stream->buffer_size = LOG_PARSER_BUFFER_SIZE;
+    stream->buffer = (char *)XMALLOC((int)stream->buffer_size + 1);
+
+    if (name) {
+        stream->file_path = strdup(name);
+    }
+
+    resetParserStats(&stream->stats);
+
+    return stream;
+}
+
+/****
+ *
+ * Reset a block stream for a new source position
+ *
+ * DESCRIPTION:
+ *   Drops buffered text and clears EOF, errors and statistics so a block stream
+ *   can be reused after its source has been repositioned.
+ *
+ * PARAMETERS:
+ *   stream - GzipStream_t handle
+ *
+ ****/
+void resetBlockStream(GzipStream_t *stream)
+{
+    if (!stream) {
+        return;
+    }
+
+    stream->buffer_used = 0;
+    stream->buffer_pos = 0;
+    stream->eof_reached = FALSE;
+    stream->read_error = FALSE;
+    stream->discard_line = FALSE;
+    resetParserStats(&stream->stats);
+}
+
+/****
+ *
+ * Decompress the next block of a stream's input
+ *
+ * DESCRIPTION:
+ *   Produces up to `room` bytes of text from the stream's source with a
+ *   single gzread() (or read_block) call, reporting read errors. Does not
+ *   touch the line buffer, so it can also feed a read-ahead thread.
+ *
+ * PARAMETERS:
+ *   stream - GzipStream_t handle
+ *   dst - Output buffer
+ *   room - Space in dst
+ *
+ * RETURNS:
+ *   Bytes written, 0 at end of data, -1 on error
+ *
+ ****/
+int readGzipBlock(GzipStream_t *stream, char *dst, size_t room)
+{
+    int got;
+    int errnum;
+
+    if (stream->read_block) {
+        return stream->read_block(stream->source, dst, room);
+    }
+
+    /* A mapped file has no blocks, its lines are all in the buffer */
+    if (stream->mapped || !stream->gz_file) {
+        fprintf(stderr, "ERR - Cannot read blocks from %s: not a compressed stream\n",
+                stream->file_path ? stream->file_path : "stream");
+        return -1;
+    }
+
+    got = gzread(stream->gz_file, dst, (unsigned int)room);
+    if (got < 0) {
+        fprintf(stderr, "ERR - Failed to read %s: %s\n",
+                stream->file_path ? stream->file_path : "gzip stream",
+                gzerror(stream->gz_file, &errnum));
+    }
+
+    return got;
+}
+
+/****
+ *
+ * Inflate the next block into the stream buffer
+ *
+ * DESCRIPTION:
+ *   Moves the unconsumed tail of the buffer (a partial line that crossed the
+ *   previous block edge) to the front, then inflates as much data as fits
+ *   into the remaining space with readGzipBlock().
+ *
+ * PARAMETERS:
+ *   stream - GzipStream_t handle
+ *
+ * RETURNS:
+ *   Number of bytes added to the buffer, 0 on EOF or error
+ *
+ * SIDE EFFECTS:
+ *   Sets eof_reached when the underlying file is exhausted or fails, and
+ *   read_error when it fails
+ *
+ ****/
+PRIVATE size_t fillGzipBuffer(GzipStream_t *stream)
+{
+    size_t tail = stream->buffer_used - stream->buffer_pos;
+    int got;
+
+    if (tail > 0 && stream->buffer_pos > 0) {
+        memmove(stream->buffer, stream->buffer + stream->buffer_pos, tail);
+    }
+    stream->buffer_used = tail;
+    stream->buffer_pos = 0;
+
+    if (stream->buffer_used >= stream->buffer_size) {
+        return 0;
+    }
+
+    got = readGzipBlock(stream, stream->buffer + stream->buffer_used,
+                        stream->buffer_size - stream->buffer_used);
+    if (got <= 0) {
+        stream->eof_reached = TRUE;
+        if (got < 0) {
+            stream->read_error = TRUE;
+        }
+        return 0;
+    }
+
+    stream->buffer_used += (size_t)got;
+
+    return (size_t)got;
+}
+
+/****
+ *
+ * Read one line from gzip stream as a zero-copy view
+ *
+ * DESCRIPTION:
+ *   Returns the next line as a pointer+length view into the stream's block
+ *   buffer. Blocks are inflated with fillGzipBuffer() and split with memchr().
+ *   A line that crosses a block edge is carried to the front of the buffer
+ *   before the next block is inflated behind it. Lines longer than the whole
+ *   buffer are truncated to buffer_size and the remainder is skipped.
+ *
+ * PARAMETERS:
+ *   stream - GzipStream_t handle
+ *   view - Output line view (valid until the next read on this stream)
+ *
+ * RETURNS:
+ *   TRUE if a line was returned, FALSE on EOF or error
+ *
+ * SIDE EFFECTS:
+ *   Overwrites the line's newline with NUL in the stream buffer (not on
+ *   mapped streams, which are read-only)
+ *   Updates line count and byte statistics
+ *
+ * PERFORMANCE:
+ *   One gzread() per ~1MB block instead of one gzgets() per line, and no
+ *   per-line copy or strlen()
+ *
+ ****/
+int readLineViewGzip(GzipStream_t *stream, LineView_t *view)
+{
+    char *start, *nl;
+    size_t avail;
+
+    if (!stream || !view) {
+        return FALSE;
+    }
+
+    for (;;) {
+        start = stream->buffer + stream->buffer_pos;
+        avail = stream->buffer_used - stream->buffer_pos;
+        nl = (avail > 0) ? (char *)memchr(start, '\n', avail) : NULL;
+
+        if (stream->discard_line) {
+            /* Skip the tail of an over-long line up to its newline */
+            if (nl) {
+                stream->buffer_pos += (size_t)(nl - start) + 1;
+                stream->stats.bytes_read += (size_t)(nl - start) + 1;
+                stream->discard_line = FALSE;
+                continue;
+            }
+            stream->buffer_pos = stream->buffer_used;
+            stream->stats.bytes_read += avail;
+            if (stream->eof_reached || fillGzipBuffer(stream) == 0) {
+                return FALSE;
+            }
+            continue;
+        }
+
+        if (nl) {
+            view->ptr = start;
+            view->len = (size_t)(nl - start);
+            stream->buffer_pos += view->len + 1;
+            stream->stats.lines_processed++;
+            stream->stats.bytes_read += view->len + 1;
+            if (!stream->mapped) {
+                *nl = '\0';
+            } else if (view->len > stream->buffer_size) {
+                /* Same limit as a block buffer would impose */
+                view->len = stream->buffer_size;
+            }
+            return TRUE;
+        }
+
+        if (stream->eof_reached) {
+            if (avail == 0) {
+                return FALSE;
+            }
+            /* Final line without a trailing newline */
+            view->ptr = start;
+            view->len = avail;
+            stream->buffer_pos = stream->buffer_used;
+            stream->stats.lines_processed++;
+            stream->stats.bytes_read += avail;
+            if (!stream->mapped) {
+                start[avail] = '\0';
+            } else if (view->len > stream->buffer_size) {
+                view->len = stream->buffer_size;
+            }
+            return TRUE;
+        }
+
+        if (avail >= stream->buffer_size) {
+            /* Line fills the whole buffer - return it truncated */
+            start[avail] = '\0';
+            view->ptr = start;
+            view->len = avail;
+            stream->buffer_pos = stream->buffer_used;
+            stream->discard_line = TRUE;
+            stream->stats.lines_processed++;
+            stream->stats.bytes_read += avail;
+            return TRUE;
+        }
+
+        fillGzipBuffer(stream);
+    }
+}
+
 /****
  *
  * Read one line from gzip stream
  *
  * DESCRIPTION:
- *   Reads next line from compressed file. Updates line count and byte statistics.
+ *   Copying wrapper around readLineViewGzip() for callers that need their
+ *   own line buffer. Lines longer than buf_size - 1 are truncated.
  *
  * PARAMETERS:
  *   stream - GzipStream_t handle
@@ -588,23 +1443,20 @@ void closeGzipStream(GzipStream_t *stream)
  ****/
 int readLineGzip(GzipStream_t *stream, char *line_buf, size_t buf_size)
 {
-    if (!stream || !line_buf || buf_size == 0) {
-        return FALSE;
-    }
+    LineView_t view;
+    size_t len;
 
-    if (stream->eof_reached) {
+    if (!stream || !line_buf || buf_size == 0) {
         return FALSE;
     }
 
-    /* Use gzgets for line-by-line reading */
-    if (gzgets(stream->gz_file, line_buf, (int)buf_size) == NULL) {
-        stream->eof_reached = TRUE;
+    if (!readLineViewGzip(stream, &view)) {
         return FALSE;
     }
 
-    /* Update statistics */
-    stream->stats.lines_processed++;
-    stream->stats.bytes_read += strlen(line_buf);
+    len = (view.len < buf_size - 1) ? view.len : buf_size - 1;
+    memcpy(line_buf, view.ptr, len);
+    line_buf[len] = '\0';
 
     return TRUE;
 }
@@ -683,7 +1535,7 @@ void printParserStats(const ParserStats_t *stats)
  *   user_data - Opaque pointer passed to callback
  *
  * RETURNS:
- *   TRUE on success, FALSE on error or callback abort
+ *   TRUE on success, FALSE on read error or callback abort
  *
  ****/
 int processGzipFile(const char *file_path,
@@ -691,7 +1543,7 @@ int processGzipFile(const char *file_path,
                     void *user_data)
 {
     GzipStream_t *stream;
-    char line_buf[LOG_PARSER_MAX_LINE];
+    LineView_t line;
     HoneypotEvent_t event;
     struct timeval start_time, end_time;
     int result = TRUE;
@@ -700,8 +1552,8 @@ int processGzipFile(const char *file_path,
         return FALSE;
     }
 
-    /* Open gzip stream */
-    stream = openGzipStream(file_path);
+    /* Open gzip stream, inflating on a separate thread unless disabled */
+    stream = (config && !config->gz_readahead) ? openGzipStream(file_path) : openGzipRingStream(file_path);
     if (!stream) {
         return FALSE;
     }
@@ -709,10 +1561,10 @@ int processGzipFile(const char *file_path,
     /* Start timing */
     gettimeofday(&start_time, NULL);
 
-    /* Read and parse each line */
-    while (readLineGzip(stream, line_buf, sizeof(line_buf))) {
+    /* Read and parse each line straight out of the inflated block buffer */
+    while (readLineViewGzip(stream, &line)) {
         /* Parse honeypot sensor log line */
-        if (parseHoneypotLine(line_buf, &event)) {
+        if (parseHoneypotLine(line.ptr, line.len, &event)) {
             stream->stats.lines_parsed_ok++;
 
             /* Call user callback with parsed event */
@@ -732,6 +1584,12 @@ int processGzipFile(const char *file_path,
         }
     }
 
+    /* A read error cut the file short */
+    if (stream->read_error) {
+        fprintf(stderr, "ERR - %s ended early on a read error\n", stream->file_path ? stream->file_path : file_path);
+        result = FALSE;
+    }
+
     /* End timing */
     gettimeofday(&end_time, NULL);
 
@@ -749,6 +1607,110 @@ int processGzipFile(const char *file_path,
     return result;
 }
 
+/****
+ *
+ * Process entire gzip log file with batched event delivery
+ *
+ * DESCRIPTION:
+ *   Same loop as processGzipFile(), but parsed events are collected into an
+ *   array and handed to the callback LOG_PARSER_BATCH_SIZE at a time (the
+ *   last batch may be shorter). Events arrive in file order.
+ *
+ * PARAMETERS:
+ *   file_path - Path to .gz log file
+ *   batch_callback - Function called for each batch (return FALSE to stop)
+ *   user_data - Opaque pointer passed to callback
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on read error or callback abort
+ *
+ * PERFORMANCE:
+ *   One indirect call per batch instead of per event, and the callback can
+ *   walk the batch in tight loops. Inflate runs on its own thread (see
+ *   openGzipRingStream()), overlapping with the callback's binning and
+ *   rendering.
+ *
+ ****/
+int processGzipFileBatch(const char *file_path,
+                         int (*batch_callback)(const HoneypotEvent_t *events, size_t count, void *user_data),
+                         void *user_data)
+{
+    GzipStream_t *stream;
+    LineView_t line;
+    HoneypotEvent_t *batch;
+    size_t batch_count = 0;
+    struct timeval start_time, end_time;
+    int result = TRUE;
+
+    if (!file_path || !batch_callback) {
+        return FALSE;
+    }
+
+    /* Open gzip stream, inflating on a separate thread unless disabled */
+    stream = (config && !config->gz_readahead) ? openGzipStream(file_path) : openGzipRingStream(file_path);
+    if (!stream) {
+        return FALSE;
+    }
+
+    batch = (HoneypotEvent_t *)XMALLOC((int)(sizeof(HoneypotEvent_t) * LOG_PARSER_BATCH_SIZE));
+
+    /* Start timing */
+    gettimeofday(&start_time, NULL);
+
+    /* Parse straight into the batch array */
+    while (readLineViewGzip(stream, &line)) {
+        if (parseHoneypotLine(line.ptr, line.len, &batch[batch_count])) {
+            stream->stats.lines_parsed_ok++;
+
+            if (++batch_count == LOG_PARSER_BATCH_SIZE) {
+                if (!batch_callback(batch, batch_count, user_data)) {
+                    /* Callback returned FALSE - stop processing */
+                    batch_count = 0;
+                    result = FALSE;
+                    break;
+                }
+                batch_count = 0;
+            }
+        } else {
+            stream->stats.lines_parse_failed++;
+        }
+
+        /* Progress indicator every 1M lines */
+        if (stream->stats.lines_processed % 1000000 == 0) {
+            fprintf(stderr, "  Processed %luM lines...\n",
+                    stream->stats.lines_processed / 1000000);
+        }
+    }
+
+    /* Deliver the partial final batch */
+    if (batch_count > 0 && !batch_callback(batch, batch_count, user_data)) {
+        result = FALSE;
+    }
+
+    /* A read error cut the file short */
+    if (stream->read_error) {
+        fprintf(stderr, "ERR - %s ended early on a read error\n", stream->file_path ? stream->file_path : file_path);
+        result = FALSE;
+    }
+
+    /* End timing */
+    gettimeofday(&end_time, NULL);
+
+    /* Calculate elapsed time */
+    stream->stats.parse_time_sec =
+        (double)(end_time.tv_sec - start_time.tv_sec) +
+        (double)(end_time.tv_usec - start_time.tv_usec) / 1000000.0;
+
+    /* Print statistics */
+    printParserStats(&stream->stats);
+
+    /* Cleanup */
+    XFREE(batch);
+    closeGzipStream(stream);
+
+    return result;
+}
+
 /****
  *
  * Extract timestamp from FortiGate log line (basic parsing for sorting only)
@@ -825,6 +1787,7 @@ PRIVATE time_t parseFortiGateTimestamp(const char *line)
  *
  * RETURNS:
  *   Unix timestamp of first parseable event, or 0 if no events found
+ *   (always 0 for standard input, which cannot be read twice)
  *
  * SIDE EFFECTS:
  *   Opens and closes file
@@ -833,13 +1796,15 @@ PRIVATE time_t parseFortiGateTimestamp(const char *line)
 time_t peekFirstTimestamp(const char *file_path)
 {
     GzipStream_t *stream = NULL;
-    char line[LOG_PARSER_MAX_LINE];
+    LineView_t line;
     HoneypotEvent_t event;
+    char text[LOG_PARSER_MAX_LINE];
+    size_t text_len;
     time_t first_timestamp = 0;
     int max_lines_to_check = 1000;  /* Don't scan forever if file is corrupt */
     int lines_checked = 0;
 
-    if (!file_path) {
+    if (!file_path || strcmp(file_path, LOG_PARSER_STDIN) == 0) {
         return 0;
     }
 
@@ -851,17 +1816,20 @@ time_t peekFirstTimestamp(const char *file_path)
     }
 
     /* Read lines until we find a parseable event */
-    while (readLineGzip(stream, line, sizeof(line)) && lines_checked < max_lines_to_check) {
+    while (lines_checked < max_lines_to_check && readLineViewGzip(stream, &line)) {
         lines_checked++;
 
         /* Try to parse as honeypot sensor log */
-        if (parseHoneypotLine(line, &event)) {
+        if (parseHoneypotLine(line.ptr, line.len, &event)) {
             first_timestamp = event.timestamp;
             break;
         }
 
-        /* Try to parse as FortiGate log (basic timestamp extraction) */
-        first_timestamp = parseFortiGateTimestamp(line);
+        /* Try to parse as FortiGate log (needs a C string; mapped lines are not terminated) */
+        text_len = (line.len < sizeof(text) - 1) ? line.len : sizeof(text) - 1;
+        memcpy(text, line.ptr, text_len);
+        text[text_len] = '\0';
+        first_timestamp = parseFortiGateTimestamp(text);
         if (first_timestamp > 0) {
             break;
         }
@@ -52,6 +52,8 @@
 
 #define LOG_PARSER_MAX_LINE 4096
 #define LOG_PARSER_BUFFER_SIZE (1024 * 1024)  // 1MB read buffer
+#define LOG_PARSER_BATCH_SIZE 4096            // Events per processGzipFileBatch() callback
+#define LOG_PARSER_STDIN "-"                  // File name that reads standard input
 
 /* Log format types */
 #define LOG_TYPE_UNKNOWN 0
@@ -74,6 +76,9 @@
  *
  * Format: Feb 22 09:26:39 10.10.10.40 honeypi00 sensor: PacketTime:2019-02-22 17:26:39.092449
  *         Len:60 IPv4/TCP 45.55.247.43:35398 -> 10.10.10.40:5900 ...
+ *
+ * Kept to a fixed 32 bytes with no text fields so batches stay compact;
+ * use ipIntToString() when an address needs printing.
  */
 typedef struct {
     /* Parsed timestamp */
@@ -90,14 +95,8 @@ typedef struct {
     /* TCP specific */
     uint8_t tcp_flags;          // TCP flags if protocol is TCP
 
-    /* Raw fields for reference */
-    char packet_time_str[32];   // Original PacketTime string
-    char src_ip_str[16];        // Source IP string
-    char dst_ip_str[16];        // Destination IP string
-
     /* Parser metadata */
     uint8_t log_type;           // LOG_TYPE_HONEYPOT_SENSOR
-    int line_number;            // Line number in file (for debugging)
 
 } HoneypotEvent_t;
 
@@ -113,16 +112,51 @@ typedef struct {
     double read_time_sec;
 } ParserStats_t;
 
+/**
+ * Zero-copy view of one line inside a stream buffer
+ *
+ * The view points directly into GzipStream_t.buffer and is only valid until
+ * the next read from the same stream. The trailing newline is replaced by a
+ * NUL in place, so ptr may also be used as a C string, except on mapped
+ * streams where the buffer is the read-only file itself: use len.
+ */
+typedef struct {
+    const char *ptr;            // Start of line
+    size_t len;                 // Line length (excluding newline)
+} LineView_t;
+
+/**
+ * Field anchors located in a honeypot sensor line (NULL if absent)
+ */
+typedef struct {
+    const char *packet_time;    // "PacketTime:"
+    const char *ipv4;           // "IPv4/"
+    const char *arrow;          // " -> " after the protocol token
+} LineAnchors_t;
+
 /**
  * Gzip file handle for streaming decompression
+ *
+ * Blocks come from gzread() on gz_file unless read_block is set, in which
+ * case it is called with source to produce the next block of text
+ * (returning bytes written, 0 at end of data, -1 on error). Uncompressed
+ * files are instead mapped whole: buffer is the mapping and the stream
+ * starts at EOF with every line already in the buffer, so there are no
+ * blocks to read.
  */
 typedef struct {
     gzFile gz_file;
-    char *buffer;
+    int (*read_block)(void *source, char *dst, size_t room);
+    void (*close_source)(void *source);
+    void *source;
+    char *buffer;               // Inflated block buffer (buffer_size + 1 bytes) or mapping
     size_t buffer_size;
-    size_t buffer_used;
-    size_t buffer_pos;
+    size_t buffer_used;         // Bytes of valid data in buffer
+    size_t buffer_pos;          // Start of next unread line
     int eof_reached;
+    int discard_line;           // Skipping the rest of an over-long line
+    int mapped;                 // buffer is a read-only mmap() of buffer_used bytes
+    int read_error;             // A block failed to read, the data ended early
     char *file_path;
     ParserStats_t stats;
 } GzipStream_t;
@@ -138,13 +172,14 @@ int initLogParser(void);
 void deInitLogParser(void);
 
 /* Honeypot sensor log parsing */
-int parseHoneypotLine(const char *line, HoneypotEvent_t *event);
+int parseHoneypotLine(const char *line, size_t len, HoneypotEvent_t *event);
 
 /* Fast field extraction functions */
 const char *findPacketTime(const char *line);
 const char *findIPv4Protocol(const char *line);
 int extractIPPort(const char *str, char *ip_buf, int ip_buf_size, uint16_t *port);
 int parseTimestamp(const char *time_str, time_t *timestamp, uint32_t *microseconds);
+int parseTimestampLen(const char *time_str, size_t len, time_t *timestamp, uint32_t *microseconds);
 
 /* IP address utilities */
 uint32_t ipStringToInt(const char *ip_str);
@@ -152,8 +187,13 @@ void ipIntToString(uint32_t ip, char *buf, size_t buf_size);
 
 /* Gzip streaming functions */
 GzipStream_t *openGzipStream(const char *file_path);
+GzipStream_t *openBlockStream(const char *name, int (*read_block)(void *source, char *dst, size_t room),
+                              void (*close_source)(void *source), void *source);
+void resetBlockStream(GzipStream_t *stream);
 void closeGzipStream(GzipStream_t *stream);
 int readLineGzip(GzipStream_t *stream, char *line_buf, size_t buf_size);
+int readLineViewGzip(GzipStream_t *stream, LineView_t *view);
+int readGzipBlock(GzipStream_t *stream, char *dst, size_t room);
 void resetParserStats(ParserStats_t *stats);
 void printParserStats(const ParserStats_t *stats);
 
@@ -161,6 +201,9 @@ void printParserStats(const ParserStats_t *stats);
 int processGzipFile(const char *file_path,
                     int (*event_callback)(const HoneypotEvent_t *event, void *user_data),
                     void *user_data);
+int processGzipFileBatch(const char *file_path,
+                         int (*batch_callback)(const HoneypotEvent_t *events, size_t count, void *user_data),
+                         void *user_data);
 
 /* File timestamp detection for chronological sorting */
 time_t peekFirstTimestamp(const char *file_path);
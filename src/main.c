@@ -28,6 +28,7 @@
 
 #include "main.h"
 #include "timebin.h"
+#include "decompress.h"
 
 /****
  *
@@ -233,6 +234,18 @@ int main(int argc, char *argv[])
   config->target_video_duration = 300;  /* 5 minutes default */
   config->auto_scale = 1;         /* Auto-scale FPS and decay by default */
   config->show_timestamp = 0;     /* Timestamp overlay off by default */
+  config->ingest_jobs = 1;        /* Serial file-by-file ingest by default */
+  config->bin_jobs = 1;           /* Frames written on the binning thread by default */
+  config->gz_readahead = 1;       /* Decompress ahead of the parser by default */
+  config->decay_cache_mb = DECAY_CACHE_BUDGET_DEFAULT_MB;
+  config->hilbert_order = HILBERT_ORDER_DEFAULT;
+  config->mem_limit_mb = 0;       /* Half of physical memory */
+  config->exp_decay = 0;          /* Linear decay by default */
+  config->stats_file = NULL;      /* No per-frame statistics by default */
+  config->load_state_file = NULL; /* Start with empty residue and decay */
+  config->save_state_file = NULL;
+  config->reorder_seconds = 0;    /* Bin events in arrival order */
+  config->prefix_table_file = NULL; /* Map each address */
 
   /* set mapping strategy defaults (v0.2.0+) */
   config->mapping_strategy = MAPPING_HILBERT_IP;  /* Default: Hilbert/IP mapping (backward compatible) */
@@ -257,11 +270,23 @@ int main(int argc, char *argv[])
         {"timestamp", no_argument, 0, 't'},
         {"mapping", required_argument, 0, 'M'},
         {"asn-db", required_argument, 0, 'A'},
+        {"render-jobs", required_argument, 0, 'B'},
         {"country-db", required_argument, 0, 'G'},
+        {"jobs", required_argument, 0, 'j'},
+        {"no-readahead", no_argument, 0, 'R'},
+        {"decay-mem", required_argument, 0, 'm'},
+        {"exp-decay", no_argument, 0, 'e'},
+        {"stats", required_argument, 0, 'S'},
+        {"order", required_argument, 0, 'O'},
+        {"mem-limit", required_argument, 0, 'L'},
+        {"load-state", required_argument, 0, 'l'},
+        {"save-state", required_argument, 0, 's'},
+        {"reorder-window", required_argument, 0, 'W'},
+        {"prefix-table", required_argument, 0, 'P'},
         {0, no_argument, 0, 0}};
-    c = getopt_long(argc, argv, "vd:hp:o:Vf:c:C:D:tM:A:G:", long_options, &option_index);
+    c = getopt_long(argc, argv, "vd:hp:o:Vf:c:C:D:tM:A:B:G:j:Rm:eS:O:L:l:s:W:P:", long_options, &option_index);
 #else
-    c = getopt(argc, argv, "vd:hp:o:Vf:c:C:D:tM:A:G:");
+    c = getopt(argc, argv, "vd:hp:o:Vf:c:C:D:tM:A:B:G:j:Rm:eS:O:L:l:s:W:P:");
 #endif
 
     if (c EQ - 1)
@@ -379,6 +404,102 @@ int main(int argc, char *argv[])
       config->country_db_path = optarg;
       break;
 
+    case 'j':
+      /* set parser thread count */
+      if (!safe_parse_int(optarg, 0, INGEST_JOBS_MAX, &config->ingest_jobs)) {
+        fprintf(stderr, "ERR - Invalid job count: %s (must be 0-%d, 0 = all CPUs)\n", optarg, INGEST_JOBS_MAX);
+        return (EXIT_FAILURE);
+      }
+      config->ingest_jobs = getIngestJobs(config->ingest_jobs);
+      break;
+
+    case 'B':
+      /* set render thread count */
+      if (!safe_parse_int(optarg, 0, BIN_JOBS_MAX, &config->bin_jobs)) {
+        fprintf(stderr, "ERR - Invalid bin job count: %s (must be 0-%d, 0 = all CPUs)\n", optarg, BIN_JOBS_MAX);
+        return (EXIT_FAILURE);
+      }
+      config->bin_jobs = getBinJobs(config->bin_jobs);
+      break;
+
+    case 'R':
+      /* decompress on the parsing thread */
+      config->gz_readahead = 0;
+      break;
+
+    case 'm':
+      /* set decay cache memory budget */
+      if (!safe_parse_int(optarg, 0, DECAY_CACHE_BUDGET_MAX_MB, (int *)&config->decay_cache_mb)) {
+        fprintf(stderr, "ERR - Invalid decay cache size: %s (must be 0-%d MB, 0 = unlimited)\n", optarg, DECAY_CACHE_BUDGET_MAX_MB);
+        return (EXIT_FAILURE);
+      }
+      break;
+
+    case 'e':
+      /* fade exponentially */
+      config->exp_decay = 1;
+      break;
+
+    case 'S':
+      /* write per-frame statistics */
+      if (!validate_file_path(optarg)) {
+        fprintf(stderr, "ERR - Invalid stats file path: %s\n", optarg);
+        return (EXIT_FAILURE);
+      }
+      config->stats_file = optarg;
+      break;
+
+    case 'O':
+      /* set Hilbert curve order */
+      if (!safe_parse_int(optarg, HILBERT_ORDER_MIN, HILBERT_ORDER_MAX, &config->hilbert_order)) {
+        fprintf(stderr, "ERR - Invalid Hilbert order: %s (must be %d-%d)\n", optarg, HILBERT_ORDER_MIN, HILBERT_ORDER_MAX);
+        return (EXIT_FAILURE);
+      }
+      break;
+
+    case 'L':
+      /* set heatmap memory budget */
+      if (!safe_parse_int(optarg, 0, HEATMAP_MEM_LIMIT_MAX_MB, (int *)&config->mem_limit_mb)) {
+        fprintf(stderr, "ERR - Invalid memory limit: %s (must be 0-%d MB, 0 = half of RAM)\n", optarg, HEATMAP_MEM_LIMIT_MAX_MB);
+        return (EXIT_FAILURE);
+      }
+      break;
+
+    case 'l':
+      /* resume from a checkpoint */
+      if (!validate_file_path(optarg)) {
+        fprintf(stderr, "ERR - Invalid state file path: %s\n", optarg);
+        return (EXIT_FAILURE);
+      }
+      config->load_state_file = optarg;
+      break;
+
+    case 's':
+      /* write a checkpoint when done */
+      if (!validate_file_path(optarg)) {
+        fprintf(stderr, "ERR - Invalid state file path: %s\n", optarg);
+        return (EXIT_FAILURE);
+      }
+      config->save_state_file = optarg;
+      break;
+
+    case 'W':
+      /* hold events back to bin late ones in order */
+      if (!parseTimeBinDuration(optarg, &config->reorder_seconds) || config->reorder_seconds > REORDER_WINDOW_MAX) {
+        fprintf(stderr, "ERR - Invalid reorder window: %s (use format: 30s, 5m, 1h, at most %dh)\n", optarg, REORDER_WINDOW_MAX / 3600);
+        return (EXIT_FAILURE);
+      }
+      break;
+
+    case 'P':
+      /* map addresses through a cached /24 table */
+      if (!validate_file_path(optarg)) {
+        fprintf(stderr, "ERR - Invalid prefix table path: %s\n", optarg);
+        return (EXIT_FAILURE);
+      }
+      config->prefix_table_file = optarg;
+      break;
+
     default:
       fprintf(stderr, "Unknown option code [0%o]\n", c);
     }
@@ -444,8 +565,16 @@ int main(int argc, char *argv[])
     }
 #endif
 
+    int stdin_count = 0;
     for (int i = 0; i < file_count; i++) {
       file_list[i].path = argv[optind + i];
+      if (strcmp(file_list[i].path, LOG_PARSER_STDIN) == 0 && ++stdin_count > 1) {
+        fprintf(stderr, "ERR - Standard input (-) can only be given once\n");
+        XFREE(file_list);
+        cleanup();
+        return (EXIT_FAILURE);
+      }
+      /* stdin cannot be peeked; it sorts to the end and is read last */
       file_list[i].first_timestamp = peekFirstTimestamp(file_list[i].path);
 
 #ifdef DEBUG
@@ -500,35 +629,69 @@ int main(int argc, char *argv[])
     }
 
     /* Process files in sorted chronological order */
-    for (int i = 0; i < file_count; i++) {
-      /* Update current time in main loop (not in signal handler) */
-      if (time(&config->current_time) EQ - 1) {
-        display(LOG_ERR, "Unable to update current time");
-        XFREE(file_list);
-        finalizeProcessing();
-        cleanup();
-        return (EXIT_FAILURE);
+    if (config->ingest_jobs > 1) {
+      /* Parallel ingest - parse all files at once and merge by timestamp */
+      char **paths = (char **)XMALLOC((int)((size_t)file_count * sizeof(char *)));
+
+      for (int i = 0; i < file_count; i++) {
+        if (strcmp(file_list[i].path, LOG_PARSER_STDIN) != 0 && !validate_file_path(file_list[i].path)) {
+          fprintf(stderr, "ERR - Invalid file path: %s\n", file_list[i].path);
+          XFREE(paths);
+          XFREE(file_list);
+          finalizeProcessing();
+          cleanup();
+          return (EXIT_FAILURE);
+        }
+        paths[i] = file_list[i].path;
       }
 
-      if (!validate_file_path(file_list[i].path)) {
-        fprintf(stderr, "ERR - Invalid file path: %s\n", file_list[i].path);
+      if (processFilesIntoTimeline(paths, file_count, config->ingest_jobs) != EXIT_SUCCESS) {
+        fprintf(stderr, "ERR - Failed to process files\n");
+        XFREE(paths);
         XFREE(file_list);
         finalizeProcessing();
         cleanup();
         return (EXIT_FAILURE);
       }
-      if (processFileIntoTimeline(file_list[i].path) != EXIT_SUCCESS) {
-        fprintf(stderr, "ERR - Failed to process file\n");
-        XFREE(file_list);
-        finalizeProcessing();
-        cleanup();
-        return (EXIT_FAILURE);
+      XFREE(paths);
+    } else {
+      for (int i = 0; i < file_count; i++) {
+        /* Update current time in main loop (not in signal handler) */
+        if (time(&config->current_time) EQ - 1) {
+          display(LOG_ERR, "Unable to update current time");
+          XFREE(file_list);
+          finalizeProcessing();
+          cleanup();
+          return (EXIT_FAILURE);
+        }
+
+        if (strcmp(file_list[i].path, LOG_PARSER_STDIN) != 0 && !validate_file_path(file_list[i].path)) {
+          fprintf(stderr, "ERR - Invalid file path: %s\n", file_list[i].path);
+          XFREE(file_list);
+          finalizeProcessing();
+          cleanup();
+          return (EXIT_FAILURE);
+        }
+        if (processFileIntoTimeline(file_list[i].path) != EXIT_SUCCESS) {
+          fprintf(stderr, "ERR - Failed to process file\n");
+          XFREE(file_list);
+          finalizeProcessing();
+          cleanup();
+          return (EXIT_FAILURE);
+        }
       }
     }
 
     /* Free file list */
     XFREE(file_list);
 
+    /* Checkpoint for the next run, before the last bin is rendered */
+    if (config->save_state_file && saveProcessingState(config->save_state_file) != EXIT_SUCCESS) {
+      finalizeProcessing();
+      cleanup();
+      return (EXIT_FAILURE);
+    }
+
     /* Finalize processing and generate video */
     if (finalizeProcessing() != EXIT_SUCCESS) {
       fprintf(stderr, "ERR - Failed to finalize processing\n");
@@ -634,6 +797,8 @@ void show_info(void)
 PRIVATE void print_version(void)
 {
   printf("%s v%s [%s - %s]\n", PROGNAME, VERSION, __DATE__, __TIME__);
+  printf("inflate: %s\n", getDecompressBackend());
+  printf("formats: %s\n", getDecompressFormats());
 }
 
 /****
@@ -661,45 +826,83 @@ PRIVATE void print_help(void)
 #ifdef HAVE_GETOPT_LONG
   fprintf(stderr, " -A|--asn-db FILE       MaxMind ASN database (default: GeoLite2-ASN.mmdb)\n");
   fprintf(stderr, "                        required for --mapping asn or country-asn\n");
+  fprintf(stderr, " -B|--render-jobs N     render finished frames on N threads; events are\n");
+  fprintf(stderr, "                        still binned on one thread (default: 1 = inline,\n");
+  fprintf(stderr, "                        0 = all CPUs)\n");
   fprintf(stderr, " -c|--codec CODEC       video codec (default: libx264)\n");
   fprintf(stderr, "                        examples: libx264, libx265, libvpx-vp9\n");
   fprintf(stderr, " -C|--cidr-map FILE     CIDR mapping file (default: cidr_map.txt)\n");
   fprintf(stderr, " -d|--debug (0-9)       enable debugging info\n");
   fprintf(stderr, " -D|--duration SECS     target video duration in seconds (default: 300)\n");
   fprintf(stderr, "                        FPS and decay auto-scale based on data span\n");
+  fprintf(stderr, " -e|--exp-decay         fade coordinates exponentially (busy ones linger)\n");
   fprintf(stderr, " -f|--fps FPS           video framerate (default: auto-scaled)\n");
   fprintf(stderr, "                        baseline: 1 day = 3 FPS, scales linearly\n");
   fprintf(stderr, " -G|--country-db FILE   MaxMind Country database (default: GeoLite2-Country.mmdb)\n");
   fprintf(stderr, "                        required for --mapping country or country-asn\n");
   fprintf(stderr, " -h|--help              this info\n");
+  fprintf(stderr, " -j|--jobs N            parse all files on N threads, merged by timestamp\n");
+  fprintf(stderr, "                        (default: 1 = one file at a time, 0 = all CPUs)\n");
+  fprintf(stderr, "                        .gz files over 64MB are indexed (FILE.tpidx) and\n");
+  fprintf(stderr, "                        split across threads\n");
+  fprintf(stderr, " -l|--load-state FILE   resume residue, decay and the unfinished bin from a\n");
+  fprintf(stderr, "                        checkpoint written by --save-state\n");
+  fprintf(stderr, " -L|--mem-limit MB      memory for dense heatmap, residue and mask buffers;\n");
+  fprintf(stderr, "                        what does not fit is kept sparse (default: 0 =\n");
+  fprintf(stderr, "                        half of RAM)\n");
+  fprintf(stderr, " -m|--decay-mem MB      decay cache memory budget (default: %d, 0 = unlimited)\n", DECAY_CACHE_BUDGET_DEFAULT_MB);
   fprintf(stderr, " -M|--mapping STRATEGY  coordinate mapping strategy (default: hilbert-ip)\n");
   fprintf(stderr, "                        hilbert-ip: Direct IP with optional CIDR clustering\n");
   fprintf(stderr, "                        asn: Group by network ownership (AS number)\n");
   fprintf(stderr, "                        country: Group by geographic country\n");
   fprintf(stderr, "                        country-asn: Hybrid country+ASN grouping\n");
   fprintf(stderr, " -o|--output DIR        output directory for frames/video (default: plots)\n");
+  fprintf(stderr, " -O|--order N           Hilbert curve order, heatmap is 2^N cells square\n");
+  fprintf(stderr, "                        (%d-%d, default: %d)\n", HILBERT_ORDER_MIN, HILBERT_ORDER_MAX, HILBERT_ORDER_DEFAULT);
   fprintf(stderr, " -p|--period DURATION   time bin period (default: 1m)\n");
   fprintf(stderr, "                        examples: 1m, 5m, 15m, 30m, 60m, 120s, 1h\n");
+  fprintf(stderr, " -P|--prefix-table FILE map addresses with a 64MB /24 lookup table cached\n");
+  fprintf(stderr, "                        in FILE (rebuilt when the order or CIDR map changes)\n");
+  fprintf(stderr, " -R|--no-readahead      decompress on the parsing thread (serial ingest)\n");
+  fprintf(stderr, " -s|--save-state FILE   write a checkpoint for the next run's --load-state\n");
+  fprintf(stderr, " -S|--stats FILE        write per-frame statistics (CSV) to FILE\n");
+  fprintf(stderr, "                        includes distinct source IPs per frame, hour and day\n");
   fprintf(stderr, " -t|--timestamp         show timestamp overlay on frames\n");
   fprintf(stderr, " -v|--version           display version information\n");
   fprintf(stderr, " -V|--verbose           show verbose output (file sorting, parser stats)\n");
-  fprintf(stderr, " filename               one or more files to process\n");
+  fprintf(stderr, " -W|--reorder-window DURATION\n");
+  fprintf(stderr, "                        bin events up to DURATION late in their own bin\n");
+  fprintf(stderr, "                        instead of cutting the frame short; later ones are\n");
+  fprintf(stderr, "                        dropped (default: off)\n");
+  fprintf(stderr, " filename               one or more files to process (- reads stdin)\n");
 #else
   fprintf(stderr, " -A {file}     MaxMind ASN database (default: GeoLite2-ASN.mmdb)\n");
+  fprintf(stderr, " -B {jobs}     frame render threads, binning stays serial (0 = all CPUs)\n");
   fprintf(stderr, " -c {codec}    video codec (default: libx264)\n");
   fprintf(stderr, " -C {file}     CIDR mapping file (default: cidr_map.txt)\n");
   fprintf(stderr, " -d {lvl}      enable debugging info\n");
   fprintf(stderr, " -D {secs}     target video duration (default: 300)\n");
+  fprintf(stderr, " -e            fade coordinates exponentially\n");
   fprintf(stderr, " -f {fps}      video framerate (default: auto-scaled)\n");
   fprintf(stderr, " -G {file}     MaxMind Country database (default: GeoLite2-Country.mmdb)\n");
   fprintf(stderr, " -h            this info\n");
+  fprintf(stderr, " -j {jobs}     parser threads, files merged by timestamp (0 = all CPUs)\n");
+  fprintf(stderr, " -l {file}     resume from a checkpoint\n");
+  fprintf(stderr, " -L {MB}       dense heatmap buffer budget (default: 0 = half of RAM)\n");
+  fprintf(stderr, " -m {MB}       decay cache memory budget (default: %d, 0 = unlimited)\n", DECAY_CACHE_BUDGET_DEFAULT_MB);
   fprintf(stderr, " -M {strategy} mapping strategy (hilbert-ip, asn, country, country-asn)\n");
   fprintf(stderr, " -o {dir}      output directory for frames/video (default: plots)\n");
+  fprintf(stderr, " -O {order}    Hilbert curve order (%d-%d, default: %d)\n", HILBERT_ORDER_MIN, HILBERT_ORDER_MAX, HILBERT_ORDER_DEFAULT);
   fprintf(stderr, " -p {period}   time bin period (default: 1m)\n");
+  fprintf(stderr, " -P {file}     /24 lookup table cache file\n");
+  fprintf(stderr, " -R            decompress on the parsing thread\n");
+  fprintf(stderr, " -s {file}     write a checkpoint when done\n");
+  fprintf(stderr, " -S {file}     write per-frame statistics (CSV) to file\n");
   fprintf(stderr, " -t            show timestamp overlay on frames\n");
   fprintf(stderr, " -v            display version information\n");
   fprintf(stderr, " -V            show verbose output (file sorting, parser stats)\n");
-  fprintf(stderr, " filename      one or more files to process\n");
+  fprintf(stderr, " -W {period}   reorder window for late events (default: off)\n");
+  fprintf(stderr, " filename      one or more files to process (- reads stdin)\n");
 #endif
 
   fprintf(stderr, "\n");
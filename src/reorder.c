@@ -0,0 +1,254 @@
+/*****
+ *
+ * Description: Late Event Reorder Window
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+/****
+ *
+ * The bin manager renders a bin as soon as an event for another bin
+ * shows up, so one line with a skewed clock costs a frame for the bin it
+ * lands in and another for the bin it interrupts. The reorder window
+ * holds events back, grouped by bin, until a later event is a whole
+ * window past their bin, and then hands the bins over oldest first.
+ * Within a bin events keep their arrival order, exactly as without the
+ * window, so in-order input gives the same frames either way.
+ *
+ ****/
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#include "reorder.h"
+#include "mem.h"
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+
+/****
+ *
+ * external variables
+ *
+ ****/
+
+extern Config_t *config;
+
+/****
+ *
+ * functions
+ *
+ ****/
+
+/****
+ *
+ * Ring slot of a bin
+ *
+ ****/
+PRIVATE ReorderBin_t *reorderSlot(ReorderBuffer_t *buf, time_t bin_start)
+{
+    return &buf->bins[(uint64_t)bin_start / buf->bin_seconds % buf->slots];
+}
+
+/****
+ *
+ * Create a reorder window
+ *
+ * PARAMETERS:
+ *   bin_seconds - Time bin period
+ *   window_seconds - How far behind the newest event a late one may be,
+ *                    rounded up to whole bins
+ *
+ * RETURNS:
+ *   Pointer to ReorderBuffer_t, or NULL if window_seconds is 0
+ *
+ * MEMORY:
+ *   One ReorderBin_t per bin in the window; event arrays are allocated
+ *   as bins fill (sizeof(ReorderEvent_t) per held event) and kept for
+ *   reuse
+ *
+ ****/
+ReorderBuffer_t *createReorderBuffer(uint32_t bin_seconds, uint32_t window_seconds)
+{
+    ReorderBuffer_t *buf;
+
+    if (bin_seconds == 0 || window_seconds == 0) {
+        return NULL;
+    }
+
+    buf = (ReorderBuffer_t *)XMALLOC(sizeof(ReorderBuffer_t));
+    XMEMSET(buf, 0, sizeof(ReorderBuffer_t));
+
+    buf->bin_seconds = bin_seconds;
+    buf->slots = (window_seconds + bin_seconds - 1) / bin_seconds + 1;
+    buf->bins = (ReorderBin_t *)XMALLOC((int)(sizeof(ReorderBin_t) * buf->slots));
+    XMEMSET(buf->bins, 0, (int)(sizeof(ReorderBin_t) * buf->slots));
+
+#ifdef DEBUG
+    if (config->debug >= 1) {
+        fprintf(stderr, "DEBUG - Reorder window: %u bins of %us\n", buf->slots - 1, bin_seconds);
+    }
+#endif
+
+    return buf;
+}
+
+/****
+ *
+ * Free a reorder window and any events still held
+ *
+ ****/
+void destroyReorderBuffer(ReorderBuffer_t *buf)
+{
+    uint32_t i;
+
+    if (!buf) {
+        return;
+    }
+
+    for (i = 0; i < buf->slots; i++) {
+        if (buf->bins[i].events) {
+            XFREE(buf->bins[i].events);
+        }
+    }
+    XFREE(buf->bins);
+    XFREE(buf);
+}
+
+/****
+ *
+ * Hold an event until its bin leaves the window
+ *
+ * DESCRIPTION:
+ *   Appends the event to its open bin. Call takeReorderBin() for the
+ *   event's bin first, so bins the event pushes out of the window are
+ *   handed over before their ring slots are reused.
+ *
+ * PARAMETERS:
+ *   buf - Reorder window
+ *   bin_start - Start of the event's time bin
+ *   event - Event to hold (copied)
+ *
+ * RETURNS:
+ *   TRUE if held, FALSE if dropped (counted in buf->late) because its
+ *   bin was already handed over or is too full to grow
+ *
+ ****/
+int addReorderEvent(ReorderBuffer_t *buf, time_t bin_start, const ReorderEvent_t *event)
+{
+    ReorderBin_t *bin;
+    size_t capacity;
+
+    if (!buf->base) {
+        buf->base = bin_start;
+    }
+    if (bin_start < buf->base) {
+        buf->late++;
+        return FALSE;
+    }
+
+    bin = reorderSlot(buf, bin_start);
+    if (bin->bin_start != bin_start) {
+        /* Slot last held a bin that has been handed over */
+        bin->bin_start = bin_start;
+        bin->count = 0;
+    }
+
+    if (bin->count == bin->capacity) {
+        capacity = bin->capacity ? bin->capacity * 2 : REORDER_INITIAL_EVENTS;
+        if (capacity > (size_t)INT_MAX / sizeof(ReorderEvent_t)) {
+            buf->late++;
+            return FALSE;
+        }
+        if (bin->events) {
+            bin->events = (ReorderEvent_t *)XREALLOC(bin->events, (int)(sizeof(ReorderEvent_t) * capacity));
+        } else {
+            bin->events = (ReorderEvent_t *)XMALLOC((int)(sizeof(ReorderEvent_t) * capacity));
+        }
+        bin->capacity = capacity;
+    }
+
+    bin->events[bin->count++] = *event;
+    buf->pending++;
+
+    return TRUE;
+}
+
+/****
+ *
+ * Hand over the oldest bin that has left the window
+ *
+ * DESCRIPTION:
+ *   A bin leaves the window once an event arrives for a bin a whole
+ *   window after it. Call repeatedly until NULL before adding an event,
+ *   and with flush set at the end of input to empty the window. Empty
+ *   bins are skipped.
+ *
+ * PARAMETERS:
+ *   buf - Reorder window
+ *   bin_start - Start of the bin of the event about to be added
+ *   flush - TRUE to hand over every held bin regardless of bin_start
+ *
+ * RETURNS:
+ *   Bin whose events should be processed now (valid until the next
+ *   addReorderEvent()), or NULL if none is due
+ *
+ * PERFORMANCE:
+ *   O(1) per bin passed over; a gap with nothing held is jumped
+ *
+ ****/
+const ReorderBin_t *takeReorderBin(ReorderBuffer_t *buf, time_t bin_start, int flush)
+{
+    time_t span, start;
+    ReorderBin_t *bin;
+    uint32_t slot;
+
+    if (!buf || !buf->base) {
+        return NULL;
+    }
+    span = (time_t)buf->slots * (time_t)buf->bin_seconds;
+
+    for (;;) {
+        if (!buf->pending) {
+            if (flush) {
+                /* Start over, the next event may be for any bin */
+                for (slot = 0; slot < buf->slots; slot++) {
+                    buf->bins[slot].count = 0;
+                }
+                buf->base = 0;
+            } else if (bin_start >= buf->base + span) {
+                buf->base = bin_start - span + (time_t)buf->bin_seconds;
+            }
+            return NULL;
+        }
+        if (!flush && bin_start < buf->base + span) {
+            return NULL;
+        }
+
+        start = buf->base;
+        bin = reorderSlot(buf, start);
+        buf->base += (time_t)buf->bin_seconds;
+        if (bin->count && bin->bin_start == start) {
+            buf->pending -= bin->count;
+            return bin;
+        }
+    }
+}
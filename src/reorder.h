@@ -0,0 +1,108 @@
+/*****
+ *
+ * Description: Late Event Reorder Window Headers
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+#ifndef REORDER_DOT_H
+#define REORDER_DOT_H
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "../include/sysdep.h"
+
+#ifndef __SYSDEP_H__
+#error something is messed up
+#endif
+
+#include "../include/common.h"
+#include <stdint.h>
+#include <time.h>
+
+/****
+ *
+ * defines
+ *
+ ****/
+
+#define REORDER_INITIAL_EVENTS 1024         // Initial events per open bin
+#define REORDER_WINDOW_MAX (7 * 86400)      // Upper bound for -W in seconds
+
+/****
+ *
+ * typedefs & structs
+ *
+ ****/
+
+/**
+ * Event held back until its bin leaves the window
+ */
+typedef struct {
+    time_t timestamp;
+    uint32_t src_ip;
+    uint32_t x;                   // Hilbert coordinates, already mapped
+    uint32_t y;
+} ReorderEvent_t;
+
+/**
+ * Events of one open bin, in arrival order
+ */
+typedef struct {
+    time_t bin_start;
+    ReorderEvent_t *events;
+    size_t count;
+    size_t capacity;
+} ReorderBin_t;
+
+/**
+ * Ring of the bins inside the reorder window
+ *
+ * Slot i holds the bin whose start / bin_seconds is i modulo slots.
+ * Bins in [base, base + slots * bin_seconds) are open; events for bins
+ * before base arrived too late and are dropped.
+ */
+typedef struct {
+    uint32_t bin_seconds;
+    uint32_t slots;               // Window in bins, plus the newest bin
+    ReorderBin_t *bins;
+    time_t base;                  // Start of the oldest open bin (0 = nothing held)
+    uint64_t pending;             // Events held
+    uint64_t late;                // Events dropped for arriving after their bin closed
+} ReorderBuffer_t;
+
+/****
+ *
+ * function prototypes
+ *
+ ****/
+
+ReorderBuffer_t *createReorderBuffer(uint32_t bin_seconds, uint32_t window_seconds);
+void destroyReorderBuffer(ReorderBuffer_t *buf);
+int addReorderEvent(ReorderBuffer_t *buf, time_t bin_start, const ReorderEvent_t *event);
+const ReorderBin_t *takeReorderBin(ReorderBuffer_t *buf, time_t bin_start, int flush);
+
+#endif /* REORDER_DOT_H */
@@ -0,0 +1,192 @@
+/*****
+ *
+ * Description: Prefix Table Direct Mapping Test
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+/****
+ *
+ * Run by `make check`. With no CIDR map loaded (the default direct
+ * mapping), maps one address from every /24 through ipToHilbertBatch()
+ * with -P style prefix table turned on, and compares each coordinate
+ * with the per-address curve scaling ipToHilbert() uses without a
+ * table. Each order is checked twice: once building the table and
+ * writing the cache file, once mapping it back from that file.
+ *
+ ****/
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#include "hilbert.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/****
+ *
+ * defines
+ *
+ ****/
+
+#define TEST_CHUNK 65536
+#define TEST_MAX_REPORTED 10
+
+/****
+ *
+ * global variables
+ *
+ ****/
+
+PUBLIC Config_t *config = NULL;
+PUBLIC int quit = FALSE;
+
+PRIVATE const uint8_t test_orders[] = { 8, 12, 14 };
+
+#define TEST_ORDER_COUNT (sizeof(test_orders) / sizeof(test_orders[0]))
+
+PRIVATE unsigned long checked = 0;
+PRIVATE unsigned long failed = 0;
+
+/****
+ *
+ * functions
+ *
+ ****/
+
+/****
+ *
+ * Reference conversion: direct curve scaling, one address at a time
+ *
+ ****/
+PRIVATE void referenceCoord(uint32_t ipv4, uint8_t order, uint32_t *x, uint32_t *y)
+{
+    uint64_t total_points = getTotalPoints(order);
+
+    hilbertIndexToXY(((uint64_t)ipv4 * total_points) >> 32, order, x, y);
+}
+
+/****
+ *
+ * Map one address per /24 in batches and compare with the reference
+ *
+ * DESCRIPTION:
+ *   The host byte varies from prefix to prefix so the levels below the
+ *   /24 are exercised above order 12.
+ *
+ ****/
+PRIVATE void checkOrder(uint8_t order, const char *pass)
+{
+    uint32_t *ipv4, *x, *y;
+    uint32_t want_x, want_y, prefix;
+    size_t i;
+
+    ipv4 = (uint32_t *)malloc(sizeof(uint32_t) * TEST_CHUNK);
+    x = (uint32_t *)malloc(sizeof(uint32_t) * TEST_CHUNK);
+    y = (uint32_t *)malloc(sizeof(uint32_t) * TEST_CHUNK);
+    if (!ipv4 || !x || !y) {
+        fprintf(stderr, "FAIL - out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (prefix = 0; prefix < (1U << 24); prefix += TEST_CHUNK) {
+        for (i = 0; i < TEST_CHUNK; i++) {
+            ipv4[i] = ((prefix + (uint32_t)i) << 8) | (((uint32_t)i * 97U + 13U) & 0xFF);
+        }
+        ipToHilbertBatch(ipv4, TEST_CHUNK, order, x, y);
+
+        for (i = 0; i < TEST_CHUNK; i++) {
+            referenceCoord(ipv4[i], order, &want_x, &want_y);
+            checked++;
+            if (x[i] != want_x || y[i] != want_y) {
+                if (++failed <= TEST_MAX_REPORTED) {
+                    fprintf(stderr, "FAIL - order %u (%s) %u.%u.%u.%u: got %u,%u, want %u,%u\n",
+                            order, pass, ipv4[i] >> 24, (ipv4[i] >> 16) & 0xFF, (ipv4[i] >> 8) & 0xFF,
+                            ipv4[i] & 0xFF, x[i], y[i], want_x, want_y);
+                }
+            }
+        }
+    }
+
+    free(ipv4);
+    free(x);
+    free(y);
+}
+
+/****
+ *
+ * main
+ *
+ ****/
+int main(void)
+{
+    Config_t test_config;
+    char dir[] = "/tmp/tplot_test_prefixXXXXXX";
+    char path[sizeof(dir) + 16];
+    struct stat st;
+    size_t i;
+    off_t want_size = (off_t)(sizeof(HilbertPrefixHeader_t) + (size_t)HILBERT_PREFIX_ENTRIES * sizeof(uint32_t));
+
+    memset(&test_config, 0, sizeof(test_config));
+    config = &test_config;
+
+    if (mkdtemp(dir) == NULL) {
+        fprintf(stderr, "FAIL - cannot create a scratch directory\n");
+        return EXIT_FAILURE;
+    }
+    snprintf(path, sizeof(path), "%s/prefix.tbl", dir);
+
+    for (i = 0; i < TEST_ORDER_COUNT; i++) {
+        if (!initHilbert(test_orders[i])) {
+            return EXIT_FAILURE;
+        }
+
+        /* First run builds the table and writes the cache file */
+        unlink(path);
+        if (!usePrefixTable(path)) {
+            return EXIT_FAILURE;
+        }
+        checkOrder(test_orders[i], "built");
+        if (stat(path, &st) != 0 || st.st_size != want_size) {
+            fprintf(stderr, "FAIL - order %u: %s was not written by the batch mapper\n", test_orders[i], path);
+            failed++;
+        }
+
+        /* Second run maps the table back from the file */
+        if (!usePrefixTable(path)) {
+            return EXIT_FAILURE;
+        }
+        checkOrder(test_orders[i], "mapped");
+
+        freePrefixTable();
+        deInitHilbert();
+    }
+
+    unlink(path);
+    rmdir(dir);
+
+    fprintf(stderr, "%lu addresses in %u orders, %lu mismatched\n", checked, (unsigned int)TEST_ORDER_COUNT, failed);
+
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,257 @@
+/*****
+ *
+ * Description: PacketTime Parser DST Test
+ *
+ * Copyright (c) 2025, Ron Dilley
+ * All rights reserved.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ****/
+
+/****
+ *
+ * Run by `make check`. Parses every second of the days around DST
+ * changes in several time zones with parseTimestamp() (fixed-width
+ * parser plus cached local midnight) and compares the result with the
+ * sscanf()/mktime() conversion the parser replaced. Days are walked in
+ * order and then interleaved, so the midnight cache keeps switching
+ * between uniform days and transition days. Exits 77 (skipped) when
+ * none of the zones is installed.
+ *
+ ****/
+
+/****
+ *
+ * includes
+ *
+ ****/
+
+#include "log_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/****
+ *
+ * defines
+ *
+ ****/
+
+#define TEST_ZONEINFO "/usr/share/zoneinfo/"
+#define TEST_MAX_REPORTED 10
+
+/****
+ *
+ * typedefs & structs
+ *
+ ****/
+
+/**
+ * Zone and the days to check in it
+ */
+typedef struct {
+    const char *zone;
+    const char *days[6];     /* YYYY-MM-DD, NULL terminated */
+} TestZone_t;
+
+/****
+ *
+ * global variables
+ *
+ ****/
+
+PUBLIC Config_t *config = NULL;
+PUBLIC int quit = FALSE;
+
+PRIVATE const TestZone_t test_zones[] = {
+    /* 02:00 skipped in March, 01:00-01:59 repeated in November */
+    { "America/New_York", { "2024-03-09", "2024-03-10", "2024-03-11", "2024-11-02", "2024-11-03", NULL } },
+    /* 01:00 skipped in March, 01:00-01:59 repeated in October */
+    { "Europe/London", { "2024-03-30", "2024-03-31", "2024-10-27", "2024-10-28", NULL, NULL } },
+    /* Half-hour shift: 01:30-01:59 repeated in April, 02:00-02:29 skipped in October */
+    { "Australia/Lord_Howe", { "2024-04-06", "2024-04-07", "2024-10-06", "2024-10-07", NULL, NULL } },
+    /* Changes at midnight: 00:00 skipped in November, 23:00-23:59 repeated in February */
+    { "America/Sao_Paulo", { "2018-11-03", "2018-11-04", "2019-02-16", "2019-02-17", NULL, NULL } },
+    { "UTC", { "2024-03-10", "2024-11-03", NULL, NULL, NULL, NULL } }
+};
+
+#define TEST_ZONE_COUNT (sizeof(test_zones) / sizeof(test_zones[0]))
+
+PRIVATE unsigned long checked = 0;
+PRIVATE unsigned long failed = 0;
+
+/****
+ *
+ * functions
+ *
+ ****/
+
+/****
+ *
+ * Reference conversion: sscanf() and mktime() on every line
+ *
+ ****/
+PRIVATE int referenceTimestamp(const char *time_str, time_t *timestamp, uint32_t *microseconds)
+{
+    struct tm tm_info;
+    int year, month, day, hour, min, sec, usec;
+    int parsed;
+
+    if (strncmp(time_str, "PacketTime:", 11) == 0) {
+        time_str += 11;
+    }
+
+    parsed = sscanf(time_str, "%d-%d-%d %d:%d:%d.%d",
+                    &year, &month, &day, &hour, &min, &sec, &usec);
+    if (parsed < 6) {
+        return FALSE;
+    }
+
+    memset(&tm_info, 0, sizeof(struct tm));
+    tm_info.tm_year = year - 1900;
+    tm_info.tm_mon = month - 1;
+    tm_info.tm_mday = day;
+    tm_info.tm_hour = hour;
+    tm_info.tm_min = min;
+    tm_info.tm_sec = sec;
+    tm_info.tm_isdst = -1;
+
+    *timestamp = mktime(&tm_info);
+    if (*timestamp == (time_t)-1) {
+        return FALSE;
+    }
+    *microseconds = (parsed == 7) ? (uint32_t)usec : 0;
+
+    return TRUE;
+}
+
+/****
+ *
+ * Parse one timestamp both ways and compare
+ *
+ ****/
+PRIVATE void checkTimestamp(const char *zone, const char *time_str)
+{
+    time_t got = 0, want = 0;
+    uint32_t got_usec = 0, want_usec = 0;
+    int got_ok, want_ok;
+
+    got_ok = parseTimestamp(time_str, &got, &got_usec);
+    want_ok = referenceTimestamp(time_str, &want, &want_usec);
+
+    checked++;
+    if (got_ok != want_ok || (want_ok && (got != want || got_usec != want_usec))) {
+        if (++failed <= TEST_MAX_REPORTED) {
+            fprintf(stderr, "FAIL - %s \"%s\": got %d/%ld.%06u, want %d/%ld.%06u\n",
+                    zone, time_str, got_ok, (long)got, got_usec, want_ok, (long)want, want_usec);
+        }
+    }
+}
+
+/****
+ *
+ * Check every second of a day
+ *
+ * DESCRIPTION:
+ *   Each second is parsed with the "PacketTime:" prefix the sensor
+ *   writes, alternating between a six-digit fraction and none.
+ *
+ ****/
+PRIVATE void checkDay(const char *zone, const char *day)
+{
+    char line[64];
+    int second;
+
+    for (second = 0; second < 86400; second++) {
+        if (second & 1) {
+            snprintf(line, sizeof(line), "PacketTime:%s %02d:%02d:%02d.%06d",
+                     day, second / 3600, (second / 60) % 60, second % 60, (second * 7919) % 1000000);
+        } else {
+            snprintf(line, sizeof(line), "PacketTime:%s %02d:%02d:%02d",
+                     day, second / 3600, (second / 60) % 60, second % 60);
+        }
+        checkTimestamp(zone, line);
+    }
+}
+
+/****
+ *
+ * Check the days of one zone, in order and then interleaved
+ *
+ * RETURNS:
+ *   TRUE if the zone was checked, FALSE if it is not installed
+ *
+ ****/
+PRIVATE int checkZone(const TestZone_t *test)
+{
+    char path[256];
+    char line[64];
+    int i, j, count;
+
+    snprintf(path, sizeof(path), "%s%s", TEST_ZONEINFO, test->zone);
+    if (access(path, R_OK) != 0) {
+        fprintf(stderr, "SKIP - %s not installed\n", test->zone);
+        return FALSE;
+    }
+
+    setenv("TZ", test->zone, 1);
+    tzset();
+
+    for (count = 0; count < 6 && test->days[count]; count++) {
+        checkDay(test->zone, test->days[count]);
+    }
+
+    /* Hop between days every line so the midnight cache is rebuilt each time */
+    for (i = 0; i < 86400; i += 59) {
+        for (j = 0; j < count; j++) {
+            snprintf(line, sizeof(line), "%s %02d:%02d:%02d.%d",
+                     test->days[j], i / 3600, (i / 60) % 60, i % 60, i);
+            checkTimestamp(test->zone, line);
+        }
+    }
+
+    return TRUE;
+}
+
+/****
+ *
+ * main
+ *
+ ****/
+int main(void)
+{
+    Config_t test_config;
+    size_t i;
+    int zones = 0;
+
+    memset(&test_config, 0, sizeof(test_config));
+    config = &test_config;
+    initLogParser();
+
+    for (i = 0; i < TEST_ZONE_COUNT; i++) {
+        zones += checkZone(&test_zones[i]);
+    }
+
+    if (zones == 0) {
+        fprintf(stderr, "SKIP - no time zone data under %s\n", TEST_ZONEINFO);
+        return 77;
+    }
+
+    fprintf(stderr, "%lu timestamps in %d zones, %lu mismatched\n", checked, zones, failed);
+
+    return (failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
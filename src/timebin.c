@@ -31,6 +31,14 @@
 #include "util.h"
 #include <string.h>
 #include <strings.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 
 /****
  *
@@ -222,14 +230,276 @@ time_t getBinForTime(time_t event_time, uint32_t bin_seconds)
     return (event_time / bin_seconds) * bin_seconds;
 }
 
+/****
+ *
+ * Hash a heatmap index to a sparse table slot
+ *
+ ****/
+PRIVATE uint32_t binCellSlot(uint32_t idx, uint32_t mask)
+{
+    uint32_t h = idx * 0x9E3779B1U;
+
+    return (h ^ (h >> 16)) & mask;
+}
+
+/****
+ *
+ * Page-granular dirty tracking
+ *
+ * DESCRIPTION:
+ *   Bin storage is cleared by page on reuse: writers flag the page they
+ *   touch and clearDirtyPages() zeroes only flagged pages, so recycling a
+ *   bin costs what the bin used rather than what it could hold.
+ *
+ ****/
+PRIVATE size_t dirtyPageCount(size_t bytes)
+{
+    return (bytes + TIMEBIN_PAGE_SIZE - 1) / TIMEBIN_PAGE_SIZE;
+}
+
+PRIVATE void clearDirtyPages(void *base, size_t bytes, uint8_t *dirty)
+{
+    size_t page, pages = dirtyPageCount(bytes);
+    size_t offset, len;
+
+    for (page = 0; page < pages; page++) {
+        if (dirty[page]) {
+            offset = page * TIMEBIN_PAGE_SIZE;
+            len = (bytes - offset < TIMEBIN_PAGE_SIZE) ? bytes - offset : TIMEBIN_PAGE_SIZE;
+            memset((char *)base + offset, 0, len);
+            dirty[page] = 0;
+        }
+    }
+}
+
+#define GRID_PAGE(idx) ((size_t)(idx) * sizeof(uint32_t) / TIMEBIN_PAGE_SIZE)
+#define CELL_PAGE(slot) ((size_t)(slot) * sizeof(TimeBinCell_t) / TIMEBIN_PAGE_SIZE)
+
+/****
+ *
+ * Allocate an empty cell table
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on allocation failure (bin unchanged)
+ *
+ ****/
+PRIVATE int allocTimeBinCells(TimeBin_t *bin, uint32_t capacity)
+{
+    size_t bytes = sizeof(TimeBinCell_t) * capacity;
+    TimeBinCell_t *cells;
+    uint8_t *dirty;
+
+    cells = (TimeBinCell_t *)XMALLOC((int)bytes);
+    if (!cells) {
+        return FALSE;
+    }
+    dirty = (uint8_t *)XMALLOC((int)dirtyPageCount(bytes));
+    if (!dirty) {
+        XFREE(cells);
+        return FALSE;
+    }
+    memset(cells, 0, bytes);
+    memset(dirty, 0, dirtyPageCount(bytes));
+
+    bin->cells = cells;
+    bin->cells_dirty = dirty;
+    bin->cell_capacity = capacity;
+    bin->cell_count = 0;
+
+    return TRUE;
+}
+
+/****
+ *
+ * Move a sparse bin's counts into its dense grid
+ *
+ * DESCRIPTION:
+ *   Allocates the full dimension x dimension grid the first time this bin
+ *   goes dense (a recycled bin reuses the one it already has) and
+ *   scatters the occupied cells into it. Used once a bin is busy enough
+ *   that the table would be slower than the grid. The table is left as
+ *   it is and cleared on the next reset.
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on allocation failure (bin left sparse)
+ *
+ ****/
+PRIVATE int makeTimeBinDense(TimeBin_t *bin)
+{
+    size_t grid_size = (size_t)bin->dimension * bin->dimension * sizeof(uint32_t);
+    uint32_t i, idx;
+
+    if (!bin->grid) {
+        bin->grid = (uint32_t *)XMALLOC((int)grid_size);
+        if (!bin->grid) {
+            return FALSE;
+        }
+        bin->grid_dirty = (uint8_t *)XMALLOC((int)dirtyPageCount(grid_size));
+        if (!bin->grid_dirty) {
+            XFREE(bin->grid);
+            bin->grid = NULL;
+            return FALSE;
+        }
+        memset(bin->grid, 0, grid_size);
+        memset(bin->grid_dirty, 0, dirtyPageCount(grid_size));
+    }
+
+    for (i = 0; i < bin->cell_capacity; i++) {
+        if (bin->cells[i].count) {
+            idx = bin->cells[i].idx;
+            bin->grid[idx] = bin->cells[i].count;
+            bin->grid_dirty[GRID_PAGE(idx)] = 1;
+        }
+    }
+
+    bin->heatmap = bin->grid;
+    bin->dense = TRUE;
+
+#ifdef DEBUG
+    if (config->debug >= 2) {
+        fprintf(stderr, "DEBUG - Time bin went dense (%u events)\n", bin->event_count);
+    }
+#endif
+
+    return TRUE;
+}
+
+/****
+ *
+ * Make room for another occupied cell in a sparse bin
+ *
+ * DESCRIPTION:
+ *   Doubles the cell table (rehashing every occupied cell) while it stays
+ *   below the dense threshold, otherwise switches the bin to its dense
+ *   grid. Bins not allowed a dense grid (memory budget) keep doubling up
+ *   to the largest table one allocation can hold. A grown table stays
+ *   grown when the bin is recycled.
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on allocation failure
+ *
+ ****/
+PRIVATE int growTimeBinCells(TimeBin_t *bin)
+{
+    uint64_t dense_limit = (uint64_t)bin->dimension * bin->dimension / TIMEBIN_DENSE_DIVISOR;
+    TimeBinCell_t *old_cells = bin->cells;
+    uint8_t *old_dirty = bin->cells_dirty;
+    uint32_t old_capacity = bin->cell_capacity;
+    uint32_t old_count = bin->cell_count;
+    uint32_t i, slot, mask;
+
+    if (bin->dense_allowed && (uint64_t)bin->cell_count + 1 > dense_limit) {
+        return makeTimeBinDense(bin);
+    }
+
+    if ((uint64_t)sizeof(TimeBinCell_t) * old_capacity * 2 > GRIDMAP_DENSE_MAX) {
+        fprintf(stderr, "ERR - Sparse time bin is full (%u cells)\n", old_count);
+        return FALSE;
+    }
+
+    if (!allocTimeBinCells(bin, old_capacity * 2)) {
+        return FALSE;
+    }
+
+    mask = bin->cell_capacity - 1;
+    for (i = 0; i < old_capacity; i++) {
+        if (old_cells[i].count) {
+            slot = binCellSlot(old_cells[i].idx, mask);
+            while (bin->cells[slot].count) {
+                slot = (slot + 1) & mask;
+            }
+            bin->cells[slot] = old_cells[i];
+            bin->cells_dirty[CELL_PAGE(slot)] = 1;
+        }
+    }
+    bin->cell_count = old_count;
+
+    XFREE(old_cells);
+    XFREE(old_dirty);
+
+    return TRUE;
+}
+
+/****
+ *
+ * Add to the count of one heatmap cell
+ *
+ * DESCRIPTION:
+ *   Common update for events and decay. Sparse bins find or insert the
+ *   cell in the open-addressing table (linear probing, kept at most 3/4
+ *   full); dense bins index the heatmap directly. Adding 0 never creates
+ *   a cell. cell_count follows every cell that goes from 0 to non-zero,
+ *   whether from an event or from decay, so it is the bin's number of
+ *   non-zero cells in either representation.
+ *
+ * PARAMETERS:
+ *   bin - Time bin
+ *   idx - Heatmap index (y * dimension + x), already bounds-checked
+ *   amount - Count to add
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on allocation failure
+ *
+ ****/
+PRIVATE int addToBinCell(TimeBin_t *bin, uint32_t idx, uint32_t amount)
+{
+    TimeBinCell_t *cell;
+    uint32_t slot, mask, value;
+
+    if (amount == 0) {
+        return TRUE;
+    }
+
+    if (!bin->dense) {
+        mask = bin->cell_capacity - 1;
+        slot = binCellSlot(idx, mask);
+        while (bin->cells[slot].count && bin->cells[slot].idx != idx) {
+            slot = (slot + 1) & mask;
+        }
+        cell = &bin->cells[slot];
+
+        if (cell->count == 0) {
+            if ((bin->cell_count + 1) * 4 > bin->cell_capacity * 3) {
+                if (!growTimeBinCells(bin)) {
+                    return FALSE;
+                }
+                return addToBinCell(bin, idx, amount);
+            }
+            cell->idx = idx;
+            bin->cell_count++;
+            bin->cells_dirty[CELL_PAGE(slot)] = 1;
+        }
+        cell->count += amount;
+        value = cell->count;
+
+        if (bin->heatmap_borrowed) {
+            bin->heatmap[idx] = value;
+        }
+    } else {
+        if (bin->grid[idx] == 0) {
+            bin->cell_count++;
+        }
+        bin->grid[idx] += amount;
+        bin->grid_dirty[GRID_PAGE(idx)] = 1;
+        value = bin->grid[idx];
+    }
+
+    if (value > bin->max_intensity) {
+        bin->max_intensity = value;
+    }
+
+    return TRUE;
+}
+
 /****
  *
  * Create new time bin heatmap
  *
  * DESCRIPTION:
- *   Allocates and initializes a TimeBin_t structure with zero-initialized
- *   heatmap array. The heatmap is a 2D array stored in row-major order
- *   (heatmap[y * dimension + x]). Sets bin time boundaries and dimension.
+ *   Allocates and initializes a sparse TimeBin_t: an empty table of
+ *   TIMEBIN_SPARSE_INITIAL_CELLS occupied-cell slots and no dense
+ *   heatmap. Sets bin time boundaries and dimension. The bin turns dense
+ *   by itself if it fills up (see addEventToBin()).
  *
  * PARAMETERS:
  *   start_time - Bin start time (Unix epoch seconds)
@@ -244,34 +514,22 @@ time_t getBinForTime(time_t event_time, uint32_t bin_seconds)
  *   Allocates memory via XMALLOC() (must be freed with destroyTimeBin())
  *   Prints debug message if config->debug >= 2
  *
- * ALGORITHM:
- *   1. Allocate TimeBin_t structure
- *   2. Zero-initialize structure
- *   3. Set bin_start = start_time
- *   4. Set bin_end = start_time + bin_seconds
- *   5. Set dimension
- *   6. Allocate heatmap array: dimension * dimension * sizeof(uint32_t)
- *   7. Zero-initialize heatmap
- *   8. Print debug info if enabled
- *
  * PERFORMANCE:
- *   O(dimension²) due to heatmap allocation and zeroing
- *   For dimension=4096: ~67MB allocation, ~10-50ms initialization
+ *   O(1) - 32KB cell table instead of a dimension^2 grid (64MB at 4096)
  *
  * MEMORY:
- *   sizeof(TimeBin_t) + dimension² * sizeof(uint32_t)
- *   Example (dimension=4096): 48 bytes + 16,777,216 bytes ≈ 16MB
+ *   sizeof(TimeBin_t) + 8 bytes per table slot; a bin that goes dense
+ *   holds dimension^2 * sizeof(uint32_t) instead
  *
  * NOTES:
  *   - Caller must call destroyTimeBin() to free memory
- *   - Heatmap starts with all zeros (no activity)
- *   - event_count, unique_ips, max_intensity all initialized to 0
+ *   - event_count, unique_cells, unique_src_ips, max_intensity all 0
+ *   - The bin manager recycles bins instead (acquireTimeBin())
  *
  ****/
 TimeBin_t *createTimeBin(time_t start_time, uint32_t bin_seconds, uint32_t dimension)
 {
     TimeBin_t *bin;
-    size_t heatmap_size;
 
     bin = (TimeBin_t *)XMALLOC(sizeof(TimeBin_t));
     if (!bin) {
@@ -283,17 +541,14 @@ TimeBin_t *createTimeBin(time_t start_time, uint32_t bin_seconds, uint32_t dimen
     bin->bin_start = start_time;
     bin->bin_end = start_time + bin_seconds;
     bin->dimension = dimension;
+    bin->dense_allowed = TRUE;
 
-    /* Allocate heatmap array */
-    heatmap_size = dimension * dimension * sizeof(uint32_t);
-    bin->heatmap = (uint32_t *)XMALLOC((int)heatmap_size);
-    if (!bin->heatmap) {
+    /* Allocate occupied-cell table */
+    if (!allocTimeBinCells(bin, TIMEBIN_SPARSE_INITIAL_CELLS)) {
         XFREE(bin);
         return NULL;
     }
 
-    memset(bin->heatmap, 0, heatmap_size);
-
 #ifdef DEBUG
     if (config->debug >= 2) {
         char time_str[32];
@@ -326,16 +581,18 @@ TimeBin_t *createTimeBin(time_t start_time, uint32_t bin_seconds, uint32_t dimen
  *
  * ALGORITHM:
  *   1. Check if bin is NULL (early return if so)
- *   2. Free heatmap array if non-NULL
- *   3. Free bin structure
+ *   2. Free dense grid and its dirty flags if allocated
+ *   3. Free cell table and its dirty flags
+ *   4. Free bin structure
  *
  * PERFORMANCE:
- *   O(1) - Two XFREE() calls
+ *   O(1) - Up to five XFREE() calls
  *   Typical: <1μs
  *
  * NOTES:
  *   - Safe to call multiple times (first call frees, subsequent are no-ops if pointer set to NULL)
  *   - Does not validate bin contents (assumes valid structure)
+ *   - An expanded bin must be collapsed first or the render grid stays dirty
  *
  ****/
 void destroyTimeBin(TimeBin_t *bin)
@@ -344,8 +601,14 @@ void destroyTimeBin(TimeBin_t *bin)
         return;
     }
 
-    if (bin->heatmap) {
-        XFREE(bin->heatmap);
+    if (bin->grid) {
+        XFREE(bin->grid);
+        XFREE(bin->grid_dirty);
+    }
+
+    if (bin->cells) {
+        XFREE(bin->cells);
+        XFREE(bin->cells_dirty);
     }
 
     XFREE(bin);
@@ -358,7 +621,8 @@ void destroyTimeBin(TimeBin_t *bin)
  * DESCRIPTION:
  *   Clears all heatmap data and statistics, preparing bin for reuse with
  *   new time period. More efficient than destroy+create cycle since it
- *   reuses existing allocations. Zeros heatmap and resets counters.
+ *   reuses existing allocations. Only the pages of the cell table and
+ *   dense grid written since the last reset are zeroed.
  *
  * PARAMETERS:
  *   bin - Pointer to TimeBin_t to reset (may be NULL for no-op)
@@ -367,26 +631,28 @@ void destroyTimeBin(TimeBin_t *bin)
  *   void
  *
  * SIDE EFFECTS:
- *   Zeros heatmap array
- *   Resets event_count, unique_ips, max_intensity to 0
+ *   Empties the cell table and zeros the dense grid (dirty pages only)
+ *   Returns the bin to the sparse representation (heatmap = NULL)
+ *   Resets event_count, unique statistics, max_intensity and the IP sketch
  *   Does NOT modify bin_start, bin_end, or dimension
  *
  * ALGORITHM:
  *   1. Check if bin is NULL (early return if so)
- *   2. Calculate heatmap_size = dimension * dimension * sizeof(uint32_t)
- *   3. memset(heatmap, 0, heatmap_size)
- *   4. Set event_count = 0
- *   5. Set unique_ips = 0
- *   6. Set max_intensity = 0
+ *   2. Clear dirty pages of the cell table, set cell_count = 0
+ *   3. Clear dirty pages of the dense grid if one was allocated
+ *   4. Set dense = FALSE, heatmap = NULL
+ *   5. Set event_count, unique_cells, unique_src_ips, max_intensity = 0
+ *   6. Clear the source IP sketch (4KB)
  *
  * PERFORMANCE:
- *   O(dimension²) due to memset() on heatmap
- *   For dimension=4096: ~10-20ms to zero 16MB array
+ *   O(pages written), one 4KB memset per dirty page
+ *   A quiet bin costs a few pages; a fully dense 4096x4096 grid costs the
+ *   same ~10-20ms as zeroing it outright
  *
  * NOTES:
  *   - Caller should update bin_start and bin_end after reset
- *   - More efficient than destroyTimeBin() + createTimeBin()
- *   - Preserves bin structure and heatmap allocation
+ *   - A borrowed render grid must be returned first (collapseTimeBin())
+ *   - Preserves the cell table (at its grown size) and the dense grid
  *
  ****/
 void resetTimeBin(TimeBin_t *bin)
@@ -395,14 +661,168 @@ void resetTimeBin(TimeBin_t *bin)
         return;
     }
 
-    size_t heatmap_size = bin->dimension * bin->dimension * sizeof(uint32_t);
-    memset(bin->heatmap, 0, heatmap_size);
+    clearDirtyPages(bin->cells, sizeof(TimeBinCell_t) * bin->cell_capacity, bin->cells_dirty);
+    bin->cell_count = 0;
+
+    if (bin->grid) {
+        clearDirtyPages(bin->grid, (size_t)bin->dimension * bin->dimension * sizeof(uint32_t),
+                        bin->grid_dirty);
+    }
+
+    bin->dense = FALSE;
+    bin->heatmap = NULL;
+    bin->heatmap_borrowed = FALSE;
 
     bin->event_count = 0;
-    bin->unique_ips = 0;
+    bin->unique_cells = 0;
+    bin->unique_src_ips = 0;
+    hllClear(&bin->src_ips);
     bin->max_intensity = 0;
 }
 
+/****
+ *
+ * Take a cleared bin from the manager's pool
+ *
+ * DESCRIPTION:
+ *   Returns a recycled bin reset for the period starting at start_time,
+ *   or a newly created one when the pool is empty. In steady state every
+ *   bin comes from the pool, so no bin storage is allocated per period.
+ *
+ * PARAMETERS:
+ *   manager - Pointer to TimeBinManager_t
+ *   start_time - Bin start timestamp (aligned)
+ *
+ * RETURNS:
+ *   Pointer to an empty TimeBin_t, NULL on allocation failure
+ *
+ ****/
+TimeBin_t *acquireTimeBin(TimeBinManager_t *manager, time_t start_time)
+{
+    TimeBin_t *bin;
+
+    if (!manager) {
+        return NULL;
+    }
+
+    if (manager->pool_count == 0) {
+        bin = createTimeBin(start_time, manager->config.bin_seconds, manager->config.dimension);
+        if (bin) {
+            bin->dense_allowed = manager->config.dense_bins;
+        }
+        return bin;
+    }
+
+    bin = manager->bin_pool[--manager->pool_count];
+    resetTimeBin(bin);
+    bin->bin_start = start_time;
+    bin->bin_end = start_time + (time_t)manager->config.bin_seconds;
+
+    return bin;
+}
+
+/****
+ *
+ * Hand a finished bin back to the manager's pool
+ *
+ * DESCRIPTION:
+ *   Returns any borrowed render grid and keeps the bin for the next
+ *   acquireTimeBin(). The bin is cleared when it is taken again, not
+ *   here, so a released bin stays readable until then. Bins beyond
+ *   TIMEBIN_POOL_SIZE are destroyed.
+ *
+ * PARAMETERS:
+ *   manager - Pointer to TimeBinManager_t
+ *   bin - Bin to release (may be NULL for no-op)
+ *
+ * RETURNS:
+ *   void
+ *
+ ****/
+void releaseTimeBin(TimeBinManager_t *manager, TimeBin_t *bin)
+{
+    if (!manager || !bin) {
+        return;
+    }
+
+    collapseTimeBin(manager, bin);
+
+    if (manager->pool_count < manager->pool_capacity) {
+        manager->bin_pool[manager->pool_count++] = bin;
+    } else {
+        destroyTimeBin(bin);
+    }
+}
+
+/****
+ *
+ * Finish the current bin and detach it from the manager
+ *
+ * DESCRIPTION:
+ *   Does what processEvent() does with the current bin when an event
+ *   starts a new one - finalize it and count it written - but hands the
+ *   bin to the caller instead of the pool. Used when a frame is still
+ *   being rendered from the bin after binning has moved on; the caller
+ *   gives it back with releaseTimeBin() once done.
+ *
+ * PARAMETERS:
+ *   manager - Pointer to TimeBinManager_t
+ *
+ * RETURNS:
+ *   The former current bin, NULL if there was none
+ *
+ * SIDE EFFECTS:
+ *   Increments manager->bins_written, clears manager->current_bin
+ *
+ ****/
+TimeBin_t *retireTimeBin(TimeBinManager_t *manager)
+{
+    TimeBin_t *bin;
+
+    if (!manager || !manager->current_bin) {
+        return NULL;
+    }
+
+    bin = manager->current_bin;
+    finalizeBin(bin);
+    manager->bins_written++;
+    manager->current_bin = NULL;
+
+    return bin;
+}
+
+/****
+ *
+ * Keep more finished bins for reuse
+ *
+ * DESCRIPTION:
+ *   Raises the number of bins the pool holds to at least bins, for
+ *   callers that keep several bins in flight (bin jobs). Without it
+ *   bins beyond TIMEBIN_POOL_SIZE are freed on release and allocated
+ *   again for a later period.
+ *
+ * PARAMETERS:
+ *   manager - Pointer to TimeBinManager_t
+ *   bins - Pool capacity wanted
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if manager is NULL
+ *
+ ****/
+int reserveTimeBins(TimeBinManager_t *manager, uint32_t bins)
+{
+    if (!manager) {
+        return FALSE;
+    }
+
+    if (bins > manager->pool_capacity) {
+        manager->bin_pool = (TimeBin_t **)XREALLOC(manager->bin_pool, (int)(sizeof(TimeBin_t *) * bins));
+        manager->pool_capacity = bins;
+    }
+
+    return TRUE;
+}
+
 /****
  *
  * Add event to time bin heatmap
@@ -410,7 +830,8 @@ void resetTimeBin(TimeBin_t *bin)
  * DESCRIPTION:
  *   Increments hit count for a specific coordinate in the heatmap.
  *   Updates bin statistics (event_count, max_intensity). Validates
- *   coordinates are within bounds. Uses row-major array indexing.
+ *   coordinates are within bounds. Uses row-major array indexing, into the
+ *   occupied-cell table for sparse bins or the heatmap for dense ones.
  *
  * PARAMETERS:
  *   bin - Pointer to TimeBin_t to update
@@ -419,24 +840,26 @@ void resetTimeBin(TimeBin_t *bin)
  *
  * RETURNS:
  *   TRUE (1) on success
- *   FALSE (0) if bin is NULL, heatmap is NULL, or coordinates out of bounds
+ *   FALSE (0) if bin is NULL, coordinates out of bounds or the cell table
+ *   cannot grow
  *
  * SIDE EFFECTS:
- *   Increments bin->heatmap[y * dimension + x]
+ *   Increments the count for y * dimension + x
  *   Increments bin->event_count
  *   Updates bin->max_intensity if new value is higher
+ *   May grow the cell table or switch the bin to dense
  *
  * ALGORITHM:
- *   1. Validate bin and heatmap pointers
+ *   1. Validate bin pointer
  *   2. Check x < dimension and y < dimension
  *   3. Calculate array index: idx = y * dimension + x
- *   4. Increment heatmap[idx]
+ *   4. Increment the cell for idx (addToBinCell())
  *   5. Increment event_count
- *   6. Update max_intensity if heatmap[idx] > max_intensity
  *
  * PERFORMANCE:
- *   O(1) - Array index calculation and increment
- *   Typical: <10ns
+ *   O(1) - Array index calculation and increment, plus a short probe
+ *   sequence while sparse
+ *   Typical: <10ns dense, ~10-20ns sparse
  *
  * NOTES:
  *   - Uses row-major order: heatmap[y * dimension + x]
@@ -448,7 +871,7 @@ int addEventToBin(TimeBin_t *bin, uint32_t x, uint32_t y)
 {
     uint32_t idx;
 
-    if (!bin || !bin->heatmap) {
+    if (!bin || !bin->cells) {
         return FALSE;
     }
 
@@ -460,14 +883,13 @@ int addEventToBin(TimeBin_t *bin, uint32_t x, uint32_t y)
     /* Calculate index into heatmap */
     idx = y * bin->dimension + x;
 
-    /* Increment hit count */
-    bin->heatmap[idx]++;
+    /* Increment hit count (also tracks max_intensity) */
+    if (!addToBinCell(bin, idx, 1)) {
+        return FALSE;
+    }
 
     /* Update statistics */
     bin->event_count++;
-    if (bin->heatmap[idx] > bin->max_intensity) {
-        bin->max_intensity = bin->heatmap[idx];
-    }
 
     return TRUE;
 }
@@ -477,68 +899,61 @@ int addEventToBin(TimeBin_t *bin, uint32_t x, uint32_t y)
  * Finalize time bin and compute statistics
  *
  * DESCRIPTION:
- *   Computes final statistics for a time bin before output. Scans entire
- *   heatmap to count unique IP locations (non-zero cells). Should be called
- *   after all events for a bin have been added and before visualization.
+ *   Computes final statistics for a time bin before output. Unique cells
+ *   (non-zero heatmap cells) are counted as cells are first written, so
+ *   this only copies the count; distinct source IPs are estimated from
+ *   the bin's HyperLogLog sketch. Should be called after all events and
+ *   decay for a bin have been added and before visualization.
  *
  * PARAMETERS:
  *   bin - Pointer to TimeBin_t to finalize
  *
  * RETURNS:
  *   TRUE (1) on success
- *   FALSE (0) if bin is NULL or heatmap is NULL
+ *   FALSE (0) if bin is NULL or has no counts
  *
  * SIDE EFFECTS:
- *   Updates bin->unique_ips with count of non-zero heatmap cells
+ *   Updates bin->unique_cells and bin->unique_src_ips
  *   Prints debug message if config->debug >= 1
  *
  * ALGORITHM:
- *   1. Validate bin and heatmap pointers
- *   2. Calculate total_points = dimension * dimension
- *   3. Initialize unique_ips = 0
- *   4. For i = 0 to total_points-1:
- *      - If heatmap[i] > 0, increment unique_ips
- *   5. Print debug summary if enabled
+ *   1. Validate bin pointer
+ *   2. unique_cells = cell_count (maintained by addToBinCell())
+ *   3. unique_src_ips = hllCount(src_ips)
+ *   4. Print debug summary if enabled
  *
  * PERFORMANCE:
- *   O(dimension²) - Full heatmap scan
- *   For dimension=4096: ~16M comparisons, ~5-20ms
+ *   O(HLL_REGISTERS) for sparse and dense bins alike, a few microseconds
  *
  * STATISTICS COMPUTED:
- *   - unique_ips: Count of distinct coordinate positions with activity
+ *   - unique_cells: Count of distinct coordinate positions with activity
+ *   - unique_src_ips: Distinct source IPs, ~1.6% standard error
  *   - event_count: Already maintained by addEventToBin()
  *   - max_intensity: Already maintained by addEventToBin()
  *
  * NOTES:
  *   - Call once per bin before output/visualization
- *   - unique_ips may be less than event_count (multiple events per IP)
+ *   - unique_cells counts cells lit only by decay and counts IPs that
+ *     share a cell once, so it can differ from unique_src_ips either way
  *   - Debug output includes bin timestamp and all statistics
  *
  ****/
 int finalizeBin(TimeBin_t *bin)
 {
-    uint32_t i, total_points;
-
-    if (!bin || !bin->heatmap) {
+    if (!bin || !bin->cells) {
         return FALSE;
     }
 
-    /* Count unique IP locations (non-zero cells) */
-    total_points = bin->dimension * bin->dimension;
-    bin->unique_ips = 0;
-
-    for (i = 0; i < total_points; i++) {
-        if (bin->heatmap[i] > 0) {
-            bin->unique_ips++;
-        }
-    }
+    /* Count unique locations (non-zero cells) and estimate unique sources */
+    bin->unique_cells = bin->cell_count;
+    bin->unique_src_ips = hllCount(&bin->src_ips);
 
 #ifdef DEBUG
     if (config->debug >= 1) {
         char time_str[32];
         strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", localtime(&bin->bin_start));
-        fprintf(stderr, "DEBUG - Finalized bin %s: events=%u, unique_ips=%u, max_intensity=%u\n",
-                time_str, bin->event_count, bin->unique_ips, bin->max_intensity);
+        fprintf(stderr, "DEBUG - Finalized bin %s: events=%u, cells=%u, src_ips=%u, max_intensity=%u\n",
+                time_str, bin->event_count, bin->unique_cells, bin->unique_src_ips, bin->max_intensity);
     }
 #endif
 
@@ -547,49 +962,572 @@ int finalizeBin(TimeBin_t *bin)
 
 /****
  *
- * Create time bin manager with decay cache
+ * Merge a finished bin into the hourly and daily source IP totals
  *
  * DESCRIPTION:
- *   Allocates and initializes a TimeBinManager_t structure to manage
- *   multiple time bins with decay tracking. Copies configuration and
- *   allocates decay cache for coordinate persistence across bins.
- *   This is the primary entry point for time binning system.
+ *   Folds the bin's source IP sketch into the manager's sketches for the
+ *   hour and UTC day the bin starts in, starting a sketch over when the
+ *   bin falls in a later hour or day, and updates the estimates. After
+ *   the last bin of an hour, hour_unique_src_ips is that hour's total.
  *
  * PARAMETERS:
- *   config_in - Pointer to TimeBinConfig_t with settings:
- *               - bin_seconds: Time bin duration
- *               - hilbert_order: Curve order for dimension calculation
- *               - dimension: Heatmap width/height (2^order)
- *               - decay_seconds: How long coordinates persist
+ *   manager - Pointer to TimeBinManager_t
+ *   bin - Finished bin, in time order
  *
  * RETURNS:
- *   Pointer to newly allocated TimeBinManager_t on success
- *   NULL on allocation failure or NULL config
+ *   void
  *
  * SIDE EFFECTS:
- *   Allocates memory for manager structure and decay cache
- *   Prints debug message if config->debug >= 1
- *
- * ALGORITHM:
- *   1. Validate config_in pointer
- *   2. Allocate TimeBinManager_t structure
- *   3. Zero-initialize structure
- *   4. Copy config_in to manager->config
- *   5. Set cache_capacity = DECAY_CACHE_MAX_ENTRIES (65536)
- *   6. Allocate decay_cache array
- *   7. Zero-initialize decay cache
- *   8. Initialize counters (current_bin=NULL, cache_size=0, etc.)
- *   9. Print debug summary if enabled
+ *   Updates hour/day sketches, start times and estimates in manager
  *
  * PERFORMANCE:
- *   O(1) allocation + O(cache_capacity) zeroing
- *   Typical: <1ms for 65536-entry cache
- *
- * MEMORY:
- *   sizeof(TimeBinManager_t) + (cache_capacity * sizeof(DecayCacheEntry_t))
- *   ~160 bytes + (65536 * 16 bytes) ≈ 1MB for decay cache
+ *   O(HLL_REGISTERS) per bin, two 4KB merges and counts
  *
- * NOTES:
+ ****/
+void accumulateBinTotals(TimeBinManager_t *manager, TimeBin_t *bin)
+{
+    time_t hour_start, day_start;
+
+    if (!manager || !bin) {
+        return;
+    }
+
+    hour_start = getBinForTime(bin->bin_start, 3600);
+    day_start = getBinForTime(bin->bin_start, 86400);
+
+    if (hour_start != manager->hour_start) {
+        hllClear(&manager->hour_src_ips);
+        manager->hour_start = hour_start;
+    }
+    if (day_start != manager->day_start) {
+        hllClear(&manager->day_src_ips);
+        manager->day_start = day_start;
+    }
+
+    hllMerge(&manager->hour_src_ips, &bin->src_ips);
+    hllMerge(&manager->day_src_ips, &bin->src_ips);
+    manager->hour_unique_src_ips = hllCount(&manager->hour_src_ips);
+    manager->day_unique_src_ips = hllCount(&manager->day_src_ips);
+}
+
+/****
+ *
+ * Give a sparse time bin a dense heatmap for rendering
+ *
+ * DESCRIPTION:
+ *   The renderer reads bin->heatmap cell by cell. For a sparse bin, the
+ *   occupied cells are scattered into the manager's render grid and the
+ *   grid is lent to the bin as its heatmap until collapseTimeBin(). The
+ *   grid is allocated on first use and reused for every frame, so only
+ *   the cells a bin touches are ever written or cleared. Dense bins are
+ *   left as they are, and so are sparse bins when the memory budget has
+ *   no room for a render grid (config.dense_render): the renderer then
+ *   reads them through getTimeBinCount().
+ *
+ * PARAMETERS:
+ *   manager - Bin manager that owns the render grid
+ *   bin - Bin about to be rendered
+ *
+ * RETURNS:
+ *   TRUE if the bin can be rendered, FALSE on allocation failure
+ *
+ * SIDE EFFECTS:
+ *   Allocates manager->render_map (dimension² * sizeof(uint32_t)) once
+ *
+ ****/
+int expandTimeBin(TimeBinManager_t *manager, TimeBin_t *bin)
+{
+    size_t grid_size;
+
+    if (!manager || !bin) {
+        return FALSE;
+    }
+
+    if (bin->dense || bin->heatmap_borrowed) {
+        return (bin->heatmap != NULL);
+    }
+
+    if (!manager->config.dense_render) {
+        return TRUE;
+    }
+
+    if (!manager->render_map) {
+        grid_size = (size_t)manager->config.dimension * manager->config.dimension * sizeof(uint32_t);
+        manager->render_map = (uint32_t *)XMALLOC((int)grid_size);
+        if (!manager->render_map) {
+            return FALSE;
+        }
+        memset(manager->render_map, 0, grid_size);
+    }
+
+    return expandTimeBinInto(bin, manager->render_map);
+}
+
+/****
+ *
+ * Give a sparse time bin a caller-owned dense heatmap
+ *
+ * DESCRIPTION:
+ *   expandTimeBin() with a grid that is not the manager's, so bins can be
+ *   rendered on several threads at once. The grid must be all zero and
+ *   dimension² cells; collapseTimeBin() leaves it all zero again.
+ *
+ * PARAMETERS:
+ *   bin - Bin about to be rendered
+ *   grid - Zeroed dimension² grid to lend to the bin, NULL to leave a
+ *          sparse bin sparse
+ *
+ * RETURNS:
+ *   TRUE if the bin can be rendered, FALSE if bin is NULL
+ *
+ ****/
+int expandTimeBinInto(TimeBin_t *bin, uint32_t *grid)
+{
+    uint32_t i;
+
+    if (!bin) {
+        return FALSE;
+    }
+
+    if (bin->dense || bin->heatmap_borrowed) {
+        return (bin->heatmap != NULL);
+    }
+
+    if (!grid) {
+        return TRUE;
+    }
+
+    for (i = 0; i < bin->cell_capacity; i++) {
+        if (bin->cells[i].count) {
+            grid[bin->cells[i].idx] = bin->cells[i].count;
+        }
+    }
+
+    bin->heatmap = grid;
+    bin->heatmap_borrowed = TRUE;
+
+    return TRUE;
+}
+
+/****
+ *
+ * Read one cell of a bin in either representation
+ *
+ * DESCRIPTION:
+ *   Renders sparse bins that were not expanded: looks the cell up in the
+ *   occupied-cell table instead of a dense heatmap. Reads only, so any
+ *   number of threads may call it on a bin nobody is writing.
+ *
+ * PARAMETERS:
+ *   bin - Time bin
+ *   idx - Heatmap index (y * dimension + x)
+ *
+ * RETURNS:
+ *   Hit count of the cell, 0 if it has none
+ *
+ * PERFORMANCE:
+ *   O(1) expected, one probe sequence in a table at most 3/4 full
+ *
+ ****/
+uint32_t getTimeBinCount(const TimeBin_t *bin, uint32_t idx)
+{
+    uint32_t slot, mask;
+
+    if (bin->heatmap) {
+        return bin->heatmap[idx];
+    }
+
+    mask = bin->cell_capacity - 1;
+    slot = binCellSlot(idx, mask);
+    while (bin->cells[slot].count) {
+        if (bin->cells[slot].idx == idx) {
+            return bin->cells[slot].count;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    return 0;
+}
+
+/****
+ *
+ * Return a rendered bin's heatmap to its owner
+ *
+ * DESCRIPTION:
+ *   Clears the cells expandTimeBin() or expandTimeBinInto() wrote into
+ *   the lent grid, leaving it all zero for the next frame, and detaches
+ *   it from the bin. Only the bin and its grid are touched, so a worker
+ *   rendering into its own grid may call this.
+ *
+ * PARAMETERS:
+ *   manager - Bin manager (the bin's, not otherwise used)
+ *   bin - Bin that was expanded (no-op otherwise)
+ *
+ ****/
+void collapseTimeBin(TimeBinManager_t *manager, TimeBin_t *bin)
+{
+    uint32_t i;
+
+    if (!manager || !bin || !bin->heatmap_borrowed) {
+        return;
+    }
+
+    for (i = 0; i < bin->cell_capacity; i++) {
+        if (bin->cells[i].count) {
+            bin->heatmap[bin->cells[i].idx] = 0;
+        }
+    }
+
+    bin->heatmap = NULL;
+    bin->heatmap_borrowed = FALSE;
+}
+
+/****
+ *
+ * Decay cache storage
+ *
+ * DESCRIPTION:
+ *   Cache entries live in a slab that only grows; entry indices stay
+ *   valid across growth so the index table and the expiry wheel can refer
+ *   to them. The index is an open-addressing table (linear probing, at
+ *   most half full) of entry index + 1, keyed on coord_key. Deleted keys
+ *   are removed by shifting the rest of their probe run back, so lookups
+ *   never walk tombstones.
+ *
+ *   Each live entry is on one expiry wheel slot: the slot of the bin
+ *   period in which it ages past decay_seconds, as of when it was
+ *   scheduled. Entries seen again since then are simply rescheduled when
+ *   their slot comes up, so an update never touches the wheel.
+ *
+ ****/
+PRIVATE uint32_t decayKeySlot(uint32_t coord_key, uint32_t mask)
+{
+    uint32_t h = coord_key * 0x9E3779B1U;
+
+    return (h ^ (h >> 16)) & mask;
+}
+
+PRIVATE size_t decayCacheBytes(uint32_t entries)
+{
+    return (size_t)entries * (sizeof(DecayCacheEntry_t) + 2 * sizeof(uint32_t));
+}
+
+PRIVATE uint32_t decayWheelSlot(TimeBinManager_t *manager, time_t when)
+{
+    return (uint32_t)((uint64_t)when / manager->config.bin_seconds % manager->wheel_slots);
+}
+
+/****
+ *
+ * Exponential decay bookkeeping
+ *
+ * DESCRIPTION:
+ *   Exponential entries store their value as of decay_epoch rather than as
+ *   of their own last update, so one factor per frame (decayEpochScale())
+ *   brings every entry to the frame's time and an entry is only written
+ *   when it gets a hit. A hit at time t adds 2^((t - epoch) / half_life);
+ *   once that factor gets large the epoch is moved forward and all stored
+ *   values are rescaled (every DECAY_EXP_REBASE_HALF_LIVES half-lives).
+ *
+ ****/
+PRIVATE double decayEpochScale(TimeBinManager_t *manager, time_t when)
+{
+    return exp2((double)(when - manager->decay_epoch) / manager->decay_half_life);
+}
+
+PRIVATE void rebaseDecayEpoch(TimeBinManager_t *manager, time_t when)
+{
+    double factor = 1.0 / decayEpochScale(manager, when);
+    uint32_t i;
+
+    for (i = 0; i < manager->cache_used; i++) {
+        if (manager->decay_cache[i].intensity) {
+            manager->decay_cache[i].value = (float)(manager->decay_cache[i].value * factor);
+        }
+    }
+    manager->decay_epoch = when;
+}
+
+/****
+ *
+ * Check whether a cache entry has faded out by a given time
+ *
+ * DESCRIPTION:
+ *   Linear entries expire once decay_seconds pass without activity;
+ *   exponential entries once their value drops below DECAY_EXP_FLOOR.
+ *   Expiry, the restart of a trail in updateDecayCache() and the cut-off
+ *   in applyDecayToHeatmap() all use this test, so output does not depend
+ *   on when cleanExpiredCacheEntries() runs.
+ *
+ ****/
+PRIVATE int decayEntryExpired(TimeBinManager_t *manager, DecayCacheEntry_t *entry, time_t when)
+{
+    if (manager->config.decay_model == DECAY_EXPONENTIAL) {
+        return (entry->value < DECAY_EXP_FLOOR * decayEpochScale(manager, when));
+    }
+
+    return (when - entry->last_seen > (time_t)manager->config.decay_seconds);
+}
+
+PRIVATE void destroyDecayCache(TimeBinManager_t *manager)
+{
+    if (manager->decay_cache) {
+        XFREE(manager->decay_cache);
+    }
+    if (manager->cache_index) {
+        XFREE(manager->cache_index);
+    }
+    if (manager->decay_wheel) {
+        XFREE(manager->decay_wheel);
+    }
+}
+
+PRIVATE int createDecayCache(TimeBinManager_t *manager)
+{
+    uint64_t slots;
+
+    if (manager->config.bin_seconds == 0) {
+        manager->config.bin_seconds = TIMEBIN_DEFAULT;
+    }
+
+    manager->cache_capacity = DECAY_CACHE_INITIAL_ENTRIES;
+    manager->cache_index_mask = DECAY_CACHE_INITIAL_ENTRIES * 2 - 1;
+
+    /* One slot per bin period across the decay window, plus the current one */
+    slots = (uint64_t)manager->config.decay_seconds / manager->config.bin_seconds + 2;
+    manager->wheel_slots = (slots > DECAY_WHEEL_MAX_SLOTS) ? DECAY_WHEEL_MAX_SLOTS : (uint32_t)slots;
+
+    manager->decay_cache = (DecayCacheEntry_t *)XMALLOC(
+        (int)(sizeof(DecayCacheEntry_t) * manager->cache_capacity));
+    manager->cache_index = (uint32_t *)XMALLOC(
+        (int)(sizeof(uint32_t) * (manager->cache_index_mask + 1)));
+    manager->decay_wheel = (uint32_t *)XMALLOC((int)(sizeof(uint32_t) * manager->wheel_slots));
+    manager->decay_half_life = (double)manager->config.decay_seconds / DECAY_EXP_HALF_LIVES;
+    if (manager->decay_half_life < 1.0) {
+        manager->decay_half_life = 1.0;
+    }
+
+    if (!manager->decay_cache || !manager->cache_index || !manager->decay_wheel) {
+        destroyDecayCache(manager);
+        return FALSE;
+    }
+
+    memset(manager->decay_cache, 0, sizeof(DecayCacheEntry_t) * manager->cache_capacity);
+    memset(manager->cache_index, 0, sizeof(uint32_t) * (manager->cache_index_mask + 1));
+    memset(manager->decay_wheel, 0, sizeof(uint32_t) * manager->wheel_slots);
+
+    return TRUE;
+}
+
+/****
+ *
+ * Double the decay cache slab and rebuild its index
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if the result would exceed decay_cache_bytes
+ *
+ ****/
+PRIVATE int growDecayCache(TimeBinManager_t *manager)
+{
+    uint32_t new_capacity = manager->cache_capacity * 2;
+    uint32_t new_mask = new_capacity * 2 - 1;
+    uint32_t *new_index;
+    uint32_t i, slot;
+
+    if (new_capacity < manager->cache_capacity ||
+        (manager->config.decay_cache_bytes &&
+         decayCacheBytes(new_capacity) > manager->config.decay_cache_bytes)) {
+        return FALSE;
+    }
+
+    new_index = (uint32_t *)XMALLOC((int)(sizeof(uint32_t) * (new_mask + 1)));
+    if (!new_index) {
+        return FALSE;
+    }
+    memset(new_index, 0, sizeof(uint32_t) * (new_mask + 1));
+
+    manager->decay_cache = (DecayCacheEntry_t *)XREALLOC(manager->decay_cache,
+        (int)(sizeof(DecayCacheEntry_t) * new_capacity));
+    memset(manager->decay_cache + manager->cache_capacity, 0,
+           sizeof(DecayCacheEntry_t) * (new_capacity - manager->cache_capacity));
+
+    for (i = 0; i < manager->cache_used; i++) {
+        if (manager->decay_cache[i].intensity) {
+            slot = decayKeySlot(manager->decay_cache[i].coord_key, new_mask);
+            while (new_index[slot]) {
+                slot = (slot + 1) & new_mask;
+            }
+            new_index[slot] = i + 1;
+        }
+    }
+
+    XFREE(manager->cache_index);
+    manager->cache_index = new_index;
+    manager->cache_index_mask = new_mask;
+    manager->cache_capacity = new_capacity;
+
+#ifdef DEBUG
+    if (config->debug >= 2) {
+        fprintf(stderr, "DEBUG - Decay cache grown to %u entries\n", new_capacity);
+    }
+#endif
+
+    return TRUE;
+}
+
+/****
+ *
+ * Put an entry on the wheel slot where it next ages past decay_seconds
+ *
+ * DESCRIPTION:
+ *   Exponential entries go on the slot where their value is due to drop
+ *   below DECAY_EXP_FLOOR, so heavy hitters stay longer than one window.
+ *
+ ****/
+PRIVATE void scheduleDecayEntry(TimeBinManager_t *manager, uint32_t entry_idx)
+{
+    DecayCacheEntry_t *entry = &manager->decay_cache[entry_idx];
+    time_t expires = entry->last_seen + (time_t)manager->config.decay_seconds + 1;
+    double fade;
+    uint32_t slot;
+
+    if (manager->config.decay_model == DECAY_EXPONENTIAL) {
+        fade = manager->decay_half_life * log2(entry->value / DECAY_EXP_FLOOR);
+        expires = manager->decay_epoch + (time_t)fade + 1;
+        if (expires < manager->wheel_time) {
+            expires = manager->wheel_time;
+        }
+    }
+
+    slot = decayWheelSlot(manager, expires);
+    entry->next = manager->decay_wheel[slot];
+    manager->decay_wheel[slot] = entry_idx + 1;
+}
+
+/****
+ *
+ * Remove an entry from the index and put it on the free list
+ *
+ ****/
+PRIVATE void freeDecayEntry(TimeBinManager_t *manager, uint32_t entry_idx)
+{
+    uint32_t mask = manager->cache_index_mask;
+    uint32_t *index = manager->cache_index;
+    uint32_t i, j, home;
+
+    i = decayKeySlot(manager->decay_cache[entry_idx].coord_key, mask);
+    while (index[i] != entry_idx + 1) {
+        i = (i + 1) & mask;
+    }
+
+    /* Shift later members of the probe run back over the hole */
+    j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (!index[j]) {
+            break;
+        }
+        home = decayKeySlot(manager->decay_cache[index[j] - 1].coord_key, mask);
+        if ((j > i && (home <= i || home > j)) || (j < i && home <= i && home > j)) {
+            index[i] = index[j];
+            i = j;
+        }
+    }
+    index[i] = 0;
+
+    manager->decay_cache[entry_idx].intensity = 0;
+    manager->decay_cache[entry_idx].next = manager->cache_free;
+    manager->cache_free = entry_idx + 1;
+    manager->cache_size--;
+}
+
+/****
+ *
+ * Residue log storage
+ *
+ * DESCRIPTION:
+ *   Blocks are appended by the binning thread only. A reader is told how
+ *   many steps it may replay (the total when its bin was handed over), so
+ *   it only follows a block's next link once that block is full and the
+ *   link is set. Blocks go away only in trimResidueLog(), once every
+ *   reader is past them.
+ *
+ ****/
+PRIVATE void appendResidueStep(TimeBinManager_t *manager, uint32_t idx, uint32_t volume)
+{
+    ResidueLogBlock_t *block;
+    uint32_t offset = (uint32_t)(manager->residue_log_total % RESIDUE_LOG_BLOCK_STEPS);
+
+    if (offset == 0 && manager->residue_log_total != manager->residue_log_tail_base) {
+        block = (ResidueLogBlock_t *)XMALLOC(sizeof(ResidueLogBlock_t));
+        block->next = NULL;
+        manager->residue_log_tail->next = block;
+        manager->residue_log_tail = block;
+        manager->residue_log_tail_base += RESIDUE_LOG_BLOCK_STEPS;
+    }
+
+    manager->residue_log_tail->steps[offset].idx = idx;
+    manager->residue_log_tail->steps[offset].volume = volume;
+    manager->residue_log_total++;
+}
+
+PRIVATE void destroyResidueLog(TimeBinManager_t *manager)
+{
+    ResidueLogBlock_t *block;
+
+    while (manager->residue_log_head) {
+        block = manager->residue_log_head->next;
+        XFREE(manager->residue_log_head);
+        manager->residue_log_head = block;
+    }
+    manager->residue_log_tail = NULL;
+}
+
+/****
+ *
+ * Create time bin manager with decay cache
+ *
+ * DESCRIPTION:
+ *   Allocates and initializes a TimeBinManager_t structure to manage
+ *   multiple time bins with decay tracking. Copies configuration and
+ *   allocates decay cache for coordinate persistence across bins.
+ *   This is the primary entry point for time binning system.
+ *
+ * PARAMETERS:
+ *   config_in - Pointer to TimeBinConfig_t with settings:
+ *               - bin_seconds: Time bin duration
+ *               - hilbert_order: Curve order for dimension calculation
+ *               - dimension: Heatmap width/height (2^order)
+ *               - decay_seconds: How long coordinates persist
+ *
+ * RETURNS:
+ *   Pointer to newly allocated TimeBinManager_t on success
+ *   NULL on allocation failure or NULL config
+ *
+ * SIDE EFFECTS:
+ *   Allocates memory for manager structure and decay cache
+ *   Prints debug message if config->debug >= 1
+ *
+ * ALGORITHM:
+ *   1. Validate config_in pointer
+ *   2. Allocate TimeBinManager_t structure
+ *   3. Zero-initialize structure
+ *   4. Copy config_in to manager->config
+ *   5. Allocate decay cache slab (DECAY_CACHE_INITIAL_ENTRIES), its index
+ *      table and the expiry wheel (one slot per bin period of the decay
+ *      window, at most DECAY_WHEEL_MAX_SLOTS)
+ *   6. Initialize counters (current_bin=NULL, cache_size=0, etc.)
+ *   7. Print debug summary if enabled
+ *
+ * PERFORMANCE:
+ *   O(1) allocation + O(initial cache + wheel) zeroing
+ *   Typical: <1ms
+ *
+ * MEMORY:
+ *   sizeof(TimeBinManager_t) + ~32 bytes per cached coordinate (slab entry
+ *   plus two index slots), growing on demand up to decay_cache_bytes
+ *
+ * NOTES:
  *   - Must call destroyTimeBinManager() to free memory
  *   - No bins created yet (current_bin = NULL)
  *   - Decay cache starts empty (cache_size = 0)
@@ -616,41 +1554,40 @@ TimeBinManager_t *createTimeBinManager(TimeBinConfig_t *config_in)
     manager->total_bins = 0;
     manager->bins_written = 0;
 
-    /* Initialize decay cache */
-    manager->cache_capacity = DECAY_CACHE_MAX_ENTRIES;
-    manager->cache_size = 0;
-    manager->decay_cache = (DecayCacheEntry_t *)XMALLOC(
-        (int)(sizeof(DecayCacheEntry_t) * manager->cache_capacity));
+    manager->bin_pool = (TimeBin_t **)XMALLOC((int)(sizeof(TimeBin_t *) * TIMEBIN_POOL_SIZE));
+    manager->pool_capacity = TIMEBIN_POOL_SIZE;
 
-    if (!manager->decay_cache) {
+    /* Initialize decay cache */
+    if (!createDecayCache(manager)) {
+        XFREE(manager->bin_pool);
         XFREE(manager);
         return NULL;
     }
 
-    memset(manager->decay_cache, 0,
-           sizeof(DecayCacheEntry_t) * manager->cache_capacity);
-
     /* Initialize residue map - persistent attack memory (cumulative volume tracking) */
-    uint32_t residue_map_size = manager->config.dimension * manager->config.dimension * sizeof(uint32_t);
-    manager->residue_map = (uint32_t *)XMALLOC((int)residue_map_size);
+    manager->residue_map = createGridMap(manager->config.hilbert_order, sizeof(uint32_t),
+                                         manager->config.dense_residue ? GRIDMAP_DENSE : GRIDMAP_HASHED);
 
     if (!manager->residue_map) {
-        XFREE(manager->decay_cache);
+        destroyDecayCache(manager);
+        XFREE(manager->bin_pool);
         XFREE(manager);
         return NULL;
     }
 
-    memset(manager->residue_map, 0, residue_map_size);
     manager->residue_count = 0;
     manager->residue_max_volume = 0;
 
 #ifdef DEBUG
     if (config->debug >= 1) {
-        fprintf(stderr, "DEBUG - Created time bin manager: bin_size=%s, order=%u, decay=%us, residue_map=%u bytes\n",
+        fprintf(stderr, "DEBUG - Created time bin manager: bin_size=%s, order=%u, decay=%us, residue_map=%s (%lu bytes), render=%s, bins=%s\n",
                 formatTimeBinDuration(config_in->bin_seconds),
                 config_in->hilbert_order,
                 config_in->decay_seconds,
-                residue_map_size);
+                getGridMapLayoutName(manager->residue_map->layout),
+                (unsigned long)getGridMapBytes(manager->residue_map),
+                config_in->dense_render ? "dense" : "sparse",
+                config_in->dense_bins ? "sparse/dense" : "sparse");
     }
 #endif
 
@@ -672,15 +1609,15 @@ TimeBinManager_t *createTimeBinManager(TimeBinConfig_t *config_in)
  *   void
  *
  * SIDE EFFECTS:
- *   Frees current_bin if non-NULL (via destroyTimeBin())
- *   Frees decay_cache if non-NULL
+ *   Frees current_bin and pooled bins (via destroyTimeBin())
+ *   Frees decay cache slab, index and expiry wheel
  *   Frees manager structure
  *   Invalidates manager pointer (caller should set to NULL)
  *
  * ALGORITHM:
  *   1. Check if manager is NULL (early return if so)
- *   2. Destroy current_bin if non-NULL
- *   3. Free decay_cache if non-NULL
+ *   2. Destroy current_bin if non-NULL, then every pooled bin
+ *   3. Free decay cache (destroyDecayCache())
  *   4. Free manager structure
  *
  * PERFORMANCE:
@@ -703,12 +1640,20 @@ void destroyTimeBinManager(TimeBinManager_t *manager)
         destroyTimeBin(manager->current_bin);
     }
 
-    if (manager->decay_cache) {
-        XFREE(manager->decay_cache);
+    while (manager->pool_count > 0) {
+        destroyTimeBin(manager->bin_pool[--manager->pool_count]);
     }
+    XFREE(manager->bin_pool);
+
+    destroyDecayCache(manager);
+    destroyResidueLog(manager);
 
     if (manager->residue_map) {
-        XFREE(manager->residue_map);
+        destroyGridMap(manager->residue_map);
+    }
+
+    if (manager->render_map) {
+        XFREE(manager->render_map);
     }
 
     XFREE(manager);
@@ -720,13 +1665,14 @@ void destroyTimeBinManager(TimeBinManager_t *manager)
  *
  * DESCRIPTION:
  *   Main event processing function that manages time bin lifecycle.
- *   Automatically creates new bins as time progresses, finalizes and
- *   destroys old bins, and adds events to the current bin. Updates
+ *   Automatically starts new bins as time progresses, finalizes and
+ *   recycles old bins, and adds events to the current bin. Updates
  *   decay cache to track coordinate persistence across bins.
  *
  * PARAMETERS:
  *   manager - Pointer to TimeBinManager_t
  *   event_time - Event timestamp (Unix epoch seconds)
+ *   src_ip - Event source IP (counted in the bin's IP sketch)
  *   x - Hilbert curve X coordinate for event source IP
  *   y - Hilbert curve Y coordinate for event source IP
  *
@@ -735,8 +1681,8 @@ void destroyTimeBinManager(TimeBinManager_t *manager)
  *   FALSE (0) if manager is NULL or bin operations fail
  *
  * SIDE EFFECTS:
- *   May create new time bin (allocates memory)
- *   May finalize and destroy current bin (frees memory)
+ *   May take a new time bin from the pool (allocates only if pool is empty)
+ *   May finalize current bin and return it to the pool
  *   Updates decay cache with coordinate activity
  *   Increments manager->total_bins when creating new bin
  *   Increments manager->bins_written when finalizing bin
@@ -749,17 +1695,17 @@ void destroyTimeBinManager(TimeBinManager_t *manager)
  *   4. If bin mismatch or no current bin:
  *      a. Finalize current_bin if it exists
  *      b. Increment bins_written
- *      c. Destroy current_bin
- *      d. Create new bin with bin_start
+ *      c. Release current_bin to the pool
+ *      d. Acquire a bin for bin_start
  *      e. Increment total_bins
  *   5. Update decay cache with (x, y, event_time, intensity=1)
- *   6. Add event to current bin at (x, y)
+ *   6. Add src_ip to the bin's IP sketch
+ *   7. Add event to current bin at (x, y)
  *
  * PERFORMANCE:
  *   Same bin: O(1) for cache update + addEventToBin()
- *   New bin: O(dimension²) for finalize + O(dimension²) for create
+ *   New bin: O(1) finalize + O(pages touched) reset of a recycled bin
  *   Typical same-bin: <100ns
- *   Typical new-bin: ~20-50ms for dimension=4096
  *
  * NOTES:
  *   - Events MUST be processed in time order for correct binning
@@ -768,7 +1714,7 @@ void destroyTimeBinManager(TimeBinManager_t *manager)
  *   - Bin output handled via external visualization callbacks
  *
  ****/
-int processEvent(TimeBinManager_t *manager, time_t event_time, uint32_t x, uint32_t y)
+int processEvent(TimeBinManager_t *manager, time_t event_time, uint32_t src_ip, uint32_t x, uint32_t y)
 {
     time_t bin_start;
 
@@ -783,14 +1729,11 @@ int processEvent(TimeBinManager_t *manager, time_t event_time, uint32_t x, uint3
     if (!manager->current_bin || bin_start != manager->current_bin->bin_start) {
         /* Finalize current bin if it exists (rendering handled externally) */
         if (manager->current_bin) {
-            finalizeBin(manager->current_bin);
-            manager->bins_written++;
-            destroyTimeBin(manager->current_bin);
+            releaseTimeBin(manager, retireTimeBin(manager));
         }
 
-        /* Create new bin */
-        manager->current_bin = createTimeBin(bin_start, manager->config.bin_seconds,
-                                            manager->config.dimension);
+        /* Start new bin, recycled from the pool when one is available */
+        manager->current_bin = acquireTimeBin(manager, bin_start);
         if (!manager->current_bin) {
             return FALSE;
         }
@@ -804,6 +1747,9 @@ int processEvent(TimeBinManager_t *manager, time_t event_time, uint32_t x, uint3
     /* Mark coordinate in residue map for persistent attack memory */
     markResidue(manager, x, y);
 
+    /* Count the source toward the bin's distinct IPs */
+    hllAdd(&manager->current_bin->src_ips, src_ip);
+
     /* Add event to current bin */
     return addEventToBin(manager->current_bin, x, y);
 }
@@ -814,9 +1760,9 @@ int processEvent(TimeBinManager_t *manager, time_t event_time, uint32_t x, uint3
  *
  * DESCRIPTION:
  *   Records or updates coordinate activity in decay cache for persistence
- *   across time bins. Creates combined coordinate key from x,y and either
- *   updates existing entry or adds new entry if space available. Linear
- *   search through cache (acceptable for 65K entries with good locality).
+ *   across time bins. Creates combined coordinate key from x,y, looks it
+ *   up in the cache index and either updates the existing entry or adds a
+ *   new one. The cache grows as needed up to the configured memory budget.
  *
  * PARAMETERS:
  *   manager - Pointer to TimeBinManager_t
@@ -831,30 +1777,33 @@ int processEvent(TimeBinManager_t *manager, time_t event_time, uint32_t x, uint3
  *
  * SIDE EFFECTS:
  *   Updates existing cache entry (last_seen, intensity) if coordinate found
- *   Adds new cache entry if not found and cache not full
+ *   Adds new cache entry if not found, growing the cache if needed
  *   Increments manager->cache_size when adding new entry
+ *   Increments manager->cache_dropped if the budget is exhausted
  *
  * ALGORITHM:
  *   1. Validate manager and decay_cache pointers
  *   2. Create coord_key = (x << 16) | y  // Pack x,y into single uint32_t
- *   3. Linear search cache for matching coord_key
+ *   3. Probe the index from hash(coord_key) until the key or an empty slot
  *   4. If found:
+ *      - If it has faded out (decayEntryExpired()), restart intensity
+ *        (same as if it had already been expired), else add intensity
+ *      - Exponential model: add intensity * 2^((t - epoch) / half_life)
+ *        to value, rebasing the epoch first if that factor is too large
  *      - Update last_seen = event_time
- *      - Add intensity to existing intensity
- *   5. If not found and cache_size < cache_capacity:
- *      - Add new entry at cache_size index
- *      - Set coord_key, last_seen, intensity
+ *   5. If not found:
+ *      - Take an entry from the free list, the slab, or grow the slab
+ *      - Insert it in the index and schedule it on the expiry wheel
  *      - Increment cache_size
  *
  * PERFORMANCE:
- *   Best case (found early): O(1)
- *   Average case: O(cache_size/2) for linear search
- *   Worst case: O(cache_size) = O(65536)
- *   Typical: 50-500ns depending on cache locality
+ *   O(1) expected: the index is kept at most half full
+ *   Growth: O(cache_size) rehash when the slab doubles
  *
  * CACHE EVICTION:
- *   When cache is full (cache_size == cache_capacity), old entries are NOT
- *   added until cleanExpiredCacheEntries() is called to compact the cache.
+ *   Entries are removed by cleanExpiredCacheEntries() once they age past
+ *   decay_seconds. When the memory budget is reached, new coordinates are
+ *   not tracked (and do not fade) until expiry frees room.
  *
  * COORD_KEY FORMAT:
  *   coord_key = (x << 16) | y
@@ -866,35 +1815,81 @@ int processEvent(TimeBinManager_t *manager, time_t event_time, uint32_t x, uint3
 int updateDecayCache(TimeBinManager_t *manager, uint32_t x, uint32_t y,
                      time_t event_time, uint32_t intensity)
 {
-    uint32_t coord_key, i;
-    int found = FALSE;
+    DecayCacheEntry_t *entry;
+    uint32_t coord_key, slot, ref;
+    double weight = 0.0;
 
     if (!manager || !manager->decay_cache) {
         return FALSE;
     }
 
+    if (!intensity) {
+        return TRUE;
+    }
+
+    /* Weight of this hit relative to the exponential epoch */
+    if (manager->config.decay_model == DECAY_EXPONENTIAL) {
+        if (!manager->decay_epoch) {
+            manager->decay_epoch = event_time;
+        } else if ((double)(event_time - manager->decay_epoch) >
+                   manager->decay_half_life * DECAY_EXP_REBASE_HALF_LIVES) {
+            rebaseDecayEpoch(manager, event_time);
+        }
+        weight = (double)intensity * decayEpochScale(manager, event_time);
+    }
+
     /* Create coordinate key: combine x and y into single uint32_t */
     coord_key = (x << 16) | y;
 
     /* Search for existing entry */
-    for (i = 0; i < manager->cache_size; i++) {
-        if (manager->decay_cache[i].coord_key == coord_key) {
-            /* Update existing entry */
-            manager->decay_cache[i].last_seen = event_time;
-            manager->decay_cache[i].intensity += intensity;
-            found = TRUE;
-            break;
+    slot = decayKeySlot(coord_key, manager->cache_index_mask);
+    while ((ref = manager->cache_index[slot]) != 0) {
+        entry = &manager->decay_cache[ref - 1];
+        if (entry->coord_key == coord_key) {
+            if (decayEntryExpired(manager, entry, event_time)) {
+                /* Faded out but not yet cleaned: start a new trail */
+                entry->intensity = intensity;
+                entry->value = (float)weight;
+            } else {
+                entry->intensity += intensity;
+                entry->value = (float)(entry->value + weight);
+            }
+            entry->last_seen = event_time;
+            return TRUE;
         }
+        slot = (slot + 1) & manager->cache_index_mask;
     }
 
-    /* Add new entry if not found and space available */
-    if (!found && manager->cache_size < manager->cache_capacity) {
-        manager->decay_cache[manager->cache_size].coord_key = coord_key;
-        manager->decay_cache[manager->cache_size].last_seen = event_time;
-        manager->decay_cache[manager->cache_size].intensity = intensity;
-        manager->cache_size++;
+    /* Add new entry */
+    if (manager->cache_free) {
+        ref = manager->cache_free;
+        manager->cache_free = manager->decay_cache[ref - 1].next;
+    } else {
+        if (manager->cache_used == manager->cache_capacity && !growDecayCache(manager)) {
+            if (manager->cache_dropped++ == 0) {
+                fprintf(stderr, "WARN - Decay cache reached its %zu MB budget, new coordinates will not fade\n",
+                        manager->config.decay_cache_bytes / (1024 * 1024));
+            }
+            return TRUE;
+        }
+        ref = ++manager->cache_used;
+
+        /* Growth rebuilt the index, find the insert slot again */
+        slot = decayKeySlot(coord_key, manager->cache_index_mask);
+        while (manager->cache_index[slot]) {
+            slot = (slot + 1) & manager->cache_index_mask;
+        }
     }
 
+    entry = &manager->decay_cache[ref - 1];
+    entry->coord_key = coord_key;
+    entry->last_seen = event_time;
+    entry->intensity = intensity;
+    entry->value = (float)weight;
+    manager->cache_index[slot] = ref;
+    manager->cache_size++;
+    scheduleDecayEntry(manager, ref - 1);
+
     return TRUE;
 }
 
@@ -906,7 +1901,8 @@ int updateDecayCache(TimeBinManager_t *manager, uint32_t x, uint32_t y,
  *   Overlays cached coordinate activity onto current bin's heatmap with
  *   time-based decay. Coordinates fade over time based on age relative to
  *   decay_seconds. Enables visualization of persistent attackers and
- *   temporal patterns. Uses linear decay function.
+ *   temporal patterns. Uses the linear or exponential decay function
+ *   (config.decay_model).
  *
  * PARAMETERS:
  *   manager - Pointer to TimeBinManager_t with decay cache
@@ -916,12 +1912,12 @@ int updateDecayCache(TimeBinManager_t *manager, uint32_t x, uint32_t y,
  *   void
  *
  * SIDE EFFECTS:
- *   Modifies bin->heatmap by adding decayed intensity values
+ *   Adds decayed intensity values to the bin's cells (sparse or dense)
  *   Updates bin->max_intensity if decayed values create new peak
  *   No modification of decay_cache itself
  *
- * ALGORITHM:
- *   For each cache entry (i = 0 to cache_size-1):
+ * ALGORITHM (linear):
+ *   For each live cache entry (slab 0 to cache_used-1, intensity != 0):
  *     1. Calculate age = bin_start - last_seen
  *     2. Skip if age > decay_seconds or age < 0 (future event)
  *     3. Calculate decay_factor = 1.0 - (age / decay_seconds)
@@ -935,15 +1931,25 @@ int updateDecayCache(TimeBinManager_t *manager, uint32_t x, uint32_t y,
  *     8. Add decayed_intensity to heatmap[y * dimension + x]
  *     9. Update max_intensity if needed
  *
+ * ALGORITHM (exponential):
+ *   Compute inv_scale = 2^-((bin_start - epoch) / half_life) once, then for
+ *   each live entry decayed_intensity = value * inv_scale (minimum 1),
+ *   skipping entries below DECAY_EXP_FLOOR and future events as above.
+ *
  * PERFORMANCE:
- *   O(cache_size) - Linear scan through decay cache
- *   Typical: 0.5-5ms for 65K entries
+ *   O(cache_used) - Linear scan through the decay cache slab
+ *   Typical: 0.5-5ms per 65K entries
+ *   Exponential entries cost one multiply each
  *
  * DECAY FUNCTION:
  *   Linear: intensity(t) = base_intensity * (1 - age/decay_period)
  *   - Simple and predictable
  *   - Events fade smoothly to zero
  *   - Minimum intensity of 1 ensures visibility until fully expired
+ *   Exponential: intensity(t) = sum over hits of 2^-((t - t_hit) / half_life)
+ *   - half_life = decay_period / DECAY_EXP_HALF_LIVES
+ *   - A single hit shows for one decay period, busy cells for longer
+ *   - Recent activity outweighs old activity, so long windows stay readable
  *
  * EXAMPLES:
  *   decay_seconds = 10800 (3 hours)
@@ -954,27 +1960,64 @@ int updateDecayCache(TimeBinManager_t *manager, uint32_t x, uint32_t y,
  ****/
 void applyDecayToHeatmap(TimeBinManager_t *manager, TimeBin_t *bin)
 {
-    uint32_t i, x, y, idx;
+    uint32_t i, x, y, idx, decayed_intensity;
     time_t age;
     float decay_factor;
+    double inv_scale = 0.0, decayed;
+    int exponential;
+
+    if (!manager || !bin || !manager->decay_cache || !bin->cells) {
+        return;
+    }
+
+    /* One factor brings every exponential entry to the bin start */
+    exponential = (manager->config.decay_model == DECAY_EXPONENTIAL);
+    if (exponential) {
+        if (!manager->decay_epoch) {
+            return;
+        }
+        inv_scale = 1.0 / decayEpochScale(manager, bin->bin_start);
+    }
+
+    /* Apply each cached coordinate to the heatmap with decay */
+    for (i = 0; i < manager->cache_used; i++) {
+        if (!manager->decay_cache[i].intensity) {
+            continue;
+        }
+
+        /* Calculate age of this coordinate */
+        age = bin->bin_start - manager->decay_cache[i].last_seen;
+
+        if (exponential) {
+            decayed = manager->decay_cache[i].value * inv_scale;
+
+            /* Skip if faded out or a future event */
+            if (decayed < DECAY_EXP_FLOOR || age < 0) {
+                continue;
+            }
+
+            decayed_intensity = (decayed >= (double)UINT32_MAX) ? UINT32_MAX : (uint32_t)decayed;
+            if (decayed_intensity < 1) {
+                decayed_intensity = 1;  /* Keep at least 1 for visibility */
+            }
+        } else {
+            /* Skip if too old (beyond decay period) */
+            if (age > (time_t)manager->config.decay_seconds || age < 0) {
+                continue;
+            }
 
-    if (!manager || !bin || !manager->decay_cache) {
-        return;
-    }
+            /* Calculate decay factor (1.0 = fresh, 0.0 = fully decayed) */
+            decay_factor = 1.0f - ((float)age / (float)manager->config.decay_seconds);
 
-    /* Apply each cached coordinate to the heatmap with decay */
-    for (i = 0; i < manager->cache_size; i++) {
-        /* Calculate age of this coordinate */
-        age = bin->bin_start - manager->decay_cache[i].last_seen;
+            /* Minimum 1 to keep visible */
+            decayed_intensity = (uint32_t)(
+                (float)manager->decay_cache[i].intensity * decay_factor);
 
-        /* Skip if too old (beyond decay period) */
-        if (age > (time_t)manager->config.decay_seconds || age < 0) {
-            continue;
+            if (decayed_intensity < 1 && decay_factor > 0.0f) {
+                decayed_intensity = 1;  /* Keep at least 1 for visibility */
+            }
         }
 
-        /* Calculate decay factor (1.0 = fresh, 0.0 = fully decayed) */
-        decay_factor = 1.0f - ((float)age / (float)manager->config.decay_seconds);
-
         /* Extract x,y from coord_key */
         x = (manager->decay_cache[i].coord_key >> 16) & 0xFFFF;
         y = manager->decay_cache[i].coord_key & 0xFFFF;
@@ -987,20 +2030,8 @@ void applyDecayToHeatmap(TimeBinManager_t *manager, TimeBin_t *bin)
         /* Calculate index and add decayed intensity */
         idx = y * bin->dimension + x;
 
-        /* Add decayed intensity to heatmap (minimum 1 to keep visible) */
-        uint32_t decayed_intensity = (uint32_t)(
-            (float)manager->decay_cache[i].intensity * decay_factor);
-
-        if (decayed_intensity < 1 && decay_factor > 0.0f) {
-            decayed_intensity = 1;  /* Keep at least 1 for visibility */
-        }
-
-        bin->heatmap[idx] += decayed_intensity;
-
-        /* Update max intensity if needed */
-        if (bin->heatmap[idx] > bin->max_intensity) {
-            bin->max_intensity = bin->heatmap[idx];
-        }
+        /* Also updates max intensity if needed */
+        addToBinCell(bin, idx, decayed_intensity);
     }
 }
 
@@ -1009,10 +2040,12 @@ void applyDecayToHeatmap(TimeBinManager_t *manager, TimeBin_t *bin)
  * Clean expired entries from decay cache
  *
  * DESCRIPTION:
- *   Removes expired entries from decay cache by compacting the array.
- *   An entry is expired if its age (current_time - last_seen) exceeds
- *   decay_seconds. Uses in-place compaction to maintain cache without
- *   reallocation. Should be called periodically to prevent cache overflow.
+ *   Advances the expiry wheel to current_time and frees every entry that
+ *   has faded out: its age (current_time - last_seen) exceeds decay_seconds,
+ *   or for the exponential model its value is below DECAY_EXP_FLOOR. Only the wheel
+ *   slots for bin periods since the previous call are visited, so each
+ *   entry is looked at about once per decay window instead of the whole
+ *   cache being scanned.
  *
  * PARAMETERS:
  *   manager - Pointer to TimeBinManager_t with decay cache
@@ -1022,75 +2055,125 @@ void applyDecayToHeatmap(TimeBinManager_t *manager, TimeBin_t *bin)
  *   void
  *
  * SIDE EFFECTS:
- *   Compacts decay_cache array (moves entries, preserves order)
- *   Updates manager->cache_size to new size after cleaning
+ *   Returns expired entries to the free list and removes them from the index
+ *   Reschedules entries seen again since they were scheduled
+ *   Updates manager->cache_size and manager->wheel_time
  *   Prints debug message if config->debug >= 2
  *
  * ALGORITHM:
  *   1. Validate manager and decay_cache pointers
- *   2. Initialize write_idx = 0 (compaction target index)
- *   3. For i = 0 to cache_size-1:
- *      a. Calculate age = current_time - last_seen
- *      b. Check if age <= decay_seconds and age >= 0 (not future)
- *      c. If valid:
- *         - Copy entry[i] to entry[write_idx] if i != write_idx
- *         - Increment write_idx
- *   4. Update cache_size = write_idx
- *   5. Print debug summary if enabled
+ *   2. Work out the bin periods from wheel_time's to current_time's (all
+ *      slots on the first call or after a gap longer than the wheel)
+ *   3. For each such slot, detach its list and for each entry:
+ *      a. Free it if it has faded out (decayEntryExpired())
+ *      b. Otherwise reschedule it for when it is next due
+ *   4. Set wheel_time = current_time
  *
  * PERFORMANCE:
- *   O(cache_size) - Single pass through cache
- *   Typical: 0.1-1ms for 65K entries
- *
- * COMPACTION EXAMPLE:
- *   Before: [valid, expired, valid, expired, valid]  (size=5)
- *   After:  [valid, valid, valid, ?, ?]              (size=3)
- *   Entries marked '?' are beyond new size (ignored)
+ *   O(entries due) per call, amortized O(1) per cached coordinate per
+ *   decay window (or per wheel revolution for windows longer than
+ *   DECAY_WHEEL_MAX_SLOTS bin periods)
  *
  * WHEN TO CALL:
- *   - Periodically during long runs (e.g., every 1000 events)
- *   - When cache_size approaches cache_capacity
- *   - Before applying decay to ensure cache has space for new entries
+ *   - Once per finished bin, with the bin start time
  *
  * NOTES:
- *   - Does NOT shrink cache allocation, only reduces logical size
- *   - Preserves insertion order of remaining entries
- *   - Future events (age < 0) are also removed as invalid
+ *   - Does NOT shrink cache allocation, freed entries are reused
+ *   - Expiry matches the age test in applyDecayToHeatmap(), so calling it
+ *     more or less often changes memory use, not output
  *
  ****/
 void cleanExpiredCacheEntries(TimeBinManager_t *manager, time_t current_time)
 {
-    uint32_t i, write_idx;
+    uint64_t first, last, period;
+    uint32_t slot, ref, next;
+#ifdef DEBUG
+    uint32_t expired = 0;
+#endif
 
     if (!manager || !manager->decay_cache) {
         return;
     }
 
-    write_idx = 0;
+    last = (uint64_t)current_time / manager->config.bin_seconds;
+    if (manager->wheel_time) {
+        /* Entries due later in the last period visited were put back on its slot */
+        first = (uint64_t)manager->wheel_time / manager->config.bin_seconds;
+        if (first > last) {
+            return;
+        }
+    } else {
+        first = 0;
+    }
+    if (last - first >= manager->wheel_slots) {
+        first = last - manager->wheel_slots + 1;
+    }
 
-    /* Compact array by removing expired entries */
-    for (i = 0; i < manager->cache_size; i++) {
-        time_t age = current_time - manager->decay_cache[i].last_seen;
+    for (period = first; period <= last; period++) {
+        slot = (uint32_t)(period % manager->wheel_slots);
+        ref = manager->decay_wheel[slot];
+        manager->decay_wheel[slot] = 0;
 
-        /* Keep entry if still within decay period */
-        if (age <= (time_t)manager->config.decay_seconds && age >= 0) {
-            if (write_idx != i) {
-                manager->decay_cache[write_idx] = manager->decay_cache[i];
+        while (ref) {
+            next = manager->decay_cache[ref - 1].next;
+            if (decayEntryExpired(manager, &manager->decay_cache[ref - 1], current_time)) {
+                freeDecayEntry(manager, ref - 1);
+#ifdef DEBUG
+                expired++;
+#endif
+            } else {
+                scheduleDecayEntry(manager, ref - 1);
             }
-            write_idx++;
+            ref = next;
         }
     }
 
-    manager->cache_size = write_idx;
+    manager->wheel_time = current_time;
 
 #ifdef DEBUG
     if (config->debug >= 2) {
-        fprintf(stderr, "DEBUG - Cleaned decay cache: %u entries remain\n",
-                manager->cache_size);
+        fprintf(stderr, "DEBUG - Cleaned decay cache: %u expired, %u entries remain\n",
+                expired, manager->cache_size);
     }
 #endif
 }
 
+/****
+ *
+ * Change the decay window
+ *
+ * DESCRIPTION:
+ *   Sets decay_seconds (and the exponential half-life derived from it).
+ *   Exponential values are first brought to the current bin start, so
+ *   decay up to now keeps the old rate and only later decay uses the new
+ *   one.
+ *
+ * PARAMETERS:
+ *   manager - Pointer to TimeBinManager_t
+ *   decay_seconds - New decay window in seconds
+ *
+ * RETURNS:
+ *   void
+ *
+ ****/
+void setDecayWindow(TimeBinManager_t *manager, uint32_t decay_seconds)
+{
+    if (!manager) {
+        return;
+    }
+
+    if (manager->config.decay_model == DECAY_EXPONENTIAL && manager->decay_epoch) {
+        rebaseDecayEpoch(manager, manager->current_bin ? manager->current_bin->bin_start
+                                                       : manager->wheel_time);
+    }
+
+    manager->config.decay_seconds = decay_seconds;
+    manager->decay_half_life = (double)decay_seconds / DECAY_EXP_HALF_LIVES;
+    if (manager->decay_half_life < 1.0) {
+        manager->decay_half_life = 1.0;
+    }
+}
+
 /****
  *
  * Mark coordinate in residue map with cumulative volume tracking
@@ -1109,14 +2192,14 @@ void cleanExpiredCacheEntries(TimeBinManager_t *manager, time_t current_time)
  *   void
  *
  * SIDE EFFECTS:
- *   Increments residue_map[y * dimension + x]
+ *   Increments the residue map cell at y * dimension + x
  *   Increments residue_count if this is first attack from this coordinate
  *   Updates residue_max_volume if new maximum reached
  *
  ****/
 void markResidue(TimeBinManager_t *manager, uint32_t x, uint32_t y)
 {
-    uint32_t idx;
+    uint32_t idx, volume;
 
     if (!manager || !manager->residue_map) {
         return;
@@ -1131,21 +2214,28 @@ void markResidue(TimeBinManager_t *manager, uint32_t x, uint32_t y)
     idx = y * manager->config.dimension + x;
 
     /* Increment cumulative volume for this coordinate */
-    if (manager->residue_map[idx] == 0) {
+    volume = addGridMapCell(manager->residue_map, idx, 1);
+    if (volume == 1) {
         manager->residue_count++;  /* First attack from this coordinate */
     }
 
-    manager->residue_map[idx]++;
-
     /* Track maximum volume across all coordinates */
-    if (manager->residue_map[idx] > manager->residue_max_volume) {
-        manager->residue_max_volume = manager->residue_map[idx];
+    if (volume > manager->residue_max_volume) {
+        manager->residue_max_volume = volume;
+    }
+
+    /* Record class changes for renderers working behind binning */
+    if (manager->residue_log_tail &&
+        (volume == 1 ||
+         volume == RESIDUE_MINIMAL_MAX + 1 ||
+         volume == RESIDUE_AVERAGE_MAX + 1)) {
+        appendResidueStep(manager, idx, volume);
     }
 
 #ifdef DEBUG
     if (config->debug >= 5) {
         fprintf(stderr, "DEBUG - Residue at (%u,%u): volume=%u, max_volume=%u, unique_coords=%u\n",
-                x, y, manager->residue_map[idx], manager->residue_max_volume, manager->residue_count);
+                x, y, volume, manager->residue_max_volume, manager->residue_count);
     }
 #endif
 }
@@ -1181,5 +2271,529 @@ uint32_t getResidue(TimeBinManager_t *manager, uint32_t x, uint32_t y)
 
     /* Calculate index and return residue volume */
     idx = y * manager->config.dimension + x;
-    return manager->residue_map[idx];
+    return getGridMapCell(manager->residue_map, idx);
+}
+
+/****
+ *
+ * Start recording residue class changes
+ *
+ * DESCRIPTION:
+ *   Frames rendered on other threads cannot read the residue map, which
+ *   keeps growing while they work. Instead each renderer keeps its own
+ *   copy, taken when the log is enabled, and replays the log up to the
+ *   position handed over with each bin. The renderer only tells volumes
+ *   apart by class (RESIDUE_MINIMAL_MAX, RESIDUE_AVERAGE_MAX), so only the
+ *   at most three class changes per coordinate are recorded.
+ *
+ * PARAMETERS:
+ *   manager - Pointer to TimeBinManager_t
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if manager is NULL or has no residue map
+ *
+ * SIDE EFFECTS:
+ *   Allocates the first log block (~512KB); markResidue() appends to it
+ *
+ ****/
+int enableResidueLog(TimeBinManager_t *manager)
+{
+    if (!manager || !manager->residue_map) {
+        return FALSE;
+    }
+
+    if (!manager->residue_log_tail) {
+        manager->residue_log_head = (ResidueLogBlock_t *)XMALLOC(sizeof(ResidueLogBlock_t));
+        manager->residue_log_head->next = NULL;
+        manager->residue_log_tail = manager->residue_log_head;
+        manager->residue_log_total = 0;
+        manager->residue_log_base = 0;
+        manager->residue_log_tail_base = 0;
+    }
+
+    return TRUE;
+}
+
+/****
+ *
+ * Free residue log blocks every renderer has replayed
+ *
+ * DESCRIPTION:
+ *   Drops head blocks that end before consumed. A renderer that stopped
+ *   exactly at a block boundary may still hold that block, so a block is
+ *   only freed once consumed is past its end. The tail block is kept.
+ *
+ * PARAMETERS:
+ *   manager - Pointer to TimeBinManager_t
+ *   consumed - Lowest log position any renderer has replayed to
+ *
+ * RETURNS:
+ *   void
+ *
+ ****/
+void trimResidueLog(TimeBinManager_t *manager, uint64_t consumed)
+{
+    ResidueLogBlock_t *block;
+
+    if (!manager) {
+        return;
+    }
+
+    while (manager->residue_log_head && manager->residue_log_head != manager->residue_log_tail &&
+           manager->residue_log_base + RESIDUE_LOG_BLOCK_STEPS < consumed) {
+        block = manager->residue_log_head->next;
+        XFREE(manager->residue_log_head);
+        manager->residue_log_head = block;
+        manager->residue_log_base += RESIDUE_LOG_BLOCK_STEPS;
+    }
+}
+
+/****
+ *
+ * Checkpoint files
+ *
+ * DESCRIPTION:
+ *   A checkpoint carries what a run needs to carry on where the last one
+ *   stopped: the residue map, the live decay cache entries with the
+ *   exponential epoch, the hour and day source IP sketches and the bin
+ *   still being filled. Bins already written are not kept. The layout is
+ *   described with TimeBinStateHeader_t.
+ *
+ ****/
+
+/****
+ *
+ * Size a checkpoint from its record counts
+ *
+ ****/
+PRIVATE uint64_t timeBinStateBytes(const TimeBinStateHeader_t *header)
+{
+    return sizeof(TimeBinStateHeader_t) + 3 * sizeof(HyperLogLog_t) +
+           (uint64_t)header->residue_count * sizeof(GridMapCell_t) +
+           (uint64_t)header->decay_count * sizeof(TimeBinStateDecay_t) +
+           (uint64_t)header->bin_cells * sizeof(TimeBinCell_t);
+}
+
+/****
+ *
+ * Write a checkpoint
+ *
+ * DESCRIPTION:
+ *   Writes the manager's state via a temporary file and rename(), so an
+ *   interrupted run leaves the previous checkpoint in place. Call it
+ *   before the current bin is finalized (decay applied), since its cells
+ *   are saved as hit counts.
+ *
+ * PARAMETERS:
+ *   manager - Pointer to TimeBinManager_t
+ *   file_path - Checkpoint to write
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on failure
+ *
+ * PERFORMANCE:
+ *   O(residue cells + cache_used + bin cells), or O(dimension^2) for a
+ *   dense residue map or bin; 8 bytes per residue or bin cell and 24 per
+ *   decay entry on disk
+ *
+ ****/
+int saveTimeBinState(TimeBinManager_t *manager, const char *file_path)
+{
+    TimeBinStateHeader_t header;
+    TimeBinStateDecay_t record;
+    HyperLogLog_t empty;
+    GridMapCell_t cell;
+    TimeBinCell_t bin_cell;
+    TimeBin_t *bin;
+    char tmp_path[PATH_MAX];
+    uint64_t pos = 0, idx, cells;
+    uint32_t i, written;
+    FILE *fp;
+    int ok;
+
+    if (!manager || !manager->residue_map || !file_path ||
+        snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", file_path) >= (int)sizeof(tmp_path)) {
+        return FALSE;
+    }
+    bin = manager->current_bin;
+
+    XMEMSET(&header, 0, sizeof(header));
+    XMEMCPY(header.magic, TIMEBIN_STATE_MAGIC, 8);
+    header.header_bytes = sizeof(TimeBinStateHeader_t);
+    header.hilbert_order = manager->config.hilbert_order;
+    header.bin_seconds = manager->config.bin_seconds;
+    header.decay_model = (uint32_t)manager->config.decay_model;
+    header.decay_seconds = manager->config.decay_seconds;
+    header.has_bin = (bin != NULL);
+    header.decay_epoch = (int64_t)manager->decay_epoch;
+    header.decay_half_life = manager->decay_half_life;
+    header.wheel_time = (int64_t)manager->wheel_time;
+    header.hour_start = (int64_t)manager->hour_start;
+    header.day_start = (int64_t)manager->day_start;
+    header.residue_count = manager->residue_count;
+    header.residue_max_volume = manager->residue_max_volume;
+    header.decay_count = manager->cache_size;
+    if (bin) {
+        header.bin_cells = bin->cell_count;
+        header.bin_start = (int64_t)bin->bin_start;
+        header.bin_events = bin->event_count;
+    }
+    header.file_bytes = timeBinStateBytes(&header);
+
+    fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        return FALSE;
+    }
+
+    hllClear(&empty);
+    ok = (fwrite(&header, sizeof(header), 1, fp) == 1 &&
+          fwrite(&manager->hour_src_ips, sizeof(HyperLogLog_t), 1, fp) == 1 &&
+          fwrite(&manager->day_src_ips, sizeof(HyperLogLog_t), 1, fp) == 1 &&
+          fwrite(bin ? &bin->src_ips : &empty, sizeof(HyperLogLog_t), 1, fp) == 1);
+
+    /* Residue cells */
+    written = 0;
+    while (ok && nextGridMapCell(manager->residue_map, &pos, &cell)) {
+        ok = (fwrite(&cell, sizeof(cell), 1, fp) == 1);
+        written++;
+    }
+    ok = ok && (written == header.residue_count);
+
+    /* Live decay entries */
+    XMEMSET(&record, 0, sizeof(record));
+    written = 0;
+    for (i = 0; ok && i < manager->cache_used; i++) {
+        if (manager->decay_cache[i].intensity) {
+            record.coord_key = manager->decay_cache[i].coord_key;
+            record.intensity = manager->decay_cache[i].intensity;
+            record.last_seen = (int64_t)manager->decay_cache[i].last_seen;
+            record.value = manager->decay_cache[i].value;
+            ok = (fwrite(&record, sizeof(record), 1, fp) == 1);
+            written++;
+        }
+    }
+    ok = ok && (written == header.decay_count);
+
+    /* Current bin hit counts */
+    written = 0;
+    if (bin && bin->dense) {
+        cells = (uint64_t)bin->dimension * bin->dimension;
+        for (idx = 0; ok && idx < cells; idx++) {
+            if (bin->grid[idx]) {
+                bin_cell.idx = (uint32_t)idx;
+                bin_cell.count = bin->grid[idx];
+                ok = (fwrite(&bin_cell, sizeof(bin_cell), 1, fp) == 1);
+                written++;
+            }
+        }
+    } else if (bin) {
+        for (i = 0; ok && i < bin->cell_capacity; i++) {
+            if (bin->cells[i].count) {
+                ok = (fwrite(&bin->cells[i], sizeof(TimeBinCell_t), 1, fp) == 1);
+                written++;
+            }
+        }
+    }
+    ok = ok && (written == header.bin_cells);
+
+    if (fclose(fp) != 0) {
+        ok = FALSE;
+    }
+    if (!ok || rename(tmp_path, file_path) != 0) {
+        unlink(tmp_path);
+        return FALSE;
+    }
+
+#ifdef DEBUG
+    if (config->debug >= 1) {
+        fprintf(stderr, "DEBUG - Saved state %s: residue=%u, decay=%u, bin_cells=%u (%lu bytes)\n",
+                file_path, header.residue_count, header.decay_count, header.bin_cells,
+                (unsigned long)header.file_bytes);
+    }
+#endif
+
+    return TRUE;
+}
+
+/****
+ *
+ * Map a checkpoint file read-only
+ *
+ * DESCRIPTION:
+ *   Uses mmap() where available, so records are read from the page cache
+ *   in place; otherwise (or if mapping fails) reads the file into memory.
+ *
+ * PARAMETERS:
+ *   file_path - Checkpoint to open
+ *   size - Set to the file size
+ *   mapped - Set to TRUE if the data must be released with munmap()
+ *
+ * RETURNS:
+ *   File contents, or NULL if the file cannot be read
+ *
+ ****/
+PRIVATE const uint8_t *mapTimeBinState(const char *file_path, size_t *size, int *mapped)
+{
+    struct stat st;
+    uint8_t *data = NULL;
+    size_t done;
+    ssize_t got;
+    int fd;
+
+    *mapped = FALSE;
+
+    fd = open(file_path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+        (uint64_t)st.st_size < sizeof(TimeBinStateHeader_t) || (uint64_t)st.st_size > (uint64_t)SIZE_MAX) {
+        close(fd);
+        return NULL;
+    }
+    *size = (size_t)st.st_size;
+
+#ifdef HAVE_SYS_MMAN_H
+    data = (uint8_t *)mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != (uint8_t *)MAP_FAILED) {
+        close(fd);
+        *mapped = TRUE;
+        return data;
+    }
+    data = NULL;
+#endif
+
+    if (*size > INT_MAX) {
+        close(fd);
+        return NULL;
+    }
+    data = (uint8_t *)XMALLOC((int)*size);
+    for (done = 0; done < *size; done += (size_t)got) {
+        got = read(fd, data + done, *size - done);
+        if (got <= 0) {
+            XFREE(data);
+            close(fd);
+            return NULL;
+        }
+    }
+    close(fd);
+
+    return data;
+}
+
+PRIVATE void unmapTimeBinState(const uint8_t *data, size_t size, int mapped)
+{
+    void *buf = (void *)(uintptr_t)data;
+
+#ifdef HAVE_SYS_MMAN_H
+    if (mapped) {
+        munmap(buf, size);
+        return;
+    }
+#else
+    (void)size;
+    (void)mapped;
+#endif
+    XFREE(buf);
+}
+
+/****
+ *
+ * Add a decay entry from a checkpoint
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if the memory budget is reached
+ *   (*duplicate is set if the coordinate was already restored)
+ *
+ ****/
+PRIVATE int restoreDecayEntry(TimeBinManager_t *manager, const TimeBinStateDecay_t *record, int *duplicate)
+{
+    DecayCacheEntry_t *entry;
+    uint32_t slot, ref;
+
+    *duplicate = FALSE;
+
+    if (manager->cache_used == manager->cache_capacity && !growDecayCache(manager)) {
+        return FALSE;
+    }
+
+    slot = decayKeySlot(record->coord_key, manager->cache_index_mask);
+    while ((ref = manager->cache_index[slot]) != 0) {
+        if (manager->decay_cache[ref - 1].coord_key == record->coord_key) {
+            *duplicate = TRUE;
+            return FALSE;
+        }
+        slot = (slot + 1) & manager->cache_index_mask;
+    }
+
+    ref = ++manager->cache_used;
+    entry = &manager->decay_cache[ref - 1];
+    entry->coord_key = record->coord_key;
+    entry->intensity = record->intensity;
+    entry->last_seen = (time_t)record->last_seen;
+    entry->value = record->value;
+    manager->cache_index[slot] = ref;
+    manager->cache_size++;
+    scheduleDecayEntry(manager, ref - 1);
+
+    return TRUE;
+}
+
+/****
+ *
+ * Load a checkpoint into a new manager
+ *
+ * DESCRIPTION:
+ *   Restores what saveTimeBinState() wrote into a manager that has not
+ *   seen any events. The checkpoint must come from a run with the same
+ *   Hilbert order, bin period and decay model. The manager keeps its own
+ *   storage choices (dense or hashed residue, dense bins) and decay
+ *   window: exponential values are carried over to the new window the
+ *   same way setDecayWindow() does mid-run. The unfinished bin becomes
+ *   the current bin, so events in the same period keep filling it.
+ *
+ * PARAMETERS:
+ *   manager - Pointer to TimeBinManager_t, fresh from createTimeBinManager()
+ *   file_path - Checkpoint to read
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if the file is missing, malformed or does not
+ *   fit this run (reason printed)
+ *
+ * MEMORY:
+ *   The file is mapped for the duration of the call only
+ *
+ ****/
+int loadTimeBinState(TimeBinManager_t *manager, const char *file_path)
+{
+    TimeBinStateHeader_t header;
+    const TimeBinStateDecay_t *records;
+    const GridMapCell_t *cells;
+    const TimeBinCell_t *bin_cells;
+    const uint8_t *data, *section;
+    TimeBin_t *bin;
+    uint64_t cell_limit;
+    uint32_t i, dimension, restored;
+    size_t size;
+    int mapped, duplicate, ok;
+
+    if (!manager || !manager->residue_map || !file_path) {
+        return FALSE;
+    }
+    if (manager->current_bin || manager->cache_size || manager->residue_count) {
+        fprintf(stderr, "ERR - State can only be loaded before any events are processed\n");
+        return FALSE;
+    }
+
+    data = mapTimeBinState(file_path, &size, &mapped);
+    if (!data) {
+        fprintf(stderr, "ERR - Unable to read state file: %s\n", file_path);
+        return FALSE;
+    }
+    XMEMCPY(&header, data, sizeof(header));
+
+    if (memcmp(header.magic, TIMEBIN_STATE_MAGIC, 8) != 0 ||
+        header.header_bytes != sizeof(TimeBinStateHeader_t) ||
+        header.file_bytes != (uint64_t)size || timeBinStateBytes(&header) != (uint64_t)size) {
+        fprintf(stderr, "ERR - Not a state file, or truncated: %s\n", file_path);
+        unmapTimeBinState(data, size, mapped);
+        return FALSE;
+    }
+    if (header.hilbert_order != manager->config.hilbert_order ||
+        header.bin_seconds != manager->config.bin_seconds ||
+        header.decay_model != (uint32_t)manager->config.decay_model) {
+        fprintf(stderr, "ERR - State file %s is for order %u, %s bins and %s decay, which this run does not match\n",
+                file_path, header.hilbert_order, formatTimeBinDuration(header.bin_seconds),
+                (header.decay_model == DECAY_EXPONENTIAL) ? "exponential" : "linear");
+        unmapTimeBinState(data, size, mapped);
+        return FALSE;
+    }
+
+    dimension = manager->config.dimension;
+    cell_limit = (uint64_t)dimension * dimension;
+    section = data + sizeof(TimeBinStateHeader_t);
+
+    /* Hour and day sketches; the bin sketch is picked up with the bin */
+    XMEMCPY(&manager->hour_src_ips, section, sizeof(HyperLogLog_t));
+    XMEMCPY(&manager->day_src_ips, section + sizeof(HyperLogLog_t), sizeof(HyperLogLog_t));
+    manager->hour_start = (time_t)header.hour_start;
+    manager->day_start = (time_t)header.day_start;
+    manager->hour_unique_src_ips = hllCount(&manager->hour_src_ips);
+    manager->day_unique_src_ips = hllCount(&manager->day_src_ips);
+    section += 3 * sizeof(HyperLogLog_t);
+
+    /* Residue map */
+    cells = (const GridMapCell_t *)(const void *)section;
+    ok = TRUE;
+    for (i = 0; ok && i < header.residue_count; i++) {
+        ok = (cells[i].idx < cell_limit && cells[i].value &&
+              getGridMapCell(manager->residue_map, cells[i].idx) == 0 &&
+              setGridMapCell(manager->residue_map, cells[i].idx, cells[i].value));
+    }
+    manager->residue_count = header.residue_count;
+    manager->residue_max_volume = header.residue_max_volume;
+    section += (size_t)header.residue_count * sizeof(GridMapCell_t);
+
+    /* Unfinished bin, before the decay window changes so it can rebase to it */
+    bin_cells = (const TimeBinCell_t *)(const void *)(section + (size_t)header.decay_count * sizeof(TimeBinStateDecay_t));
+    if (ok && header.has_bin) {
+        bin = acquireTimeBin(manager, (time_t)header.bin_start);
+        ok = (bin != NULL);
+        if (ok) {
+            manager->current_bin = bin;
+            manager->total_bins = 1;
+            bin->event_count = header.bin_events;
+            XMEMCPY(&bin->src_ips, data + sizeof(TimeBinStateHeader_t) + 2 * sizeof(HyperLogLog_t),
+                    sizeof(HyperLogLog_t));
+        }
+        for (i = 0; ok && i < header.bin_cells; i++) {
+            ok = (bin_cells[i].idx < cell_limit && bin_cells[i].count &&
+                  addToBinCell(bin, bin_cells[i].idx, bin_cells[i].count));
+        }
+    }
+
+    /* Decay cache, on the epoch and half-life it was saved with */
+    records = (const TimeBinStateDecay_t *)(const void *)section;
+    manager->decay_epoch = (time_t)header.decay_epoch;
+    if (header.decay_half_life >= 1.0) {
+        manager->decay_half_life = header.decay_half_life;
+    }
+    manager->wheel_time = (time_t)header.wheel_time;
+    restored = 0;
+    for (i = 0; ok && i < header.decay_count; i++) {
+        ok = (records[i].intensity &&
+              (records[i].coord_key >> 16) < dimension && (records[i].coord_key & 0xFFFF) < dimension);
+        if (ok && !restoreDecayEntry(manager, &records[i], &duplicate)) {
+            if (duplicate) {
+                ok = FALSE;
+            } else {
+                manager->cache_dropped = header.decay_count - restored;
+                fprintf(stderr, "WARN - Decay cache budget holds %u of %u saved coordinates, the rest will not fade\n",
+                        restored, header.decay_count);
+                break;
+            }
+        }
+        restored++;
+    }
+
+    unmapTimeBinState(data, size, mapped);
+
+    if (!ok) {
+        fprintf(stderr, "ERR - Corrupt state file: %s\n", file_path);
+        return FALSE;
+    }
+
+    if (header.decay_seconds != manager->config.decay_seconds) {
+        setDecayWindow(manager, manager->config.decay_seconds);
+    }
+
+#ifdef DEBUG
+    if (config->debug >= 1) {
+        fprintf(stderr, "DEBUG - Loaded state %s: residue=%u, decay=%u, bin_cells=%u, %s\n",
+                file_path, manager->residue_count, manager->cache_size, header.bin_cells,
+                mapped ? "mapped" : "read");
+    }
+#endif
+
+    return TRUE;
 }
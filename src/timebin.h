@@ -41,6 +41,8 @@
 
 #include "../include/common.h"
 #include "hilbert.h"
+#include "hll.h"
+#include "gridmap.h"
 #include <stdint.h>
 #include <time.h>
 
@@ -59,9 +61,40 @@
 
 #define TIMEBIN_DEFAULT TIMEBIN_1MIN
 
+/* Sparse bins: cell table starts small and the bin goes dense once it is busy */
+#define TIMEBIN_SPARSE_INITIAL_CELLS 4096   /* Initial table slots (power of 2) */
+#ifndef TIMEBIN_DENSE_DIVISOR
+#define TIMEBIN_DENSE_DIVISOR 16            /* Dense above dimension^2 / 16 occupied cells */
+#endif
+
+/* Bin recycling: finished bins go back to the manager and are cleared page by page */
+#define TIMEBIN_POOL_SIZE 4                 /* Bins kept for reuse unless raised (reserveTimeBins()) */
+#define TIMEBIN_PAGE_SIZE 4096              /* Clearing granularity in bytes */
+
+/* Residue volume classes drawn by the renderer (1..MINIMAL, ..AVERAGE, above) */
+#define RESIDUE_MINIMAL_MAX 10
+#define RESIDUE_AVERAGE_MAX 100
+#define RESIDUE_LOG_BLOCK_STEPS 65536       /* Class changes per residue log block */
+
+/* Decay cache keys hold x and y in 16 bits each */
+#if HILBERT_ORDER_MAX > 16
+#error "DecayCacheEntry_t coord_key cannot hold coordinates above order 16"
+#endif
+
 /* Decay cache defaults */
 #define DECAY_CACHE_DURATION_DEFAULT (3 * 60 * 60)  /* 3 hour default */
-#define DECAY_CACHE_MAX_ENTRIES 65536  /* Max cached coordinates */
+#define DECAY_CACHE_INITIAL_ENTRIES 4096    /* Initial entry slab (power of 2) */
+#define DECAY_CACHE_BUDGET_DEFAULT_MB 64    /* Memory budget (~2M coordinates) */
+#define DECAY_CACHE_BUDGET_MAX_MB 65536
+#define DECAY_WHEEL_MAX_SLOTS 65536         /* Longer horizons wrap, entries are rechecked */
+
+/* Exponential decay: a single hit fades below the floor over one decay window */
+#define DECAY_EXP_HALF_LIVES 8              /* Half-lives per decay window */
+#define DECAY_EXP_FLOOR (1.0 / (1 << DECAY_EXP_HALF_LIVES))  /* Value at which a cell stops showing */
+#define DECAY_EXP_REBASE_HALF_LIVES 64      /* Rescale stored values before they overflow */
+
+/* Checkpoint files (saveTimeBinState()) */
+#define TIMEBIN_STATE_MAGIC "TPSTATE1"       /* 8 bytes, version in the last byte */
 
 /****
  *
@@ -69,15 +102,49 @@
  *
  ****/
 
+/**
+ * Decay models for fading coordinates after their last activity
+ */
+typedef enum {
+    DECAY_LINEAR = 0,        /* Accumulated hits scaled by 1 - age/decay_seconds */
+    DECAY_EXPONENTIAL        /* Every hit halves each decay_seconds/DECAY_EXP_HALF_LIVES */
+} DecayModel_t;
+
 /**
  * Decay cache entry - tracks when a coordinate was last seen
+ *
+ * Entries live in a slab indexed by an open-addressing table keyed on
+ * coord_key. Each live entry sits on exactly one expiry wheel slot; free
+ * entries are chained on the free list through the same next link.
  */
 typedef struct {
-    uint32_t coord_key;      /* Combined x,y coordinate as key */
+    uint32_t coord_key;      /* (x << 16) | y, distinct for every cell up to order 16 */
+    uint32_t intensity;      /* Peak intensity at this coordinate, 0 = free */
     time_t last_seen;        /* Last time this coordinate had activity */
-    uint32_t intensity;      /* Peak intensity at this coordinate */
+    uint32_t next;           /* Next entry on wheel slot or free list (index + 1, 0 = end) */
+    float value;             /* Exponential model: decayed hits, scaled to decay_epoch */
 } DecayCacheEntry_t;
 
+/**
+ * Residue log - coordinates whose residue volume class changed, in order
+ *
+ * Kept only while bin jobs render frames off the binning thread
+ * (enableResidueLog()). Volumes only grow, so a coordinate changes class
+ * at most three times and a renderer can rebuild the residue classes of
+ * any bin by replaying the log up to the position recorded with it. Step
+ * n lives in the block starting at n rounded down to
+ * RESIDUE_LOG_BLOCK_STEPS.
+ */
+typedef struct {
+    uint32_t idx;            /* Residue map index (y * dimension + x) */
+    uint32_t volume;         /* Volume that entered the new class */
+} ResidueStep_t;
+
+typedef struct ResidueLogBlock_s {
+    ResidueStep_t steps[RESIDUE_LOG_BLOCK_STEPS];
+    struct ResidueLogBlock_s *next;
+} ResidueLogBlock_t;
+
 /**
  * Time bin configuration
  */
@@ -88,19 +155,60 @@ typedef struct {
     uint8_t hilbert_order;   /* Hilbert curve order for heatmap */
     uint32_t dimension;      /* Hilbert curve dimension (2^order) */
     uint32_t decay_seconds;  /* How long coordinates persist (default: 3600) */
+    size_t decay_cache_bytes; /* Decay cache memory budget (0 = unlimited) */
+    DecayModel_t decay_model; /* How cached coordinates fade (default: DECAY_LINEAR) */
+
+    /* Storage chosen for the memory budget (TRUE = dimension^2 array) */
+    int dense_residue;       /* Residue map dense, else hashed */
+    int dense_render;        /* Sparse bins rendered through a dense grid, else read in place */
+    int dense_bins;          /* Busy bins may switch to a dense grid, else stay sparse */
 } TimeBinConfig_t;
 
+/**
+ * Occupied heatmap cell of a sparse time bin
+ */
+typedef struct {
+    uint32_t idx;            /* Heatmap index (y * dimension + x) */
+    uint32_t count;          /* Hit count, 0 = empty slot */
+} TimeBinCell_t;
+
 /**
  * Time bin heatmap (one frame's worth of data)
+ *
+ * A bin starts sparse: hit counts live in an open-addressing table of
+ * occupied cells and heatmap is NULL. Once more than dimension^2 /
+ * TIMEBIN_DENSE_DIVISOR cells are occupied the counts move to a dense
+ * grid and heatmap points at it, unless the memory budget rules dense
+ * bins out (dense_allowed). expandTimeBin() gives a sparse bin a
+ * temporary dense heatmap for rendering.
+ *
+ * Bins are recycled through the manager (acquireTimeBin()). The table and
+ * the grid are kept across uses, and every page written is flagged so a
+ * reset only clears those pages.
  */
 typedef struct {
     time_t bin_start;        /* Start time of this bin */
     time_t bin_end;          /* End time of this bin */
     uint32_t event_count;    /* Total events in bin */
-    uint32_t unique_ips;     /* Number of unique IPs seen */
-    uint32_t *heatmap;       /* 2D array: heatmap[y * dimension + x] */
+    uint32_t unique_cells;   /* Non-zero heatmap cells (set by finalizeBin()) */
+    uint32_t unique_src_ips; /* Estimated distinct source IPs (set by finalizeBin()) */
+    HyperLogLog_t src_ips;   /* Sketch of source IPs in this bin */
+    uint32_t *heatmap;       /* 2D array: heatmap[y * dimension + x], NULL while sparse */
     uint32_t dimension;      /* Width/height of heatmap */
     uint32_t max_intensity;  /* Maximum hit count in this bin */
+
+    /* Sparse representation */
+    TimeBinCell_t *cells;    /* Occupied cells (stale while dense) */
+    uint32_t cell_capacity;  /* Table slots (power of 2) */
+    uint32_t cell_count;     /* Non-zero cells (occupied slots while sparse) */
+    uint8_t *cells_dirty;    /* One flag per TIMEBIN_PAGE_SIZE bytes of cells */
+    int dense;               /* Counts are in grid, not cells */
+    int heatmap_borrowed;    /* heatmap is a lent render grid (expandTimeBin()) */
+    int dense_allowed;       /* May switch to the dense grid when busy */
+
+    /* Dense representation, allocated the first time the bin goes dense */
+    uint32_t *grid;          /* dimension^2 counts, zero outside dirty pages */
+    uint8_t *grid_dirty;     /* One flag per TIMEBIN_PAGE_SIZE bytes of grid */
 } TimeBin_t;
 
 /**
@@ -114,16 +222,94 @@ typedef struct {
     uint32_t bins_written;
 
     /* Decay cache for coordinate persistence */
-    DecayCacheEntry_t *decay_cache;  /* Array of cache entries */
-    uint32_t cache_size;              /* Current number of cached entries */
-    uint32_t cache_capacity;          /* Maximum cache capacity */
+    DecayCacheEntry_t *decay_cache;  /* Entry slab */
+    uint32_t cache_size;              /* Live entries */
+    uint32_t cache_capacity;          /* Slab entries allocated */
+    uint32_t cache_used;              /* Slab entries ever handed out (high water) */
+    uint32_t cache_free;              /* Free list head (index + 1, 0 = empty) */
+    uint32_t *cache_index;            /* Open-addressing table of entry index + 1 */
+    uint32_t cache_index_mask;        /* Table slots - 1 (power of 2, >= 2x capacity) */
+    uint32_t cache_dropped;           /* New coordinates refused at the memory budget */
+
+    /* Expiry wheel: one slot per bin period, entries rechecked when their slot comes up */
+    uint32_t *decay_wheel;            /* Slot list heads (entry index + 1) */
+    uint32_t wheel_slots;
+    time_t wheel_time;                /* Last time the wheel was advanced to (0 = never) */
+
+    /* Exponential decay: value at t = entry value * 2^-((t - decay_epoch) / decay_half_life) */
+    time_t decay_epoch;               /* 0 until the first event */
+    double decay_half_life;           /* Seconds */
 
     /* Residue map - persistent attack memory across all time bins */
-    uint32_t *residue_map;            /* 2D volume map: residue_map[y * dimension + x] = cumulative event count */
+    GridMap_t *residue_map;           /* Cumulative event count per cell (dense or hashed) */
     uint32_t residue_count;           /* Number of coordinates marked in residue map */
     uint32_t residue_max_volume;      /* Maximum cumulative volume across all coordinates */
+
+    /* Residue class changes for renderers on other threads, NULL unless enabled */
+    ResidueLogBlock_t *residue_log_head;
+    ResidueLogBlock_t *residue_log_tail;
+    uint64_t residue_log_base;        /* Position of the head block's first step */
+    uint64_t residue_log_tail_base;   /* Position of the tail block's first step */
+    uint64_t residue_log_total;       /* Steps recorded */
+
+    /* Dense grid lent to sparse bins while they are rendered, all zero otherwise
+     * (never allocated unless config.dense_render) */
+    uint32_t *render_map;
+
+    /* Distinct source IPs over the hour and UTC day of the latest finished bin */
+    HyperLogLog_t hour_src_ips;
+    HyperLogLog_t day_src_ips;
+    time_t hour_start;
+    time_t day_start;
+    uint32_t hour_unique_src_ips;     /* Estimates as of the latest accumulateBinTotals() */
+    uint32_t day_unique_src_ips;
+
+    /* Finished bins kept for reuse */
+    TimeBin_t **bin_pool;
+    uint32_t pool_count;
+    uint32_t pool_capacity;           /* TIMEBIN_POOL_SIZE unless raised (reserveTimeBins()) */
 } TimeBinManager_t;
 
+/**
+ * Checkpoint file layout (host byte order)
+ *
+ * A fixed header followed by the hour, day and current bin IP sketches
+ * and three record arrays: residue cells, live decay cache entries and
+ * the current bin's cells. Every section starts on an 8 byte boundary
+ * and is sized by the header, so the file can be mapped and the
+ * records read in place.
+ */
+typedef struct {
+    char magic[8];           /* TIMEBIN_STATE_MAGIC */
+    uint32_t header_bytes;   /* sizeof(TimeBinStateHeader_t) */
+    uint32_t hilbert_order;
+    uint32_t bin_seconds;
+    uint32_t decay_model;    /* DecayModel_t */
+    uint32_t decay_seconds;  /* Decay window the entries were kept under */
+    uint32_t has_bin;        /* Current bin section present */
+    int64_t decay_epoch;
+    double decay_half_life;
+    int64_t wheel_time;
+    int64_t hour_start;
+    int64_t day_start;
+    uint32_t residue_count;  /* Residue records */
+    uint32_t residue_max_volume;
+    uint32_t decay_count;    /* Decay records */
+    uint32_t bin_cells;      /* Current bin records */
+    int64_t bin_start;
+    uint32_t bin_events;
+    uint32_t reserved;
+    uint64_t file_bytes;     /* Whole file, checked against its size */
+} TimeBinStateHeader_t;
+
+typedef struct {
+    uint32_t coord_key;
+    uint32_t intensity;
+    int64_t last_seen;
+    float value;
+    uint32_t reserved;
+} TimeBinStateDecay_t;
+
 /****
  *
  * function prototypes
@@ -138,13 +324,22 @@ void destroyTimeBinManager(TimeBinManager_t *manager);
 TimeBin_t *createTimeBin(time_t start_time, uint32_t bin_seconds, uint32_t dimension);
 void destroyTimeBin(TimeBin_t *bin);
 void resetTimeBin(TimeBin_t *bin);
+TimeBin_t *acquireTimeBin(TimeBinManager_t *manager, time_t start_time);
+void releaseTimeBin(TimeBinManager_t *manager, TimeBin_t *bin);
+TimeBin_t *retireTimeBin(TimeBinManager_t *manager);
+int reserveTimeBins(TimeBinManager_t *manager, uint32_t bins);
 
 /* Add events to bins */
 int addEventToBin(TimeBin_t *bin, uint32_t x, uint32_t y);
-int processEvent(TimeBinManager_t *manager, time_t event_time, uint32_t x, uint32_t y);
+int processEvent(TimeBinManager_t *manager, time_t event_time, uint32_t src_ip, uint32_t x, uint32_t y);
 
 /* Finalize and output */
 int finalizeBin(TimeBin_t *bin);
+void accumulateBinTotals(TimeBinManager_t *manager, TimeBin_t *bin);
+int expandTimeBin(TimeBinManager_t *manager, TimeBin_t *bin);
+int expandTimeBinInto(TimeBin_t *bin, uint32_t *grid);
+uint32_t getTimeBinCount(const TimeBin_t *bin, uint32_t idx);
+void collapseTimeBin(TimeBinManager_t *manager, TimeBin_t *bin);
 time_t getBinForTime(time_t event_time, uint32_t bin_seconds);
 
 /* Utility functions */
@@ -155,9 +350,16 @@ const char *formatTimeBinDuration(uint32_t seconds);
 int updateDecayCache(TimeBinManager_t *manager, uint32_t x, uint32_t y, time_t event_time, uint32_t intensity);
 void applyDecayToHeatmap(TimeBinManager_t *manager, TimeBin_t *bin);
 void cleanExpiredCacheEntries(TimeBinManager_t *manager, time_t current_time);
+void setDecayWindow(TimeBinManager_t *manager, uint32_t decay_seconds);
 
 /* Residue map operations - persistent attack memory */
 void markResidue(TimeBinManager_t *manager, uint32_t x, uint32_t y);
 uint32_t getResidue(TimeBinManager_t *manager, uint32_t x, uint32_t y);
+int enableResidueLog(TimeBinManager_t *manager);
+void trimResidueLog(TimeBinManager_t *manager, uint64_t consumed);
+
+/* Checkpoints - residue, decay cache and current bin across runs */
+int saveTimeBinState(TimeBinManager_t *manager, const char *file_path);
+int loadTimeBinState(TimeBinManager_t *manager, const char *file_path);
 
 #endif /* TIMEBIN_DOT_H */
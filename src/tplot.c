@@ -29,6 +29,7 @@
 #include "tplot.h"
 #include <sys/wait.h>  /* For waitpid() */
 #include <glob.h>      /* For glob() */
+#include <unistd.h>    /* For access() */
 
 /****
  *
@@ -43,6 +44,16 @@ typedef struct {
   uint64_t event_count;
   TimeBinManager_t *bin_manager;
   VisualizationConfig_t *viz_config;
+  FILE *stats;                  /* Per-frame statistics (--stats), NULL if off */
+  BinJobs_t *bin_jobs;          /* Render threads (--render-jobs), NULL renders inline */
+  uint32_t resumed_events;      /* Events in the bin restored by --load-state, 0 once it is done */
+  ReorderBuffer_t *reorder;     /* Late event window (--reorder-window), NULL if off */
+
+  /* Per-batch scratch arrays */
+  uint32_t batch_ip[LOG_PARSER_BATCH_SIZE];
+  uint32_t batch_x[LOG_PARSER_BATCH_SIZE];
+  uint32_t batch_y[LOG_PARSER_BATCH_SIZE];
+  time_t batch_bin[LOG_PARSER_BATCH_SIZE];
 } CallbackData_t;
 
 /****
@@ -288,104 +299,416 @@ PRIVATE int execute_ffmpeg(const char *output_dir, const char *codec,
 
 /****
  *
- * Process honeypot log events
+ * Take a dense buffer (and its copies) out of the memory budget
+ *
+ * RETURNS:
+ *   TRUE if it fits and was taken, FALSE if it should be kept sparse
+ *
+ ****/
+PRIVATE int takeDenseBudget(uint64_t *budget, uint64_t bytes, uint64_t copies)
+{
+  if (bytes > GRIDMAP_DENSE_MAX || bytes * copies > *budget) {
+    return FALSE;
+  }
+  *budget -= bytes * copies;
+  return TRUE;
+}
+
+/****
+ *
+ * Choose dense or sparse storage for the heatmap-sized buffers
  *
  * DESCRIPTION:
- *   Callback for log parser. Maps IP to Hilbert coordinates, tracks time span,
- *   processes events into bins, renders frames when bins complete, applies decay.
+ *   Sets the curve order from --order. Every buffer with a value per
+ *   heatmap cell grows with 4^order (64MB per 32-bit buffer at order 12,
+ *   16GB at order 16), so they are offered the --mem-limit budget in the
+ *   order rendering leans on them: residue map, render grid, then the
+ *   grids busy bins switch to. Each one, with its copies on render
+ *   threads, is made dense if it still fits; otherwise the residue map
+ *   is hashed, sparse bins are read in place and bins stay sparse.
+ *   Frames come out the same either way. The non-routable mask is a
+ *   bit per cell and always dense, so it comes off the budget first.
  *
  * PARAMETERS:
- *   event - Honeypot event data (src IP, timestamp, etc.)
- *   user_data - CallbackData_t with bin manager and config
+ *   bin_config - Receives the order and the residue, render and bin choices
+ *
+ ****/
+PRIVATE void planHeatmapStorage(TimeBinConfig_t *bin_config)
+{
+  uint8_t order = (uint8_t)config->hilbert_order;
+  uint64_t grid_bytes = getGridMapDenseBytes(order, sizeof(uint32_t));
+  uint64_t mask_bytes;
+  uint64_t workers = (config->bin_jobs > 1) ? (uint64_t)config->bin_jobs : 0;
+  uint64_t budget;
+  long pages = -1, page_size = -1;
+
+  if (config->mem_limit_mb) {
+    budget = (uint64_t)config->mem_limit_mb << 20;
+  } else {
+#ifdef _SC_PHYS_PAGES
+    pages = sysconf(_SC_PHYS_PAGES);
+    page_size = sysconf(_SC_PAGESIZE);
+#endif
+    if (pages > 0 && page_size > 0) {
+      budget = (uint64_t)pages * (uint64_t)page_size / 2;
+    } else {
+      budget = (uint64_t)HEATMAP_MEM_LIMIT_FALLBACK_MB << 20;
+    }
+  }
+
+  bin_config->hilbert_order = order;
+  bin_config->dimension = 1U << order;  /* 2^order */
+
+  mask_bytes = getGridMapDenseBytes(order, 1) / 8;
+  budget -= (mask_bytes < budget) ? mask_bytes : budget;
+  bin_config->dense_residue = takeDenseBudget(&budget, grid_bytes, 1 + workers);
+  bin_config->dense_render = takeDenseBudget(&budget, grid_bytes, 1 + workers);
+  bin_config->dense_bins = takeDenseBudget(&budget, grid_bytes,
+                                           TIMEBIN_POOL_SIZE + 1 + workers * BIN_JOBS_QUEUED);
+
+  fprintf(stderr, "Heatmap: order %u (%ux%u), residue %s, render %s, bins %s\n",
+          order, bin_config->dimension, bin_config->dimension,
+          bin_config->dense_residue ? "dense" : "sparse",
+          bin_config->dense_render ? "dense" : "sparse",
+          bin_config->dense_bins ? "sparse/dense" : "sparse");
+}
+
+/****
+ *
+ * Open the per-frame statistics file
+ *
+ * DESCRIPTION:
+ *   Creates config->stats_file (if set) and writes the CSV header. One
+ *   row per written frame follows (writeFrameStats()).
+ *
+ * PARAMETERS:
+ *   data - CallbackData_t to attach the file to
  *
  * RETURNS:
- *   TRUE to continue processing, FALSE to stop
+ *   TRUE on success or when no stats file is configured, FALSE on error
  *
  ****/
-PRIVATE int honeypotEventCallback(const HoneypotEvent_t *event, void *user_data)
+PRIVATE int openFrameStats(CallbackData_t *data)
 {
-  CallbackData_t *data = (CallbackData_t *)user_data;
-  HilbertCoord_t coord;
-  TimeBin_t *old_bin = NULL;
-  char output_path[PATH_MAX];
+  data->stats = NULL;
+  if (!config->stats_file) {
+    return TRUE;
+  }
 
-  data->event_count++;
+  if ((data->stats = fopen(config->stats_file, "w")) == NULL) {
+    fprintf(stderr, "ERR - Unable to open stats file: %s (%s)\n", config->stats_file, strerror(errno));
+    return FALSE;
+  }
 
-  /* Track time span for auto-scaling */
-  if (g_first_timestamp == 0 || event->timestamp < g_first_timestamp) {
-    g_first_timestamp = event->timestamp;
+  fprintf(data->stats, "frame,bin_start,events,cells,src_ips,hour_src_ips,day_src_ips,max_intensity,cached\n");
+  return TRUE;
+}
+
+PRIVATE void closeFrameStats(CallbackData_t *data)
+{
+  if (data->stats) {
+    if (fclose(data->stats) != 0) {
+      fprintf(stderr, "WARN - Failed to write stats file: %s\n", config->stats_file);
+    }
+    data->stats = NULL;
   }
-  if (event->timestamp > g_last_timestamp) {
-    g_last_timestamp = event->timestamp;
+}
+
+/****
+ *
+ * Record the statistics of a written frame
+ *
+ * DESCRIPTION:
+ *   Appends one CSV row for the bin. src_ips is the bin's distinct source
+ *   IP estimate; hour_src_ips and day_src_ips are the estimates for the
+ *   UTC hour and day so far, so the last row of an hour or day holds that
+ *   period's total.
+ *
+ * PARAMETERS:
+ *   data - CallbackData_t with bin manager and stats file
+ *   bin - Finalized bin (accumulateBinTotals() already applied)
+ *   frame - Frame number used in the file name
+ *
+ ****/
+PRIVATE void writeFrameStats(CallbackData_t *data, TimeBin_t *bin, uint32_t frame)
+{
+  if (!data->stats) {
+    return;
+  }
+
+  fprintf(data->stats, "%u,%ld,%u,%u,%u,%u,%u,%u,%u\n",
+          frame, (long)bin->bin_start, bin->event_count, bin->unique_cells, bin->unique_src_ips,
+          data->bin_manager->hour_unique_src_ips, data->bin_manager->day_unique_src_ips,
+          bin->max_intensity, data->bin_manager->cache_size);
+}
+
+/****
+ *
+ * Render the current time bin
+ *
+ * DESCRIPTION:
+ *   Applies decay, finalizes and writes the bin that is about to be
+ *   replaced. Called when an event falls outside the current bin. With
+ *   render threads the bin is handed to them once everything that
+ *   depends on binning order is done, and binning carries on with a new
+ *   bin while the frame is written.
+ *
+ * PARAMETERS:
+ *   data - CallbackData_t with bin manager and config
+ *
+ ****/
+PRIVATE void renderCurrentBin(CallbackData_t *data)
+{
+  TimeBin_t *old_bin = data->bin_manager->current_bin;
+  char output_path[PATH_MAX];
+  int unchanged;
+
+  /* A restored bin that got no new events was drawn by the run that saved it */
+  if (data->resumed_events) {
+    unchanged = (old_bin->event_count == data->resumed_events);
+    data->resumed_events = 0;
+    if (unchanged) {
+      cleanExpiredCacheEntries(data->bin_manager, old_bin->bin_start);
+      finalizeBin(old_bin);
+      accumulateBinTotals(data->bin_manager, old_bin);
+      data->bin_manager->current_bin = NULL;
+      releaseTimeBin(data->bin_manager, old_bin);
+      return;
+    }
   }
 
-  /* Map IP to Hilbert curve coordinates */
-  coord = ipToHilbert(event->src_ip, HILBERT_ORDER_DEFAULT);
+  /* Apply decay cache to show fading IPs */
+  applyDecayToHeatmap(data->bin_manager, old_bin);
+
+  /* Expire cache entries that aged out by this bin */
+  cleanExpiredCacheEntries(data->bin_manager, old_bin->bin_start);
+
+  finalizeBin(old_bin);
+  accumulateBinTotals(data->bin_manager, old_bin);
 
+  /* Generate output filename and render */
+  generateBinFilename(output_path, sizeof(output_path),
+                     data->viz_config->output_dir,
+                     data->viz_config->output_prefix,
+                     old_bin->bin_start,
+                     data->bin_manager->bins_written);
+
+  if (data->bin_jobs) {
+    /* Frame number and statistics are fixed now, the frame is written later */
+    data->bin_manager->bins_written++;
+    writeFrameStats(data, old_bin, data->bin_manager->bins_written - 1);
 #ifdef DEBUG
-  /* Print first 10 events for verification (debug mode only) */
-  if (config->debug >= 2 && data->event_count <= 10) {
-    fprintf(stderr, "DEBUG - Event %lu: %s:%u -> %s:%u proto=%s time=%ld.%06u Hilbert(%u,%u)\n",
-            data->event_count,
-            event->src_ip_str, event->src_port,
-            event->dst_ip_str, event->dst_port,
-            event->protocol == PROTO_TCP ? "TCP" : "UDP",
-            (long)event->timestamp, event->timestamp_us,
-            coord.x, coord.y);
+    if (config->debug >= 1) {
+      fprintf(stderr, "DEBUG - Queued frame %u: %s (events=%u, cells=%u, src_ips=%u, hour_src_ips=%u, day_src_ips=%u, max_intensity=%u, cached=%u)\n",
+              data->bin_manager->bins_written - 1, output_path,
+              old_bin->event_count, old_bin->unique_cells, old_bin->unique_src_ips,
+              data->bin_manager->hour_unique_src_ips, data->bin_manager->day_unique_src_ips,
+              old_bin->max_intensity, data->bin_manager->cache_size);
+    }
+#endif
+    submitBinJob(data->bin_jobs, retireTimeBin(data->bin_manager), output_path);
+    return;
   }
+
+  if (expandTimeBin(data->bin_manager, old_bin) &&
+      renderTimeBin(old_bin, output_path,
+                    data->viz_config->width,
+                    data->viz_config->height,
+                    data->bin_manager->residue_map,
+                    data->bin_manager->residue_max_volume)) {
+    data->bin_manager->bins_written++;
+    writeFrameStats(data, old_bin, data->bin_manager->bins_written - 1);
+#ifdef DEBUG
+    if (config->debug >= 1) {
+      fprintf(stderr, "DEBUG - Wrote frame %u: %s (events=%u, cells=%u, src_ips=%u, hour_src_ips=%u, day_src_ips=%u, max_intensity=%u, cached=%u)\n",
+              data->bin_manager->bins_written - 1, output_path,
+              old_bin->event_count, old_bin->unique_cells, old_bin->unique_src_ips,
+              data->bin_manager->hour_unique_src_ips, data->bin_manager->day_unique_src_ips,
+              old_bin->max_intensity, data->bin_manager->cache_size);
+    }
 #endif
+  } else {
+    fprintf(stderr, "ERR - Failed to write frame: %s\n", output_path);
+  }
+  collapseTimeBin(data->bin_manager, old_bin);
+}
+
+/****
+ *
+ * Add one event to the timeline
+ *
+ * DESCRIPTION:
+ *   Renders the current bin first if the event belongs to another one,
+ *   then hands the event to the bin manager.
+ *
+ * PARAMETERS:
+ *   data - CallbackData_t with bin manager and config
+ *   timestamp - Event time
+ *   bin_start - Start of the event's time bin
+ *   src_ip - Event source IP
+ *   x, y - Hilbert coordinates of src_ip
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if the bin manager failed
+ *
+ ****/
+PRIVATE int binEvent(CallbackData_t *data, time_t timestamp, time_t bin_start,
+                     uint32_t src_ip, uint32_t x, uint32_t y)
+{
+  TimeBinManager_t *manager = data->bin_manager;
 
-  /* Check if this event triggers a new time bin */
-  time_t event_bin = getBinForTime(event->timestamp, data->bin_manager->config.bin_seconds);
+  /* Finalize and render the current bin before moving to next */
+  if (manager->current_bin && bin_start != manager->current_bin->bin_start) {
+    renderCurrentBin(data);
+  }
 
-  if (data->bin_manager->current_bin &&
-      event_bin != data->bin_manager->current_bin->bin_start) {
-    /* Finalize and render the current bin before moving to next */
-    old_bin = data->bin_manager->current_bin;
+  if (!processEvent(manager, timestamp, src_ip, x, y)) {
+    fprintf(stderr, "ERR - Failed to process event at time %ld\n", (long)timestamp);
+    return FALSE;
+  }
 
-    /* Apply decay cache to show fading IPs */
-    applyDecayToHeatmap(data->bin_manager, old_bin);
+  return TRUE;
+}
 
-    /* Clean expired cache entries periodically */
-    if (data->bin_manager->bins_written % 10 == 0) {
-      cleanExpiredCacheEntries(data->bin_manager, old_bin->bin_start);
+/****
+ *
+ * Feed bins leaving the reorder window into the timeline
+ *
+ * PARAMETERS:
+ *   data - CallbackData_t with the reorder window
+ *   bin_start - Bin of the event about to be held (ignored when flushing)
+ *   flush - TRUE at end of input to feed every held bin
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE if the bin manager failed
+ *
+ ****/
+PRIVATE int binReorderedEvents(CallbackData_t *data, time_t bin_start, int flush)
+{
+  const ReorderBin_t *bin;
+  size_t i;
+
+  while ((bin = takeReorderBin(data->reorder, bin_start, flush)) != NULL) {
+    for (i = 0; i < bin->count; i++) {
+      if (!binEvent(data, bin->events[i].timestamp, bin->bin_start, bin->events[i].src_ip,
+                    bin->events[i].x, bin->events[i].y)) {
+        return FALSE;
+      }
     }
+  }
 
-    finalizeBin(old_bin);
+  return TRUE;
+}
+
+/****
+ *
+ * Process a batch of honeypot log events
+ *
+ * DESCRIPTION:
+ *   Batch callback for log parser. Tracks time span, maps IPs to Hilbert
+ *   coordinates and computes bin starts for the whole batch in separate
+ *   tight loops, then feeds the events into the bin manager in order,
+ *   rendering a frame whenever an event starts a new bin.
+ *
+ * PARAMETERS:
+ *   events - Honeypot events in file order
+ *   count - Number of events (at most LOG_PARSER_BATCH_SIZE)
+ *   user_data - CallbackData_t with bin manager and config
+ *
+ * RETURNS:
+ *   TRUE to continue processing, FALSE to stop
+ *
+ ****/
+PRIVATE int honeypotBatchCallback(const HoneypotEvent_t *events, size_t count, void *user_data)
+{
+  CallbackData_t *data = (CallbackData_t *)user_data;
+  TimeBinManager_t *manager = data->bin_manager;
+  time_t bin_seconds = (time_t)manager->config.bin_seconds;
+  time_t batch_min, batch_max;
+  size_t i;
+
+  if (count == 0) {
+    return TRUE;
+  }
+  if (count > LOG_PARSER_BATCH_SIZE) {
+    count = LOG_PARSER_BATCH_SIZE;
+  }
+
+  /* Track time span for auto-scaling */
+  batch_min = batch_max = events[0].timestamp;
+  for (i = 1; i < count; i++) {
+    time_t t = events[i].timestamp;
+    batch_min = (t < batch_min) ? t : batch_min;
+    batch_max = (t > batch_max) ? t : batch_max;
+  }
+  if (g_first_timestamp == 0 || batch_min < g_first_timestamp) {
+    g_first_timestamp = batch_min;
+  }
+  if (batch_max > g_last_timestamp) {
+    g_last_timestamp = batch_max;
+  }
+
+  /* Map IPs to Hilbert curve coordinates */
+  for (i = 0; i < count; i++) {
+    data->batch_ip[i] = events[i].src_ip;
+  }
+  ipToHilbertBatch(data->batch_ip, count, manager->config.hilbert_order,
+                   data->batch_x, data->batch_y);
+
+  /* Time bin of each event (same as getBinForTime()) */
+  for (i = 0; i < count; i++) {
+    data->batch_bin[i] = (events[i].timestamp / bin_seconds) * bin_seconds;
+  }
 
-    /* Generate output filename and render */
-    generateBinFilename(output_path, sizeof(output_path),
-                       data->viz_config->output_dir,
-                       data->viz_config->output_prefix,
-                       old_bin->bin_start,
-                       data->bin_manager->bins_written);
-
-    if (renderTimeBin(old_bin, output_path,
-                      data->viz_config->width,
-                      data->viz_config->height,
-                      data->bin_manager->residue_map,
-                      data->bin_manager->residue_max_volume)) {
-      data->bin_manager->bins_written++;
 #ifdef DEBUG
-      if (config->debug >= 1) {
-        fprintf(stderr, "DEBUG - Wrote frame %u: %s (events=%u, unique_ips=%u, max_intensity=%u, cached=%u)\n",
-                data->bin_manager->bins_written - 1, output_path,
-                old_bin->event_count, old_bin->unique_ips, old_bin->max_intensity,
-                data->bin_manager->cache_size);
-      }
+  /* Print first 10 events for verification (debug mode only) */
+  if (config->debug >= 2) {
+    for (i = 0; i < count && data->event_count + i < 10; i++) {
+      char src_str[16], dst_str[16];
+      ipIntToString(events[i].src_ip, src_str, sizeof(src_str));
+      ipIntToString(events[i].dst_ip, dst_str, sizeof(dst_str));
+      fprintf(stderr, "DEBUG - Event %lu: %s:%u -> %s:%u proto=%s time=%ld.%06u Hilbert(%u,%u)\n",
+              (unsigned long)(data->event_count + i + 1),
+              src_str, events[i].src_port,
+              dst_str, events[i].dst_port,
+              events[i].protocol == PROTO_TCP ? "TCP" : "UDP",
+              (long)events[i].timestamp, events[i].timestamp_us,
+              data->batch_x[i], data->batch_y[i]);
+    }
+  }
 #endif
-    } else {
-      fprintf(stderr, "ERR - Failed to write frame: %s\n", output_path);
+
+  /* Hold events back in the reorder window, feeding out bins it closes */
+  if (data->reorder) {
+    ReorderEvent_t held;
+
+    for (i = 0; i < count; i++) {
+      if (!binReorderedEvents(data, data->batch_bin[i], FALSE)) {
+        data->event_count += i;
+        return FALSE;
+      }
+      held.timestamp = events[i].timestamp;
+      held.src_ip = events[i].src_ip;
+      held.x = data->batch_x[i];
+      held.y = data->batch_y[i];
+      addReorderEvent(data->reorder, data->batch_bin[i], &held);
     }
+
+    data->event_count += count;
+    return TRUE;
   }
 
-  /* Process event into time bin manager */
-  if (!processEvent(data->bin_manager, event->timestamp, coord.x, coord.y)) {
-    fprintf(stderr, "ERR - Failed to process event at time %ld\n",
-            (long)event->timestamp);
-    return FALSE;
+  /* Feed events into the bin manager in order */
+  for (i = 0; i < count; i++) {
+    if (!binEvent(data, events[i].timestamp, data->batch_bin[i], events[i].src_ip,
+                  data->batch_x[i], data->batch_y[i])) {
+      data->event_count += i;
+      return FALSE;
+    }
   }
 
+  data->event_count += count;
+
   return TRUE;  /* Continue processing */
 }
 
@@ -418,9 +741,9 @@ int processHoneypotFile(const char *fName)
   bin_config.bin_seconds = config->time_bin_seconds;
   bin_config.start_time = 0;  /* Auto-detect from first event */
   bin_config.end_time = 0;    /* Process all events */
-  bin_config.hilbert_order = HILBERT_ORDER_DEFAULT;
-  bin_config.dimension = 1 << HILBERT_ORDER_DEFAULT;  /* 2^order */
   bin_config.decay_seconds = DECAY_CACHE_DURATION_DEFAULT;  /* 1 hour decay */
+  bin_config.decay_cache_bytes = (size_t)config->decay_cache_mb * 1024 * 1024;
+  bin_config.decay_model = config->exp_decay ? DECAY_EXPONENTIAL : DECAY_LINEAR;
 
   /* Setup visualization configuration */
   viz_config.width = config->viz_width;
@@ -431,6 +754,9 @@ int processHoneypotFile(const char *fName)
   fprintf(stderr, "Output directory: %s\n", viz_config.output_dir);
   fprintf(stderr, "Resolution: %ux%u\n", viz_config.width, viz_config.height);
 
+  /* Hilbert order and dense/sparse storage within --mem-limit */
+  planHeatmapStorage(&bin_config);
+
   /* Create output directory if it doesn't exist */
   if (mkdir(viz_config.output_dir, 0755) != 0 && errno != EEXIST) {
     fprintf(stderr, "ERR - Failed to create output directory: %s\n", viz_config.output_dir);
@@ -438,10 +764,13 @@ int processHoneypotFile(const char *fName)
   }
 
   /* Initialize Hilbert curve engine */
-  if (!initHilbert(HILBERT_ORDER_DEFAULT)) {
+  if (!initHilbert(bin_config.hilbert_order)) {
     fprintf(stderr, "ERR - Failed to initialize Hilbert curve engine\n");
     return EXIT_FAILURE;
   }
+  if (config->prefix_table_file && !usePrefixTable(config->prefix_table_file)) {
+    fprintf(stderr, "WARN - Prefix table disabled, mapping each address\n");
+  }
 
   /* Load CIDR mapping for proportional timezone-based positioning */
   if (config->cidr_map_file && config->cidr_map_file[0] != '\0') {
@@ -483,10 +812,28 @@ int processHoneypotFile(const char *fName)
 
   callback_data.event_count = 0;
   callback_data.viz_config = &viz_config;
+  callback_data.resumed_events = 0;
+
+  if (!openFrameStats(&callback_data)) {
+    destroyTimeBinManager(callback_data.bin_manager);
+    deInitLogParser();
+    deInitVisualization();
+    deInitHilbert();
+    return EXIT_FAILURE;
+  }
+
+  /* Write frames on render threads while binning continues (NULL = inline) */
+  callback_data.bin_jobs = createBinJobs(callback_data.bin_manager, &viz_config, config->bin_jobs);
+
+  /* Take late events into their bins (NULL = bin in arrival order) */
+  callback_data.reorder = createReorderBuffer(callback_data.bin_manager->config.bin_seconds, config->reorder_seconds);
 
   /* Process the gzip file */
-  if (!processGzipFile(fName, honeypotEventCallback, &callback_data)) {
+  if (!processGzipFileBatch(fName, honeypotBatchCallback, &callback_data)) {
     fprintf(stderr, "ERR - Failed to process honeypot log file\n");
+    destroyReorderBuffer(callback_data.reorder);
+    destroyBinJobs(callback_data.bin_jobs);
+    closeFrameStats(&callback_data);
     destroyTimeBinManager(callback_data.bin_manager);
     deInitLogParser();
     deInitVisualization();
@@ -494,12 +841,18 @@ int processHoneypotFile(const char *fName)
     return EXIT_FAILURE;
   }
 
+  /* Bin what the reorder window still holds */
+  if (callback_data.reorder && !binReorderedEvents(&callback_data, 0, TRUE)) {
+    fprintf(stderr, "ERR - Failed to process held events\n");
+  }
+
   /* Finalize and render the last bin if it exists */
   if (callback_data.bin_manager->current_bin) {
     /* Apply decay cache to final bin */
     applyDecayToHeatmap(callback_data.bin_manager, callback_data.bin_manager->current_bin);
 
     finalizeBin(callback_data.bin_manager->current_bin);
+    accumulateBinTotals(callback_data.bin_manager, callback_data.bin_manager->current_bin);
 
     generateBinFilename(output_path, sizeof(output_path),
                        viz_config.output_dir,
@@ -507,17 +860,22 @@ int processHoneypotFile(const char *fName)
                        callback_data.bin_manager->current_bin->bin_start,
                        callback_data.bin_manager->bins_written);
 
-    if (renderTimeBin(callback_data.bin_manager->current_bin, output_path,
+    if (expandTimeBin(callback_data.bin_manager, callback_data.bin_manager->current_bin) &&
+        renderTimeBin(callback_data.bin_manager->current_bin, output_path,
                       viz_config.width, viz_config.height,
                       callback_data.bin_manager->residue_map,
                       callback_data.bin_manager->residue_max_volume)) {
       callback_data.bin_manager->bins_written++;
+      writeFrameStats(&callback_data, callback_data.bin_manager->current_bin, callback_data.bin_manager->bins_written - 1);
 #ifdef DEBUG
       if (config->debug >= 1) {
-        fprintf(stderr, "DEBUG - Wrote final frame %u: %s (events=%u, unique_ips=%u, max_intensity=%u, cached=%u)\n",
+        fprintf(stderr, "DEBUG - Wrote final frame %u: %s (events=%u, cells=%u, src_ips=%u, hour_src_ips=%u, day_src_ips=%u, max_intensity=%u, cached=%u)\n",
                 callback_data.bin_manager->bins_written - 1, output_path,
                 callback_data.bin_manager->current_bin->event_count,
-                callback_data.bin_manager->current_bin->unique_ips,
+                callback_data.bin_manager->current_bin->unique_cells,
+                callback_data.bin_manager->current_bin->unique_src_ips,
+                callback_data.bin_manager->hour_unique_src_ips,
+                callback_data.bin_manager->day_unique_src_ips,
                 callback_data.bin_manager->current_bin->max_intensity,
                 callback_data.bin_manager->cache_size);
       }
@@ -525,7 +883,11 @@ int processHoneypotFile(const char *fName)
     } else {
       fprintf(stderr, "ERR - Failed to write final frame: %s\n", output_path);
     }
+    collapseTimeBin(callback_data.bin_manager, callback_data.bin_manager->current_bin);
   }
+  destroyBinJobs(callback_data.bin_jobs);
+  callback_data.bin_jobs = NULL;
+  closeFrameStats(&callback_data);
 
   fprintf(stderr, "\nSummary:\n");
   fprintf(stderr, "========\n");
@@ -533,6 +895,10 @@ int processHoneypotFile(const char *fName)
   fprintf(stderr, "Total frames written: %u\n", callback_data.bin_manager->bins_written);
   fprintf(stderr, "Average events per frame: %.1f\n",
           (float)callback_data.event_count / (float)callback_data.bin_manager->bins_written);
+  if (callback_data.reorder && callback_data.reorder->late) {
+    fprintf(stderr, "Late events dropped: %lu (outside the %s reorder window)\n",
+            (unsigned long)callback_data.reorder->late, formatTimeBinDuration(config->reorder_seconds));
+  }
 
   /* Generate video */
   if (callback_data.bin_manager->bins_written > 0) {
@@ -562,6 +928,7 @@ int processHoneypotFile(const char *fName)
   }
 
   /* Cleanup */
+  destroyReorderBuffer(callback_data.reorder);
   destroyTimeBinManager(callback_data.bin_manager);
   deInitLogParser();
   deInitVisualization();
@@ -607,9 +974,9 @@ int initProcessing(void)
   bin_config.bin_seconds = config->time_bin_seconds;
   bin_config.start_time = 0;  /* Auto-detect from first event */
   bin_config.end_time = 0;    /* Process all events */
-  bin_config.hilbert_order = HILBERT_ORDER_DEFAULT;
-  bin_config.dimension = 1 << HILBERT_ORDER_DEFAULT;  /* 2^order */
   bin_config.decay_seconds = DECAY_CACHE_DURATION_DEFAULT;
+  bin_config.decay_cache_bytes = (size_t)config->decay_cache_mb * 1024 * 1024;
+  bin_config.decay_model = config->exp_decay ? DECAY_EXPONENTIAL : DECAY_LINEAR;
 
   /* Setup visualization configuration */
   g_viz_config.width = config->viz_width;
@@ -620,6 +987,9 @@ int initProcessing(void)
   fprintf(stderr, "Output directory: %s\n", g_viz_config.output_dir);
   fprintf(stderr, "Resolution: %ux%u\n", g_viz_config.width, g_viz_config.height);
 
+  /* Hilbert order and dense/sparse storage within --mem-limit */
+  planHeatmapStorage(&bin_config);
+
   /* Create output directory if it doesn't exist */
   if (mkdir(g_viz_config.output_dir, 0755) != 0 && errno != EEXIST) {
     fprintf(stderr, "ERR - Failed to create output directory: %s\n", g_viz_config.output_dir);
@@ -627,10 +997,13 @@ int initProcessing(void)
   }
 
   /* Initialize Hilbert curve engine */
-  if (!initHilbert(HILBERT_ORDER_DEFAULT)) {
+  if (!initHilbert(bin_config.hilbert_order)) {
     fprintf(stderr, "ERR - Failed to initialize Hilbert curve engine\n");
     return EXIT_FAILURE;
   }
+  if (config->prefix_table_file && !usePrefixTable(config->prefix_table_file)) {
+    fprintf(stderr, "WARN - Prefix table disabled, mapping each address\n");
+  }
 
   /* Load CIDR mapping for proportional timezone-based positioning */
   if (config->cidr_map_file && config->cidr_map_file[0] != '\0') {
@@ -673,6 +1046,45 @@ int initProcessing(void)
   g_callback_data.event_count = 0;
   g_callback_data.bin_manager = g_bin_manager;
   g_callback_data.viz_config = &g_viz_config;
+  g_callback_data.resumed_events = 0;
+
+  /* Carry residue, decay and the unfinished bin over from the last run */
+  if (config->load_state_file && access(config->load_state_file, F_OK) != 0 && errno == ENOENT) {
+    fprintf(stderr, "WARN - No state file yet, starting cold: %s\n", config->load_state_file);
+  } else if (config->load_state_file) {
+    if (!loadTimeBinState(g_bin_manager, config->load_state_file)) {
+      destroyTimeBinManager(g_bin_manager);
+      g_bin_manager = NULL;
+      deInitLogParser();
+      deInitVisualization();
+      deInitHilbert();
+      return EXIT_FAILURE;
+    }
+    if (g_bin_manager->current_bin) {
+      g_callback_data.resumed_events = g_bin_manager->current_bin->event_count;
+    }
+    fprintf(stderr, "Resumed state: %s (%u residue cells, %u fading, %u events in open bin)\n",
+            config->load_state_file, g_bin_manager->residue_count, g_bin_manager->cache_size,
+            g_callback_data.resumed_events);
+  }
+
+  if (!openFrameStats(&g_callback_data)) {
+    destroyTimeBinManager(g_bin_manager);
+    g_bin_manager = NULL;
+    deInitLogParser();
+    deInitVisualization();
+    deInitHilbert();
+    return EXIT_FAILURE;
+  }
+
+  /* Write frames on render threads while binning continues (NULL = inline) */
+  g_callback_data.bin_jobs = createBinJobs(g_bin_manager, &g_viz_config, config->bin_jobs);
+
+  /* Take late events into their bins (NULL = bin in arrival order) */
+  g_callback_data.reorder = createReorderBuffer(g_bin_manager->config.bin_seconds, config->reorder_seconds);
+  if (g_callback_data.reorder) {
+    fprintf(stderr, "Reorder window: %s\n", formatTimeBinDuration(config->reorder_seconds));
+  }
 
   g_processing_initialized = TRUE;
 
@@ -704,7 +1116,7 @@ int processFileIntoTimeline(const char *fName)
   fprintf(stderr, "\nProcessing: %s\n", fName);
 
   /* Process the gzip file */
-  if (!processGzipFile(fName, honeypotEventCallback, &g_callback_data)) {
+  if (!processGzipFileBatch(fName, honeypotBatchCallback, &g_callback_data)) {
     fprintf(stderr, "ERR - Failed to process file: %s\n", fName);
     return EXIT_FAILURE;
   }
@@ -712,6 +1124,84 @@ int processFileIntoTimeline(const char *fName)
   return EXIT_SUCCESS;
 }
 
+/****
+ *
+ * Process several files into existing timeline in parallel
+ *
+ * DESCRIPTION:
+ *   Parses all files on parser threads and merges their events by
+ *   timestamp before binning, so files that overlap in time (several
+ *   sensors, or out-of-order rotations) still land in the right bins.
+ *   Must be called after initProcessing().
+ *
+ * PARAMETERS:
+ *   file_paths - Paths to gzip log files (merge tie-break order)
+ *   file_count - Number of files
+ *   jobs - Number of parser threads
+ *
+ * RETURNS:
+ *   EXIT_SUCCESS or EXIT_FAILURE
+ *
+ ****/
+int processFilesIntoTimeline(char **file_paths, int file_count, int jobs)
+{
+  if (!g_processing_initialized) {
+    fprintf(stderr, "ERR - Processing not initialized. Call initProcessing() first\n");
+    return EXIT_FAILURE;
+  }
+
+  fprintf(stderr, "\nProcessing %d files with %d parser thread%s (merged by timestamp)\n",
+          file_count, jobs, (jobs == 1) ? "" : "s");
+
+  if (!ingestFilesMerged(file_paths, file_count, jobs, honeypotBatchCallback, &g_callback_data)) {
+    fprintf(stderr, "ERR - Failed to process input files\n");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+/****
+ *
+ * Save a checkpoint of the timeline
+ *
+ * DESCRIPTION:
+ *   Writes residue, decay cache and the unfinished bin for a later run's
+ *   --load-state. Must be called after the last file and before
+ *   finalizeProcessing(), which applies decay to the last bin and
+ *   rescales the decay window.
+ *
+ * PARAMETERS:
+ *   file_path - Checkpoint to write
+ *
+ * RETURNS:
+ *   EXIT_SUCCESS or EXIT_FAILURE
+ *
+ ****/
+int saveProcessingState(const char *file_path)
+{
+  if (!g_processing_initialized) {
+    fprintf(stderr, "ERR - Processing not initialized. Call initProcessing() first\n");
+    return EXIT_FAILURE;
+  }
+
+  /* Events still in the reorder window belong in the checkpoint */
+  if (g_callback_data.reorder && !binReorderedEvents(&g_callback_data, 0, TRUE)) {
+    fprintf(stderr, "ERR - Failed to process held events\n");
+    return EXIT_FAILURE;
+  }
+
+  if (!saveTimeBinState(g_bin_manager, file_path)) {
+    fprintf(stderr, "ERR - Failed to save state file: %s\n", file_path);
+    return EXIT_FAILURE;
+  }
+
+  fprintf(stderr, "\nSaved state: %s (%u residue cells, %u fading)\n",
+          file_path, g_bin_manager->residue_count, g_bin_manager->cache_size);
+
+  return EXIT_SUCCESS;
+}
+
 /****
  *
  * Finalize multi-file processing and generate video
@@ -736,6 +1226,11 @@ int finalizeProcessing(void)
     return EXIT_FAILURE;
   }
 
+  /* Bin what the reorder window still holds */
+  if (g_callback_data.reorder && !binReorderedEvents(&g_callback_data, 0, TRUE)) {
+    fprintf(stderr, "ERR - Failed to process held events\n");
+  }
+
   /* Calculate auto-scaled FPS and decay based on data time span */
   if (config->auto_scale && g_first_timestamp > 0 && g_last_timestamp > g_first_timestamp) {
     /* Calculate time span in days */
@@ -760,7 +1255,7 @@ int finalizeProcessing(void)
     config->video_fps = calculated_fps;
 
     /* Update decay in bin manager config */
-    g_bin_manager->config.decay_seconds = calculated_decay_seconds;
+    setDecayWindow(g_bin_manager, calculated_decay_seconds);
 
     fprintf(stderr, "Auto-scaled: FPS=%u, Decay=%uh (%.1f days x 3)\n",
             config->video_fps,
@@ -774,6 +1269,7 @@ int finalizeProcessing(void)
     applyDecayToHeatmap(g_bin_manager, g_bin_manager->current_bin);
 
     finalizeBin(g_bin_manager->current_bin);
+    accumulateBinTotals(g_bin_manager, g_bin_manager->current_bin);
 
     generateBinFilename(output_path, sizeof(output_path),
                        g_viz_config.output_dir,
@@ -781,17 +1277,22 @@ int finalizeProcessing(void)
                        g_bin_manager->current_bin->bin_start,
                        g_bin_manager->bins_written);
 
-    if (renderTimeBin(g_bin_manager->current_bin, output_path,
+    if (expandTimeBin(g_bin_manager, g_bin_manager->current_bin) &&
+        renderTimeBin(g_bin_manager->current_bin, output_path,
                       g_viz_config.width, g_viz_config.height,
                       g_bin_manager->residue_map,
                       g_bin_manager->residue_max_volume)) {
       g_bin_manager->bins_written++;
+      writeFrameStats(&g_callback_data, g_bin_manager->current_bin, g_bin_manager->bins_written - 1);
 #ifdef DEBUG
       if (config->debug >= 1) {
-        fprintf(stderr, "DEBUG - Wrote final frame %u: %s (events=%u, unique_ips=%u, max_intensity=%u, cached=%u)\n",
+        fprintf(stderr, "DEBUG - Wrote final frame %u: %s (events=%u, cells=%u, src_ips=%u, hour_src_ips=%u, day_src_ips=%u, max_intensity=%u, cached=%u)\n",
                 g_bin_manager->bins_written - 1, output_path,
                 g_bin_manager->current_bin->event_count,
-                g_bin_manager->current_bin->unique_ips,
+                g_bin_manager->current_bin->unique_cells,
+                g_bin_manager->current_bin->unique_src_ips,
+                g_bin_manager->hour_unique_src_ips,
+                g_bin_manager->day_unique_src_ips,
                 g_bin_manager->current_bin->max_intensity,
                 g_bin_manager->cache_size);
       }
@@ -799,7 +1300,11 @@ int finalizeProcessing(void)
     } else {
       fprintf(stderr, "ERR - Failed to write final frame: %s\n", output_path);
     }
+    collapseTimeBin(g_bin_manager, g_bin_manager->current_bin);
   }
+  destroyBinJobs(g_callback_data.bin_jobs);
+  g_callback_data.bin_jobs = NULL;
+  closeFrameStats(&g_callback_data);
 
   fprintf(stderr, "\nSummary:\n");
   fprintf(stderr, "========\n");
@@ -809,6 +1314,10 @@ int finalizeProcessing(void)
     fprintf(stderr, "Average events per frame: %.1f\n",
             (float)g_callback_data.event_count / (float)g_bin_manager->bins_written);
   }
+  if (g_callback_data.reorder && g_callback_data.reorder->late) {
+    fprintf(stderr, "Late events dropped: %lu (outside the %s reorder window)\n",
+            (unsigned long)g_callback_data.reorder->late, formatTimeBinDuration(config->reorder_seconds));
+  }
 
   /* Generate video */
   if (g_bin_manager->bins_written > 0) {
@@ -838,6 +1347,8 @@ int finalizeProcessing(void)
   }
 
   /* Cleanup */
+  destroyReorderBuffer(g_callback_data.reorder);
+  g_callback_data.reorder = NULL;
   destroyTimeBinManager(g_bin_manager);
   deInitLogParser();
   deInitVisualization();
@@ -30,6 +30,8 @@
  ****/
 
 #define LINEBUF_SIZE 4096
+#define HEATMAP_MEM_LIMIT_MAX_MB (1024 * 1024)  /* Upper bound for --mem-limit */
+#define HEATMAP_MEM_LIMIT_FALLBACK_MB 4096       /* Used when physical memory is unknown */
 
 /****
  *
@@ -51,9 +53,12 @@
 #include "util.h"
 #include "mem.h"
 #include "log_parser.h"
+#include "ingest.h"
 #include "hilbert.h"
 #include "timebin.h"
 #include "visualize.h"
+#include "binjobs.h"
+#include "reorder.h"
 
 /****
  *
@@ -79,6 +84,8 @@ int processHoneypotFile(const char *fName);
 /* Multi-file interface */
 int initProcessing(void);
 int processFileIntoTimeline(const char *fName);
+int processFilesIntoTimeline(char **file_paths, int file_count, int jobs);
+int saveProcessingState(const char *file_path);
 int finalizeProcessing(void);
 
 #endif /* TPLOT_DOT_H */
@@ -31,8 +31,17 @@
 #include "mem.h"
 #include "util.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/stat.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
 
 /****
  *
@@ -43,8 +52,10 @@
 PRIVATE int viz_initialized = FALSE;
 PRIVATE VisualizationConfig_t viz_config;
 
-/* Cached non-routable mask to avoid recreating every frame */
-PRIVATE uint8_t *cached_nonroutable_mask = NULL;
+/* Cached non-routable mask (a bit per cell) to avoid recreating every frame */
+PRIVATE uint64_t *cached_nonroutable_mask = NULL;
+PRIVATE void *cached_mask_base = NULL;       /* Allocation or mapping holding the mask */
+PRIVATE size_t cached_mask_mapped = 0;       /* Mapping size, 0 if allocated */
 PRIVATE uint8_t cached_mask_order = 0;
 PRIVATE uint32_t cached_mask_dimension = 0;
 
@@ -160,13 +171,13 @@ PRIVATE void drawChar(uint8_t *image, uint32_t img_width, uint32_t img_height,
 PRIVATE void drawTimestamp(uint8_t *image, uint32_t img_width, uint32_t img_height, time_t timestamp)
 {
     char time_str[32];
-    struct tm *tm_info;
+    struct tm tm_info;
     uint32_t x, i;
     uint32_t scale = 2;  /* 2x scale for readability */
     uint32_t char_spacing = (FONT_WIDTH + 2) * scale;
 
-    tm_info = localtime(&timestamp);
-    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", tm_info);
+    localtime_r(&timestamp, &tm_info);  /* Frames may be drawn on several threads */
+    strftime(time_str, sizeof(time_str), "%Y-%m-%d %H:%M:%S", &tm_info);
 
     /* Position at bottom left with margin */
     x = TIMESTAMP_MARGIN;
@@ -212,6 +223,30 @@ int initVisualization(VisualizationConfig_t *config_in)
     return TRUE;
 }
 
+/****
+ * Release the cached non-routable mask
+ *
+ * DESCRIPTION:
+ *   Unmaps or frees the mask. Safe to call when none is cached.
+ ****/
+PRIVATE void freeNonRoutableMask(void)
+{
+#ifdef HAVE_SYS_MMAN_H
+    if (cached_mask_mapped) {
+        munmap(cached_mask_base, cached_mask_mapped);
+        cached_mask_base = NULL;
+    }
+#endif
+    if (cached_mask_base) {
+        XFREE(cached_mask_base);
+        cached_mask_base = NULL;
+    }
+    cached_mask_mapped = 0;
+    cached_nonroutable_mask = NULL;
+    cached_mask_order = 0;
+    cached_mask_dimension = 0;
+}
+
 /****
  * Deinitialize visualization system and free resources
  *
@@ -221,106 +256,220 @@ int initVisualization(VisualizationConfig_t *config_in)
  ****/
 void deInitVisualization(void)
 {
-    /* Free cached mask if allocated */
-    if (cached_nonroutable_mask) {
-        XFREE(cached_nonroutable_mask);
-        cached_nonroutable_mask = NULL;
-        cached_mask_order = 0;
-        cached_mask_dimension = 0;
-    }
+    freeNonRoutableMask();
 
     viz_initialized = FALSE;
 }
 
 /****
- * Create non-routable IP space mask for Hilbert curve visualization
+ * Path of the non-routable mask cache file
  *
  * DESCRIPTION:
- *   Generates binary mask identifying non-routable IP coordinates (RFC1918
- *   private, loopback, multicast, etc.). Samples IPv4 space and maps to
- *   Hilbert coordinates. Result is cached to avoid repeated computation.
+ *   $XDG_CACHE_HOME/tplot (or ~/.cache/tplot), creating the directories
+ *   as needed. The name carries the order and CIDR map hash, so masks
+ *   for different orders and maps live side by side.
  *
  * PARAMETERS:
- *   order - Hilbert curve order (determines 2^order dimension)
- *   dimension - Hilbert curve dimension (must equal 2^order)
+ *   path - Receives the path
+ *   path_size - Size of path
+ *   header - Header of the mask to cache
  *
  * RETURNS:
- *   Allocated uint8_t array of size dimension² (0=routable, 1=non-routable)
- *   NULL on allocation failure
+ *   TRUE if path is usable, FALSE if there is nowhere to cache
  ****/
-PRIVATE uint8_t *createNonRoutableMask(uint8_t order, uint32_t dimension)
+PRIVATE int getMaskCachePath(char *path, size_t path_size, const MaskCacheHeader_t *header)
 {
-    uint8_t *mask;
-    uint32_t mask_size;
-    uint32_t ip, x, y, idx;
-    uint64_t hilbert_idx;
-    uint32_t sample_step;
-
-    mask_size = dimension * dimension;
-    mask = (uint8_t *)XMALLOC((int)(mask_size * sizeof(uint8_t)));
-    if (!mask) {
-        fprintf(stderr, "ERR - Failed to allocate non-routable mask\n");
-        return NULL;
+    const char *base = getenv("XDG_CACHE_HOME");
+    size_t dir_len;
+    int len;
+
+    if (base && base[0] == '/') {
+        len = snprintf(path, path_size, "%s", base);
+    } else {
+        base = getenv("HOME");
+        if (!base || base[0] != '/') {
+            return FALSE;
+        }
+        len = snprintf(path, path_size, "%s/.cache", base);
+    }
+    if (len < 0 || (size_t)len >= path_size || (mkdir(path, 0700) != 0 && errno != EEXIST)) {
+        return FALSE;
+    }
+
+    dir_len = (size_t)len;
+    len = snprintf(path + dir_len, path_size - dir_len, "/%s", VIZ_MASK_CACHE_DIR);
+    if (len < 0 || (size_t)len >= path_size - dir_len || (mkdir(path, 0700) != 0 && errno != EEXIST)) {
+        return FALSE;
     }
 
-    /* Initialize to zero (routable) */
-    memset(mask, 0, mask_size);
+    dir_len += (size_t)len;
+    len = snprintf(path + dir_len, path_size - dir_len, "/nonroutable-o%u-%08x.bin",
+                   header->order, header->map_hash);
+    return (len > 0 && (size_t)len < path_size - dir_len);
+}
 
-    /* Sample the IP space - we'll check every Nth IP to build the mask
-     * For order 12 (4096x4096 = 16M points) vs 4.3B IPv4 addresses,
-     * we sample every ~256 IPs to get good coverage
-     */
-    sample_step = (order <= 10) ? 64 : 256;
+/****
+ * Map a cached non-routable mask
+ *
+ * PARAMETERS:
+ *   path - Cache file
+ *   expected - Header the file must carry
+ *
+ * RETURNS:
+ *   TRUE if the mask is attached, FALSE if the file is missing, stale
+ *   or cannot be mapped
+ ****/
+PRIVATE int mapNonRoutableMask(const char *path, const MaskCacheHeader_t *expected)
+{
+#ifdef HAVE_SYS_MMAN_H
+    MaskCacheHeader_t header;
+    struct stat st;
+    void *base;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return FALSE;
+    }
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || (uint64_t)st.st_size != expected->file_bytes ||
+        read(fd, &header, sizeof(header)) != (ssize_t)sizeof(header) ||
+        memcmp(&header, expected, sizeof(header)) != 0) {
+        close(fd);
+        return FALSE;
+    }
 
-#ifdef DEBUG
-    if (config->debug >= 2) {
-        fprintf(stderr, "DEBUG - Creating non-routable IP mask (order=%u, step=%u)\n",
-                order, sample_step);
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return FALSE;
     }
+
+    cached_mask_base = base;
+    cached_mask_mapped = (size_t)st.st_size;
+    cached_nonroutable_mask = (uint64_t *)(void *)((uint8_t *)base + sizeof(MaskCacheHeader_t));
+    return TRUE;
+#else
+    (void)path;
+    (void)expected;
+    return FALSE;
 #endif
+}
 
-    /* Scan IP ranges that are non-routable */
-    for (ip = 0; ip < 0xFFFFFFFF; ip += sample_step) {
-        if (isNonRoutableIP(ip)) {
-            /* Map this IP to Hilbert coordinates */
-            hilbert_idx = ipToHilbertIndex(ip, order);
-            hilbertIndexToXY(hilbert_idx, order, &x, &y);
-
-            /* Mark this position as non-routable */
-            if (x < dimension && y < dimension) {
-                idx = y * dimension + x;
-                mask[idx] = 1;
-            }
-        }
+/****
+ * Write the non-routable mask to its cache file
+ *
+ * DESCRIPTION:
+ *   Writes via a per-process temporary file and rename() so concurrent
+ *   runs never map a partial mask.
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on I/O error
+ ****/
+PRIVATE int saveNonRoutableMask(const char *path, const MaskCacheHeader_t *header)
+{
+    char tmp_path[PATH_MAX];
+    size_t mask_bytes = (size_t)(header->file_bytes - sizeof(*header));
+    FILE *fp;
+    int ok;
+
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.tmp", path, (long)getpid()) >= (int)sizeof(tmp_path)) {
+        return FALSE;
+    }
+
+    fp = fopen(tmp_path, "wb");
+    if (!fp) {
+        return FALSE;
+    }
+    ok = (fwrite(header, sizeof(*header), 1, fp) == 1 &&
+          fwrite(cached_nonroutable_mask, 1, mask_bytes, fp) == mask_bytes);
+    if (fclose(fp) != 0) {
+        ok = FALSE;
+    }
+    if (!ok || rename(tmp_path, path) != 0) {
+        unlink(tmp_path);
+        return FALSE;
+    }
+
+    return TRUE;
+}
 
-        /* Handle wrap-around at end of IP space */
-        if (ip > 0xFFFFFFFF - sample_step) {
-            break;
+/****
+ * Create non-routable IP space mask for Hilbert curve visualization
+ *
+ * DESCRIPTION:
+ *   Builds the bitset of cells non-routable addresses (RFC1918 private,
+ *   loopback, multicast, etc.) map to under the current mapping, direct
+ *   or CIDR (rasterizeNonRoutable()). Maps the on-disk copy when one
+ *   matches the order and CIDR map, otherwise rasterizes it and writes
+ *   the cache file for the next run.
+ *
+ * PARAMETERS:
+ *   order - Hilbert curve order (determines 2^order dimension)
+ *   dimension - Hilbert curve dimension (must equal 2^order)
+ *
+ * RETURNS:
+ *   TRUE if the mask is cached, FALSE on allocation failure
+ *
+ * MEMORY:
+ *   dimension^2 / 8 bytes (2MB at order 12, 512MB at order 16), shared
+ *   page cache when mapped from the cache file
+ ****/
+PRIVATE int createNonRoutableMask(uint8_t order, uint32_t dimension)
+{
+    MaskCacheHeader_t header;
+    char path[PATH_MAX];
+    uint64_t mask_bytes = ((uint64_t)dimension * dimension) / 8;
+    int have_path;
+
+    XMEMSET(&header, 0, sizeof(header));
+    XMEMCPY(header.magic, VIZ_MASK_MAGIC, 8);
+    header.header_bytes = sizeof(MaskCacheHeader_t);
+    header.order = order;
+    header.map_hash = getCIDRMapHash();
+    header.file_bytes = sizeof(MaskCacheHeader_t) + mask_bytes;
+
+    have_path = getMaskCachePath(path, sizeof(path), &header);
+    if (have_path && mapNonRoutableMask(path, &header)) {
+#ifdef DEBUG
+        if (config->debug >= 2) {
+            fprintf(stderr, "DEBUG - Non-routable mask mapped from %s\n", path);
         }
+#endif
+        return TRUE;
+    }
+
+    cached_mask_base = XMALLOC((int)mask_bytes);
+    if (!cached_mask_base) {
+        fprintf(stderr, "ERR - Failed to allocate non-routable mask\n");
+        return FALSE;
     }
+    XMEMSET(cached_mask_base, 0, (int)mask_bytes);
+    cached_nonroutable_mask = (uint64_t *)cached_mask_base;
 
-    /* Also check the last IP explicitly */
-    if (isNonRoutableIP(0xFFFFFFFF)) {
-        hilbert_idx = ipToHilbertIndex(0xFFFFFFFF, order);
-        hilbertIndexToXY(hilbert_idx, order, &x, &y);
-        if (x < dimension && y < dimension) {
-            idx = y * dimension + x;
-            mask[idx] = 1;
+    rasterizeNonRoutable(cached_nonroutable_mask, order);
+
+    if (have_path && !saveNonRoutableMask(path, &header)) {
+#ifdef DEBUG
+        if (config->debug >= 2) {
+            fprintf(stderr, "DEBUG - Cannot write non-routable mask cache %s\n", path);
         }
+#endif
     }
 
 #ifdef DEBUG
     if (config->debug >= 2) {
-        uint32_t marked_count = 0;
-        for (idx = 0; idx < mask_size; idx++) {
-            if (mask[idx]) marked_count++;
+        uint64_t marked_count = 0;
+        uint64_t pos, mask_size = (uint64_t)dimension * dimension;
+        for (pos = 0; pos < mask_size / 64; pos++) {
+            marked_count += (uint64_t)__builtin_popcountll(cached_nonroutable_mask[pos]);
         }
-        fprintf(stderr, "DEBUG - Non-routable mask: %u/%u positions marked (%.2f%%)\n",
-                marked_count, mask_size, (100.0f * marked_count) / mask_size);
+        fprintf(stderr, "DEBUG - Non-routable mask: %lu/%lu positions marked (%.2f%%), %lu bytes\n",
+                (unsigned long)marked_count, (unsigned long)mask_size,
+                (100.0 * (double)marked_count) / (double)mask_size, (unsigned long)mask_bytes);
     }
 #endif
 
-    return mask;
+    return TRUE;
 }
 
 /****
@@ -400,6 +549,83 @@ RGB_t intensityToColor(uint32_t intensity, uint32_t max_intensity)
     return color;
 }
 
+/****
+ * Get the cached non-routable mask for a Hilbert curve dimension
+ *
+ * DESCRIPTION:
+ *   Returns the cached mask, building it (and replacing a mask cached for
+ *   another dimension) on first use.
+ *
+ * RETURNS:
+ *   Mask with a bit per cell, NULL if it could not be built
+ ****/
+PRIVATE const uint64_t *getNonRoutableMask(uint32_t dimension)
+{
+    /* Calculate Hilbert order from dimension (dimension = 2^order) */
+    uint8_t hilbert_order = 0;
+    uint32_t temp_dim = dimension;
+    while (temp_dim > 1) {
+        temp_dim >>= 1;
+        hilbert_order++;
+    }
+
+    /* Check if we can use cached mask */
+    if (cached_nonroutable_mask &&
+        cached_mask_order == hilbert_order &&
+        cached_mask_dimension == dimension) {
+        /* Reuse cached mask */
+#ifdef DEBUG
+        if (config->debug >= 4) {
+            fprintf(stderr, "DEBUG - Using cached non-routable mask\n");
+        }
+#endif
+        return cached_nonroutable_mask;
+    }
+
+    /* Replace a mask cached for other dimensions */
+    freeNonRoutableMask();
+    if (!createNonRoutableMask(hilbert_order, dimension)) {
+        fprintf(stderr, "WARN - Failed to create non-routable mask, continuing without it\n");
+        return NULL;
+    }
+    cached_mask_order = hilbert_order;
+    cached_mask_dimension = dimension;
+
+    return cached_nonroutable_mask;
+}
+
+/****
+ * Build the non-routable mask ahead of rendering
+ *
+ * DESCRIPTION:
+ *   Frames written on several threads share the cached mask. Building it
+ *   up front leaves writePPMBuffer() only reading shared state.
+ *
+ * RETURNS:
+ *   TRUE if the mask is cached, FALSE otherwise (frames render without it)
+ ****/
+int prepareNonRoutableMask(uint32_t dimension)
+{
+    return (getNonRoutableMask(dimension) != NULL);
+}
+
+/****
+ * Size of the image buffer for one frame
+ *
+ * RETURNS:
+ *   Bytes of RGB data, including the timestamp strip when enabled
+ ****/
+uint32_t getPPMBufferSize(uint32_t width, uint32_t height)
+{
+    uint32_t actual_height = height;
+
+    if (config->show_timestamp) {
+        actual_height = height + TIMESTAMP_HEIGHT;
+    }
+
+    return actual_height * width * 3;  /* 3 bytes per pixel (RGB) */
+}
+
 /****
  * Write time bin heatmap as PPM image file
  *
@@ -409,7 +635,7 @@ RGB_t intensityToColor(uint32_t intensity, uint32_t max_intensity)
  *
  * PARAMETERS:
  *   filename - Output file path
- *   bin - TimeBin_t with heatmap data
+ *   bin - TimeBin_t to draw, dense, expanded (expandTimeBin()) or sparse
  *   width - Output width in pixels
  *   height - Output height in pixels
  *   residue_map - Persistent attack memory volume map (may be NULL)
@@ -418,22 +644,55 @@ RGB_t intensityToColor(uint32_t intensity, uint32_t max_intensity)
  * RETURNS:
  *   TRUE on success, FALSE on error
  ****/
-int writePPM(const char *filename, const TimeBin_t *bin, uint32_t width, uint32_t height, const uint32_t *residue_map, uint32_t residue_max_volume)
+int writePPM(const char *filename, const TimeBin_t *bin, uint32_t width, uint32_t height, const GridMap_t *residue_map, uint32_t residue_max_volume)
+{
+    uint8_t *image_buffer;
+    int ret;
+
+    if (!filename || !bin) {
+        return FALSE;
+    }
+
+    /* Allocate image buffer */
+    image_buffer = (uint8_t *)XMALLOC((int)getPPMBufferSize(width, height));
+    if (!image_buffer) {
+        fprintf(stderr, "ERR - Failed to allocate image buffer\n");
+        return FALSE;
+    }
+
+    ret = writePPMBuffer(filename, bin, width, height, residue_map, residue_max_volume, image_buffer);
+    XFREE(image_buffer);
+
+    return ret;
+}
+
+/****
+ * Write time bin heatmap as PPM image file into a caller's buffer
+ *
+ * DESCRIPTION:
+ *   writePPM() rendering into image_buffer (getPPMBufferSize() bytes)
+ *   instead of a buffer allocated per frame. Allocates nothing once the
+ *   non-routable mask is cached, so frames may be written on several
+ *   threads at once after prepareNonRoutableMask().
+ *
+ * RETURNS:
+ *   TRUE on success, FALSE on error
+ ****/
+int writePPMBuffer(const char *filename, const TimeBin_t *bin, uint32_t width, uint32_t height, const GridMap_t *residue_map, uint32_t residue_max_volume, uint8_t *image_buffer)
 {
     FILE *fp;
     uint32_t x, y, src_x, src_y;
     uint32_t intensity, idx;
     RGB_t color;
-    uint8_t *nonroutable_mask = NULL;
+    const uint64_t *nonroutable_mask = NULL;
     int is_nonroutable;
-    uint8_t *image_buffer = NULL;
     uint32_t actual_height = height;
     uint32_t image_buffer_size;
 
     /* Suppress unused parameter warning - kept in signature for API consistency */
     (void)residue_max_volume;
 
-    if (!filename || !bin || !bin->heatmap) {
+    if (!filename || !bin || !image_buffer) {
         return FALSE;
     }
 
@@ -442,60 +701,17 @@ int writePPM(const char *filename, const TimeBin_t *bin, uint32_t width, uint32_
         actual_height = height + TIMESTAMP_HEIGHT;
     }
 
-    /* Allocate image buffer */
-    image_buffer_size = actual_height * width * 3;  /* 3 bytes per pixel (RGB) */
-    image_buffer = (uint8_t *)XMALLOC((int)image_buffer_size);
-    if (!image_buffer) {
-        fprintf(stderr, "ERR - Failed to allocate image buffer\n");
-        return FALSE;
-    }
-
     /* Initialize buffer to black */
+    image_buffer_size = getPPMBufferSize(width, height);
     memset(image_buffer, 0, image_buffer_size);
 
     /* Create mask for non-routable IP space */
-    /* Calculate Hilbert order from dimension (dimension = 2^order) */
-    uint8_t hilbert_order = 0;
-    uint32_t temp_dim = bin->dimension;
-    while (temp_dim > 1) {
-        temp_dim >>= 1;
-        hilbert_order++;
-    }
-
-    /* Check if we can use cached mask */
-    if (cached_nonroutable_mask &&
-        cached_mask_order == hilbert_order &&
-        cached_mask_dimension == bin->dimension) {
-        /* Reuse cached mask */
-        nonroutable_mask = cached_nonroutable_mask;
-#ifdef DEBUG
-        if (config->debug >= 4) {
-            fprintf(stderr, "DEBUG - Using cached non-routable mask\n");
-        }
-#endif
-    } else {
-        /* Create new mask and cache it */
-        nonroutable_mask = createNonRoutableMask(hilbert_order, bin->dimension);
-        if (!nonroutable_mask) {
-            fprintf(stderr, "WARN - Failed to create non-routable mask, continuing without it\n");
-        } else {
-            /* Free old cache if different dimensions */
-            if (cached_nonroutable_mask &&
-                (cached_mask_order != hilbert_order || cached_mask_dimension != bin->dimension)) {
-                XFREE(cached_nonroutable_mask);
-            }
-            /* Cache the new mask */
-            cached_nonroutable_mask = nonroutable_mask;
-            cached_mask_order = hilbert_order;
-            cached_mask_dimension = bin->dimension;
-        }
-    }
+    nonroutable_mask = getNonRoutableMask(bin->dimension);
 
     /* Use secure_fopen() to prevent symlink attacks */
     fp = secure_fopen(filename, "wb");
     if (!fp) {
         fprintf(stderr, "ERR - Failed to open %s for writing\n", filename);
-        XFREE(image_buffer);
         /* Note: Do not free nonroutable_mask - it's cached */
         return FALSE;
     }
@@ -538,24 +754,24 @@ int writePPM(const char *filename, const TimeBin_t *bin, uint32_t width, uint32_
 
                 if (src_x < bin->dimension && src_y < bin->dimension) {
                     idx = src_y * bin->dimension + src_x;
-                    intensity = bin->heatmap[idx];
+                    intensity = getTimeBinCount(bin, idx);
                     int residue_shown = FALSE;
+                    uint32_t residue_volume = (residue_map && intensity == 0) ? getGridMapCell(residue_map, idx) : 0;
 
                     /* Check residue map first - show volume-based colors for historical attacks with no current activity */
-                    if (residue_map && residue_map[idx] > 0 && intensity == 0) {
-                        uint32_t residue_volume = residue_map[idx];
+                    if (residue_volume > 0) {
 
                         /* Classify residue volume into minimal/average/heavy using absolute thresholds
                          * - Minimal (1-10 attacks): dark gray RGB(54, 54, 54)
                          * - Average (11-100 attacks): dark yellow RGB(90, 90, 0)
                          * - Heavy (100+ attacks): dark red RGB(90, 0, 0)
                          */
-                        if (residue_volume <= 10) {
+                        if (residue_volume <= RESIDUE_MINIMAL_MAX) {
                             /* Minimal volume - dark gray */
                             color.r = 54;
                             color.g = 54;
                             color.b = 54;
-                        } else if (residue_volume <= 100) {
+                        } else if (residue_volume <= RESIDUE_AVERAGE_MAX) {
                             /* Average volume - dark yellow (brighter for visibility) */
                             color.r = 90;
                             color.g = 90;
@@ -574,7 +790,7 @@ int writePPM(const char *filename, const TimeBin_t *bin, uint32_t width, uint32_
                     }
 
                     /* Apply dark blue overlay for non-routable IP space */
-                    is_nonroutable = (nonroutable_mask && nonroutable_mask[idx]);
+                    is_nonroutable = (nonroutable_mask && ((nonroutable_mask[idx >> 6] >> (idx & 63)) & 1));
                     if (is_nonroutable && !residue_shown) {
                         /* If no activity and no residue, show dark blue base color
                          * If activity present, blend with moderately dark blue
@@ -619,13 +835,11 @@ int writePPM(const char *filename, const TimeBin_t *bin, uint32_t width, uint32_
     /* Write buffer to file */
     if (fwrite(image_buffer, 1, image_buffer_size, fp) != image_buffer_size) {
         fprintf(stderr, "ERR - Failed to write image data to %s\n", filename);
-        XFREE(image_buffer);
         fclose(fp);
         return FALSE;
     }
 
     fclose(fp);
-    XFREE(image_buffer);
 
     /* Note: Do not free nonroutable_mask here - it's cached for reuse */
 
@@ -678,7 +892,7 @@ int generateBinFilename(char *buf, size_t buf_size, const char *dir,
  * RETURNS:
  *   TRUE on success, FALSE on error
  ****/
-int renderTimeBin(const TimeBin_t *bin, const char *output_path, uint32_t width, uint32_t height, const uint32_t *residue_map, uint32_t residue_max_volume)
+int renderTimeBin(const TimeBin_t *bin, const char *output_path, uint32_t width, uint32_t height, const GridMap_t *residue_map, uint32_t residue_max_volume)
 {
     if (!bin || !output_path) {
         return FALSE;
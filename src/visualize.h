@@ -68,6 +68,10 @@
 #define VIZ_WIDTH_DEFAULT  VIZ_WIDTH_UWQHD
 #define VIZ_HEIGHT_DEFAULT VIZ_HEIGHT_UWQHD
 
+/* Non-routable mask cache files, bump the magic when the prefix list changes */
+#define VIZ_MASK_MAGIC "TPMASK01"
+#define VIZ_MASK_CACHE_DIR "tplot"   /* Under $XDG_CACHE_HOME or ~/.cache */
+
 /****
  *
  * typedefs & structs
@@ -93,6 +97,18 @@ typedef struct {
     const char *output_prefix; /* Filename prefix for frames */
 } VisualizationConfig_t;
 
+/**
+ * Non-routable mask cache file header, followed by dimension^2 bits
+ */
+typedef struct {
+    char magic[8];           /* VIZ_MASK_MAGIC */
+    uint32_t header_bytes;   /* sizeof(MaskCacheHeader_t) */
+    uint32_t order;          /* Hilbert order the mask was built for */
+    uint32_t map_hash;       /* CIDR map contents (getCIDRMapHash()) */
+    uint32_t reserved;       /* Zero */
+    uint64_t file_bytes;     /* Whole file, checked against its size */
+} MaskCacheHeader_t;
+
 /****
  *
  * function prototypes
@@ -107,10 +123,13 @@ void deInitVisualization(void);
 RGB_t intensityToColor(uint32_t intensity, uint32_t max_intensity);
 
 /* PPM output */
-int writePPM(const char *filename, const TimeBin_t *bin, uint32_t width, uint32_t height, const uint32_t *residue_map, uint32_t residue_max_volume);
+int writePPM(const char *filename, const TimeBin_t *bin, uint32_t width, uint32_t height, const GridMap_t *residue_map, uint32_t residue_max_volume);
+int writePPMBuffer(const char *filename, const TimeBin_t *bin, uint32_t width, uint32_t height, const GridMap_t *residue_map, uint32_t residue_max_volume, uint8_t *image_buffer);
+uint32_t getPPMBufferSize(uint32_t width, uint32_t height);
+int prepareNonRoutableMask(uint32_t dimension);
 
 /* Render time bin to image file */
-int renderTimeBin(const TimeBin_t *bin, const char *output_path, uint32_t width, uint32_t height, const uint32_t *residue_map, uint32_t residue_max_volume);
+int renderTimeBin(const TimeBin_t *bin, const char *output_path, uint32_t width, uint32_t height, const GridMap_t *residue_map, uint32_t residue_max_volume);
 
 /* Generate filename for bin */
 int generateBinFilename(char *buf, size_t buf_size, const char *dir,
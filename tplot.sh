@@ -8,6 +8,8 @@
 #   tplot.sh 7              # Process last 7 files with default options
 #   tplot.sh 7 -p 5m        # Process last 7 files with 5-minute bins
 #   tplot.sh 7 -d 1 -p 5m   # Process last 7 files with debug output
+#   tplot.sh 1 -p 5m -l state.tps -s state.tps
+#                           # Process the newest file, resuming the last run
 #
 
 # Default log directory